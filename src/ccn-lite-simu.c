@@ -194,7 +194,7 @@ ccnl_client_TX(char node, char *name, int seqn, int nonce)
     // inject it into the relay:
     if (buf) {
         ccnl_core_RX(relay, -1, buf->data, buf->datalen, 0, 0);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
     }
 }
 
@@ -263,18 +263,18 @@ ccnl_app_RX(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
         for (i = 0; i < p->compcnt-1; i++) {
             strcat((char*)tmp, "/");
             tmp[strlen(tmp) + p->complen[i] - 4] = '\0';
-            memcpy(tmp + strlen(tmp), p->comp[i]+4, p->complen[i]-4);
+            memcpy(tmp + strlen(tmp), ccnl_prefix_comp(p, i)+4, p->complen[i]-4);
         }
-        memcpy(tmp2, p->comp[p->compcnt-1]+4, p->complen[p->compcnt-1]-4);
+        memcpy(tmp2, ccnl_prefix_comp(p, p->compcnt-1)+4, p->complen[p->compcnt-1]-4);
         tmp2[p->complen[p->compcnt-1]-4] = '\0';
     } else {
         tmp[0] = '\0';
         for (i = 0; i < p->compcnt-1; i++) {
             strcat((char*)tmp, "/");
             tmp[strlen(tmp) + p->complen[i]] = '\0';
-            memcpy(tmp + strlen(tmp), p->comp[i], p->complen[i]);
+            memcpy(tmp + strlen(tmp), ccnl_prefix_comp(p, i), p->complen[i]);
         }
-        memcpy(tmp2, p->comp[p->compcnt-1], p->complen[p->compcnt-1]);
+        memcpy(tmp2, ccnl_prefix_comp(p, p->compcnt-1), p->complen[p->compcnt-1]);
         tmp2[p->complen[p->compcnt-1]] = '\0';
     }
 
@@ -418,8 +418,7 @@ ccnl_simu_add_fwd(char node, const char *name, char dstnode, int mtu)
         fwd->face->frag = ccnl_frag_new(CCNL_FRAG_BEGINEND2015, mtu);
 #endif
     fwd->face->flags |= CCNL_FACE_FLAGS_STATIC;
-    fwd->next = relay->fib;
-    relay->fib = fwd;
+    ccnl_fib_link(relay, fwd);
 }
 
 
@@ -499,36 +498,15 @@ ccnl_simu_phase_two(void *ptr, void *dummy)
 void
 simu_eventloop()
 {
-    static struct timeval now;
     long usec;
 
-    while (eventqueue) {
-        struct ccnl_timer_s *t = eventqueue;
+    while ((usec = ccnl_run_events()) >= 0) {
         // printf("  looping now %g\n", CCNL_NOW());
-        gettimeofday(&now, 0);
-        usec = timevaldelta(&(t->timeout), &now);
-        if (usec >= 0) {
-            // usleep(usec);
-            struct timespec ts;
-            ts.tv_sec = usec / 1000000;
-            ts.tv_nsec = 1000 * (usec % 1000000);
-            nanosleep(&ts, NULL);
-        }
-        t = eventqueue;
-        eventqueue = t->next;
-        if (t->fct) {
-            void (*fct)(char,int) = t->fct;
-            char c = t->node;
-            int i = t->intarg;
-            ccnl_free(t);
-            (fct)(c, i);
-        } else if (t->fct2) {
-            void (*fct2)(void*,void*) = t->fct2;
-            void *aux1 = t->aux1;
-            void *aux2 = t->aux2;
-            ccnl_free(t);
-            (fct2)(aux1, aux2);
-        }
+        // usleep(usec);
+        struct timespec ts;
+        ts.tv_sec = usec / 1000000;
+        ts.tv_nsec = 1000 * (usec % 1000000);
+        nanosleep(&ts, NULL);
     }
     DEBUGMSG(ERROR, "simu event loop: no more events to handle\n");
 }
@@ -550,8 +528,7 @@ ccnl_simu_cleanup(void *dummy, void *dummy2)
         ccnl_core_cleanup(relay);
     }
 
-    while(eventqueue)
-        ccnl_rem_timer(eventqueue);
+    ccnl_timer_cleanup();
 
     while(etherqueue) {
         struct ccnl_ethernet_s *e = etherqueue->next;
@@ -346,7 +346,7 @@ ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
             continue;
         }
 
-        buf = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*buf) + s.st_size);
+        buf = ccnl_buf_new(NULL, (size_t) s.st_size);
         if (buf)
             datalen = read(fd, buf->data, s.st_size);
         else
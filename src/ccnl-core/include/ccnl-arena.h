@@ -0,0 +1,122 @@
+/**
+ * @addtogroup CCNL-core
+ * @{
+ *
+ * @file ccnl-arena.h
+ * @brief Bump allocator for state that lives no longer than one packet
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#ifndef CCNL_ARENA_H
+#define CCNL_ARENA_H
+
+#ifndef CCNL_LINUXKERNEL
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief A region handing out memory by bumping an offset
+ *
+ * Objects are never freed one by one. Instead the offset is reset to a
+ * mark taken earlier, which drops everything allocated after it at once.
+ * \ref ccnl_core_RX enters the packet arena for every received frame, so
+ * the decoders put packets, names and nonces there. Whatever has to
+ * outlive the frame, a PIT or CS entry, is moved out by
+ * \ref ccnl_pkt_persist.
+ */
+struct ccnl_arena_s {
+    unsigned char *base;
+    size_t size;
+    size_t used;
+    size_t peak;                /**< highest used seen */
+    uint32_t depth;             /**< frames currently being handled */
+    uint32_t overflows;         /**< allocations that did not fit */
+    uint32_t promotions;        /**< packets moved to long-lived storage */
+};
+
+/**
+ * @brief The arena of the packet being handled by \ref ccnl_core_RX
+ */
+extern struct ccnl_arena_s ccnl_pkt_arena;
+
+/**
+ * @brief Allocates @p size bytes for @p arena, 0 leaves it without memory
+ *
+ * @return 0 on success, -1 while the arena is in use or out of memory
+ */
+int
+ccnl_arena_reserve(struct ccnl_arena_s *arena, size_t size);
+
+/**
+ * @brief Releases the memory of @p arena
+ */
+void
+ccnl_arena_release(struct ccnl_arena_s *arena);
+
+/**
+ * @brief Returns a mark to hand to \ref ccnl_arena_reset
+ */
+size_t
+ccnl_arena_mark(struct ccnl_arena_s *arena);
+
+/**
+ * @brief Drops everything allocated in @p arena since @p mark was taken
+ */
+void
+ccnl_arena_reset(struct ccnl_arena_s *arena, size_t mark);
+
+/**
+ * @brief Starts handling a frame, decoders allocate from @p arena until
+ *        the matching \ref ccnl_arena_leave
+ *
+ * @return The mark to pass to \ref ccnl_arena_leave
+ */
+size_t
+ccnl_arena_enter(struct ccnl_arena_s *arena);
+
+/**
+ * @brief Ends handling a frame and drops what was allocated during it
+ */
+void
+ccnl_arena_leave(struct ccnl_arena_s *arena, size_t mark);
+
+/**
+ * @brief Returns the packet arena while a frame is being handled, NULL
+ *        otherwise or if it has no memory
+ */
+struct ccnl_arena_s*
+ccnl_arena_active(void);
+
+/**
+ * @brief Returns @p size bytes of @p arena, NULL if they do not fit
+ */
+void*
+ccnl_arena_alloc(struct ccnl_arena_s *arena, size_t size);
+
+/**
+ * @brief Like \ref ccnl_arena_alloc, with the memory zeroed
+ */
+void*
+ccnl_arena_calloc(struct ccnl_arena_s *arena, size_t size);
+
+/**
+ * @brief Returns 1 if @p ptr lies in the memory of @p arena
+ */
+int
+ccnl_arena_owns(struct ccnl_arena_s *arena, void *ptr);
+
+#endif // CCNL_ARENA_H
+/** @} */
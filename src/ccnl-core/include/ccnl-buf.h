@@ -22,27 +22,82 @@
 #ifndef CCNL_LINUXKERNEL
 #include <unistd.h> //FIXME: SWITCH HERE
 #include <string.h>
+#include <stdint.h>
 #endif
 #include <stddef.h>
 
 
 struct ccnl_relay_s;
 
+/**
+ * @brief A packet buffer
+ *
+ * Buffers are either owners, with the bytes stored right after the
+ * header, or shares created by \ref ccnl_buf_share, which point into an
+ * owner's bytes. The bytes are immutable once a buffer is shared. Each
+ * share is its own header, so owner and shares can sit in different
+ * queues at the same time.
+ */
 struct ccnl_buf_s {
     struct ccnl_buf_s *next;
     size_t datalen;
-    unsigned char data[1];
+    unsigned char *data;
+    struct ccnl_buf_s *owner;   /**< buffer holding the bytes, NULL for an owner */
+    uint32_t refcnt;            /**< owner only: the owner itself plus its live shares */
+    unsigned char storage[1];
 };
 
 /**
- * 
+ * @brief Allocates a buffer, copying @p len bytes from @p data if given
  */
 struct ccnl_buf_s*
 ccnl_buf_new(void *data, size_t len);
 
+/**
+ * @brief Like \ref ccnl_buf_new, for the decoders of received packets
+ *
+ * While \ref ccnl_core_RX handles a frame the buffer comes from the packet
+ * arena, sharing it yields a copy.
+ */
+struct ccnl_buf_s*
+ccnl_buf_new_rx(void *data, size_t len);
+
+/**
+ * @brief Returns a new reference to the bytes of @p buf without copying them
+ *
+ * @param[in] buf The buffer to share, may itself be a share
+ *
+ * @return A buffer to be released with \ref ccnl_buf_free, NULL if
+ *         @p buf is NULL or out of memory
+ */
+struct ccnl_buf_s*
+ccnl_buf_share(struct ccnl_buf_s *buf);
+
+/**
+ * @brief Returns a share of the @p len bytes at @p data inside @p buf
+ *
+ * Lets a parser keep a packet in the buffer it was received into instead
+ * of copying it out.
+ *
+ * @param[in] buf   The buffer, may be NULL or itself a share
+ * @param[in] data  Start of the range
+ * @param[in] len   Length of the range
+ *
+ * @return A buffer to be released with \ref ccnl_buf_free, NULL if the
+ *         range does not lie within @p buf or out of memory
+ */
+struct ccnl_buf_s*
+ccnl_buf_slice(struct ccnl_buf_s *buf, void *data, size_t len);
+
+/**
+ * @brief Releases a buffer or a share, the bytes are freed with the last one
+ */
+void
+ccnl_buf_free(struct ccnl_buf_s *buf);
+
 #define buf_dup(B)      (B) ? ccnl_buf_new(B->data, B->datalen) : NULL
 #define buf_equal(X,Y)  ((X) && (Y) && (X->datalen==Y->datalen) &&\
-                         !memcmp(X->data,Y->data,X->datalen))
+                         (X->data==Y->data || !memcmp(X->data,Y->data,X->datalen)))
 
 void
 ccnl_core_cleanup(struct ccnl_relay_s *ccnl);
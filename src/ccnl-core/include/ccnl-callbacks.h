@@ -54,19 +54,23 @@ void ccnl_set_cb_tx_on_data(ccnl_cb_on_data func);
 /**
  * @brief Callback for inbound on-data events
  *
- * @param[in] relay The active ccn-lite relay
- * @param[in] from  The face the packet was received over
- * @param[in] pkt   The actual received packet 
+ * The callback may keep the packet beyond the received frame, so it is
+ * moved out of the packet arena first, see \ref ccnl_pkt_persist. Without
+ * a callback the packet is left where it is.
+ *
+ * @param[in] relay     The active ccn-lite relay
+ * @param[in] from      The face the packet was received over
+ * @param[in,out] pkt   The actual received packet, replaced if moved
  *
  * @note if the callback function returns any other value than 0,
  *       then the data packet is discarded.
  *
  * @return return value of the callback function
- * @return 0, if no function has been set
+ * @return 0, if no function has been set or the packet could not be moved
  */
 int ccnl_callback_rx_on_data(struct ccnl_relay_s *relay,
                              struct ccnl_face_s *from,
-                             struct ccnl_pkt_s *pkt);
+                             struct ccnl_pkt_s **pkt);
 
 /**
  * @brief Callback for outbound on-data events
@@ -85,4 +89,56 @@ int ccnl_callback_tx_on_data(struct ccnl_relay_s *relay,
                              struct ccnl_face_s *to,
                              struct ccnl_pkt_s *pkt);
 
+/**
+ * @brief Function pointer callback type for FIB changes
+ */
+typedef void (*ccnl_cb_on_fib)(struct ccnl_relay_s *relay,
+                               struct ccnl_forward_s *fwd, int added);
+
+/**
+ * @brief Set a callback function for FIB changes
+ *
+ * The callback learns about entries added at runtime, by a management
+ * request or by the forwarder itself, and about entries removed.
+ *
+ * @param[in] func  The callback function for FIB changes
+ */
+void ccnl_set_cb_on_fib(ccnl_cb_on_fib func);
+
+/**
+ * @brief Callback for FIB changes
+ *
+ * @param[in] relay The active ccn-lite relay
+ * @param[in] fwd   The entry, complete with prefix and face
+ * @param[in] added 1 if the entry was added or changed, 0 if it is
+ *                  about to be removed
+ */
+void ccnl_callback_on_fib(struct ccnl_relay_s *relay,
+                          struct ccnl_forward_s *fwd, int added);
+
+/**
+ * @brief Function pointer callback type for unsolicited Data
+ */
+typedef void (*ccnl_cb_on_unsolicited)(struct ccnl_relay_s *relay,
+                                       struct ccnl_face_s *from,
+                                       struct ccnl_pkt_s *pkt);
+
+/**
+ * @brief Set a callback function for unsolicited Data
+ * The callback learns about Data no PIT entry was waiting for, right
+ * before the relay drops it.
+ * @param[in] func  The callback function for unsolicited Data
+ */
+void ccnl_set_cb_on_unsolicited(ccnl_cb_on_unsolicited func);
+
+/**
+ * @brief Callback for unsolicited Data
+ * @param[in] relay The active ccn-lite relay
+ * @param[in] from  The face the packet was received over
+ * @param[in] pkt   The packet, its buffer holds it as received
+ */
+void ccnl_callback_on_unsolicited(struct ccnl_relay_s *relay,
+                                  struct ccnl_face_s *from,
+                                  struct ccnl_pkt_s *pkt);
+
 #endif  /* CCNL_CALLBACKS_H */
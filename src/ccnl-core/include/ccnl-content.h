@@ -31,12 +31,15 @@
 
 #endif
 
+#include "ccnl-wheel.h"
+
 #ifdef CCNL_RIOT
 #include "evtimer_msg.h"
 #endif
 
 struct ccnl_pkt_s;
 struct ccnl_prefix_s;
+struct ccnl_relay_s;
 
 /**
  * @brief Defines if content added to the content store is
@@ -46,9 +49,22 @@ typedef enum ccnl_content_flags_e {
     CCNL_CONTENT_FLAGS_NOT_STALE = 0x0, /**< content is not stale */
     CCNL_CONTENT_FLAGS_STATIC = 0x01,   /**< content is static */
     CCNL_CONTENT_FLAGS_STALE = 0x02,    /**< content is stale */
+    CCNL_CONTENT_FLAGS_REFERENCED = 0x04, /**< content was used since the CLOCK hand passed it */
     CCNL_CONTENT_DO_NOT_USE = UINT8_MAX /**< for internal use only, sets the width of the enum to sizeof(uint8_t) */
 } ccnl_content_flags;
 
+/**
+ * @brief Replacement policies of the content store
+ *
+ * All policies select a victim in constant (amortized) time and never
+ * select content which is marked \ref CCNL_CONTENT_FLAGS_STATIC.
+ */
+typedef enum ccnl_cs_replacement_e {
+    CCNL_CS_REPLACE_LRU = 0,            /**< evict the least recently used content */
+    CCNL_CS_REPLACE_CLOCK = 1,          /**< second chance approximation of LRU */
+    CCNL_CS_REPLACE_LFU = 2             /**< evict the least frequently served content */
+} ccnl_cs_replacement;
+
 /**
  * @brief Defines an entry in the content store.
  *
@@ -71,6 +87,12 @@ typedef struct ccnl_content_s {
     evtimer_msg_event_t evtmsg_cstimeout; /**< event timer message which is triggered when a timeout in the content store occurs */
 #endif
     int served_cnt;                       /**< determines how often the content has been served */
+    struct ccnl_content_s *hnext;         /**< pointer to the next element in the same bucket of the name index */
+    uint64_t namehash;                    /**< hash of the content name, see \ref ccnl_prefix_hash */
+    struct ccnl_content_s *rnext;         /**< next (less recently used) element in the replacement list */
+    struct ccnl_content_s *rprev;         /**< previous (more recently used) element in the replacement list */
+    uint8_t repl_level;                   /**< replacement list the content is linked into */
+    struct ccnl_wheel_link_s ageing;      /**< link into the content ageing wheel, due when the content times out */
 } ccnl_content;
 
 /**
@@ -94,5 +116,140 @@ ccnl_content_new(struct ccnl_pkt_s **packet);
 int
 ccnl_content_free(struct ccnl_content_s *content);
 
+/**
+ * @brief Tells whether the freshness period of \p content has run out
+ *
+ * Staleness is evaluated when content is matched instead of by the ageing
+ * of the relay. Once stale, the content is marked as such.
+ *
+ * @param[in] content The content to check
+ *
+ * @return 1 if \p content is stale, 0 otherwise
+ */
+int
+ccnl_content_is_stale(struct ccnl_content_s *content);
+
+/**
+ * @brief Adds \p content to the name index of the content store
+ *
+ * The index is a hash table keyed on the content name which is grown on
+ * demand. It does not touch the linked list of the content store.
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] content The content to be indexed
+ *
+ * @return 0 upon success
+ * @return -1 if the index could not be allocated
+ */
+int
+ccnl_content_index_add(struct ccnl_relay_s *relay, struct ccnl_content_s *content);
+
+/**
+ * @brief Removes \p content from the name index of the content store
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] content The content to be removed from the index
+ */
+void
+ccnl_content_index_remove(struct ccnl_relay_s *relay, struct ccnl_content_s *content);
+
+/**
+ * @brief Looks up the content whose name exactly matches \p prefix
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] prefix  The name to look up
+ *
+ * @return The matching content, NULL if there is none
+ */
+struct ccnl_content_s*
+ccnl_content_index_lookup(struct ccnl_relay_s *relay, struct ccnl_prefix_s *prefix);
+
+/**
+ * @brief Finds a content which satisfies the Interest \p pkt
+ *
+ * Besides the exact name, the name without its last component is probed as
+ * well, which covers Interests carrying an implicit digest component. Every
+ * candidate is confirmed with the suite specific \p match function.
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] pkt     The Interest packet
+ * @param[in] match   Suite specific matching function, returns 0 on a match
+ *
+ * @return The matching content, NULL if there is none
+ */
+struct ccnl_content_s*
+ccnl_content_index_match(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt,
+                         int8_t (*match)(struct ccnl_pkt_s*, struct ccnl_content_s*));
+
+/**
+ * @brief Releases the name index of the content store
+ *
+ * @param[in] relay   The relay owning the content store
+ */
+void
+ccnl_content_index_free(struct ccnl_relay_s *relay);
+
+/**
+ * @brief Makes \p content a candidate for replacement
+ *
+ * Content which is marked static is not linked and hence never evicted.
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] content The content which was added to the content store
+ */
+void
+ccnl_content_repl_add(struct ccnl_relay_s *relay, struct ccnl_content_s *content);
+
+/**
+ * @brief Removes \p content from the replacement lists
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] content The content which leaves the content store
+ */
+void
+ccnl_content_repl_remove(struct ccnl_relay_s *relay, struct ccnl_content_s *content);
+
+/**
+ * @brief Records a use (cache hit) of \p content
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] content The content which was served from the content store
+ */
+void
+ccnl_content_repl_touch(struct ccnl_relay_s *relay, struct ccnl_content_s *content);
+
+/**
+ * @brief Selects the content to be evicted next
+ *
+ * The content is not removed from the content store.
+ *
+ * @param[in] relay   The relay owning the content store
+ *
+ * @return The victim, NULL if all content is static
+ */
+struct ccnl_content_s*
+ccnl_content_repl_victim(struct ccnl_relay_s *relay);
+
+/**
+ * @brief Switches the replacement policy of the content store
+ *
+ * Content already in the store is relinked in its insertion order.
+ *
+ * @param[in] relay   The relay owning the content store
+ * @param[in] policy  The new \ref ccnl_cs_replacement policy
+ */
+void
+ccnl_content_repl_set_policy(struct ccnl_relay_s *relay, ccnl_cs_replacement policy);
+
+/**
+ * @brief Converts a policy name ("lru", "clock", "lfu") to a \ref ccnl_cs_replacement
+ *
+ * @param[in] str   The name of the policy
+ *
+ * @return The policy, -1 if \p str is unknown
+ */
+int
+ccnl_content_repl_str2policy(const char *str);
+
 #endif // EOF
 /** @} */
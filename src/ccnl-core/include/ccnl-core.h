@@ -23,6 +23,7 @@
 #ifndef CCNL_CORE_H
 #define CCNL_CORE_H
 
+#include "ccnl-arena.h"
 #include "ccnl-array.h"
 #include "ccnl-content.h"
 #include "ccnl-defs.h"
@@ -42,6 +43,7 @@
 #include "ccnl-logging.h"
 #include "ccnl-mgmt.h"
 #include "ccnl-pkt-util.h"
+#include "ccnl-pool.h"
 #include "ccnl-prefix.h"
 #include "ccnl-sched.h"
 
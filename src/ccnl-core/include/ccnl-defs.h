@@ -87,8 +87,153 @@
 #ifdef CCNL_RIOT
 #define CCNL_MAX_NONCES                 -1 // -1 --> detect dups by PIT
 #else //!CCNL_RIOT
-#define CCNL_MAX_NONCES                 256 // for detected dups
+#define CCNL_MAX_NONCES                 256 // for detected dups, power of two
 #endif //CCNL_RIOT
+#define CCNL_NONCE_TABLE_SIZE           (2 * CCNL_MAX_NONCES) // slots of the nonce set
+#define CCNL_NONCE_PROBES               8   // slots probed per nonce
+
+#ifndef CCNL_CS_INDEX_MIN_SIZE
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_CS_INDEX_MIN_SIZE          8   // initial number of CS index buckets
+#else
+# define CCNL_CS_INDEX_MIN_SIZE          64  // initial number of CS index buckets
+#endif
+#endif
+
+#ifndef CCNL_RCU_MAX_READERS
+# define CCNL_RCU_MAX_READERS            8   // threads looking up the FIB without locks, at most 32
+#endif
+
+#ifndef CCNL_FIB_INDEX_MIN_SIZE
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_FIB_INDEX_MIN_SIZE         8   // initial number of FIB index buckets
+#else
+# define CCNL_FIB_INDEX_MIN_SIZE         64  // initial number of FIB index buckets
+#endif
+#endif
+
+#ifndef CCNL_PIT_INDEX_MIN_SIZE
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_PIT_INDEX_MIN_SIZE         8   // initial number of PIT index buckets
+#else
+# define CCNL_PIT_INDEX_MIN_SIZE         64  // initial number of PIT index buckets
+#endif
+#endif
+
+#ifndef CCNL_FACE_INDEX_MIN_SIZE
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_FACE_INDEX_MIN_SIZE        8   // initial number of face index buckets
+#else
+# define CCNL_FACE_INDEX_MIN_SIZE        64  // initial number of face index buckets
+#endif
+#endif
+
+#ifndef CCNL_MAX_FACE_QLEN
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_MAX_FACE_QLEN              4   // packets queued per face at most
+#else
+# define CCNL_MAX_FACE_QLEN              32  // packets queued per face at most
+#endif
+#endif
+#define CCNL_FACE_OUTQ_FILTER           (4 * CCNL_MAX_FACE_QLEN) // duplicate filter counters per face, the queue length has to be a power of two
+
+#ifndef CCNL_AGEING_WHEEL_SLOTS
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_AGEING_WHEEL_SLOTS         16  // one second slots of the ageing wheels, power of two
+#else
+# define CCNL_AGEING_WHEEL_SLOTS         512 // one second slots of the ageing wheels, power of two
+#endif
+#endif
+
+#ifndef CCNL_SERVE_FANOUT_BUCKETS
+# define CCNL_SERVE_FANOUT_BUCKETS       8   // fan-out histogram: 0, 1, 2, 3-4, 5-8, ..., more
+#endif
+
+#ifndef CCNL_CS_LFU_LEVELS
+# define CCNL_CS_LFU_LEVELS              8   // saturating use counter levels for LFU replacement
+#endif
+
+#ifndef CCNL_EPOLL_RX_BUDGET
+# define CCNL_EPOLL_RX_BUDGET            64  // max datagrams read per interface and wakeup
+#endif
+
+#ifndef CCNL_MAX_RX_BATCH
+# define CCNL_MAX_RX_BATCH               64  // max datagrams fetched by one recvmmsg()
+#endif
+
+#ifndef CCNL_MAX_WORKERS
+# define CCNL_MAX_WORKERS                16  // max relay processes sharing the UDP ports
+#endif
+
+#ifndef CCNL_SHARD_RING_SLOTS
+# define CCNL_SHARD_RING_SLOTS           64  // datagrams in flight from one worker to another, power of two
+#endif
+
+#ifndef CCNL_SHARD_NAME_COMPS
+# define CCNL_SHARD_NAME_COMPS           3   // leading name components which pick the worker of a packet
+#endif
+
+#ifndef CCNL_SCHED_DRR_QUANTUM
+# define CCNL_SCHED_DRR_QUANTUM          1500 // bytes a face of weight 1 sends per round of the fair scheduler
+#endif
+
+#ifndef CCNL_SCHED_DRR_DEPTH
+# define CCNL_SCHED_DRR_DEPTH            2   // sends the fair scheduler lets an interface hold, keep below its queue depth
+#endif
+
+#ifndef CCNL_SCHED_DRR_MAX_WEIGHT
+# define CCNL_SCHED_DRR_MAX_WEIGHT       64  // max weight of a face sharing an interface
+#endif
+
+#ifndef CCNL_RX_SHARE_MIN
+# define CCNL_RX_SHARE_MIN               (CCNL_MAX_PACKET_SIZE / 4) // smallest datagram parsed in its receive buffer
+#endif
+
+#ifndef CCNL_POOL_CAPACITY
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_POOL_CAPACITY              0   // objects preallocated per pool, 0: heap only
+#else
+# define CCNL_POOL_CAPACITY              512 // objects preallocated per pool, 0: heap only
+#endif
+#endif
+
+#ifndef CCNL_POOL_TINY_BUF_SIZE
+# define CCNL_POOL_TINY_BUF_SIZE         32  // bytes of the smallest pooled buffers
+#endif
+
+#ifndef CCNL_FRAG_MAX_FRAGS
+# define CCNL_FRAG_MAX_FRAGS             64  // fragments of one reassembled packet, at most 64
+#endif
+
+#ifndef CCNL_FRAG_REASM_SLOTS
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_FRAG_REASM_SLOTS           1   // packets reassembled at the same time per face
+#else
+# define CCNL_FRAG_REASM_SLOTS           4   // packets reassembled at the same time per face
+#endif
+#endif
+
+#ifndef CCNL_FRAG_MAX_EARLY
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_FRAG_MAX_EARLY             2   // fragments per face held until the first of their packet
+#else
+# define CCNL_FRAG_MAX_EARLY             16  // fragments per face held until the first of their packet
+#endif
+#endif
+
+#ifndef CCNL_FRAG_TIMEOUT
+# define CCNL_FRAG_TIMEOUT               2   // sec, partial packets are dropped after
+#endif
+
+#define CCNL_FRAG_HDR_MAX               16  // bytes a BeginEnd2015 fragment adds to its slice
+
+#ifndef CCNL_ARENA_SIZE
+#if defined(CCNL_ARDUINO) || defined(CCNL_RIOT)
+# define CCNL_ARENA_SIZE                 0   // bytes of the per-packet arena, 0: none
+#else
+# define CCNL_ARENA_SIZE                 (4 * CCNL_MAX_PACKET_SIZE) // bytes of the per-packet arena, 0: none
+#endif
+#endif
 
 enum {
 #ifdef USE_SUITE_CCNB
@@ -222,6 +367,7 @@ typedef enum ccnl_enc_e {
 #define CCNL_BEFRAG_FLAG_MID         0x00
 #define CCNL_BEFRAG_FLAG_LAST        0x02
 #define CCNL_BEFRAG_FLAG_SINGLE      0x03
+#define CCNL_BEFRAG_SEQ_MASK         0x3fff // sequence numbers carried in 14 bits
 
 //#define USE_SIGNATURES
 
@@ -235,7 +381,6 @@ typedef enum ccnl_enc_e {
 
 #define CCNL_FACE_FLAGS_STATIC  1
 #define CCNL_FACE_FLAGS_REFLECT 2
-#define CCNL_FACE_FLAGS_SERVED  4
 #define CCNL_FACE_FLAGS_FWDALLI 8 // forward all interests, also known ones
 
 #define CCNL_FRAG_NONE          0
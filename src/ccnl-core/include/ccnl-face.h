@@ -23,12 +23,33 @@
 #ifndef CCNL_FACE_H
 #define CCNL_FACE_H
 
+#include "ccnl-defs.h"
 #include "ccnl-sockunion.h"
+#include "ccnl-wheel.h"
 
 #ifdef CCNL_RIOT
 #include "evtimer_msg.h"
 #endif
 
+/**
+ * @brief What a full face queue drops to make room, see \ref ccnl_face_outq_add
+ */
+typedef enum ccnl_face_drop_e {
+    CCNL_FACE_DROP_TAIL = 0,    /**< the packet which does not fit */
+    CCNL_FACE_DROP_HEAD,        /**< the oldest queued packet */
+    CCNL_FACE_DROP_PRIO         /**< the oldest queued Interest for any other packet, else the tail */
+} ccnl_face_drop;
+
+/**
+ * @brief A packet waiting in the queue of a face
+ */
+struct ccnl_outq_entry_s {
+    struct ccnl_buf_s *buf;
+    uint32_t fingerprint;       /**< hash of the bytes, valid if hashed is set */
+    uint8_t hashed;             /**< the fingerprint was computed and counted in outqseen */
+    uint8_t request;            /**< the packet is an Interest */
+};
+
 struct ccnl_face_s {
     struct ccnl_face_s *next, *prev;
     int faceid;
@@ -36,15 +57,137 @@ struct ccnl_face_s {
     sockunion peer;
     int flags;
     uint32_t last_used; // updated when we receive a packet
-    struct ccnl_buf_s *outq, *outqend; // queue of packets to send
+    struct ccnl_outq_entry_s outq[CCNL_MAX_FACE_QLEN]; // ring of packets to send
+    size_t outqlen;   // number of queued packets
+    size_t outqfront; // index of the next packet to send
+    size_t outqmax;   // queue depth, 0 for CCNL_MAX_FACE_QLEN
+    int outqdrop;     // what a full queue drops, see ccnl_face_drop
+    uint8_t outqseen[CCNL_FACE_OUTQ_FILTER]; // hashed packets queued per fingerprint bucket
+    uint32_t outq_drops; // packets dropped because the queue was full
+    uint32_t outq_dups;  // packets not queued because they were already
     struct ccnl_frag_s *frag;  // which special datagram armoring
     struct ccnl_sched_s *sched;
 #ifdef CCNL_RIOT
     evtimer_msg_event_t evtmsg_timeout;
 #endif
+    struct ccnl_face_s *hnext;  /**< next face in the same bucket of the address index */
+    struct ccnl_face_s *idnext; /**< next face in the same bucket of the faceid index */
+    uint32_t addrhash;          /**< hash of (ifndx, peer), see \ref ccnl_face_index_add */
+    struct ccnl_wheel_link_s ageing; /**< link into the face ageing wheel of the relay */
+    uint32_t served_epoch;      /**< serve epoch of the relay in which the face last got the Data, see \ref ccnl_content_serve_pending */
 };
 
+struct ccnl_relay_s;
+
 void
 ccnl_face_free(struct ccnl_face_s *face);
 
+/**
+ * @brief Returns the number of packets \p f queues at most
+ */
+size_t
+ccnl_face_qmax(struct ccnl_face_s *f);
+
+/**
+ * @brief Converts a policy name ("tail", "head", "prio") to a \ref ccnl_face_drop
+ *
+ * @param[in] str   The name of the policy
+ *
+ * @return The policy, -1 if \p str is unknown
+ */
+int
+ccnl_face_drop_str2policy(const char *str);
+
+/**
+ * @brief Appends \p buf to the queue of \p f unless it is already queued
+ *
+ * Duplicates are found through a counting filter over fingerprints of the
+ * queued bytes, so a miss costs the same for any queue length. A packet
+ * queued behind an empty queue is only hashed once another one arrives,
+ * which spares the hashing while the queue drains as fast as it fills.
+ * If the queue is full, the drop policy of the face decides what goes.
+ *
+ * @param[in] f         The face
+ * @param[in] buf       The packet, owned by the queue from now on
+ * @param[in] request   Whether the packet is an Interest, see \ref CCNL_FACE_DROP_PRIO
+ *
+ * @return 0 if \p buf was queued
+ * @return -1 if it was a duplicate or dropped, \p buf is freed then
+ */
+int
+ccnl_face_outq_add(struct ccnl_face_s *f, struct ccnl_buf_s *buf, int request);
+
+/**
+ * @brief Takes the next packet to send from the queue of \p f
+ *
+ * @return The packet, NULL if the queue is empty
+ */
+struct ccnl_buf_s*
+ccnl_face_outq_take(struct ccnl_face_s *f);
+
+/**
+ * @brief Frees all packets in the queue of \p f
+ */
+void
+ccnl_face_outq_clear(struct ccnl_face_s *f);
+
+/**
+ * @brief Adds \p f to the face indices of \p relay
+ *
+ * Faces are indexed by their interface index plus peer address and by their
+ * faceid. Both tables are grown on demand. \p f must carry its final ifndx,
+ * peer and faceid.
+ *
+ * @param[in] relay   The relay owning the faces
+ * @param[in] f       The face to be indexed
+ *
+ * @return 0 upon success
+ * @return -1 if the indices could not be allocated
+ */
+int
+ccnl_face_index_add(struct ccnl_relay_s *relay, struct ccnl_face_s *f);
+
+/**
+ * @brief Removes \p f from the face indices of \p relay
+ *
+ * @param[in] relay   The relay owning the faces
+ * @param[in] f       The face to be removed
+ */
+void
+ccnl_face_index_remove(struct ccnl_relay_s *relay, struct ccnl_face_s *f);
+
+/**
+ * @brief Looks up the face bound to interface \p ifndx and peer \p su
+ *
+ * If \p su is NULL, the local (in memory) client face with ifndx -1 is
+ * looked up instead.
+ *
+ * @param[in] relay   The relay owning the faces
+ * @param[in] ifndx   The interface index of the face
+ * @param[in] su      The peer address of the face, may be NULL
+ *
+ * @return The matching face, NULL if there is none
+ */
+struct ccnl_face_s*
+ccnl_face_index_lookup(struct ccnl_relay_s *relay, int ifndx, sockunion *su);
+
+/**
+ * @brief Looks up the face with the given \p faceid
+ *
+ * @param[in] relay   The relay owning the faces
+ * @param[in] faceid  The id of the face
+ *
+ * @return The matching face, NULL if there is none
+ */
+struct ccnl_face_s*
+ccnl_face_lookup_id(struct ccnl_relay_s *relay, int faceid);
+
+/**
+ * @brief Releases the face indices of \p relay
+ *
+ * @param[in] relay   The relay owning the faces
+ */
+void
+ccnl_face_index_free(struct ccnl_relay_s *relay);
+
 #endif // CCNL_FACE_H
@@ -32,11 +32,148 @@ typedef void (*tapCallback)(struct ccnl_relay_s *, struct ccnl_face_s *,
                             struct ccnl_prefix_s *, struct ccnl_buf_s *);
 
 struct ccnl_forward_s {
-    struct ccnl_forward_s *next;
+    struct ccnl_forward_s *next;  /**< FIB list of the writer, later the list of retired entries */
+    struct ccnl_forward_s *prev;
     struct ccnl_prefix_s *prefix;
     tapCallback tap;
     struct ccnl_face_s *face;
     char suite;
+    struct ccnl_forward_s *hnext[2]; /**< next entry in the same bucket, one link per index generation */
+    uint64_t namehash;            /**< hash of the prefix, see \ref ccnl_prefix_hash */
+    uint32_t retired;             /**< epoch the entry was retired in, see \ref ccnl_fib_remove */
 };
 
+/**
+ * @brief Hash index of the FIB, published to the readers as a whole
+ *
+ * Lookups take no locks: they load the index of the relay once and follow
+ * the bucket chains, which the writer only changes by single pointer
+ * stores. A grown index is built next to the old one, on the other link of
+ * each entry, and replaces it in one store. The old index and unlinked
+ * entries are freed once no registered reader can hold them any more, see
+ * \ref ccnl_rcu_s.
+ */
+struct ccnl_fib_index_s {
+    uint32_t size;                 /**< number of buckets, a power of two */
+    uint32_t maxlen;               /**< most components of any prefix, bounds the LPM probes */
+    int gen;                       /**< the link of the entries the chains use */
+    uint32_t retired;              /**< epoch the index was replaced in */
+    struct ccnl_fib_index_s *next; /**< next retired index */
+    struct ccnl_forward_s *buckets[]; /**< the chains */
+};
+
+/**
+ * @brief State of a longest prefix match walk over the FIB
+ */
+struct ccnl_fib_match_s {
+    struct ccnl_prefix_s *name;    /**< the name being matched */
+    struct ccnl_fib_index_s *index; /**< the index walked, valid until the next quiescent state */
+    struct ccnl_forward_s *fwd;    /**< entry returned last, NULL at the start of a bucket */
+    int32_t len;                   /**< prefix length currently probed */
+};
+
+/**
+ * @brief Links \p fwd into the FIB of \p relay
+ *
+ * The entry is prepended to the FIB list and added to the prefix index, which
+ * is grown on demand. \p fwd must carry its prefix.
+ *
+ * @param[in] relay   The relay owning the FIB
+ * @param[in] fwd     The entry to be linked
+ *
+ * @return 0 upon success
+ * @return -1 if the index could not be allocated
+ */
+int
+ccnl_fib_link(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd);
+
+/**
+ * @brief Unlinks \p fwd from the FIB of \p relay without freeing it
+ *
+ * Readers may still hold the entry, while one is registered it has to be
+ * freed by \ref ccnl_fib_remove instead.
+ *
+ * @param[in] relay   The relay owning the FIB
+ * @param[in] fwd     The entry to be unlinked
+ */
+void
+ccnl_fib_unlink(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd);
+
+/**
+ * @brief Looks up the FIB entry whose prefix and suite exactly match \p pfx
+ *
+ * @param[in] relay   The relay owning the FIB
+ * @param[in] pfx     The prefix to look up
+ *
+ * @return The matching entry, NULL if there is none
+ */
+struct ccnl_forward_s*
+ccnl_fib_lookup(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx);
+
+/**
+ * @brief Starts a walk over all FIB entries which are a prefix of \p name
+ *
+ * @param[in] relay   The relay owning the FIB
+ * @param[out] m      The walk state
+ * @param[in] name    The name to be matched
+ */
+void
+ccnl_fib_match_init(struct ccnl_relay_s *relay, struct ccnl_fib_match_s *m,
+                    struct ccnl_prefix_s *name);
+
+/**
+ * @brief Returns the next FIB entry which is a prefix of the walked name
+ *
+ * Entries are returned longest prefix first, so the first entry is the
+ * longest prefix match. Every prefix length costs one hash probe.
+ *
+ * @param[in] relay   The relay owning the FIB
+ * @param[in,out] m   The walk state
+ *
+ * @return The next matching entry, NULL if there are no more
+ */
+struct ccnl_forward_s*
+ccnl_fib_match_next(struct ccnl_relay_s *relay, struct ccnl_fib_match_s *m);
+
+/**
+ * @brief Finds the longest prefix match for \p name in the FIB
+ *
+ * @param[in] relay   The relay owning the FIB
+ * @param[in] name    The name to be matched
+ *
+ * @return The entry with the longest matching prefix, NULL if there is none
+ */
+struct ccnl_forward_s*
+ccnl_fib_lpm(struct ccnl_relay_s *relay, struct ccnl_prefix_s *name);
+
+/**
+ * @brief Unlinks \p fwd from the FIB and frees it with its prefix once no
+ *        reader can hold it any more
+ *
+ * @param[in] relay   The relay owning the FIB
+ * @param[in] fwd     The entry to be removed
+ */
+void
+ccnl_fib_remove(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd);
+
+/**
+ * @brief Frees what was removed from the FIB and is no longer read
+ *
+ * Called by the writer, for instance after the readers' quiescent states.
+ *
+ * @param[in] relay   The relay owning the FIB
+ */
+void
+ccnl_fib_reclaim(struct ccnl_relay_s *relay);
+
+/**
+ * @brief Releases the prefix index of the FIB and all retired entries
+ *
+ * No reader may use the FIB any more.
+ *
+ * @param[in] relay   The relay owning the FIB
+ */
+void
+ccnl_fib_index_free(struct ccnl_relay_s *relay);
+
 #endif //CCNL_FORWARD_H
@@ -28,8 +28,41 @@
 #include "ccnl-relay.h"
 
 // returns >=0 if content consumed, buf and len pointers updated
-typedef int (RX_datagram)(struct ccnl_relay_s*, struct ccnl_face_s*,
-                          unsigned char**, int*);
+typedef int8_t (RX_datagram)(struct ccnl_relay_s*, struct ccnl_face_s*,
+                             uint8_t**, size_t*);
+
+/**
+ * @brief A packet being reassembled from BeginEnd2015 fragments
+ *
+ * Every fragment but the last one is as long as the first, so each
+ * fragment is copied once, straight to its place in the buffer, in
+ * whatever order the fragments arrive. The buffer is allocated at the
+ * length in the packet header the first fragment carries; for a suite
+ * whose header is not understood it grows by doubling.
+ */
+struct ccnl_frag_reasm_s {
+    unsigned char *data;    /**< reassembled bytes, NULL while the slot is free */
+    uint32_t cap;           /**< fragments the buffer has room for */
+    uint32_t first;         /**< sequence number of the first fragment */
+    uint32_t stride;        /**< length of every fragment but the last */
+    int32_t last;           /**< index of the last fragment, -1 while unknown */
+    uint32_t lastlen;       /**< length of the last fragment */
+    uint64_t have;          /**< one bit per fragment received */
+    uint32_t started;       /**< time the first fragment arrived */
+    uint8_t sized;          /**< the first fragment told the length of the packet */
+};
+
+/**
+ * @brief A fragment received before the first fragment of its packet
+ */
+struct ccnl_frag_early_s {
+    struct ccnl_frag_early_s *next;
+    uint32_t seqno;
+    unsigned int bits;      /**< BeginEnd flags of the fragment */
+    uint32_t arrived;
+    uint32_t len;
+    unsigned char data[1];
+};
 
  struct ccnl_frag_s {
     int protocol; // fragmentation protocol, 0=none
@@ -43,6 +76,11 @@ typedef int (RX_datagram)(struct ccnl_relay_s*, struct ccnl_face_s*,
 
     // int insuite; // suite of incoming packet series
     struct ccnl_buf_s *defrag; // incoming bytes
+    struct ccnl_frag_reasm_s reasm[CCNL_FRAG_REASM_SLOTS]; // BeginEnd2015 packets being reassembled
+    struct ccnl_frag_early_s *early; // BeginEnd2015 fragments waiting for their first, newest first
+    unsigned int earlycnt;
+    unsigned int reasmcnt; // packets reassembled
+    unsigned int dropcnt;  // partial packets dropped
 
     unsigned int sendseq;
     unsigned int losscount;
@@ -87,6 +125,27 @@ ccnl_frag_getnextBE2015(struct ccnl_frag_s *fr, int *ifndx, sockunion *su);
 struct ccnl_buf_s*
 ccnl_frag_getnext(struct ccnl_frag_s *fr, int *ifndx, sockunion *su);
 
+/**
+ * @brief Cuts the next BeginEnd2015 fragment without copying the packet
+ *
+ * Unlike \ref ccnl_frag_getnext, which copies each fragment into a buffer
+ * of its own, the fragment is returned as its header and a share of the
+ * bytes of the packet that follow it, to be sent with
+ * \ref ccnl_interface_enqueue_hdr.
+ *
+ * @param[in]  fr     The fragmentation state of the face
+ * @param[out] hdr    Receives the fragment header, room for CCNL_FRAG_HDR_MAX bytes
+ * @param[out] hdrlen Length of the header
+ * @param[out] ifndx  Interface to send the fragment on, may be NULL
+ * @param[out] su     Destination of the fragment, may be NULL
+ *
+ * @return The payload of the fragment, NULL if the packet is done, the
+ *         protocol is not BeginEnd2015 or out of memory
+ */
+struct ccnl_buf_s*
+ccnl_frag_getnextslice(struct ccnl_frag_s *fr, uint8_t *hdr, size_t *hdrlen,
+                       int *ifndx, sockunion *su);
+
 int
 ccnl_frag_nomorefragments(struct ccnl_frag_s *e);
 
@@ -136,11 +195,23 @@ ccnl_frag_RX_Sequenced2015(RX_datagram callback, struct ccnl_relay_s *relay,
 
 #endif // OBSOLTE_BY_2015_06
 
+/**
+ * @brief Processes a BeginEnd2015 fragment received on @p from
+ *
+ * Several packets per face are reassembled at the same time, fragments may
+ * arrive in any order as long as no packet spans more than
+ * \ref CCNL_FRAG_MAX_FRAGS of them. A packet is passed to @p callback as
+ * soon as its last missing fragment arrives. Partial packets are dropped
+ * after \ref CCNL_FRAG_TIMEOUT seconds, the oldest one also when another
+ * packet starts while all \ref CCNL_FRAG_REASM_SLOTS are taken.
+ *
+ * @return 1 if the fragment was consumed, 0 if it was not accepted
+ */
 int
 ccnl_frag_RX_BeginEnd2015(RX_datagram callback, struct ccnl_relay_s *relay,
                           struct ccnl_face_s *from, int mtu,
                           unsigned int bits, unsigned int seqno,
-                          unsigned char **data, int *datalen);
+                          uint8_t **data, size_t *datalen);
 
 struct ccnl_buf_s*
 ccnl_frag_getnext(struct ccnl_frag_s *fr, int *ifndx, sockunion *su);
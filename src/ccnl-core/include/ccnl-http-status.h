@@ -48,6 +48,19 @@ int
 ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
                      fd_set *readfs, fd_set *writefs);
 
+/**
+ * @brief Serves the status page once its sockets became ready
+ *
+ * This is the event loop agnostic part of \ref ccnl_http_postselect. The
+ * readiness flags refer to the server socket and to the client socket as
+ * they were when the event loop waited.
+ *
+ * @return 0 upon success, -1 if \p http is NULL
+ */
+int
+ccnl_http_handle(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
+                 int server_readable, int client_readable, int client_writable);
+
 int
 ccnl_cmpfaceid(const void *a, const void *b);
 
@@ -32,13 +32,27 @@
 
 
 
+/**
+ * @brief A datagram queued at an interface
+ *
+ * A fragment is queued as its header, kept in the request, and a share of
+ * the packet it was cut from. The link layer gathers both when sending,
+ * see \ref ccnl_txrequest_len.
+ */
 struct ccnl_txrequest_s {
     struct ccnl_buf_s *buf;
     sockunion dst;
     void (*txdone)(void*, int, int);
     struct ccnl_face_s* txdone_face;
+    uint8_t hdrlen;                     /**< bytes in hdr, sent before buf */
+    uint8_t hdr[CCNL_FRAG_HDR_MAX];
 };
 
+/**
+ * @brief Length of the datagram a request sends
+ */
+#define ccnl_txrequest_len(r)   ((r)->hdrlen + (r)->buf->datalen)
+
 struct ccnl_if_s { // interface for packet IO
     sockunion addr;
 #ifdef CCNL_LINUXKERNEL
@@ -63,17 +77,43 @@ struct ccnl_if_s { // interface for packet IO
 
     size_t qlen;  // number of pending sends
     size_t qfront; // index of next packet to send
+    size_t qmax;  // queue depth, 0 for CCNL_MAX_IF_QLEN
+    int txbatch;  // > 1: queued sends are flushed in batches by the I/O loop
     struct ccnl_txrequest_s queue[CCNL_MAX_IF_QLEN];
     struct ccnl_sched_s *sched;
 
 #ifdef USE_STATS
     uint32_t rx_cnt, tx_cnt;
+    uint32_t tx_drops; // sends dropped because the queue was full
 #endif
 };
 
 void
 ccnl_interface_cleanup(struct ccnl_if_s *i);
 
+/**
+ * @brief Returns the number of sends an interface queues at most
+ *
+ * @param[in] i The interface
+ *
+ * @return The configured queue depth, bounded by CCNL_MAX_IF_QLEN
+ */
+size_t
+ccnl_interface_qmax(struct ccnl_if_s *i);
+
+/**
+ * @brief Copies the header and payload of a request into one buffer
+ *
+ * For link layers which cannot send from several places at once.
+ *
+ * @param[in] r The request
+ *
+ * @return A new buffer, or a share of the payload if there is no header;
+ *         NULL if out of memory
+ */
+struct ccnl_buf_s*
+ccnl_txrequest_flatten(struct ccnl_txrequest_s *r);
+
 #if !defined(CCNL_LINUXKERNEL) && !defined(CCNL_ANDROID)
 int
 ccnl_close_socket(int s);
@@ -53,6 +53,9 @@ struct ccnl_interest_s {
     uint32_t lifetime;                  /**< interest lifetime */
     uint32_t last_used;                 /**< last time the entry was used */
     int retries;                        /**< current number of executed retransmits. */
+    struct ccnl_interest_s *hnext;      /**< next element in the same bucket of the PIT index */
+    uint64_t namehash;                  /**< hash the entry is indexed under, see \ref ccnl_interest_index_add */
+    struct ccnl_wheel_link_s ageing;    /**< link into the PIT ageing wheel, due at the next retransmission */
 #ifdef CCNL_RIOT
     evtimer_msg_event_t evtmsg_retrans; /**< retransmission timer */
     evtimer_msg_event_t evtmsg_timeout; /**< timeout timer for (?) */
@@ -115,4 +118,64 @@ ccnl_interest_append_pending(struct ccnl_interest_s *i, struct ccnl_face_s *from
 int
 ccnl_interest_remove_pending(struct ccnl_interest_s *i, struct ccnl_face_s *face);
 
+/**
+ * @brief Adds \p i to the name index of the PIT
+ *
+ * The index is a hash table grown on demand. Entries are keyed on the hash of
+ * their name. If the last component has the length of a SHA256 digest, the
+ * entry is keyed on the name without it, since it may be the implicit digest
+ * of the requested content. Hence every entry a Data packet can satisfy is
+ * keyed on the hash of a leading sub-prefix of the Data name.
+ *
+ * @param[in] relay   The relay owning the PIT
+ * @param[in] i       The PIT entry to be indexed
+ *
+ * @return 0 upon success
+ * @return -1 if the index could not be allocated
+ */
+int
+ccnl_interest_index_add(struct ccnl_relay_s *relay, struct ccnl_interest_s *i);
+
+/**
+ * @brief Removes \p i from the name index of the PIT
+ *
+ * @param[in] relay   The relay owning the PIT
+ * @param[in] i       The PIT entry to be removed from the index
+ */
+void
+ccnl_interest_index_remove(struct ccnl_relay_s *relay, struct ccnl_interest_s *i);
+
+/**
+ * @brief Finds the PIT entry an Interest \p pkt can be aggregated with
+ *
+ * @param[in] relay   The relay owning the PIT
+ * @param[in] pkt     The Interest packet
+ *
+ * @return The PIT entry for which \ref ccnl_interest_isSame holds, NULL if there is none
+ */
+struct ccnl_interest_s*
+ccnl_interest_index_lookup(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt);
+
+/**
+ * @brief Returns the first PIT entry in the bucket of \p hash
+ *
+ * The bucket is walked via \ref ccnl_interest_s.hnext, entries whose
+ * namehash differs from \p hash have to be skipped by the caller.
+ *
+ * @param[in] relay   The relay owning the PIT
+ * @param[in] hash    The hash of a name as computed by \ref ccnl_prefix_hash
+ *
+ * @return The first entry of the bucket, NULL if it is empty
+ */
+struct ccnl_interest_s*
+ccnl_interest_index_bucket(struct ccnl_relay_s *relay, uint64_t hash);
+
+/**
+ * @brief Releases the name index of the PIT
+ *
+ * @param[in] relay   The relay owning the PIT
+ */
+void
+ccnl_interest_index_free(struct ccnl_relay_s *relay);
+
 #endif //CCNL_INTEREST_H
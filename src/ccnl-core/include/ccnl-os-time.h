@@ -77,7 +77,8 @@ timestamp(void);
 // ----------------------------------------------------------------------
 
 struct ccnl_timer_s {
-    struct ccnl_timer_s *next;
+    struct ccnl_timer_s *next;  /**< next unused timer, while the timer is not armed */
+    int heapidx;                /**< position in the event queue, -1 if not armed */
     struct timeval timeout;
     void (*fct)(char,int);
     void (*fct2)(void*,void*);
@@ -88,19 +89,49 @@ struct ccnl_timer_s {
   //    int handler;
 };
 
+/**
+ * @brief Reads the clock all timers are based on
+ *
+ * The clock is monotonic where the platform provides one, so timers are
+ * not disturbed when the wall clock is set.
+ *
+ * @param[out] tv   the current time
+ */
 void
 ccnl_get_timeval(struct timeval *tv);
 
 long
 timevaldelta(struct timeval *a, struct timeval *b);
 
+/**
+ * @brief Arms a timer which calls \p fct after \p usec microseconds
+ *
+ * Timers are kept in a binary min-heap, arming costs O(log n).
+ *
+ * @return a handle for \ref ccnl_rem_timer, NULL if out of memory
+ */
 void*
 ccnl_set_timer(uint64_t usec, void (*fct)(void *aux1, void *aux2),
                  void *aux1, void *aux2);
 
+/**
+ * @brief Cancels a timer armed by \ref ccnl_set_timer in O(log n)
+ *
+ * A handle is valid until its timer fires or is cancelled, it must not be
+ * passed in afterwards: the timer is reused by a later \ref ccnl_set_timer,
+ * which the stale handle would then cancel.
+ *
+ * @param[in] h     the handle returned when arming the timer
+ */
 void
 ccnl_rem_timer(void *h);
 
+/**
+ * @brief Cancels all timers and releases the memory of the event queue
+ */
+void
+ccnl_timer_cleanup(void);
+
 #endif
 
 #ifdef CCNL_LINUXKERNEL
@@ -150,6 +181,11 @@ ccnl_rem_timer(void *p);
 
 #else
 
+/**
+ * @brief Fires all expired timers
+ *
+ * @return microseconds until the next timer expires, -1 if none is armed
+ */
 int
 ccnl_run_events(void);
 
@@ -159,7 +195,7 @@ ccnl_run_events(void);
 
 void*
 ccnl_set_absolute_timer(struct timeval abstime, void (*fct)(void *aux1, void *aux2),
-         void *aux1, void *aux2)
+         void *aux1, void *aux2);
 
 #endif
 
@@ -125,6 +125,31 @@ struct ccnl_pkt_s {
 void
 ccnl_pkt_free(struct ccnl_pkt_s *pkt);
 
+/**
+ * @brief Allocates a zeroed pkt data structure for a decoder
+ *
+ * While \ref ccnl_core_RX handles a frame the pkt comes from the packet
+ * arena, otherwise from the pkt pool.
+ *
+ * @return  the new pkt, NULL if out of memory
+*/
+struct ccnl_pkt_s*
+ccnl_pkt_new_rx(void);
+
+/**
+ * @brief Moves a pkt and what it owns out of the packet arena
+ *
+ * Must be called before a decoded pkt is kept beyond the frame it came
+ * with. The packet bytes themselves are never in the arena.
+ *
+ * @param[in,out] pkt   pkt to persist, replaced by the moved copy
+ *
+ * @return  0 on success, -1 if out of memory (@p pkt stays valid for
+ *          \ref ccnl_pkt_free)
+*/
+int
+ccnl_pkt_persist(struct ccnl_pkt_s **pkt);
+
 /**
  * @brief Duplicates a pkt data structure
  *
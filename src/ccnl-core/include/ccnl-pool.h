@@ -0,0 +1,134 @@
+/**
+ * @addtogroup CCNL-core
+ * @{
+ *
+ * @file ccnl-pool.h
+ * @brief Fixed-size object pools for the objects of the forwarding path
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#ifndef CCNL_POOL_H
+#define CCNL_POOL_H
+
+#ifndef CCNL_LINUXKERNEL
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief A pool of equally sized objects carved from one slab
+ *
+ * The slab is allocated once by \ref ccnl_pool_reserve. Requests the slab
+ * cannot serve, because it is used up, was never reserved or the object
+ * is larger than a slot, go to the heap and are counted as fallbacks. A
+ * relay whose pools are large enough does not touch the heap for these
+ * objects once it runs.
+ */
+struct ccnl_pool_s {
+    const char *name;
+    size_t objsize;             /**< usable bytes per slot */
+    uint32_t capacity;          /**< slots in the slab */
+    uint32_t inuse;             /**< slots currently handed out */
+    uint32_t peak;              /**< highest inuse seen */
+    uint32_t allocs;            /**< allocations served by the slab */
+    uint32_t fallbacks;         /**< allocations served by the heap */
+    void *freelist;
+    unsigned char *slab;
+    size_t slotsize;            /**< objsize rounded up for alignment */
+};
+
+/**
+ * @brief The pools of the core, indices into \ref ccnl_pools
+ */
+enum {
+    CCNL_POOL_PKT,              /**< struct ccnl_pkt_s */
+    CCNL_POOL_PREFIX,           /**< parsed names, see \ref ccnl_prefix_new */
+    CCNL_POOL_BUF_TINY,         /**< buffer shares and buffers of a few bytes */
+    CCNL_POOL_BUF_SMALL,        /**< buffers up to CCNL_RX_SHARE_MIN bytes */
+    CCNL_POOL_BUF_LARGE,        /**< buffers up to CCNL_MAX_PACKET_SIZE bytes */
+    CCNL_POOL_INTEREST,         /**< struct ccnl_interest_s */
+    CCNL_POOL_PENDINT,          /**< struct ccnl_pendint_s */
+    CCNL_POOL_CONTENT,          /**< struct ccnl_content_s */
+    CCNL_POOL_COUNT
+};
+
+extern struct ccnl_pool_s ccnl_pools[CCNL_POOL_COUNT];
+
+/**
+ * @brief Shorthand for the core pool of the given kind, e.g. CCNL_POOL(PKT)
+ */
+#define CCNL_POOL(kind)         (ccnl_pools + CCNL_POOL_ ## kind)
+
+/**
+ * @brief Allocates the slab of @p pool with room for @p capacity objects
+ *
+ * A previous slab is released first. A capacity of 0 leaves the pool
+ * without a slab, so every allocation goes to the heap.
+ *
+ * @return 0 on success, -1 if objects of the old slab are still in use or
+ *         out of memory
+ */
+int
+ccnl_pool_reserve(struct ccnl_pool_s *pool, uint32_t capacity);
+
+/**
+ * @brief Releases the slab of @p pool if none of its objects is in use
+ */
+void
+ccnl_pool_release(struct ccnl_pool_s *pool);
+
+/**
+ * @brief Returns an object of @p size bytes, from the slab if it fits
+ */
+void*
+ccnl_pool_malloc(struct ccnl_pool_s *pool, size_t size);
+
+/**
+ * @brief Like \ref ccnl_pool_malloc, with the object zeroed
+ */
+void*
+ccnl_pool_calloc(struct ccnl_pool_s *pool, size_t size);
+
+/**
+ * @brief Returns 1 if @p ptr lies in the slab of @p pool
+ */
+int
+ccnl_pool_owns(struct ccnl_pool_s *pool, void *ptr);
+
+/**
+ * @brief Releases an object allocated from @p pool, NULL is ignored
+ */
+void
+ccnl_pool_free(struct ccnl_pool_s *pool, void *ptr);
+
+/**
+ * @brief Reserves @p capacity objects in every core pool
+ *
+ * Large buffers are reserved at a quarter of @p capacity, they hold
+ * receive buffers and the rare packet too big for the small ones.
+ *
+ * @return 0 on success, -1 if any pool could not be reserved
+ */
+int
+ccnl_pools_init(uint32_t capacity);
+
+/**
+ * @brief Releases the slabs of all core pools
+ */
+void
+ccnl_pools_cleanup(void);
+
+#endif // CCNL_POOL_H
+/** @} */
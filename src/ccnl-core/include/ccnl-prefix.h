@@ -32,24 +32,63 @@
 #endif
 #ifndef CCNL_LINUXKERNEL
 #include <unistd.h>
+#include "ccnl-defs.h"
+#else
+#include "../include/ccnl-defs.h"
 #endif
 
 struct ccnl_content_s;
 
+/**
+ * @brief Offset or length of a name component
+ *
+ * Names never span more than a packet, so 16 bits are enough unless the
+ * platform allows larger packets.
+ */
+#if CCNL_MAX_PACKET_SIZE > 0xffff
+typedef uint32_t ccnl_compoff_t;
+#else
+typedef uint16_t ccnl_compoff_t;
+#endif
+
+/**
+ * @brief A name, as decoded from a packet or built from an URI
+ *
+ * A prefix is one allocation: the header, the cumulative component hashes,
+ * the component offsets and lengths, and for names which do not point into
+ * a packet, the component bytes. Components are addressed relative to
+ * @ref base, so moving a decoded name to another copy of its packet only
+ * moves @ref base. Use \ref ccnl_prefix_comp to get at a component.
+ *
+ * The hashes are computed once, by the decoder or whoever built the name,
+ * so the CS, PIT and FIB look up any leading sub-prefix without touching
+ * the component bytes again.
+ */
 struct ccnl_prefix_s {
-    uint8_t **comp; /**< name components of the prefix without '\0' at the end */
-    size_t *complen; /**< length of the name components */
+    uint8_t *base; /**< the component offsets are relative to this */
+    uint64_t *comphash; /**< comphash[i] is ccnl_prefix_hash() over components 0..i */
+    ccnl_compoff_t *compoff; /**< offset of each name component from base */
+    ccnl_compoff_t *complen; /**< length of each name component */
     uint32_t compcnt; /**< number of name components */
+    uint64_t hash; /**< ccnl_prefix_hash() over all components, see \ref ccnl_prefix_rehash */
+    int64_t chunknum; /**< if defined, number of the chunk else -1 */
     char suite; /**< type of the packet format */
     uint8_t *nameptr; /**< binary name (for fast comparison) */
-    ssize_t namelen; /**<  valid length of name memory */
-    uint8_t *bytes;   /**< memory for name component copies */
-    uint32_t *chunknum;   /**< if defined, number of the chunk else -1 */
+    ssize_t namelen; /**<  valid length of name memory, the whole name TLV */
+    void *ext; /**< components grown by ccnl_prefix_appendCmp(), NULL while inline */
 };
 
+/**
+ * @brief The @p i-th name component of prefix @p p, not '\0' terminated
+ */
+#define ccnl_prefix_comp(p, i)  ((p)->base + (p)->compoff[i])
+
 /**
  * @brief Create a new CCNL_Prefix datastructure
  *
+ * The prefix has room for @p cnt components and compcnt set to @p cnt,
+ * the caller sets base and the component offsets and lengths.
+ *
  * @param[in] suite       Packet format for which the Prefix should be created
  * @param[in] cnt         Number of components which the Prefix should contain
  *
@@ -58,6 +97,17 @@ struct ccnl_prefix_s {
 struct ccnl_prefix_s*
 ccnl_prefix_new(char suite, uint32_t cnt);
 
+/**
+ * @brief Like \ref ccnl_prefix_new, for a name decoded from a received
+ *        packet
+ *
+ * While \ref ccnl_core_RX handles a frame the prefix comes from the packet
+ * arena and is gone with the frame, unless \ref ccnl_prefix_persist moves
+ * it out.
+ */
+struct ccnl_prefix_s*
+ccnl_prefix_new_rx(char suite, uint32_t cnt);
+
 /**
  * @brief Frees CCNL_Prefix datastructure
  *
@@ -76,6 +126,19 @@ ccnl_prefix_free(struct ccnl_prefix_s *prefix);
 struct ccnl_prefix_s* 
 ccnl_prefix_dup(struct ccnl_prefix_s *prefix);
 
+/**
+ * @brief Moves a prefix out of the packet arena
+ *
+ * Component bytes outside the arena, usually the packet buffer, are not
+ * copied. Does nothing for a prefix which is not in the arena.
+ *
+ * @param[in,out] prefix   Prefix to persist, replaced by the moved copy
+ *
+ * @return 0 on success, -1 if out of memory (@p prefix is left untouched)
+ */
+int
+ccnl_prefix_persist(struct ccnl_prefix_s **prefix);
+
 /**
  * @brief Add a component to a Prefix
  *
@@ -88,6 +151,17 @@ ccnl_prefix_dup(struct ccnl_prefix_s *prefix);
 int8_t
 ccnl_prefix_appendCmp(struct ccnl_prefix_s *prefix, uint8_t *cmp, size_t cmplen);
 
+/**
+ * @brief Recomputes the cached hashes of a Prefix
+ *
+ * Needed after setting or removing components by hand, the Prefix
+ * functions and the decoders keep the hashes up to date themselves.
+ *
+ * @param[in,out] prefix   Prefix whose components changed
+*/
+void
+ccnl_prefix_rehash(struct ccnl_prefix_s *prefix);
+
 /**
  * @brief Set a Cunknum to a Prefix
  *
@@ -99,9 +173,51 @@ ccnl_prefix_appendCmp(struct ccnl_prefix_s *prefix, uint8_t *cmp, size_t cmplen)
 int
 ccnl_prefix_addChunkNum(struct ccnl_prefix_s *prefix, uint32_t chunknum);
 
+/**
+ * @brief Returns the hash value of the first @p cnt components of a Prefix
+ *
+ * Prefixes with equal components always hash to the same value, regardless
+ * of whether they were decoded from the wire or built from an URI. The
+ * values are cached in the Prefix, so this is a table lookup.
+ *
+ * @param[in] prefix   Prefix to be hashed
+ * @param[in] cnt      Number of leading components to include (capped at compcnt)
+ *
+ * @return      the hash value
+*/
+uint64_t
+ccnl_prefix_hash(struct ccnl_prefix_s *prefix, uint32_t cnt);
+
+/**
+ * @brief Seeds the name hash
+ *
+ * A relay picks a random seed at startup, so peers cannot choose names
+ * which all land in the same bucket. Must be called before the first
+ * Prefix is created, hashes computed under another seed do not match.
+ *
+ * @param[in] seed     The new seed
+ *
+ * @return      the basis hashed under before, see \ref ccnl_prefix_hash_restore
+*/
+uint64_t
+ccnl_prefix_hash_seed(uint64_t seed);
+
+/**
+ * @brief Restores a basis returned by \ref ccnl_prefix_hash_seed
+ *
+ * @param[in] basis    The basis to hash under again
+*/
+void
+ccnl_prefix_hash_restore(uint64_t basis);
+
 /**
  * @brief Compares two Prefix datastructures
  *
+ * The cached hashes reject a mismatch without comparing component bytes,
+ * only components which hash alike are compared. Two names decoded from
+ * packets with the same encoding are compared as a whole, see
+ * \ref ccnl_simd_equal.
+ *
  * @param[in] pfx   Prefix 1 to be compared (shorter of Longest Prefix matching)
  * @param[in] md    ?
  * @param[in] nam   Prefix 2 to be compared (longer of Longest Prefix matching)
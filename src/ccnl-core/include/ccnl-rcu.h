@@ -0,0 +1,88 @@
+/**
+ * @addtogroup CCNL-core
+ * @{
+ *
+ * @file ccnl-rcu.h
+ * @brief Grace periods for tables read without locks
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#ifndef CCNL_RCU_H
+#define CCNL_RCU_H
+
+#ifndef CCNL_LINUXKERNEL
+#include <stdint.h>
+#endif
+
+#include "ccnl-defs.h"
+
+/**
+ * @brief Quiescent state based tracking of the readers of a table
+ *
+ * Readers take no locks. Each registered reader announces from time to time
+ * that it holds no pointer into the table, for instance between two packets.
+ * The single writer unlinks an object, stamps it with a new epoch and frees
+ * it once every registered reader has announced such a quiescent state in
+ * that epoch or a later one. Without registered readers an object can be
+ * freed right away.
+ *
+ * A zeroed tracker is ready to use.
+ */
+struct ccnl_rcu_s {
+    uint32_t epoch;                         /**< advanced by every retirement */
+    uint32_t readers;                       /**< one bit per registered reader */
+    uint32_t seen[CCNL_RCU_MAX_READERS];    /**< epoch of the last quiescent state of each reader */
+};
+
+/**
+ * @brief Registers a reader
+ *
+ * May be called from the reader's thread.
+ *
+ * @return The id of the reader, -1 if \ref CCNL_RCU_MAX_READERS are registered
+ */
+int
+ccnl_rcu_register(struct ccnl_rcu_s *rcu);
+
+/**
+ * @brief Unregisters the reader @p id, which must hold no pointers any more
+ */
+void
+ccnl_rcu_unregister(struct ccnl_rcu_s *rcu, int id);
+
+/**
+ * @brief Announces that the reader @p id holds no pointer into the table
+ *
+ * An id of -1, from a failed registration, is ignored.
+ */
+void
+ccnl_rcu_quiescent(struct ccnl_rcu_s *rcu, int id);
+
+/**
+ * @brief Starts a new epoch for objects the writer just unlinked
+ *
+ * @return The epoch to stamp the objects with
+ */
+uint32_t
+ccnl_rcu_retire(struct ccnl_rcu_s *rcu);
+
+/**
+ * @brief Returns 1 if no reader can still hold an object retired in @p epoch
+ */
+int
+ccnl_rcu_done(struct ccnl_rcu_s *rcu, uint32_t epoch);
+
+#endif // CCNL_RCU_H
+/** @} */
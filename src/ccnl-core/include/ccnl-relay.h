@@ -28,25 +28,63 @@
 #include "ccnl-if.h"
 #include "ccnl-pkt.h"
 #include "ccnl-sched.h"
+#include "ccnl-rcu.h"
 
 
+/**
+ * @brief Slot of the nonce set used for duplicate Interest detection
+ */
+struct ccnl_nonce_s {
+    uint32_t nonce;    /**< the nonce, folded to 32 bit if it is longer */
+    uint32_t expires;  /**< time at which the slot becomes free again */
+};
+
 struct ccnl_relay_s {
     void (*ccnl_ll_TX_ptr)(struct ccnl_relay_s*, struct ccnl_if_s*,
         sockunion*, struct ccnl_buf_s*);
+    int (*ccnl_ll_TXv_ptr)(struct ccnl_relay_s*, struct ccnl_if_s*,
+        struct ccnl_txrequest_s*, int); /**< optional, sends several queued requests at once, fragments without copying them */
 #ifndef CCNL_ARDUINO
     time_t startup_time;
 #endif
     int id;
     struct ccnl_face_s *faces;  /**< The existing forwarding faces */
-    struct ccnl_forward_s *fib; /**< The Forwarding Information Base (FIB) */
+    struct ccnl_face_s **face_index; /**< hash buckets indexing the faces by (ifndx, peer) */
+    struct ccnl_face_s **faceid_index; /**< hash buckets indexing the faces by faceid */
+    uint32_t face_index_size;   /**< number of buckets in face_index and faceid_index */
+    uint32_t facecnt;           /**< number of indexed faces */
+    struct ccnl_forward_s *fib; /**< The Forwarding Information Base (FIB), listed for the writer */
+    struct ccnl_fib_index_s *fib_index; /**< hash index of the FIB by prefix, read without locks */
+    uint32_t fibcnt;            /**< number of FIB entries */
+    struct ccnl_rcu_s fib_rcu;  /**< readers of fib_index, see \ref ccnl_fib_reclaim */
+    struct ccnl_forward_s *fib_retired; /**< entries removed while they may still be read */
+    struct ccnl_fib_index_s *fib_retired_index; /**< replaced indexes which may still be read */
 
     struct ccnl_interest_s *pit; /**< The Pending Interest Table (PIT) */
+    struct ccnl_interest_s **pit_index; /**< hash buckets indexing the PIT by name */
+    uint32_t pit_index_size;    /**< number of buckets in pit_index */
     struct ccnl_content_s *contents; /**< contentsend; */
-    struct ccnl_buf_s *nonces;  /**< The nonces that are currently in use */
+    struct ccnl_content_s **cs_index; /**< hash buckets indexing the content store by name */
+    uint32_t cs_index_size;     /**< number of buckets in cs_index */
+    struct ccnl_content_s *cs_repl[CCNL_CS_LFU_LEVELS]; /**< replacement lists of the content store, see \ref ccnl_cs_replacement */
+    struct ccnl_content_s *cs_clock_hand; /**< next content inspected by the CLOCK replacement */
+    uint8_t cs_replacement;     /**< active cache replacement policy */
+    struct ccnl_wheel_s cs_ageing;   /**< content by the second it times out */
+    struct ccnl_wheel_s pit_ageing;  /**< PIT entries by the second of their next retransmission */
+    struct ccnl_wheel_s face_ageing; /**< non-static faces by the second they may time out */
+#if CCNL_MAX_NONCES > 0
+    struct ccnl_nonce_s nonces[CCNL_NONCE_TABLE_SIZE]; /**< The nonces that are currently in use */
+#endif
+    uint32_t nonce_hits;        /**< number of Interests dropped as duplicates */
+    uint32_t nonce_evictions;   /**< number of live nonces displaced from a full probe window */
+    uint32_t serve_epoch;       /**< counts the calls of \ref ccnl_content_serve_pending */
+    uint32_t serve_fanout[CCNL_SERVE_FANOUT_BUCKETS]; /**< Data by the number of faces they were sent to, see \ref ccnl_serve_fanout_bucket */
     int contentcnt;             /**< number of cached items */
     int max_cache_entries;      /**< max number of cached items -1: unlimited */
     int pitcnt;                 /**< Number of entries in the PIT */
     int max_pit_entries;        /**< max number of pit entries; -1: unlimited */ 
+    size_t face_qmax;           /**< depth of the face output queues, 0: \ref CCNL_MAX_FACE_QLEN */
+    int face_qdrop;             /**< drop policy of full face output queues, see \ref ccnl_face_drop */
     struct ccnl_if_s ifs[CCNL_MAX_INTERFACES];
     int ifcount;               /**< number of active interfaces */
     char halt_flag;            /**< Flag to interrupt the IO_Loop and to exit the relay */
@@ -57,6 +95,7 @@ struct ccnl_relay_s {
 #ifdef USE_HTTP_STATUS
     struct ccnl_http_s *http;  /**< http server for status information*/
 #endif
+    struct ccnl_buf_s *rxbuf;  /**< buffer holding the datagram in ccnl_core_RX, if the caller lends it, see \ref ccnl_buf_slice */
     void *aux;
   /*
     struct ccnl_face_s *crypto_face;
@@ -94,6 +133,23 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
                        struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
                        struct ccnl_buf_s *buf, sockunion *dest);
 
+/**
+ * @brief Queues @p hdr followed by the bytes of @p buf as one datagram
+ *
+ * The header is copied into the request, @p buf is sent from where it
+ * is. This is how fragments go out without being assembled in a buffer
+ * of their own.
+ *
+ * @param[in] hdr    Bytes to send first, at most CCNL_FRAG_HDR_MAX
+ * @param[in] hdrlen Length of @p hdr, 0 to send @p buf alone
+ * @param[in] buf    The payload, released once sent or dropped
+ */
+void
+ccnl_interface_enqueue_hdr(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
+                           struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+                           uint8_t *hdr, size_t hdrlen,
+                           struct ccnl_buf_s *buf, sockunion *dest);
+
 struct ccnl_buf_s*
 ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
 
@@ -162,6 +218,10 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 /**
  * @brief deliver new content @p c to all clients with (loosely) matching interest 
  *
+ * Only the PIT entries indexed under a prefix of the content name are
+ * visited. Faces already served are recognized by their served_epoch, the
+ * number of faces served is counted in serve_fanout.
+ *
  * @param[in] ccnl  pointer to current ccnl relay
  * @param[in] c     content to be sent
  *
@@ -170,12 +230,48 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 int
 ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 
+/**
+ * @brief Returns the bucket of serve_fanout counting Data sent to @p fanout faces
+ *
+ * Bucket 0 counts unsolicited Data, 1 and 2 single and two faces, and
+ * each further bucket twice as many faces as the one before. The last
+ * bucket takes everything above.
+ */
+int
+ccnl_serve_fanout_bucket(int fanout);
+
 void
 ccnl_do_ageing(void *ptr, void *dummy);
 
+/**
+ * @brief Looks up a nonce in the nonce set of \p ccnl and adds it if absent
+ *
+ * The set has a fixed number of slots and never allocates. A nonce is
+ * remembered for \p lifetime seconds. If all slots it may occupy hold live
+ * nonces, the one expiring first is evicted. Nonces longer than 32 bit are
+ * folded, so distinct long nonces may rarely collide.
+ *
+ * @param[in] ccnl      The relay owning the nonce set
+ * @param[in] nonce     The nonce of the received Interest
+ * @param[in] lifetime  Time in seconds the nonce is remembered
+ *
+ * @return -1 if the nonce is known and has not expired yet
+ * @return 0 if the nonce was added
+ */
 int
-ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce);
+ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce,
+                          uint32_t lifetime);
 
+/**
+ * @brief Checks whether \p pkt carries a nonce seen before
+ *
+ * Nonces are remembered for the lifetime of the Interest.
+ *
+ * @param[in] relay  The relay receiving the Interest
+ * @param[in] pkt    The received Interest
+ *
+ * @return 1 if the Interest is a duplicate, 0 otherwise
+ */
 int
 ccnl_nonce_isDup(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt);
 
@@ -231,6 +327,20 @@ ccnl_cs_dump(struct ccnl_relay_s *ccnl);
 void
 ccnl_interface_CTS(void *aux1, void *aux2);
 
+/**
+ * @brief Sends everything queued at an interface
+ *
+ * If the interface has a txbatch above one and the relay provides
+ * ccnl_ll_TXv_ptr, the queue is handed out in batches of up to txbatch
+ * requests, otherwise it is drained with \ref ccnl_interface_CTS. Stops
+ * early if the link layer reports that it would block.
+ *
+ * @param[in] ccnl The relay
+ * @param[in] ifc  The interface to flush
+ */
+void
+ccnl_interface_flush(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc);
+
 #define DBL_LINKED_LIST_ADD(l,e) \
   do { if ((l)) (l)->prev = (e); \
        (e)->next = (l); \
@@ -293,9 +403,11 @@ ccnl_cs_lookup(struct ccnl_relay_s *ccnl, char *prefix);
  * The given function will be called if the cache is full and a new content
  * chunk arrives. It shall remove (at least) one entry from the cache.
  *
- * If the return value of @p func is 0, the default caching strategy will be
- * applied by the CCN-lite stack. If the return value is 1, it is assumed that
- * (at least) one entry has been removed from the cache.
+ * If the return value of @p func is 0, the relay's replacement policy (see
+ * @ref ccnl_content_repl_set_policy) will be applied by the CCN-lite stack.
+ * If the return value is 1, it is assumed that (at least) one entry has been
+ * removed from the cache. A strategy may use @ref ccnl_content_repl_victim to
+ * consult the replacement policy itself.
  *
  * @param[in] func  The function to be called for an incoming content chunk if
  *                  the cache is full.
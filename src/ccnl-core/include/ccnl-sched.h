@@ -30,7 +30,7 @@
 struct ccnl_relay_s;
 
 struct ccnl_sched_s {
-    char mode; // 0=dummy, 1=pktrate
+    char mode; // 0=dummy, 1=pktrate, 2=drr (interface), 3=drr face
     void (*rts)(struct ccnl_sched_s* s, int cnt, int len, void *aux1, void *aux2);
     // private:
     void (*cts)(void *aux1, void *aux2);
@@ -46,6 +46,18 @@ struct ccnl_sched_s {
     // simple packet rate limiter:
     int ipi; // inter_packet_interval, minimum time between send() in usec
 #endif
+    // deficit round robin, see ccnl_sched_drr_new():
+    struct ccnl_sched_s *parent;   // face: the scheduler of its interface
+    struct ccnl_sched_s *sibling;  // face: next face of the same interface
+    struct ccnl_sched_s *next;     // face: next face of the round
+    struct ccnl_sched_s *flows;    // interface: all faces sharing it
+    struct ccnl_sched_s *active, *last; // interface: faces with packets
+    struct ccnl_sched_s *serving;  // interface: face handing over a packet
+    int quantum;  // interface: bytes per round and unit of weight
+    int weight;   // face: its share of the interface
+    long deficit; // face: bytes left of its turn, negative if overdrawn
+    char inround, turn; // face: in the round, in its turn
+    char running, txbusy; // interface: serving faces, waiting for a send
 };
 
 int 
@@ -61,6 +73,62 @@ struct ccnl_sched_s*
 ccnl_sched_pktrate_new(void (cts)(void *aux1, void *aux2),
         struct ccnl_relay_s *ccnl, int inter_packet_interval);
 
+/**
+ * @brief Creates a scheduler which shares an interface fairly among faces
+ *
+ * Deficit round robin: faces with packets take turns, and a face may hand
+ * \p quantum bytes times its weight to the interface per turn. A face
+ * which sends more than that is charged the excess in its next turn, so
+ * the share of each face is kept in bytes, not in packets. The interface
+ * is handed at most CCNL_SCHED_DRR_DEPTH sends at a time, the order is
+ * decided when the link is ready.
+ *
+ * @param[in] cts   sends the next packet queued at the interface
+ * @param[in] ccnl  the relay
+ * @param[in] quantum bytes per turn and unit of weight, 0 for
+ *                  CCNL_SCHED_DRR_QUANTUM
+ * @param[in] inter_packet_interval minimum time between sends in usec
+ *
+ * @return the scheduler, NULL if out of memory
+ */
+struct ccnl_sched_s*
+ccnl_sched_drr_new(void (cts)(void *aux1, void *aux2),
+        struct ccnl_relay_s *ccnl, int quantum, int inter_packet_interval);
+
+/**
+ * @brief Creates the scheduler of a face sharing a fair interface
+ *
+ * \ref ccnl_sched_RTS of the face announces its packets, the interface
+ * calls \p cts whenever the face may hand one packet over.
+ *
+ * @param[in] cts   hands the next packet of the face to the interface
+ * @param[in] drr   the scheduler of the interface
+ * @param[in] weight share of the face, 1 to CCNL_SCHED_DRR_MAX_WEIGHT
+ *
+ * @return the scheduler, NULL if out of memory or \p drr is not fair
+ */
+struct ccnl_sched_s*
+ccnl_sched_drr_face_new(void (cts)(void *aux1, void *aux2),
+        struct ccnl_sched_s *drr, int weight);
+
+/**
+ * @brief Sets the share of a face at a fair interface
+ *
+ * @param[in] s     the scheduler of the face
+ * @param[in] weight 1 to CCNL_SCHED_DRR_MAX_WEIGHT
+ *
+ * @return 0 on success, -1 if the weight is out of range or \p s is not
+ *         the scheduler of a face at a fair interface
+ */
+int
+ccnl_sched_drr_weight(struct ccnl_sched_s *s, int weight);
+
+/**
+ * @brief Tells whether a scheduler shares its interface among faces
+ */
+int
+ccnl_sched_is_drr(struct ccnl_sched_s *s);
+
 void
 ccnl_sched_destroy(struct ccnl_sched_s *s);
 
@@ -0,0 +1,65 @@
+/**
+ * @addtogroup CCNL-core
+ * @{
+ *
+ * @file ccnl-simd.h
+ * @brief Vectorized byte comparison, selected at runtime
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#ifndef CCNL_SIMD_H
+#define CCNL_SIMD_H
+
+#ifndef CCNL_LINUXKERNEL
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Instruction sets \ref ccnl_simd_equal can use
+ */
+enum ccnl_simd_level_e {
+    CCNL_SIMD_SCALAR = 0,   /**< portable C */
+    CCNL_SIMD_SSE2,         /**< 16 bytes per step */
+    CCNL_SIMD_AVX2,         /**< 32 bytes per step */
+};
+
+/**
+ * @brief Returns 1 if the @p len bytes at @p a and @p b are equal, else 0
+ *
+ * On the first call the widest instruction set the CPU supports is picked.
+ */
+int
+ccnl_simd_equal(const void *a, const void *b, size_t len);
+
+/**
+ * @brief Selects the implementation of \ref ccnl_simd_equal
+ *
+ * @param[in] level   The wanted instruction set, capped at what the CPU
+ *                    and the build support
+ *
+ * @return The level now in use
+ */
+int
+ccnl_simd_select(int level);
+
+/**
+ * @brief Returns the name of the instruction set in use
+ */
+const char*
+ccnl_simd_name(void);
+
+#endif // CCNL_SIMD_H
+/** @} */
@@ -130,6 +130,19 @@ char* ccnl_addr2ascii(sockunion *su);
 int
 ccnl_addr_cmp(sockunion *s1, sockunion *s2);
 
+/**
+ * @brief Computes a hash value over a socket address
+ *
+ * Only the fields compared by \ref ccnl_addr_cmp are hashed, so addresses
+ * which compare equal always hash to the same value.
+ *
+ * @param[in] su The socket address to hash
+ *
+ * @return the hash value, 0 for NULL and unsupported address families
+ */
+uint32_t
+ccnl_addr_hash(sockunion *su);
+
 char*
 ll2ascii(unsigned char *addr, size_t len);
 
@@ -0,0 +1,103 @@
+/**
+ * @addtogroup CCNL-core
+ * @{
+ *
+ * @file ccnl-wheel.h
+ * @brief Timer wheel indexing table entries by the second they are due
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#ifndef CCNL_WHEEL_H
+#define CCNL_WHEEL_H
+
+#ifndef CCNL_LINUXKERNEL
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+#include "ccnl-defs.h"
+
+/**
+ * @brief Link of a table entry into a \ref ccnl_wheel_s
+ *
+ * The link is embedded in the entry, \ref CCNL_WHEEL_ENTRY gets back to it.
+ */
+struct ccnl_wheel_link_s {
+    struct ccnl_wheel_link_s *next;
+    struct ccnl_wheel_link_s *prev;
+    struct ccnl_wheel_link_s **head; /**< list the link is in, NULL if it is in none */
+    uint32_t due;                    /**< second at which the entry has to be looked at */
+};
+
+/**
+ * @brief Hashed timer wheel with one slot per second
+ *
+ * An entry waits in the slot of its due second modulo the number of slots.
+ * Advancing the wheel only visits the slots of the seconds which passed, so
+ * the cost depends on the entries which are due instead of on the size of
+ * the table. Entries due more than one turn ahead stay in their slot until
+ * their turn comes.
+ *
+ * A zeroed wheel is ready to use.
+ */
+struct ccnl_wheel_s {
+    struct ccnl_wheel_link_s *slots[CCNL_AGEING_WHEEL_SLOTS];
+    struct ccnl_wheel_link_s *expired; /**< entries handed out by \ref ccnl_wheel_pop */
+    uint32_t next;                     /**< the first second not advanced over yet */
+    uint32_t count;                    /**< entries in the slots and the expired list */
+};
+
+/**
+ * @brief Returns the entry of type @p type containing @p link as @p member
+ */
+#define CCNL_WHEEL_ENTRY(link, type, member) \
+    ((type*) (void*) ((char*) (link) - offsetof(type, member)))
+
+/**
+ * @brief Schedules @p link at second @p due, moving it if it is scheduled
+ *
+ * A second the wheel has already advanced over means the next advance.
+ */
+void
+ccnl_wheel_add(struct ccnl_wheel_s *wheel, struct ccnl_wheel_link_s *link,
+               uint32_t due);
+
+/**
+ * @brief Removes @p link from @p wheel, does nothing if it is not scheduled
+ */
+void
+ccnl_wheel_remove(struct ccnl_wheel_s *wheel, struct ccnl_wheel_link_s *link);
+
+/**
+ * @brief Collects the entries due at or before @p now
+ *
+ * At most one turn of slots is visited, also after a long pause.
+ */
+void
+ccnl_wheel_advance(struct ccnl_wheel_s *wheel, uint32_t now);
+
+/**
+ * @brief Takes the next entry collected by \ref ccnl_wheel_advance
+ *
+ * The entry is no longer scheduled. Entries which are removed before they
+ * are taken, for instance because a face went away, are not returned.
+ *
+ * @return The link of the entry, NULL if no collected entry is left
+ */
+struct ccnl_wheel_link_s*
+ccnl_wheel_pop(struct ccnl_wheel_s *wheel);
+
+#endif // CCNL_WHEEL_H
+/** @} */
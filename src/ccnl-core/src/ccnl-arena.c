@@ -0,0 +1,140 @@
+/*
+ * @f ccnl-arena.c
+ * @b CCN lite, bump allocator for per-packet state
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-06-11 created
+ */
+
+#ifndef CCNL_LINUXKERNEL
+#include "ccnl-arena.h"
+#include "ccnl-malloc.h"
+#include <string.h>
+#else
+#include "../include/ccnl-arena.h"
+#include "../include/ccnl-malloc.h"
+#endif
+
+#define CCNL_ARENA_ALIGN        16
+
+struct ccnl_arena_s ccnl_pkt_arena;
+
+int
+ccnl_arena_reserve(struct ccnl_arena_s *arena, size_t size)
+{
+    if (arena->depth || arena->used) {
+        return -1;
+    }
+    ccnl_arena_release(arena);
+    if (!size) {
+        return 0;
+    }
+    arena->base = (unsigned char*) ccnl_malloc(size);
+    if (!arena->base) {
+        return -1;
+    }
+    arena->size = size;
+    return 0;
+}
+
+void
+ccnl_arena_release(struct ccnl_arena_s *arena)
+{
+    ccnl_free(arena->base);
+    arena->base = NULL;
+    arena->size = arena->used = 0;
+}
+
+size_t
+ccnl_arena_mark(struct ccnl_arena_s *arena)
+{
+    return arena->used;
+}
+
+void
+ccnl_arena_reset(struct ccnl_arena_s *arena, size_t mark)
+{
+    if (mark >= arena->used) {
+        return;
+    }
+#ifdef USE_DEBUG_MALLOC
+    // make a dangling reference into the dropped objects show up early
+    memset(arena->base + mark, 0xa5, arena->used - mark);
+#endif
+    arena->used = mark;
+}
+
+size_t
+ccnl_arena_enter(struct ccnl_arena_s *arena)
+{
+    arena->depth++;
+    return arena->used;
+}
+
+void
+ccnl_arena_leave(struct ccnl_arena_s *arena, size_t mark)
+{
+    arena->depth--;
+    ccnl_arena_reset(arena, mark);
+}
+
+struct ccnl_arena_s*
+ccnl_arena_active(void)
+{
+    return ccnl_pkt_arena.depth && ccnl_pkt_arena.base ? &ccnl_pkt_arena : NULL;
+}
+
+void*
+ccnl_arena_alloc(struct ccnl_arena_s *arena, size_t size)
+{
+    size_t start = (arena->used + CCNL_ARENA_ALIGN - 1) &
+                   ~((size_t) CCNL_ARENA_ALIGN - 1);
+
+    if (!arena->base) {
+        return NULL;
+    }
+    if (start > arena->size || size > arena->size - start) {
+        arena->overflows++;
+        return NULL;
+    }
+    arena->used = start + size;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+    return arena->base + start;
+}
+
+void*
+ccnl_arena_calloc(struct ccnl_arena_s *arena, size_t size)
+{
+    void *p = ccnl_arena_alloc(arena, size);
+
+    if (p) {
+        memset(p, 0, size);
+    }
+    return p;
+}
+
+int
+ccnl_arena_owns(struct ccnl_arena_s *arena, void *ptr)
+{
+    unsigned char *cp = (unsigned char*) ptr;
+
+    return arena->base && cp >= arena->base && cp < arena->base + arena->size;
+}
+
+// eof
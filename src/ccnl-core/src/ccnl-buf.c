@@ -27,34 +27,156 @@
 #include "ccnl-logging.h"
 #include "ccnl-relay.h"
 #include "ccnl-forward.h"
+#include "ccnl-interest.h"
 #include "ccnl-prefix.h"
 #include "ccnl-malloc.h"
+#include "ccnl-pool.h"
+#include "ccnl-arena.h"
 #else
 #include "../include/ccnl-os-time.h"
 #include "../include/ccnl-buf.h"
 #include "../include/ccnl-logging.h"
 #include "../include/ccnl-relay.h"
 #include "../include/ccnl-forward.h"
+#include "../include/ccnl-interest.h"
 #include "../include/ccnl-prefix.h"
 #include "../include/ccnl-malloc.h"
+#include "../include/ccnl-pool.h"
+#include "../include/ccnl-arena.h"
 #endif
 
-struct ccnl_buf_s*
-ccnl_buf_new(void *data, size_t len)
+// the smallest buffer pool with room for len bytes, the large one if none
+static struct ccnl_pool_s*
+ccnl_buf_pool(size_t len)
+{
+    if (len <= CCNL_POOL_TINY_BUF_SIZE) {
+        return CCNL_POOL(BUF_TINY);
+    }
+    if (len <= CCNL_RX_SHARE_MIN) {
+        return CCNL_POOL(BUF_SMALL);
+    }
+    return CCNL_POOL(BUF_LARGE);
+}
+
+// returns a buffer header to the pool it came from, or to the heap,
+// arena buffers go with their frame
+static void
+ccnl_buf_release(struct ccnl_buf_s *buf)
 {
-    struct ccnl_buf_s *b = (struct ccnl_buf_s*) ccnl_malloc(sizeof(*b) + len);
+    struct ccnl_pool_s *pool = CCNL_POOL(BUF_TINY);
 
+    if (ccnl_arena_owns(&ccnl_pkt_arena, buf)) {
+        return;
+    }
+    for (; pool <= CCNL_POOL(BUF_LARGE); pool++) {
+        if (ccnl_pool_owns(pool, buf)) {
+            ccnl_pool_free(pool, buf);
+            return;
+        }
+    }
+    ccnl_free(buf);
+}
+
+static struct ccnl_buf_s*
+ccnl_buf_init(struct ccnl_buf_s *b, void *data, size_t len)
+{
     if (!b) {
         return NULL;
     }
     b->next = NULL;
     b->datalen = len;
+    b->data = b->storage;
+    b->owner = NULL;
+    b->refcnt = 1;
     if (data) {
         memcpy(b->data, data, len);
     }
     return b;
 }
 
+struct ccnl_buf_s*
+ccnl_buf_new(void *data, size_t len)
+{
+    return ccnl_buf_init((struct ccnl_buf_s*) ccnl_pool_malloc(ccnl_buf_pool(len),
+                                                               sizeof(struct ccnl_buf_s) + len),
+                         data, len);
+}
+
+struct ccnl_buf_s*
+ccnl_buf_new_rx(void *data, size_t len)
+{
+    struct ccnl_arena_s *arena = ccnl_arena_active();
+    struct ccnl_buf_s *b = NULL;
+
+    if (arena) {
+        b = (struct ccnl_buf_s*) ccnl_arena_alloc(arena, sizeof(*b) + len);
+    }
+    return b ? ccnl_buf_init(b, data, len) : ccnl_buf_new(data, len);
+}
+
+struct ccnl_buf_s*
+ccnl_buf_share(struct ccnl_buf_s *buf)
+{
+    struct ccnl_buf_s *b;
+
+    if (!buf) {
+        return NULL;
+    }
+    if (ccnl_arena_owns(&ccnl_pkt_arena, buf->owner ? buf->owner : buf)) {
+        // the bytes do not outlive the frame, the share has to
+        return ccnl_buf_new(buf->data, buf->datalen);
+    }
+    b = (struct ccnl_buf_s*) ccnl_pool_malloc(CCNL_POOL(BUF_TINY), sizeof(*b));
+    if (!b) {
+        return NULL;
+    }
+    b->next = NULL;
+    b->datalen = buf->datalen;
+    b->data = buf->data;
+    b->owner = buf->owner ? buf->owner : buf;
+    b->refcnt = 0;
+    b->owner->refcnt++;
+    return b;
+}
+
+struct ccnl_buf_s*
+ccnl_buf_slice(struct ccnl_buf_s *buf, void *data, size_t len)
+{
+    struct ccnl_buf_s *b;
+    unsigned char *cp = (unsigned char*) data;
+
+    if (!buf || cp < buf->data || cp > buf->data + buf->datalen ||
+        len > (size_t) (buf->data + buf->datalen - cp)) {
+        return NULL;
+    }
+    if (ccnl_arena_owns(&ccnl_pkt_arena, buf->owner ? buf->owner : buf)) {
+        return ccnl_buf_new(cp, len);
+    }
+    b = ccnl_buf_share(buf);
+    if (b) {
+        b->data = cp;
+        b->datalen = len;
+    }
+    return b;
+}
+
+void
+ccnl_buf_free(struct ccnl_buf_s *buf)
+{
+    struct ccnl_buf_s *owner;
+
+    if (!buf) {
+        return;
+    }
+    owner = buf->owner ? buf->owner : buf;
+    if (owner != buf) {
+        ccnl_buf_release(buf);
+    }
+    if (--owner->refcnt == 0) {
+        ccnl_buf_release(owner);
+    }
+}
+
 void
 ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
 {
@@ -64,21 +186,17 @@ ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
 
     while (ccnl->pit)
         ccnl_interest_remove(ccnl, ccnl->pit);
+    ccnl_interest_index_free(ccnl);
     while (ccnl->faces)
         ccnl_face_remove(ccnl, ccnl->faces); // removes allmost all FWD entries
+    ccnl_face_index_free(ccnl);
     while (ccnl->fib) {
-        struct ccnl_forward_s *fwd = ccnl->fib->next;
-        ccnl_prefix_free(ccnl->fib->prefix);
-        ccnl_free(ccnl->fib);
-        ccnl->fib = fwd;
+        ccnl_fib_remove(ccnl, ccnl->fib);
     }
+    ccnl_fib_index_free(ccnl);
     while (ccnl->contents)
         ccnl_content_remove(ccnl, ccnl->contents);
-    while (ccnl->nonces) {
-        struct ccnl_buf_s *tmp = ccnl->nonces->next;
-        ccnl_free(ccnl->nonces);
-        ccnl->nonces = tmp;
-    }
+    ccnl_content_index_free(ccnl);
     for (k = 0; k < ccnl->ifcount; k++)
         ccnl_interface_cleanup(ccnl->ifs + k);
 }
@@ -32,6 +32,16 @@ static ccnl_cb_on_data _cb_rx_on_data = NULL;
  */
 static ccnl_cb_on_data _cb_tx_on_data = NULL;
 
+/**
+ * callback function for FIB changes
+ */
+static ccnl_cb_on_fib _cb_on_fib = NULL;
+
+/**
+ * callback function for unsolicited Data
+ */
+static ccnl_cb_on_unsolicited _cb_on_unsolicited = NULL;
+
 void
 ccnl_set_cb_rx_on_data(ccnl_cb_on_data func)
 {
@@ -47,10 +57,12 @@ ccnl_set_cb_tx_on_data(ccnl_cb_on_data func)
 int
 ccnl_callback_rx_on_data(struct ccnl_relay_s *relay,
                          struct ccnl_face_s *from,
-                         struct ccnl_pkt_s *pkt)
+                         struct ccnl_pkt_s **pkt)
 {
-    if (_cb_rx_on_data) {
-        return _cb_rx_on_data(relay, from, pkt);
+    // a packet which cannot be moved is not offered, ccnl_content_new()
+    // fails on it the same way
+    if (_cb_rx_on_data && !ccnl_pkt_persist(pkt)) {
+        return _cb_rx_on_data(relay, from, *pkt);
     }
 
     return 0;
@@ -67,3 +79,34 @@ ccnl_callback_tx_on_data(struct ccnl_relay_s *relay,
 
     return 0;
 }
+
+void
+ccnl_set_cb_on_fib(ccnl_cb_on_fib func)
+{
+    _cb_on_fib = func;
+}
+
+void
+ccnl_callback_on_fib(struct ccnl_relay_s *relay,
+                     struct ccnl_forward_s *fwd, int added)
+{
+    if (_cb_on_fib) {
+        _cb_on_fib(relay, fwd, added);
+    }
+}
+
+void
+ccnl_set_cb_on_unsolicited(ccnl_cb_on_unsolicited func)
+{
+    _cb_on_unsolicited = func;
+}
+
+void
+ccnl_callback_on_unsolicited(struct ccnl_relay_s *relay,
+                             struct ccnl_face_s *from,
+                             struct ccnl_pkt_s *pkt)
+{
+    if (_cb_on_unsolicited) {
+        _cb_on_unsolicited(relay, from, pkt);
+    }
+}
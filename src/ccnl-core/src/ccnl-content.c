@@ -23,18 +23,23 @@
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-content.h"
 #include "ccnl-malloc.h"
+#include "ccnl-pool.h"
 #include "ccnl-prefix.h"
 #include "ccnl-pkt.h"
 #include "ccnl-os-time.h"
 #include "ccnl-logging.h"
 #include "ccnl-defs.h"
+#include "ccnl-relay.h"
+#include <string.h>
 #else
 #include "../include/ccnl-content.h"
 #include "../include/ccnl-malloc.h"
+#include "../include/ccnl-pool.h"
 #include "../include/ccnl-prefix.h"
 #include "../include/ccnl-pkt.h"
 #include "../include/ccnl-os-time.h"
 #include "../include/ccnl-logging.h"
+#include "../include/ccnl-relay.h"
 #endif
 
 // TODO: remove unused ccnl parameter
@@ -52,9 +57,12 @@ ccnl_content_new(struct ccnl_pkt_s **pkt)
 
     DEBUGMSG_CORE(TRACE, "ccnl_content_new %p <%s [%lu]>\n",
              (void*) *pkt, ccnl_prefix_to_str((*pkt)->pfx, s, CCNL_MAX_PREFIX_SIZE),
-             ((*pkt)->pfx->chunknum) ? (long unsigned) *((*pkt)->pfx->chunknum) : (long unsigned) 0);
+             ((*pkt)->pfx->chunknum >= 0) ? (long unsigned) (*pkt)->pfx->chunknum : (long unsigned) 0);
 
-    c = (struct ccnl_content_s *) ccnl_calloc(1, sizeof(struct ccnl_content_s));
+    if (ccnl_pkt_persist(pkt)) {
+        return NULL;
+    }
+    c = (struct ccnl_content_s *) ccnl_pool_calloc(CCNL_POOL(CONTENT), sizeof(struct ccnl_content_s));
     if (!c)
         return NULL;
     c->pkt = *pkt;
@@ -73,10 +81,304 @@ ccnl_content_free(struct ccnl_content_s *content)
             ccnl_pkt_free(content->pkt);
         }
         
-        ccnl_free(content);
+        ccnl_pool_free(CCNL_POOL(CONTENT), content);
+
+        return 0;
+    }
+
+    return -1;
+}
+
+int
+ccnl_content_is_stale(struct ccnl_content_s *content)
+{
+#ifdef USE_SUITE_NDNTLV
+    if (!(content->flags & (CCNL_CONTENT_FLAGS_STALE | CCNL_CONTENT_FLAGS_STATIC)) &&
+        content->pkt->suite == CCNL_SUITE_NDNTLV &&
+        (content->last_used + (content->pkt->s.ndntlv.freshnessperiod / 1000)) <= (uint32_t) CCNL_NOW()) {
+        content->flags |= CCNL_CONTENT_FLAGS_STALE;
+    }
+#endif
+    return (content->flags & CCNL_CONTENT_FLAGS_STALE) != 0;
+}
+
+static int
+ccnl_content_index_grow(struct ccnl_relay_s *relay)
+{
+    struct ccnl_content_s **buckets, *c, *next;
+    uint32_t size, i;
+
+    size = relay->cs_index_size ? relay->cs_index_size * 2 : CCNL_CS_INDEX_MIN_SIZE;
+    buckets = (struct ccnl_content_s **) ccnl_calloc(size, sizeof(*buckets));
+    if (!buckets) {
+        return -1;
+    }
+    for (i = 0; i < relay->cs_index_size; i++) {
+        for (c = relay->cs_index[i]; c; c = next) {
+            next = c->hnext;
+            c->hnext = buckets[c->namehash & (size - 1)];
+            buckets[c->namehash & (size - 1)] = c;
+        }
+    }
+    ccnl_free(relay->cs_index);
+    relay->cs_index = buckets;
+    relay->cs_index_size = size;
+
+    return 0;
+}
+
+int
+ccnl_content_index_add(struct ccnl_relay_s *relay, struct ccnl_content_s *content)
+{
+    struct ccnl_content_s **bucket;
+
+    if (!relay->cs_index || relay->contentcnt >= (int) relay->cs_index_size) {
+        // a failed resize keeps the old (smaller) table, which is still valid
+        if (ccnl_content_index_grow(relay) && !relay->cs_index) {
+            return -1;
+        }
+    }
+    content->namehash = ccnl_prefix_hash(content->pkt->pfx, content->pkt->pfx->compcnt);
+    bucket = relay->cs_index + (content->namehash & (relay->cs_index_size - 1));
+    content->hnext = *bucket;
+    *bucket = content;
+
+    return 0;
+}
+
+void
+ccnl_content_index_remove(struct ccnl_relay_s *relay, struct ccnl_content_s *content)
+{
+    struct ccnl_content_s **pc;
+
+    if (!relay->cs_index) {
+        return;
+    }
+    pc = relay->cs_index + (content->namehash & (relay->cs_index_size - 1));
+    for (; *pc; pc = &(*pc)->hnext) {
+        if (*pc == content) {
+            *pc = content->hnext;
+            content->hnext = NULL;
+            return;
+        }
+    }
+}
+
+struct ccnl_content_s*
+ccnl_content_index_lookup(struct ccnl_relay_s *relay, struct ccnl_prefix_s *prefix)
+{
+    struct ccnl_content_s *c;
+    uint64_t h;
+
+    if (!relay->cs_index || !prefix) {
+        return NULL;
+    }
+    h = ccnl_prefix_hash(prefix, prefix->compcnt);
+    for (c = relay->cs_index[h & (relay->cs_index_size - 1)]; c; c = c->hnext) {
+        if (c->namehash == h &&
+            ccnl_prefix_cmp(c->pkt->pfx, NULL, prefix, CMP_EXACT) == 0) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+static struct ccnl_content_s*
+ccnl_content_index_probe(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt,
+                         int8_t (*match)(struct ccnl_pkt_s*, struct ccnl_content_s*),
+                         uint32_t cnt)
+{
+    struct ccnl_content_s *c;
+    uint64_t h = ccnl_prefix_hash(pkt->pfx, cnt);
+
+    for (c = relay->cs_index[h & (relay->cs_index_size - 1)]; c; c = c->hnext) {
+        if (c->namehash == h && c->pkt->pfx->suite == pkt->pfx->suite &&
+            !match(pkt, c)) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+struct ccnl_content_s*
+ccnl_content_index_match(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt,
+                         int8_t (*match)(struct ccnl_pkt_s*, struct ccnl_content_s*))
+{
+    struct ccnl_content_s *c;
+
+    if (!relay->cs_index || !pkt->pfx) {
+        return NULL;
+    }
+    c = ccnl_content_index_probe(relay, pkt, match, pkt->pfx->compcnt);
+    if (!c && pkt->pfx->compcnt > 0) {
+        // the last component may be an implicit digest of the content
+        c = ccnl_content_index_probe(relay, pkt, match, pkt->pfx->compcnt - 1);
+    }
+    return c;
+}
 
+void
+ccnl_content_index_free(struct ccnl_relay_s *relay)
+{
+    ccnl_free(relay->cs_index);
+    relay->cs_index = NULL;
+    relay->cs_index_size = 0;
+}
+
+/* links content at the most recently used end of the circular list *head */
+static void
+ccnl_content_repl_push(struct ccnl_content_s **head, struct ccnl_content_s *c)
+{
+    if (!*head) {
+        c->rnext = c->rprev = c;
+    } else {
+        c->rnext = *head;
+        c->rprev = (*head)->rprev;
+        c->rprev->rnext = c;
+        (*head)->rprev = c;
+    }
+    *head = c;
+}
+
+static void
+ccnl_content_repl_unlink(struct ccnl_relay_s *relay, struct ccnl_content_s *c)
+{
+    struct ccnl_content_s **head = &relay->cs_repl[c->repl_level];
+
+    if (relay->cs_clock_hand == c) {
+        relay->cs_clock_hand = (c->rprev != c) ? c->rprev : NULL;
+    }
+    if (c->rnext == c) {
+        *head = NULL;
+    } else {
+        c->rprev->rnext = c->rnext;
+        c->rnext->rprev = c->rprev;
+        if (*head == c) {
+            *head = c->rnext;
+        }
+    }
+    c->rnext = c->rprev = NULL;
+}
+
+static uint8_t
+ccnl_content_repl_level(struct ccnl_relay_s *relay, struct ccnl_content_s *c)
+{
+    if (relay->cs_replacement != CCNL_CS_REPLACE_LFU || c->served_cnt <= 0) {
         return 0;
     }
+    if (c->served_cnt >= CCNL_CS_LFU_LEVELS) {
+        return CCNL_CS_LFU_LEVELS - 1;
+    }
+    return (uint8_t) c->served_cnt;
+}
+
+void
+ccnl_content_repl_add(struct ccnl_relay_s *relay, struct ccnl_content_s *c)
+{
+    struct ccnl_content_s *hand = relay->cs_clock_hand;
+
+    if (c->rnext || (c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+        return;
+    }
+    c->repl_level = ccnl_content_repl_level(relay, c);
+    if (relay->cs_replacement == CCNL_CS_REPLACE_CLOCK && hand) {
+        // insert right behind the hand, i.e. inspect the new content last
+        c->rprev = hand;
+        c->rnext = hand->rnext;
+        hand->rnext->rprev = c;
+        hand->rnext = c;
+        return;
+    }
+    ccnl_content_repl_push(&relay->cs_repl[c->repl_level], c);
+}
+
+void
+ccnl_content_repl_remove(struct ccnl_relay_s *relay, struct ccnl_content_s *c)
+{
+    if (c->rnext) {
+        ccnl_content_repl_unlink(relay, c);
+    }
+}
+
+void
+ccnl_content_repl_touch(struct ccnl_relay_s *relay, struct ccnl_content_s *c)
+{
+    if (!c->rnext) {
+        return;
+    }
+    if (relay->cs_replacement == CCNL_CS_REPLACE_CLOCK) {
+        c->flags |= CCNL_CONTENT_FLAGS_REFERENCED;
+        return;
+    }
+    ccnl_content_repl_unlink(relay, c);
+    c->repl_level = ccnl_content_repl_level(relay, c);
+    ccnl_content_repl_push(&relay->cs_repl[c->repl_level], c);
+}
+
+struct ccnl_content_s*
+ccnl_content_repl_victim(struct ccnl_relay_s *relay)
+{
+    struct ccnl_content_s *c;
+    int level;
+
+    // static content is dropped from the lists when it is encountered, so
+    // every entry is skipped at most once and victim selection stays O(1)
+    if (relay->cs_replacement == CCNL_CS_REPLACE_CLOCK) {
+        while ((c = relay->cs_clock_hand) ||
+               (relay->cs_repl[0] && (c = relay->cs_repl[0]->rprev))) {
+            if (c->flags & CCNL_CONTENT_FLAGS_STATIC) {
+                ccnl_content_repl_unlink(relay, c);
+            } else if (c->flags & CCNL_CONTENT_FLAGS_REFERENCED) {
+                c->flags &= ~CCNL_CONTENT_FLAGS_REFERENCED;
+                relay->cs_clock_hand = c->rprev;
+            } else {
+                return c;
+            }
+        }
+        return NULL;
+    }
 
+    for (level = 0; level < CCNL_CS_LFU_LEVELS; level++) {
+        while (relay->cs_repl[level]) {
+            c = relay->cs_repl[level]->rprev;
+            if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+                return c;
+            }
+            ccnl_content_repl_unlink(relay, c);
+        }
+    }
+    return NULL;
+}
+
+void
+ccnl_content_repl_set_policy(struct ccnl_relay_s *relay, ccnl_cs_replacement policy)
+{
+    struct ccnl_content_s *c, *last = NULL;
+
+    for (c = relay->contents; c; c = c->next) {
+        ccnl_content_repl_remove(relay, c);
+        c->flags &= ~CCNL_CONTENT_FLAGS_REFERENCED;
+        last = c;
+    }
+    relay->cs_replacement = (uint8_t) policy;
+    relay->cs_clock_hand = NULL;
+    // the content store is prepended to, hence relink from the oldest entry
+    for (c = last; c; c = c->prev) {
+        ccnl_content_repl_add(relay, c);
+    }
+}
+
+int
+ccnl_content_repl_str2policy(const char *str)
+{
+    if (!strcmp(str, "lru")) {
+        return CCNL_CS_REPLACE_LRU;
+    }
+    if (!strcmp(str, "clock")) {
+        return CCNL_CS_REPLACE_CLOCK;
+    }
+    if (!strcmp(str, "lfu")) {
+        return CCNL_CS_REPLACE_LFU;
+    }
     return -1;
 }
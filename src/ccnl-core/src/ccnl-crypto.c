@@ -402,18 +402,13 @@ ccnl_mgmt_crypto(struct ccnl_relay_s *ccnl, char *type, unsigned char *buf, int
       len2 +=len;
       msg2[len2++] = 0;
 
-      from = ccnl->faces;
-      while(from){
-          if(from->faceid == seqnum)
-              break;
-          from = from->next;
-      }
+      from = ccnl_face_lookup_id(ccnl, seqnum);
 
       buf1 = ccnl_ccnb_extract(&msg2, &len2, &scope, &aok, &minsfx,
                          &maxsfx, &p, &nonce, &ppkd, &content, &contlen);
 
       if (p->complen[2] < sizeof(cmd)) {
-            memcpy(cmd, p->comp[2], p->complen[2]);
+            memcpy(cmd, ccnl_prefix_comp(p, 2), p->complen[2]);
             cmd[p->complen[2]] = '\0';
       } else
             strcpy(cmd, "cmd-is-too-long-to-display");
@@ -439,12 +434,7 @@ ccnl_mgmt_crypto(struct ccnl_relay_s *ccnl, char *type, unsigned char *buf, int
       len1 +=len;
 
       out[len1++] = 0; // end-of-interest
-      from = ccnl->faces;
-      while(from){
-          if(from->faceid == seqnum)
-              break;
-          from = from->next;
-      }
+      from = ccnl_face_lookup_id(ccnl, seqnum);
 
       retbuf = ccnl_buf_new((char *)out, len1);
       if(seqnum >= 0){
@@ -466,15 +456,11 @@ ccnl_mgmt_crypto(struct ccnl_relay_s *ccnl, char *type, unsigned char *buf, int
               //DEBUGMSG(DEBUG, "%s", prefix_a->comp);
               //ccnl_free(prefix_a);
           }
-          //prefix_a = (struct ccnl_prefix_s *)ccnl_malloc(sizeof(struct ccnl_prefix_s));
-          prefix_a->compcnt = 2;
-          prefix_a->comp = (unsigned char **) ccnl_malloc(sizeof(unsigned char*)*2);
-          prefix_a->comp[0] = "mgmt";
+          ccnl_prefix_free(prefix_a);
+          prefix_a = ccnl_prefix_new(CCNL_SUITE_CCNB, 0);
           snprintf(ht, 20, "seqnum-%d", -seqnum);
-          prefix_a->comp[1] = ht;
-          prefix_a->complen = (int *) ccnl_malloc(sizeof(int)*2);
-          prefix_a->complen[0] = strlen("mgmt");
-          prefix_a->complen[1] = strlen(ht);
+          ccnl_prefix_appendCmp(prefix_a, (unsigned char*) "mgmt", strlen("mgmt"));
+          ccnl_prefix_appendCmp(prefix_a, (unsigned char*) ht, strlen(ht));
           c = ccnl_content_new(ccnl, CCNL_SUITE_CCNB, &pkt, &prefix_a, &ppkd,
                                 content, contlen);
           if (!c) goto Done;
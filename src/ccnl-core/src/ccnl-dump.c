@@ -39,6 +39,7 @@
 #include "ccnl-interest.h"
 #include "ccnl-pkt.h"
 #include "ccnl-content.h"
+#include "ccnl-frag.h"
 
 
 static void
@@ -51,6 +52,27 @@ blob(struct ccnl_buf_s *buf)
         CONSOLE("%02x", *cp);
 }
 
+#ifdef USE_FRAG
+char*
+frag_protocol(int e)
+{
+    switch (e) {
+    case CCNL_FRAG_NONE:
+        return "none";
+    case CCNL_FRAG_SEQUENCED2012:
+        return "seqd2012";
+    case CCNL_FRAG_CCNx2013:
+        return "ccnx2013";
+    case CCNL_FRAG_SEQUENCED2015:
+        return "seqd2015";
+    case CCNL_FRAG_BEGINEND2015:
+        return "beginend2015";
+    default:
+        return "?";
+    }
+}
+#endif
+
 
 void
 ccnl_dump(int lev, int typ, void *p)
@@ -164,10 +186,14 @@ ccnl_dump(int lev, int typ, void *p)
                 if (fac->frag)
                     ccnl_dump(lev + 2, CCNL_FRAG, fac->frag);
                 CONSOLE("\n");
-                if (fac->outq) {
+                if (fac->outqlen) {
+                    size_t k;
                     INDENT(lev + 1);
                     CONSOLE("outq:\n");
-                    ccnl_dump(lev + 2, CCNL_BUF, fac->outq);
+                    for (k = 0; k < fac->outqlen; k++) {
+                        ccnl_dump(lev + 2, CCNL_BUF,
+                                  fac->outq[(fac->outqfront + k) % CCNL_MAX_FACE_QLEN].buf);
+                    }
                 }
                 fac = fac->next;
             }
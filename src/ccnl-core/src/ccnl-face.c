@@ -20,9 +20,343 @@
  * 2017-06-16 created
  */
 
+#ifndef CCNL_LINUXKERNEL
 #include "ccnl-malloc.h"
+#include "ccnl-buf.h"
 #include "ccnl-face.h"
+#include "ccnl-relay.h"
+#include <string.h>
+#else
+#include "../include/ccnl-malloc.h"
+#include "../include/ccnl-buf.h"
+#include "../include/ccnl-face.h"
+#include "../include/ccnl-relay.h"
+#endif
 
 void ccnl_face_free(struct ccnl_face_s *face) {
     ccnl_free(face);
 }
+
+size_t
+ccnl_face_qmax(struct ccnl_face_s *f)
+{
+    if (!f->outqmax || f->outqmax > CCNL_MAX_FACE_QLEN) {
+        return CCNL_MAX_FACE_QLEN;
+    }
+    return f->outqmax;
+}
+
+int
+ccnl_face_drop_str2policy(const char *str)
+{
+    if (!strcmp(str, "tail")) {
+        return CCNL_FACE_DROP_TAIL;
+    }
+    if (!strcmp(str, "head")) {
+        return CCNL_FACE_DROP_HEAD;
+    }
+    if (!strcmp(str, "prio")) {
+        return CCNL_FACE_DROP_PRIO;
+    }
+    return -1;
+}
+
+#define CCNL_FACE_OUTQ_SLOT(f, k) \
+    ((f)->outq + (((f)->outqfront + (k)) % CCNL_MAX_FACE_QLEN))
+#define CCNL_FACE_OUTQ_SEEN(f, fp) \
+    ((f)->outqseen[(fp) & (CCNL_FACE_OUTQ_FILTER - 1)])
+
+// bytes hashed at either end of a packet, names and nonces are near the
+// start, signatures at the end
+#define CCNL_FACE_FINGERPRINT_SPAN      64
+
+static uint64_t
+ccnl_face_fingerprint_mix(uint64_t h, unsigned char *p, size_t len)
+{
+    uint64_t w;
+
+    for (; len >= sizeof(w); p += sizeof(w), len -= sizeof(w)) {
+        memcpy(&w, p, sizeof(w));
+        h = (h ^ w) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    if (len) {
+        w = 0;
+        memcpy(&w, p, len);
+        h = (h ^ w) * 0xff51afd7ed558ccdULL;
+    }
+    return h;
+}
+
+/* equal fingerprints are confirmed by comparing the bytes anyway, so the
+ * middle of long packets is left out */
+static uint32_t
+ccnl_face_fingerprint(struct ccnl_buf_s *buf)
+{
+    size_t len = buf->datalen;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ len;
+
+    if (len <= 2 * CCNL_FACE_FINGERPRINT_SPAN) {
+        h = ccnl_face_fingerprint_mix(h, buf->data, len);
+    } else {
+        h = ccnl_face_fingerprint_mix(h, buf->data, CCNL_FACE_FINGERPRINT_SPAN);
+        h = ccnl_face_fingerprint_mix(h, buf->data + len - CCNL_FACE_FINGERPRINT_SPAN,
+                                      CCNL_FACE_FINGERPRINT_SPAN);
+    }
+    h ^= h >> 29;
+    return (uint32_t) (h ^ (h >> 32));
+}
+
+static void
+ccnl_face_outq_hash(struct ccnl_face_s *f, struct ccnl_outq_entry_s *e)
+{
+    if (!e->hashed) {
+        e->fingerprint = ccnl_face_fingerprint(e->buf);
+        e->hashed = 1;
+        CCNL_FACE_OUTQ_SEEN(f, e->fingerprint)++;
+    }
+}
+
+/* drops the k-th queued packet, the ones behind it move up */
+static void
+ccnl_face_outq_drop(struct ccnl_face_s *f, size_t k)
+{
+    struct ccnl_outq_entry_s *e = CCNL_FACE_OUTQ_SLOT(f, k);
+
+    if (e->hashed) {
+        CCNL_FACE_OUTQ_SEEN(f, e->fingerprint)--;
+    }
+    ccnl_buf_free(e->buf);
+    if (k == 0) {
+        f->outqfront = (f->outqfront + 1) % CCNL_MAX_FACE_QLEN;
+    } else {
+        for (; k + 1 < f->outqlen; k++) {
+            *CCNL_FACE_OUTQ_SLOT(f, k) = *CCNL_FACE_OUTQ_SLOT(f, k + 1);
+        }
+    }
+    f->outqlen--;
+}
+
+int
+ccnl_face_outq_add(struct ccnl_face_s *f, struct ccnl_buf_s *buf, int request)
+{
+    struct ccnl_outq_entry_s *e;
+    uint32_t fp = 0;
+    size_t k;
+    int hashed = 0;
+
+    if (f->outqlen > 0) {
+        // only a packet queued while the queue was empty is not hashed yet,
+        // and that one is in front
+        ccnl_face_outq_hash(f, CCNL_FACE_OUTQ_SLOT(f, 0));
+        fp = ccnl_face_fingerprint(buf);
+        hashed = 1;
+        if (CCNL_FACE_OUTQ_SEEN(f, fp)) {
+            for (k = 0; k < f->outqlen; k++) {
+                e = CCNL_FACE_OUTQ_SLOT(f, k);
+                if (e->fingerprint == fp && buf_equal(e->buf, buf)) {
+                    f->outq_dups++;
+                    ccnl_buf_free(buf);
+                    return -1;
+                }
+            }
+        }
+    }
+    if (f->outqlen >= ccnl_face_qmax(f)) {
+        f->outq_drops++;
+        k = f->outqlen;
+        if (f->outqdrop == CCNL_FACE_DROP_HEAD) {
+            k = 0;
+        } else if (f->outqdrop == CCNL_FACE_DROP_PRIO && !request) {
+            for (k = 0; k < f->outqlen && !CCNL_FACE_OUTQ_SLOT(f, k)->request; k++);
+        }
+        if (k >= f->outqlen) {
+            ccnl_buf_free(buf);
+            return -1;
+        }
+        ccnl_face_outq_drop(f, k);
+    }
+    e = CCNL_FACE_OUTQ_SLOT(f, f->outqlen);
+    e->buf = buf;
+    e->fingerprint = fp;
+    e->hashed = (uint8_t) hashed;
+    e->request = (uint8_t) (request != 0);
+    if (hashed) {
+        CCNL_FACE_OUTQ_SEEN(f, fp)++;
+    }
+    buf->next = NULL;
+    f->outqlen++;
+
+    return 0;
+}
+
+struct ccnl_buf_s*
+ccnl_face_outq_take(struct ccnl_face_s *f)
+{
+    struct ccnl_outq_entry_s *e;
+    struct ccnl_buf_s *buf;
+
+    if (!f->outqlen) {
+        return NULL;
+    }
+    e = CCNL_FACE_OUTQ_SLOT(f, 0);
+    if (e->hashed) {
+        CCNL_FACE_OUTQ_SEEN(f, e->fingerprint)--;
+    }
+    buf = e->buf;
+    e->buf = NULL;
+    f->outqfront = (f->outqfront + 1) % CCNL_MAX_FACE_QLEN;
+    f->outqlen--;
+    return buf;
+}
+
+void
+ccnl_face_outq_clear(struct ccnl_face_s *f)
+{
+    struct ccnl_buf_s *buf;
+
+    while ((buf = ccnl_face_outq_take(f))) {
+        ccnl_buf_free(buf);
+    }
+}
+
+static uint32_t
+ccnl_face_keyhash(int ifndx, sockunion *su)
+{
+    return (ccnl_addr_hash(su) ^ (uint32_t) ifndx) * 16777619U;
+}
+
+static int
+ccnl_face_index_grow(struct ccnl_relay_s *relay)
+{
+    struct ccnl_face_s **buckets, **ids, *f, *next;
+    uint32_t size, i;
+
+    size = relay->face_index_size ? relay->face_index_size * 2 : CCNL_FACE_INDEX_MIN_SIZE;
+    buckets = (struct ccnl_face_s **) ccnl_calloc(size, sizeof(*buckets));
+    ids = (struct ccnl_face_s **) ccnl_calloc(size, sizeof(*ids));
+    if (!buckets || !ids) {
+        ccnl_free(buckets);
+        ccnl_free(ids);
+        return -1;
+    }
+    // every indexed face sits in both tables, so one walk rehashes both
+    for (i = 0; i < relay->face_index_size; i++) {
+        for (f = relay->face_index[i]; f; f = next) {
+            next = f->hnext;
+            f->hnext = buckets[f->addrhash & (size - 1)];
+            buckets[f->addrhash & (size - 1)] = f;
+            f->idnext = ids[(uint32_t) f->faceid & (size - 1)];
+            ids[(uint32_t) f->faceid & (size - 1)] = f;
+        }
+    }
+    ccnl_free(relay->face_index);
+    ccnl_free(relay->faceid_index);
+    relay->face_index = buckets;
+    relay->faceid_index = ids;
+    relay->face_index_size = size;
+
+    return 0;
+}
+
+int
+ccnl_face_index_add(struct ccnl_relay_s *relay, struct ccnl_face_s *f)
+{
+    uint32_t b;
+
+    if (!relay->face_index || relay->facecnt >= relay->face_index_size) {
+        // a failed resize keeps the old (smaller) tables, which are still valid
+        if (ccnl_face_index_grow(relay) && !relay->face_index) {
+            return -1;
+        }
+    }
+    f->addrhash = ccnl_face_keyhash(f->ifndx, f->ifndx == -1 ? NULL : &f->peer);
+    b = f->addrhash & (relay->face_index_size - 1);
+    f->hnext = relay->face_index[b];
+    relay->face_index[b] = f;
+    b = (uint32_t) f->faceid & (relay->face_index_size - 1);
+    f->idnext = relay->faceid_index[b];
+    relay->faceid_index[b] = f;
+    relay->facecnt++;
+
+    return 0;
+}
+
+void
+ccnl_face_index_remove(struct ccnl_relay_s *relay, struct ccnl_face_s *f)
+{
+    struct ccnl_face_s **pf;
+
+    if (!relay->face_index) {
+        return;
+    }
+    pf = relay->face_index + (f->addrhash & (relay->face_index_size - 1));
+    for (; *pf; pf = &(*pf)->hnext) {
+        if (*pf == f) {
+            *pf = f->hnext;
+            f->hnext = NULL;
+            break;
+        }
+    }
+    pf = relay->faceid_index + ((uint32_t) f->faceid & (relay->face_index_size - 1));
+    for (; *pf; pf = &(*pf)->idnext) {
+        if (*pf == f) {
+            *pf = f->idnext;
+            f->idnext = NULL;
+            relay->facecnt--;
+            return;
+        }
+    }
+}
+
+struct ccnl_face_s*
+ccnl_face_index_lookup(struct ccnl_relay_s *relay, int ifndx, sockunion *su)
+{
+    struct ccnl_face_s *f;
+    uint32_t h;
+
+    if (!relay->face_index) {
+        return NULL;
+    }
+    if (!su) {
+        ifndx = -1;
+    }
+    h = ccnl_face_keyhash(ifndx, su);
+    for (f = relay->face_index[h & (relay->face_index_size - 1)]; f; f = f->hnext) {
+        if (f->addrhash != h || f->ifndx != ifndx) {
+            continue;
+        }
+        if (!su || !ccnl_addr_cmp(&f->peer, su)) {
+            return f;
+        }
+    }
+    return NULL;
+}
+
+struct ccnl_face_s*
+ccnl_face_lookup_id(struct ccnl_relay_s *relay, int faceid)
+{
+    struct ccnl_face_s *f;
+
+    if (!relay->faceid_index) {
+        return NULL;
+    }
+    f = relay->faceid_index[(uint32_t) faceid & (relay->face_index_size - 1)];
+    for (; f; f = f->idnext) {
+        if (f->faceid == faceid) {
+            return f;
+        }
+    }
+    return NULL;
+}
+
+void
+ccnl_face_index_free(struct ccnl_relay_s *relay)
+{
+    ccnl_free(relay->face_index);
+    ccnl_free(relay->faceid_index);
+    relay->face_index = NULL;
+    relay->faceid_index = NULL;
+    relay->face_index_size = 0;
+    relay->facecnt = 0;
+}
@@ -20,4 +20,266 @@
  * 2017-06-16 created
  */
 
+#ifndef CCNL_LINUXKERNEL
 #include "ccnl-forward.h"
+#include "ccnl-malloc.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
+#else
+#include "../include/ccnl-forward.h"
+#include "../include/ccnl-malloc.h"
+#include "../include/ccnl-prefix.h"
+#include "../include/ccnl-relay.h"
+#endif
+
+#define LOAD(p)         __atomic_load_n(&(p), __ATOMIC_ACQUIRE)
+#define PUBLISH(p, v)   __atomic_store_n(&(p), (v), __ATOMIC_RELEASE)
+
+static struct ccnl_fib_index_s*
+ccnl_fib_index_new(uint32_t size, int gen)
+{
+    struct ccnl_fib_index_s *idx;
+
+    idx = (struct ccnl_fib_index_s *) ccnl_calloc(1, sizeof(*idx) +
+                                                  size * sizeof(idx->buckets[0]));
+    if (idx) {
+        idx->size = size;
+        idx->gen = gen;
+    }
+    return idx;
+}
+
+// builds a larger index on the other link of the entries, readers walk the
+// old one until they load the new
+static int
+ccnl_fib_index_grow(struct ccnl_relay_s *relay)
+{
+    struct ccnl_fib_index_s *old = relay->fib_index, *idx;
+    struct ccnl_forward_s *fwd;
+    uint32_t size;
+    int gen;
+
+    if (!old) {
+        idx = ccnl_fib_index_new(CCNL_FIB_INDEX_MIN_SIZE, 0);
+        if (!idx) {
+            return -1;
+        }
+        PUBLISH(relay->fib_index, idx);
+        return 0;
+    }
+    // the other link is free once the index using it is gone
+    ccnl_fib_reclaim(relay);
+    if (relay->fib_retired_index) {
+        return -1;
+    }
+    size = old->size * 2;
+    gen = !old->gen;
+    idx = ccnl_fib_index_new(size, gen);
+    if (!idx) {
+        return -1;
+    }
+    idx->maxlen = old->maxlen;
+    for (fwd = relay->fib; fwd; fwd = fwd->next) {
+        struct ccnl_forward_s **bucket = idx->buckets + (fwd->namehash & (size - 1));
+
+        fwd->hnext[gen] = *bucket;
+        *bucket = fwd;
+    }
+    PUBLISH(relay->fib_index, idx);
+
+    old->retired = ccnl_rcu_retire(&relay->fib_rcu);
+    old->next = NULL;
+    relay->fib_retired_index = old;
+    ccnl_fib_reclaim(relay);
+
+    return 0;
+}
+
+int
+ccnl_fib_link(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd)
+{
+    struct ccnl_fib_index_s *idx;
+    struct ccnl_forward_s **bucket;
+
+    if (!relay->fib_index || relay->fibcnt >= relay->fib_index->size) {
+        // while readers may still walk the other link, or if memory is
+        // short, the old (smaller) index stays, which is still valid
+        if (ccnl_fib_index_grow(relay) && !relay->fib_index) {
+            return -1;
+        }
+    }
+    idx = relay->fib_index;
+    fwd->namehash = ccnl_prefix_hash(fwd->prefix, fwd->prefix->compcnt);
+    if (fwd->prefix->compcnt > idx->maxlen) {
+        PUBLISH(idx->maxlen, fwd->prefix->compcnt);
+    }
+
+    fwd->prev = NULL;
+    DBL_LINKED_LIST_ADD(relay->fib, fwd);
+    relay->fibcnt++;
+
+    // the entry is complete before readers can reach it
+    bucket = idx->buckets + (fwd->namehash & (idx->size - 1));
+    fwd->hnext[idx->gen] = *bucket;
+    PUBLISH(*bucket, fwd);
+
+    return 0;
+}
+
+void
+ccnl_fib_unlink(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd)
+{
+    struct ccnl_fib_index_s *idx = relay->fib_index;
+    struct ccnl_forward_s **pf;
+
+    DBL_LINKED_LIST_REMOVE(relay->fib, fwd);
+    fwd->next = fwd->prev = NULL;
+    relay->fibcnt--;
+
+    if (!idx) {
+        return;
+    }
+    pf = idx->buckets + (fwd->namehash & (idx->size - 1));
+    for (; *pf; pf = &(*pf)->hnext[idx->gen]) {
+        if (*pf == fwd) {
+            // readers on the entry still find the rest of the chain
+            PUBLISH(*pf, fwd->hnext[idx->gen]);
+            return;
+        }
+    }
+}
+
+void
+ccnl_fib_remove(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd)
+{
+    ccnl_fib_unlink(relay, fwd);
+    fwd->retired = ccnl_rcu_retire(&relay->fib_rcu);
+    // only this entry is checked, the retired list is left to the
+    // writer's next ccnl_fib_reclaim() instead of walked per removal
+    if (ccnl_rcu_done(&relay->fib_rcu, fwd->retired)) {
+        ccnl_prefix_free(fwd->prefix);
+        ccnl_free(fwd);
+        return;
+    }
+    fwd->next = relay->fib_retired;
+    relay->fib_retired = fwd;
+}
+
+void
+ccnl_fib_reclaim(struct ccnl_relay_s *relay)
+{
+    struct ccnl_forward_s **pf = &relay->fib_retired, *fwd;
+    struct ccnl_fib_index_s **pi = &relay->fib_retired_index, *idx;
+
+    while ((fwd = *pf)) {
+        if (ccnl_rcu_done(&relay->fib_rcu, fwd->retired)) {
+            *pf = fwd->next;
+            ccnl_prefix_free(fwd->prefix);
+            ccnl_free(fwd);
+        } else {
+            pf = &fwd->next;
+        }
+    }
+    while ((idx = *pi)) {
+        if (ccnl_rcu_done(&relay->fib_rcu, idx->retired)) {
+            *pi = idx->next;
+            ccnl_free(idx);
+        } else {
+            pi = &idx->next;
+        }
+    }
+}
+
+struct ccnl_forward_s*
+ccnl_fib_lookup(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx)
+{
+    struct ccnl_fib_index_s *idx = LOAD(relay->fib_index);
+    struct ccnl_forward_s *fwd;
+    uint64_t h;
+
+    if (!idx || !pfx) {
+        return NULL;
+    }
+    h = ccnl_prefix_hash(pfx, pfx->compcnt);
+    fwd = LOAD(idx->buckets[h & (idx->size - 1)]);
+    for (; fwd; fwd = LOAD(fwd->hnext[idx->gen])) {
+        if (fwd->namehash == h && fwd->suite == pfx->suite && fwd->prefix &&
+            !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) {
+            return fwd;
+        }
+    }
+    return NULL;
+}
+
+void
+ccnl_fib_match_init(struct ccnl_relay_s *relay, struct ccnl_fib_match_s *m,
+                    struct ccnl_prefix_s *name)
+{
+    struct ccnl_fib_index_s *idx = LOAD(relay->fib_index);
+    uint32_t len = name->compcnt;
+
+    // no FIB prefix is longer than maxlen, skip probing those lengths
+    if (idx && len > LOAD(idx->maxlen)) {
+        len = LOAD(idx->maxlen);
+    }
+    if (len > CCNL_MAX_NAME_COMP) {
+        len = CCNL_MAX_NAME_COMP;
+    }
+    m->name = name;
+    m->index = idx;
+    m->fwd = NULL;
+    m->len = idx ? (int32_t) len : -1;
+}
+
+struct ccnl_forward_s*
+ccnl_fib_match_next(struct ccnl_relay_s *relay, struct ccnl_fib_match_s *m)
+{
+    struct ccnl_fib_index_s *idx = m->index;
+    struct ccnl_forward_s *fwd;
+    uint64_t h;
+    (void) relay;
+
+    for (; m->len >= 0; m->len--, m->fwd = NULL) {
+        h = ccnl_prefix_hash(m->name, (uint32_t) m->len);
+        fwd = m->fwd ? LOAD(m->fwd->hnext[idx->gen])
+                     : LOAD(idx->buckets[h & (idx->size - 1)]);
+        for (; fwd; fwd = LOAD(fwd->hnext[idx->gen])) {
+            if (fwd->namehash == h && fwd->prefix &&
+                fwd->prefix->compcnt == (uint32_t) m->len &&
+                fwd->suite == m->name->suite &&
+                ccnl_prefix_cmp(fwd->prefix, NULL, m->name, CMP_LONGEST) == m->len) {
+                m->fwd = fwd;
+                return fwd;
+            }
+        }
+    }
+    return NULL;
+}
+
+struct ccnl_forward_s*
+ccnl_fib_lpm(struct ccnl_relay_s *relay, struct ccnl_prefix_s *name)
+{
+    struct ccnl_fib_match_s m;
+
+    ccnl_fib_match_init(relay, &m, name);
+    return ccnl_fib_match_next(relay, &m);
+}
+
+void
+ccnl_fib_index_free(struct ccnl_relay_s *relay)
+{
+    struct ccnl_fib_index_s *idx;
+    struct ccnl_forward_s *fwd;
+
+    while ((fwd = relay->fib_retired)) {
+        relay->fib_retired = fwd->next;
+        ccnl_prefix_free(fwd->prefix);
+        ccnl_free(fwd);
+    }
+    while ((idx = relay->fib_retired_index)) {
+        relay->fib_retired_index = idx->next;
+        ccnl_free(idx);
+    }
+    ccnl_free(relay->fib_index);
+    relay->fib_index = NULL;
+}
@@ -23,6 +23,9 @@
 #include "ccnl-frag.h"
 #include "ccnl-malloc.h"
 #include "ccnl-pkt.h"
+#include "ccnl-pkt-util.h"
+#include "ccnl-pkt-ccntlv.h"
+#include "ccnl-os-time.h"
 #include "ccnl-logging.h"
 
 #ifdef USE_FRAG
@@ -97,13 +100,13 @@ void
 ccnl_frag_reset(struct ccnl_frag_s *e, struct ccnl_buf_s *buf,
                   int ifndx, sockunion *dst)
 {
-    DEBUGMSG_EFRA(VERBOSE, "ccnl_frag_reset if=%d (%zd bytes) dst=%s\n", ifndx,
-             buf ? buf->datalen : -1, ccnl_addr2ascii(dst));
+    DEBUGMSG_EFRA(VERBOSE, "ccnl_frag_reset if=%d (%d bytes) dst=%s\n", ifndx,
+             buf ? (int) buf->datalen : -1, ccnl_addr2ascii(dst));
     if (!e)
         return;
     e->ifndx = ifndx;
     memcpy(&e->dest, dst, sizeof(*dst));
-    ccnl_free(e->bigpkt);
+    ccnl_buf_free(e->bigpkt);
     e->bigpkt = buf;
     if (buf)
         e->outsuite = ccnl_pkt2suite(buf->data, buf->datalen, 0);
@@ -232,13 +235,13 @@ ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
     if (datalen >= e->bigpkt->datalen) { // fits in a single fragment
         buf->data[flagoffs + e->flagwidth - 1] =
             CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     } else if (e->sendoffs == 0) // this is the start fragment
         buf->data[flagoffs + e->flagwidth - 1] = CCNL_DTAG_FRAG_FLAG_FIRST;
     else if(datalen >= (e->bigpkt->datalen - e->sendoffs)) { // the end
         buf->data[flagoffs + e->flagwidth - 1] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     } else // in the middle
         buf->data[flagoffs + e->flagwidth - 1] = 0x00;
@@ -301,13 +304,13 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     // patch flag field:
     if (datalen >= fr->bigpkt->datalen) { // single
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_SINGLE;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     } else if (fr->sendoffs == 0) // start
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_FIRST;
     else if(datalen >= (fr->bigpkt->datalen - fr->sendoffs)) { // end
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     } else
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_MID;
@@ -352,7 +355,7 @@ ccnl_frag_getnextSEQD2015(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
 
         fr->sendoffs += datalen;
         if (fr->sendoffs >= fr->bigpkt->datalen) {
-            ccnl_free(fr->bigpkt);
+            ccnl_buf_free(fr->bigpkt);
             fr->bigpkt = NULL;
         }
 
@@ -371,6 +374,25 @@ ccnl_frag_getnextSEQD2015(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
 }
 #endif // OBSOLETE
 
+// moves on past the datalen bytes the fragment just cut carries
+static void
+ccnl_frag_advance(struct ccnl_frag_s *fr, size_t datalen,
+                  int *ifndx, sockunion *su)
+{
+    fr->sendseq++;
+
+    fr->sendoffs += datalen;
+    if (fr->sendoffs >= (unsigned) fr->bigpkt->datalen) {
+        ccnl_buf_free(fr->bigpkt);
+        fr->bigpkt = NULL;
+    }
+
+    if (ifndx)
+        *ifndx = fr->ifndx;
+    if (su)
+        memcpy(su, &fr->dest, sizeof(*su));
+}
+
 struct ccnl_buf_s*
 ccnl_frag_getnextBE2015(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
 {
@@ -396,19 +418,7 @@ ccnl_frag_getnextBE2015(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     }
 
     if (buf) {
-        fr->sendseq++;
-
-        fr->sendoffs += datalen;
-        if (fr->sendoffs >= (unsigned) fr->bigpkt->datalen) {
-            ccnl_free(fr->bigpkt);
-            fr->bigpkt = NULL;
-        }
-
-        if (ifndx)
-            *ifndx = fr->ifndx;
-        if (su)
-            memcpy(su, &fr->dest, sizeof(*su));
-
+        ccnl_frag_advance(fr, datalen, ifndx, su);
         DEBUGMSG_EFRA(VERBOSE, "  produced %zd bytes fragment, seqnr=%d-1\n",
                  buf->datalen, fr->sendseq);
     } else
@@ -418,6 +428,50 @@ ccnl_frag_getnextBE2015(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     return buf;
 }
 
+struct ccnl_buf_s*
+ccnl_frag_getnextslice(struct ccnl_frag_s *fr, uint8_t *hdr, size_t *hdrlen,
+                       int *ifndx, sockunion *su)
+{
+    struct ccnl_buf_s *slice;
+    size_t datalen = 0;
+    int8_t rc = -1;
+
+    if (!fr->bigpkt || fr->protocol != CCNL_FRAG_BEGINEND2015) {
+        return NULL;
+    }
+
+    switch(fr->outsuite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        rc = ccnl_ccntlv_mkFragHdr(fr, hdr, hdrlen, &datalen);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        rc = ccnl_ndntlv_mkFragHdr(fr, hdr, hdrlen, &datalen);
+        break;
+#endif
+    default:
+        break;
+    }
+    if (rc) {
+        DEBUGMSG_EFRA(VERBOSE, "  produced NO fragment, seqnr remains at =%d-1\n",
+                      fr->sendseq);
+        return NULL;
+    }
+
+    // the fragment goes out from the bytes of the packet itself
+    slice = ccnl_buf_slice(fr->bigpkt, fr->bigpkt->data + fr->sendoffs, datalen);
+    if (!slice) {
+        return NULL;
+    }
+    ccnl_frag_advance(fr, datalen, ifndx, su);
+    DEBUGMSG_EFRA(VERBOSE, "  produced %zu+%zu bytes fragment, seqnr=%d-1\n",
+                  *hdrlen, datalen, fr->sendseq);
+
+    return slice;
+}
+
 struct ccnl_buf_s*
 ccnl_frag_getnext(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
 {
@@ -457,8 +511,18 @@ void
 ccnl_frag_destroy(struct ccnl_frag_s *e)
 {
     if (e) {
-        ccnl_free(e->bigpkt);
+        struct ccnl_frag_early_s *x;
+        int i;
+
+        ccnl_buf_free(e->bigpkt);
         ccnl_free(e->defrag);
+        for (i = 0; i < CCNL_FRAG_REASM_SLOTS; i++) {
+            ccnl_free(e->reasm[i].data);
+        }
+        while ((x = e->early)) {
+            e->early = x->next;
+            ccnl_free(x);
+        }
         ccnl_free(e);
     }
 }
@@ -563,7 +627,7 @@ ccnl_frag_RX_serialfragment(RX_datagram callback,
         DEBUGMSG_EFRA(VERBOSE, "  >> reassembled fragment is %d bytes\n", buf->datalen);
         // FIXME: loop over multiple packets in this reassembled frame?
         callback(relay, from, &frag, &fraglen);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
     }
 }
 
@@ -753,16 +817,326 @@ ccnl_frag_RX_Sequenced2015(RX_datagram callback, struct ccnl_relay_s *relay,
 }
 #endif // OBSOLETE
 
+// ----------------------------------------------------------------------
+// BeginEnd2015 reassembly
+
+#define SEQDIST(to, from)       (((to) - (from)) & CCNL_BEFRAG_SEQ_MASK)
+// how far from lies behind to, 0 for a seqno in the upper half, i.e. ahead
+#define SEQBEHIND(to, from)     (SEQDIST(to, from) > CCNL_BEFRAG_SEQ_MASK / 2 ? \
+                                 0 : SEQDIST(to, from))
+#define REASM_INITIAL_FRAGS     4 // room of a packet whose length is unknown
+
+// length of the packet beginning in the first fragment, 0 if unknown
+static uint32_t
+ccnl_frag_pktlen(unsigned char *data, uint32_t len)
+{
+    size_t skip = 0;
+
+    switch (ccnl_pkt2suite(data, len, &skip)) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV: {
+        struct ccnx_tlvhdr_ccnx2015_s *hp;
+
+        if (len - skip < sizeof(*hp)) {
+            break;
+        }
+        hp = (struct ccnx_tlvhdr_ccnx2015_s *) (data + skip);
+        return (uint32_t) skip + ntohs(hp->pktlen);
+    }
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV: {
+        uint8_t *cp = data + skip;
+        size_t cplen = len - skip;
+        uint64_t typ, vallen;
+
+        // only the header is in this fragment, ccnl_ndntlv_dehead would
+        // refuse the length
+        if (ccnl_ndntlv_varlenint(&cp, &cplen, &typ) ||
+            ccnl_ndntlv_varlenint(&cp, &cplen, &vallen) ||
+            vallen > UINT32_MAX - CCNL_MAX_PACKET_SIZE) {
+            break;
+        }
+        return (uint32_t) (cp - data) + (uint32_t) vallen;
+    }
+#endif
+    default:
+        break;
+    }
+    return 0;
+}
+
+static void
+ccnl_frag_reasm_drop(struct ccnl_frag_s *e, struct ccnl_frag_reasm_s *r)
+{
+    DEBUGMSG_EFRA(DEBUG, "  >> dropped partial packet seqno=%u\n", r->first);
+    ccnl_free(r->data);
+    r->data = NULL;
+    e->dropcnt++;
+}
+
+// keeps a copy of a fragment until the first fragment of its packet arrives
+static void
+ccnl_frag_early_add(struct ccnl_frag_s *e, uint32_t seqno, unsigned int bits,
+                    unsigned char *data, uint32_t len, uint32_t arrived)
+{
+    struct ccnl_frag_early_s *x, **pp;
+
+    if (e->earlycnt >= CCNL_FRAG_MAX_EARLY) {
+        // the one at the end was added first
+        for (pp = &e->early; (*pp)->next; pp = &(*pp)->next);
+        ccnl_free(*pp);
+        *pp = NULL;
+        e->earlycnt--;
+        e->dropcnt++;
+    }
+    x = (struct ccnl_frag_early_s *) ccnl_malloc(sizeof(*x) + len);
+    if (!x) {
+        return;
+    }
+    x->seqno = seqno;
+    x->bits = bits;
+    x->arrived = arrived;
+    x->len = len;
+    memcpy(x->data, data, len);
+    x->next = e->early;
+    e->early = x;
+    e->earlycnt++;
+}
+
+static void
+ccnl_frag_expire(struct ccnl_frag_s *e, uint32_t now)
+{
+    struct ccnl_frag_early_s **pp = &e->early, *x;
+    int i;
+
+    for (i = 0; i < CCNL_FRAG_REASM_SLOTS; i++) {
+        if (e->reasm[i].data && now - e->reasm[i].started > CCNL_FRAG_TIMEOUT) {
+            ccnl_frag_reasm_drop(e, e->reasm + i);
+        }
+    }
+    while ((x = *pp)) {
+        if (now - x->arrived > CCNL_FRAG_TIMEOUT) {
+            *pp = x->next;
+            ccnl_free(x);
+            e->earlycnt--;
+            e->dropcnt++;
+        } else {
+            pp = &x->next;
+        }
+    }
+}
+
+// the fragments from idx on were taken for a packet which ends before them
+static void
+ccnl_frag_reasm_split(struct ccnl_frag_s *e, struct ccnl_frag_reasm_s *r,
+                      uint32_t idx)
+{
+    uint32_t k;
+
+    if (idx >= CCNL_FRAG_MAX_FRAGS) {
+        return;
+    }
+    for (k = idx; k < r->cap && (r->have >> k); k++) {
+        if (r->have & (1ULL << k)) {
+            int islast = r->last == (int32_t) k;
+
+            ccnl_frag_early_add(e, (r->first + k) & CCNL_BEFRAG_SEQ_MASK,
+                                islast ? CCNL_BEFRAG_FLAG_LAST : CCNL_BEFRAG_FLAG_MID,
+                                r->data + k * r->stride,
+                                islast ? r->lastlen : r->stride, r->started);
+        }
+    }
+    r->have &= (1ULL << idx) - 1;
+    if (r->last >= (int32_t) idx) {
+        r->last = -1;
+    }
+}
+
+// copies fragment idx of the packet into place, returns -1 if it cannot
+// be part of the packet
+static int
+ccnl_frag_reasm_put(struct ccnl_frag_s *e, struct ccnl_frag_reasm_s *r,
+                    uint32_t idx, unsigned int bits, unsigned char *data,
+                    uint32_t len)
+{
+    if (bits == CCNL_BEFRAG_FLAG_LAST) {
+        if (r->last >= 0 && (uint32_t) r->last < idx) {
+            return -1;
+        }
+        if (r->sized) {
+            if ((uint32_t) r->last != idx || len != r->lastlen) {
+                return -1;
+            }
+        } else if (len > r->stride) {
+            return -1;
+        } else if (r->last != (int32_t) idx) {
+            // what was taken for this packet beyond its end is the next one's
+            ccnl_frag_reasm_split(e, r, idx + 1);
+            r->last = (int32_t) idx;
+            r->lastlen = len;
+        }
+    } else if (len != r->stride || (r->last >= 0 && (uint32_t) r->last <= idx)) {
+        return -1;
+    }
+    if (r->have & (1ULL << idx)) {
+        return 0; // a duplicate
+    }
+    if (idx >= r->cap) {
+        uint32_t cap = r->cap;
+        unsigned char *data2;
+
+        while (cap <= idx) {
+            cap *= 2;
+        }
+        if (cap > CCNL_FRAG_MAX_FRAGS) {
+            cap = CCNL_FRAG_MAX_FRAGS;
+        }
+        data2 = (unsigned char *) ccnl_realloc(r->data, cap * r->stride);
+        if (!data2) {
+            ccnl_frag_reasm_drop(e, r);
+            return 0;
+        }
+        r->data = data2;
+        r->cap = cap;
+    }
+    memcpy(r->data + idx * r->stride, data, len);
+    r->have |= 1ULL << idx;
+    return 0;
+}
+
+static int
+ccnl_frag_reasm_complete(struct ccnl_frag_reasm_s *r)
+{
+    if (!r->data || r->last < 0) {
+        return 0;
+    }
+    if (r->last == 63) {
+        return r->have == ~0ULL;
+    }
+    return r->have == (1ULL << (r->last + 1)) - 1;
+}
+
+// starts a packet with its first fragment, NULL if there is none to start
+static struct ccnl_frag_reasm_s*
+ccnl_frag_reasm_start(struct ccnl_frag_s *e, uint32_t seqno,
+                      unsigned char *data, uint32_t len, uint32_t now)
+{
+    struct ccnl_frag_reasm_s *r = NULL;
+    struct ccnl_frag_early_s *list, *x, *keep = NULL, **pp;
+    uint32_t total, n;
+    int i;
+
+    if (!len) {
+        return NULL;
+    }
+    for (i = 0; i < CCNL_FRAG_REASM_SLOTS; i++) {
+        struct ccnl_frag_reasm_s *o = e->reasm + i;
+        uint32_t d;
+
+        if (!o->data) {
+            continue;
+        }
+        d = SEQDIST(seqno, o->first);
+        if (!d) {
+            return NULL; // a duplicate
+        }
+        // a packet cannot hold the start of another one
+        if (d < CCNL_FRAG_MAX_FRAGS && (o->last < 0 || d <= (uint32_t) o->last)) {
+            if (o->sized) {
+                ccnl_frag_reasm_drop(e, o);
+            } else {
+                ccnl_frag_reasm_split(e, o, d);
+            }
+        }
+    }
+    for (i = 0; i < CCNL_FRAG_REASM_SLOTS; i++) {
+        struct ccnl_frag_reasm_s *o = e->reasm + i;
+
+        if (!o->data) {
+            r = o;
+            break;
+        }
+        // within the same second, the one furthest behind in the sequence
+        if (!r || now - o->started > now - r->started ||
+            (o->started == r->started &&
+             SEQBEHIND(seqno, o->first) > SEQBEHIND(seqno, r->first))) {
+            r = o;
+        }
+    }
+    if (r->data) {
+        // all slots are taken, the oldest packet gives way
+        ccnl_frag_reasm_drop(e, r);
+    }
+
+    memset(r, 0, sizeof(*r));
+    r->first = seqno;
+    r->stride = len;
+    r->started = now;
+    r->last = -1;
+    total = ccnl_frag_pktlen(data, len);
+    if (total > len) {
+        n = (total + len - 1) / len;
+        if (n > CCNL_FRAG_MAX_FRAGS) {
+            DEBUGMSG_EFRA(WARNING, "  >> packet of %u bytes has too many fragments\n",
+                          total);
+            e->dropcnt++;
+            return NULL;
+        }
+        r->sized = 1;
+        r->cap = n;
+        r->last = (int32_t) n - 1;
+        r->lastlen = total - (n - 1) * len;
+        r->data = (unsigned char *) ccnl_malloc(total);
+    } else {
+        r->cap = REASM_INITIAL_FRAGS < CCNL_FRAG_MAX_FRAGS ?
+                 REASM_INITIAL_FRAGS : CCNL_FRAG_MAX_FRAGS;
+        r->data = (unsigned char *) ccnl_malloc(r->cap * len);
+    }
+    if (!r->data) {
+        return NULL;
+    }
+    memcpy(r->data, data, len);
+    r->have = 1;
+
+    // fragments which overtook this one
+    list = e->early;
+    e->early = NULL;
+    e->earlycnt = 0;
+    while ((x = list)) {
+        uint32_t d = SEQDIST(x->seqno, seqno);
+
+        list = x->next;
+        if (r->data && d && d < CCNL_FRAG_MAX_FRAGS &&
+            !ccnl_frag_reasm_put(e, r, d, x->bits, x->data, x->len)) {
+            ccnl_free(x);
+            continue;
+        }
+        x->next = keep;
+        keep = x;
+    }
+    // back in their order, behind what was split off meanwhile
+    for (pp = &e->early; *pp; pp = &(*pp)->next);
+    while ((x = keep)) {
+        keep = x->next;
+        x->next = *pp;
+        *pp = x;
+        e->earlycnt++;
+    }
+    return r->data ? r : NULL;
+}
+
 int
 ccnl_frag_RX_BeginEnd2015(RX_datagram callback, struct ccnl_relay_s *relay,
                           struct ccnl_face_s *from, int mtu,
                           unsigned int bits, unsigned int seqno,
-                          unsigned char **data, int *datalen)
+                          uint8_t **data, size_t *datalen)
 {
-    struct ccnl_buf_s *buf = NULL;
+    struct ccnl_frag_reasm_s *r = NULL;
     struct ccnl_frag_s *e;
+    uint32_t now, len;
 
-    DEBUGMSG_EFRA(DEBUG, "ccnl_frag_RX_BeginEnd2015 (%d bytes), seqno=%d\n",
+    DEBUGMSG_EFRA(DEBUG, "ccnl_frag_RX_BeginEnd2015 (%zu bytes), seqno=%u\n",
                   *datalen, seqno);
 
     if (!from) {
@@ -779,82 +1153,62 @@ ccnl_frag_RX_BeginEnd2015(RX_datagram callback, struct ccnl_relay_s *relay,
         DEBUGMSG_EFRA(WARNING, "WRONG FRAG PROTOCOL\n");
         return 0;
     }
+    if (*datalen > CCNL_MAX_PACKET_SIZE) {
+        return 0;
+    }
 
     e = from->frag;
-    if (e->recvseq != seqno) {
-        // should increase error counter here
-        DEBUGMSG_EFRA(WARNING, "  >> seqnum mismatch: rcvd %d, expected %d\n",
-                      seqno, e->recvseq);
-        if (e->defrag) {
-            DEBUGMSG_EFRA(WARNING, "  >> had to drop defrag buf\n");
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
-        }
-        e->recvseq = seqno;
-    }
+    seqno &= CCNL_BEFRAG_SEQ_MASK;
+    bits &= CCNL_BEFRAG_FLAG_MASK;
+    len = (uint32_t) *datalen;
+    e->recvseq = (seqno + 1) & CCNL_BEFRAG_SEQ_MASK;
 
-    switch(bits & (CCNL_BEFRAG_FLAG_MASK)) {
-    case CCNL_BEFRAG_FLAG_SINGLE: // single packet
-        DEBUGMSG_EFRA(VERBOSE, "  >> single fragment seqno=%d (%d bytes)\n",
+    if (bits == CCNL_BEFRAG_FLAG_SINGLE) {
+        DEBUGMSG_EFRA(VERBOSE, "  >> single fragment seqno=%u (%zu bytes)\n",
                       seqno, *datalen);
-        if (e->defrag) {
-            DEBUGMSG_EFRA(WARNING, "    had to drop defrag buf\n");
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
-        }
-        e->recvseq++;
         // no need to copy the buffer:
         callback(relay, from, data, datalen);
         return 1;
-    case CCNL_BEFRAG_FLAG_FIRST: // start of fragment sequence
+    }
+
+    now = (uint32_t) CCNL_NOW();
+    ccnl_frag_expire(e, now);
+
+    if (bits == CCNL_BEFRAG_FLAG_FIRST) {
         DEBUGMSG_EFRA(VERBOSE, "  >> start of fragment series\n");
-        if (e->defrag) {
-            DEBUGMSG_EFRA(WARNING, "    had to drop defrag buf\n");
-            ccnl_free(e->defrag);
-        }
-        e->defrag = ccnl_buf_new(*data, *datalen);
-        break;
-    case CCNL_BEFRAG_FLAG_LAST: // end of fragment sequence
-        DEBUGMSG_EFRA(VERBOSE, "  >> last fragment of a series\n");
-        if (!e->defrag) {
-            DEBUGMSG_EFRA(WARNING, "  >> no e->defrag?\n");
-            break;
+        r = ccnl_frag_reasm_start(e, seqno, *data, len, now);
+    } else {
+        uint32_t d, bestd = CCNL_FRAG_MAX_FRAGS;
+        int i;
+
+        DEBUGMSG_EFRA(VERBOSE, "  >> %s fragment of a series\n",
+                      bits == CCNL_BEFRAG_FLAG_LAST ? "last" : "middle");
+        // the packet started by the nearest first fragment before this one
+        for (i = 0; i < CCNL_FRAG_REASM_SLOTS; i++) {
+            if (!e->reasm[i].data) {
+                continue;
+            }
+            d = SEQDIST(seqno, e->reasm[i].first);
+            if (d && d < bestd) {
+                r = e->reasm + i;
+                bestd = d;
+            }
         }
-        buf = ccnl_buf_new(NULL, e->defrag->datalen + *datalen);
-        if (buf) {
-            memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-            memcpy(buf->data + e->defrag->datalen, *data, *datalen);
+        if (!r || ccnl_frag_reasm_put(e, r, bestd, bits, *data, len)) {
+            ccnl_frag_early_add(e, seqno, bits, *data, len, now);
+            r = NULL;
         }
-        ccnl_free(e->defrag);
-        e->defrag = NULL;
-        break;
-    case CCNL_BEFRAG_FLAG_MID:  // fragment in the middle of a squence
-    default:
-        DEBUGMSG_EFRA(VERBOSE, "  >> fragment in the middle of a series\n");
-        if (!e->defrag)
-            break;
-        buf = ccnl_buf_new(NULL, e->defrag->datalen + *datalen);
-        if (buf) {
-            memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-            memcpy(buf->data + e->defrag->datalen, *data, *datalen);
-            ccnl_free(e->defrag);
-            e->defrag = buf;
-            buf = NULL;
-        } else {
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
-        }
-        break;
     }
     *data += *datalen;
     *datalen = 0;
-    e->recvseq++;
 
-    if (buf) {
-        unsigned char *frag = buf->data;
-        int fraglen = buf->datalen;
-        DEBUGMSG_EFRA(DEBUG, "  >> reassembled fragment is %zd bytes\n",
-                      buf->datalen);
+    if (r && ccnl_frag_reasm_complete(r)) {
+        uint8_t *buf = r->data, *frag = buf;
+        size_t fraglen = (size_t) r->last * r->stride + r->lastlen;
+
+        r->data = NULL;
+        e->reasmcnt++;
+        DEBUGMSG_EFRA(DEBUG, "  >> reassembled fragment is %zu bytes\n", fraglen);
         // FIXME: loop over multiple packets in this reassembled frame?
         callback(relay, from, &frag, &fraglen);
         ccnl_free(buf);
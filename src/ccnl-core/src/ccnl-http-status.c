@@ -27,6 +27,8 @@ void null_func(void);
 
 #include "ccnl-http-status.h"
 #include "ccnl-os-time.h"
+#include "ccnl-pool.h"
+#include "ccnl-arena.h"
 
 // ----------------------------------------------------------------------
 
@@ -111,8 +113,19 @@ ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
 {
     if (!http)
         return -1;
+    return ccnl_http_handle(ccnl, http, FD_ISSET(http->server, readfs),
+                            http->client && FD_ISSET(http->client, readfs),
+                            http->client && FD_ISSET(http->client, writefs));
+}
+
+int
+ccnl_http_handle(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
+                 int server_readable, int client_readable, int client_writable)
+{
+    int client = http->client;
+
     // accept only one client at the time:
-    if (!http->client && FD_ISSET(http->server, readfs)) {
+    if (!http->client && server_readable) {
         struct sockaddr_in peer;
         socklen_t len = sizeof(peer);
         http->client = accept(http->server, (struct sockaddr*) &peer, &len);
@@ -124,7 +137,7 @@ ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
             http->inlen = http->outlen = http->inoffs = http->outoffs = 0;
         }
     }
-    if (http->client && FD_ISSET(http->client, readfs)) {
+    if (client && http->client == client && client_readable) {
         int len = sizeof(http->in) - http->inlen - 1;
         len = recv(http->client, http->in + http->inlen, len, 0);
         if (len == 0) {
@@ -136,7 +149,7 @@ ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
             ccnl_http_status(ccnl, http);
         }
     }
-    if (http->client && FD_ISSET(http->client, writefs) && http->out) {
+    if (client && http->client == client && client_writable && http->out) {
         int len = send(http->client, http->out + http->outoffs,
                        http->outlen, 0);
         if (len > 0) {
@@ -178,7 +191,7 @@ ccnl_cmpfib(const void *a, const void *b)
         if (len > p2->complen[i]) {
             len = p2->complen[i];
         }
-        r = memcmp(p1->comp[i], p2->comp[i], len);
+        r = memcmp(ccnl_prefix_comp(p1, i), ccnl_prefix_comp(p2, i), len);
         if (r) {
             return r;
         }
@@ -201,13 +214,12 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
         "Content-Type: text/html; charset=utf-8\n\r"
         "Connection: close\n\r\n\r", *cp;
     size_t len = strlen(hdr);
-    int i, j, cnt;
+    int i, cnt;
     time_t t;
     //struct utsname uts;
     struct ccnl_face_s *f;
     struct ccnl_forward_s *fwd;
     struct ccnl_interest_s *ipt;
-    struct ccnl_buf_s *bpt;
     char s[CCNL_MAX_PREFIX_SIZE];
 
     strcpy(txt, hdr);
@@ -279,8 +291,11 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
             else
                 len += snprintf(txt+len, sizeof(txt) - len, "%.1fsec",
                         fa[i]->last_used + CCNL_FACE_TIMEOUT - CCNL_NOW());
-            for (j = 0, bpt = fa[i]->outq; bpt; bpt = bpt->next, j++);
-            len += snprintf(txt+len, sizeof(txt) - len, " &nbsp;qlen=%d\n", j);
+            len += snprintf(txt+len, sizeof(txt) - len,
+                            " &nbsp;qlen=%zu/%zu drops=%lu dups=%lu\n",
+                            fa[i]->outqlen, ccnl_face_qmax(fa[i]),
+                            (unsigned long) fa[i]->outq_drops,
+                            (unsigned long) fa[i]->outq_dups);
         }
         ccnl_free(fa);
     }
@@ -292,33 +307,75 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
 #ifdef USE_STATS
         len += snprintf(txt+len, sizeof(txt) - len, "<li><strong>i%d</strong>&nbsp;&nbsp;"
                        "addr=<font face=courier>%s</font>&nbsp;&nbsp;"
-                       "qlen=%zu/%d"
-                       "&nbsp;&nbsp;rx=%u&nbsp;&nbsp;tx=%u"
+                       "qlen=%zu/%zu"
+                       "&nbsp;&nbsp;rx=%u&nbsp;&nbsp;tx=%u&nbsp;&nbsp;dropped=%u"
                        "\n",
                        i, ccnl_addr2ascii(&ccnl->ifs[i].addr),
-                       ccnl->ifs[i].qlen, CCNL_MAX_IF_QLEN,
-                       ccnl->ifs[i].rx_cnt, ccnl->ifs[i].tx_cnt);
+                       ccnl->ifs[i].qlen, ccnl_interface_qmax(ccnl->ifs + i),
+                       ccnl->ifs[i].rx_cnt, ccnl->ifs[i].tx_cnt,
+                       ccnl->ifs[i].tx_drops);
 #else
         len += snprintf(txt+len, sizeof(txt) - len, "<li><strong>i%d</strong>&nbsp;&nbsp;"
                        "addr=<font face=courier>%s</font>&nbsp;&nbsp;"
-                       "qlen=%d/%d"
+                       "qlen=%zu/%zu"
                        "\n",
                        i, ccnl_addr2ascii(&ccnl->ifs[i].addr),
-                       ccnl->ifs[i].qlen, CCNL_MAX_IF_QLEN);
+                       ccnl->ifs[i].qlen, ccnl_interface_qmax(ccnl->ifs + i));
 #endif
     }
     len += snprintf(txt+len, sizeof(txt) - len, "</ul>\n");
 
     len += snprintf(txt+len, sizeof(txt) - len, "\n<p><table borders=0 width=100%% bgcolor=#e0e0ff>"
                    "<tr><td><em>Misc stats</em></table><ul>\n");
-    for (cnt = 0, bpt = ccnl->nonces; bpt; bpt = bpt->next, cnt++);
-    len += snprintf(txt+len, sizeof(txt) - len, "<li>Nonces: %d\n", cnt);
+    cnt = 0;
+#if CCNL_MAX_NONCES > 0
+    for (i = 0; i < CCNL_NONCE_TABLE_SIZE; i++) {
+        if (ccnl->nonces[i].expires > (uint32_t) CCNL_NOW()) {
+            cnt++;
+        }
+    }
+#endif
+    len += snprintf(txt+len, sizeof(txt) - len, "<li>Nonces: %d (duplicates=%lu, evicted=%lu)\n",
+                   cnt, (unsigned long) ccnl->nonce_hits, (unsigned long) ccnl->nonce_evictions);
+    len += snprintf(txt+len, sizeof(txt) - len, "<li>Data by faces served:");
+    for (i = 0; i < CCNL_SERVE_FANOUT_BUCKETS; i++) {
+        int lo = i < 2 ? i : (1 << (i - 2)) + 1, hi = i < 2 ? i : 1 << (i - 1);
+
+        if (i == CCNL_SERVE_FANOUT_BUCKETS - 1) {
+            len += snprintf(txt+len, sizeof(txt) - len, "&nbsp;&nbsp;%d+:%lu\n",
+                           lo, (unsigned long) ccnl->serve_fanout[i]);
+        } else if (lo == hi) {
+            len += snprintf(txt+len, sizeof(txt) - len, "&nbsp;&nbsp;%d:%lu",
+                           lo, (unsigned long) ccnl->serve_fanout[i]);
+        } else {
+            len += snprintf(txt+len, sizeof(txt) - len, "&nbsp;&nbsp;%d-%d:%lu",
+                           lo, hi, (unsigned long) ccnl->serve_fanout[i]);
+        }
+    }
     for (cnt = 0, ipt = ccnl->pit; ipt; ipt = ipt->next, cnt++);
     len += snprintf(txt+len, sizeof(txt) - len, "<li>Pending interests: %d\n", cnt);
     len += snprintf(txt+len, sizeof(txt) - len, "<li>Content chunks: %d (max=%d)\n",
                    ccnl->contentcnt, ccnl->max_cache_entries);
     len += snprintf(txt+len, sizeof(txt) - len, "</ul>\n");
 
+    len += snprintf(txt+len, sizeof(txt) - len, "\n<p><table borders=0 width=100%% bgcolor=#e0e0ff>"
+                   "<tr><td><em>Memory pools</em></table><ul>\n");
+    for (i = 0; i < CCNL_POOL_COUNT; i++) {
+        len += snprintf(txt+len, sizeof(txt) - len,
+                       "<li>%s: %u/%u in use (peak=%u, %zu bytes each)"
+                       "&nbsp;&nbsp;pooled=%u&nbsp;&nbsp;heap=%u\n",
+                       ccnl_pools[i].name, ccnl_pools[i].inuse,
+                       ccnl_pools[i].capacity, ccnl_pools[i].peak,
+                       ccnl_pools[i].objsize, ccnl_pools[i].allocs,
+                       ccnl_pools[i].fallbacks);
+    }
+    len += snprintf(txt+len, sizeof(txt) - len,
+                   "<li>packet arena: %zu bytes (peak=%zu)"
+                   "&nbsp;&nbsp;overflows=%u&nbsp;&nbsp;persisted=%u\n",
+                   ccnl_pkt_arena.size, ccnl_pkt_arena.peak,
+                   ccnl_pkt_arena.overflows, ccnl_pkt_arena.promotions);
+    len += snprintf(txt+len, sizeof(txt) - len, "</ul>\n");
+
     len += snprintf(txt+len, sizeof(txt) - len, "\n<p><table borders=0 width=100%% bgcolor=#e0e0ff>"
                    "<tr><td><em>Config</em></table><table borders=0>\n");
     len += snprintf(txt+len, sizeof(txt) - len, "<tr><td>content.timeout:"
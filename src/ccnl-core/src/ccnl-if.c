@@ -23,6 +23,7 @@
 
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-if.h"
+#include "ccnl-buf.h"
 #include "ccnl-os-time.h"
 #include "ccnl-malloc.h"
 #include "ccnl-logging.h"
@@ -35,6 +36,7 @@
 #include <unistd.h>
 #else
 #include "../include/ccnl-if.h"
+#include "../include/ccnl-buf.h"
 #include "../include/ccnl-os-time.h"
 #include "../include/ccnl-malloc.h"
 #include "../include/ccnl-logging.h"
@@ -49,13 +51,38 @@ ccnl_interface_cleanup(struct ccnl_if_s *i)
     ccnl_sched_destroy(i->sched);
     for (j = 0; j < i->qlen; j++) {
         struct ccnl_txrequest_s *r = i->queue + (i->qfront+j)%CCNL_MAX_IF_QLEN;
-        ccnl_free(r->buf);
+        ccnl_buf_free(r->buf);
     }
 #if !defined(CCNL_RIOT) && !defined(CCNL_ANDROID) && !defined(CCNL_LINUXKERNEL)
     ccnl_close_socket(i->sock);
 #endif
 }
 
+size_t
+ccnl_interface_qmax(struct ccnl_if_s *i)
+{
+    if (!i->qmax || i->qmax > CCNL_MAX_IF_QLEN) {
+        return CCNL_MAX_IF_QLEN;
+    }
+    return i->qmax;
+}
+
+struct ccnl_buf_s*
+ccnl_txrequest_flatten(struct ccnl_txrequest_s *r)
+{
+    struct ccnl_buf_s *b;
+
+    if (!r->hdrlen) {
+        return ccnl_buf_share(r->buf);
+    }
+    b = ccnl_buf_new(NULL, ccnl_txrequest_len(r));
+    if (b) {
+        memcpy(b->data, r->hdr, r->hdrlen);
+        memcpy(b->data + r->hdrlen, r->buf->data, r->buf->datalen);
+    }
+    return b;
+}
+
 #if !defined(CCNL_RIOT) && !defined(CCNL_ANDROID) && !defined(CCNL_LINUXKERNEL)
 int
 ccnl_close_socket(int s)
@@ -25,6 +25,7 @@
 #include "ccnl-interest.h"
 #include "ccnl-relay.h"
 #include "ccnl-malloc.h"
+#include "ccnl-pool.h"
 #include "ccnl-os-time.h"
 #include "ccnl-prefix.h"
 #include "ccnl-logging.h"
@@ -33,6 +34,7 @@
 #include "../include/ccnl-relay.h"
 #include "../include/ccnl-interest.h"
 #include "../include/ccnl-malloc.h"
+#include "../include/ccnl-pool.h"
 #include "../include/ccnl-os-time.h"
 #include "../include/ccnl-prefix.h"
 #include "../include/ccnl-logging.h"
@@ -50,7 +52,7 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
-    struct ccnl_interest_s *i = (struct ccnl_interest_s *) ccnl_calloc(1,
+    struct ccnl_interest_s *i = (struct ccnl_interest_s *) ccnl_pool_calloc(CCNL_POOL(INTEREST),
                                             sizeof(struct ccnl_interest_s));
     DEBUGMSG_CORE(TRACE,
                   "ccnl_new_interest(prefix=%s, suite=%s)\n",
@@ -59,6 +61,10 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
 
     if (!i)
         return NULL;
+    if (ccnl_pkt_persist(pkt)) {
+        ccnl_pool_free(CCNL_POOL(INTEREST), i);
+        return NULL;
+    }
     i->pkt = *pkt;
     /* currently, the aging function relies on seconds rather than on milli seconds */
     i->lifetime = ccnl_pkt_interest_lifetime(*pkt);
@@ -74,11 +80,20 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
      * value against the pitcnt value */
     if ((ccnl->max_pit_entries != -1) && (ccnl->pitcnt >= ccnl->max_pit_entries)) {
         ccnl_pkt_free(i->pkt);
-        ccnl_free(i);
+        ccnl_pool_free(CCNL_POOL(INTEREST), i);
+        return NULL;
+    }
+
+    if (ccnl_interest_index_add(ccnl, i)) {
+        DEBUGMSG_CORE(WARNING, "  no memory for the PIT index\n");
+        ccnl_pkt_free(i->pkt);
+        ccnl_pool_free(CCNL_POOL(INTEREST), i);
         return NULL;
     }
 
     DBL_LINKED_LIST_ADD(ccnl->pit, i);
+    // the first retransmission is due with the next ageing round
+    ccnl_wheel_add(&ccnl->pit_ageing, &i->ageing, i->last_used + 1);
 
     ccnl->pitcnt++;
 
@@ -90,6 +105,115 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
     return i;
 }
 
+static int
+ccnl_interest_index_grow(struct ccnl_relay_s *relay)
+{
+    struct ccnl_interest_s **buckets, *i, *next;
+    uint32_t size, k;
+
+    size = relay->pit_index_size ? relay->pit_index_size * 2 : CCNL_PIT_INDEX_MIN_SIZE;
+    buckets = (struct ccnl_interest_s **) ccnl_calloc(size, sizeof(*buckets));
+    if (!buckets) {
+        return -1;
+    }
+    for (k = 0; k < relay->pit_index_size; k++) {
+        for (i = relay->pit_index[k]; i; i = next) {
+            next = i->hnext;
+            i->hnext = buckets[i->namehash & (size - 1)];
+            buckets[i->namehash & (size - 1)] = i;
+        }
+    }
+    ccnl_free(relay->pit_index);
+    relay->pit_index = buckets;
+    relay->pit_index_size = size;
+
+    return 0;
+}
+
+static uint64_t
+ccnl_interest_keyhash(struct ccnl_prefix_s *pfx)
+{
+    uint32_t cnt = pfx->compcnt;
+
+    // the last component may be the implicit digest of the content
+    if (cnt > 0 && pfx->complen[cnt - 1] == 32) { // SHA256_DIGEST_LEN
+        cnt--;
+    }
+    return ccnl_prefix_hash(pfx, cnt);
+}
+
+int
+ccnl_interest_index_add(struct ccnl_relay_s *relay, struct ccnl_interest_s *i)
+{
+    struct ccnl_interest_s **bucket;
+
+    if (!relay->pit_index || relay->pitcnt >= (int) relay->pit_index_size) {
+        // a failed resize keeps the old (smaller) table, which is still valid
+        if (ccnl_interest_index_grow(relay) && !relay->pit_index) {
+            return -1;
+        }
+    }
+    i->namehash = i->pkt->pfx ? ccnl_interest_keyhash(i->pkt->pfx) : 0;
+    bucket = relay->pit_index + (i->namehash & (relay->pit_index_size - 1));
+    i->hnext = *bucket;
+    *bucket = i;
+
+    return 0;
+}
+
+void
+ccnl_interest_index_remove(struct ccnl_relay_s *relay, struct ccnl_interest_s *i)
+{
+    struct ccnl_interest_s **pi;
+
+    if (!relay->pit_index) {
+        return;
+    }
+    pi = relay->pit_index + (i->namehash & (relay->pit_index_size - 1));
+    for (; *pi; pi = &(*pi)->hnext) {
+        if (*pi == i) {
+            *pi = i->hnext;
+            i->hnext = NULL;
+            return;
+        }
+    }
+}
+
+struct ccnl_interest_s*
+ccnl_interest_index_lookup(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt)
+{
+    struct ccnl_interest_s *i;
+    uint64_t h;
+
+    if (!relay->pit_index || !pkt || !pkt->pfx) {
+        return NULL;
+    }
+    h = ccnl_interest_keyhash(pkt->pfx);
+    for (i = relay->pit_index[h & (relay->pit_index_size - 1)]; i; i = i->hnext) {
+        if (i->namehash == h && ccnl_interest_isSame(i, pkt) == 1) {
+            return i;
+        }
+    }
+    return NULL;
+}
+
+struct ccnl_interest_s*
+ccnl_interest_index_bucket(struct ccnl_relay_s *relay, uint64_t hash)
+{
+    if (!relay->pit_index) {
+        return NULL;
+    }
+    return relay->pit_index[hash & (relay->pit_index_size - 1)];
+}
+
+void
+ccnl_interest_index_free(struct ccnl_relay_s *relay)
+{
+    ccnl_free(relay->pit_index);
+    relay->pit_index = NULL;
+    relay->pit_index_size = 0;
+}
+
 int
 ccnl_interest_isSame(struct ccnl_interest_s *i, struct ccnl_pkt_s *pkt)
 {
@@ -146,7 +270,7 @@ ccnl_interest_append_pending(struct ccnl_interest_s *i,  struct ccnl_face_s *fro
                     }
                     last = pi;
             }
-            pi = (struct ccnl_pendint_s *) ccnl_calloc(1,sizeof(struct ccnl_pendint_s));
+            pi = (struct ccnl_pendint_s *) ccnl_pool_calloc(CCNL_POOL(PENDINT), sizeof(struct ccnl_pendint_s));
             if (!pi) {
                     DEBUGMSG_CORE(DEBUG, "  no mem\n");
                     return -1;
@@ -197,11 +321,11 @@ ccnl_interest_remove_pending(struct ccnl_interest_s *interest, struct ccnl_face_
                     result++; 
                     if (prev) { 
                         prev->next = pend->next;
-                        ccnl_free(pend);
+                        ccnl_pool_free(CCNL_POOL(PENDINT), pend);
                         pend = prev->next;
                     } else {
                         interest->pending = pend->next;
-                        ccnl_free(pend);
+                        ccnl_pool_free(CCNL_POOL(PENDINT), pend);
                         pend = interest->pending;
                     }
                 } else {
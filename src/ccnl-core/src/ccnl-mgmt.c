@@ -26,6 +26,7 @@
 #include "ccnl-dump.h"
 #include "ccnl-crypto.h"
 #include "ccnl-forward.h"
+#include "ccnl-callbacks.h"
 #include "ccnl-pkt-switch.h"
 #include <sys/socket.h>
 #include <arpa/inet.h>
@@ -40,6 +41,7 @@
 #include "../include/ccnl-dump.h"
 #include "../include/ccnl-crypto.h"
 #include "../include/ccnl-forward.h"
+#include "../include/ccnl-callbacks.h"
 #include "../../ccnl-pkt/include/ccnl-pkt-switch.h"
 #endif
 
@@ -337,7 +339,7 @@ ccnl_prefix_clone(struct ccnl_prefix_s *p)
     for (i = 0, len = 0; i < p->compcnt; len += p2->complen[i++]) {
         p2->complen[i] = p->complen[i];
         p2->comp[i] = p2->bytes + len;
-        memcpy(p2->comp[i], p->comp[i], p2->complen[i]);
+        memcpy(ccnl_prefix_comp(p2, i), ccnl_prefix_comp(p, i), p2->complen[i]);
     }
     return p2;
 Bail:
@@ -974,7 +976,7 @@ ccnl_mgmt_debug(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     DEBUGMSG(TRACE, "ccnl_mgmt_debug from=%s\n", ccnl_addr2ascii(&from->peer));
     action = debugaction = NULL;
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         goto SoftBail;
@@ -1279,7 +1281,7 @@ ccnl_mgmt_newface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     path = frag = flags = wpanaddr = wpanpanid = NULL;
     
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         goto SoftBail;
@@ -1597,7 +1599,7 @@ ccnl_mgmt_setfrag(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
              (void*) from, from->ifndx);
     action = faceid = frag = mtu = NULL;
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         goto SoftBail;
@@ -1650,7 +1652,7 @@ ccnl_mgmt_setfrag(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         long lmtu = 0;
         (void) lmtu;
 
-        for (f = ccnl->faces; f && f->faceid != fi; f = f->next);
+        f = ccnl_face_lookup_id(ccnl, fi);
         if (!f) {
             goto Error;
         }
@@ -1668,6 +1670,8 @@ ccnl_mgmt_setfrag(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             e = CCNL_FRAG_CCNx2013;
         } else if (!strcmp((const char*)frag, "seqd2015")) {
             e = CCNL_FRAG_SEQUENCED2015;
+        } else if (!strcmp((const char*)frag, "beginend2015")) {
+            e = CCNL_FRAG_BEGINEND2015;
         }
         if (e < 0) {
             goto Error;
@@ -1769,7 +1773,7 @@ ccnl_mgmt_destroyface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     DEBUGMSG(DEBUG, "ccnl_mgmt_destroyface\n");
     action = faceid = NULL;
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         goto SoftBail;
@@ -1822,7 +1826,7 @@ ccnl_mgmt_destroyface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             goto SoftBail;
         }
         fi = (int) lfi;
-        for (f = ccnl->faces; f && f->faceid != fi; f = f->next);
+        f = ccnl_face_lookup_id(ccnl, fi);
         if (!f) {
             DEBUGMSG(TRACE, "  could not find face=%s\n", faceid);
             goto SoftBail;
@@ -1915,7 +1919,7 @@ ccnl_mgmt_newdev(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     DEBUGMSG(TRACE, "ccnl_mgmt_newdev\n");
     action = devname = ip4src = ip6src = port = frag = flags = NULL;
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         goto SoftBail;
@@ -2297,7 +2301,7 @@ ccnl_mgmt_echo(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     DEBUGMSG(TRACE, "ccnl_mgmt_echo\n");
     action = NULL;
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         goto SoftBail;
@@ -2326,15 +2330,10 @@ ccnl_mgmt_echo(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         goto SoftBail;
     }
 
-    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    p = ccnl_prefix_new(0, 0);
     if (!p) {
         goto SoftBail;
     }
-    p->comp = (unsigned char**) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(unsigned char*));
-    p->complen = (size_t *) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(size_t));
-    if (!p->comp || !p->complen) {
-        goto SoftBail;
-    }
 
     while (!ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         if (num == 0 && typ == 0) {
@@ -2351,15 +2350,14 @@ ccnl_mgmt_echo(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
                 }
                 if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT &&
                     p->compcnt < CCNL_MAX_NAME_COMP) {
-                        // if (ccnl_grow_prefix(p)) {
-                        //     goto SoftBail;
-                        // }
+                    uint8_t *comp = buf;
+                    size_t complen = 0;
+
                     if (ccnl_ccnb_consume(typ, num, &buf, &buflen,
-                                p->comp + p->compcnt,
-                                p->complen + p->compcnt)) {
+                                          &comp, &complen) ||
+                        ccnl_prefix_appendCmp(p, comp, complen)) {
                         goto SoftBail;
                     }
-                    p->compcnt++;
                 } else {
                     if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0)) {
                         goto SoftBail;
@@ -2479,7 +2477,7 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     DEBUGMSG(TRACE, "ccnl_mgmt_prefixreg\n");
     action = faceid = NULL;
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         goto SoftBail;
@@ -2508,15 +2506,10 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         goto SoftBail;
     }
 
-    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    p = ccnl_prefix_new(0, 0);
     if (!p) {
         goto Bail;
     }
-    p->comp = (uint8_t**) ccnl_calloc(CCNL_MAX_NAME_COMP, sizeof(uint8_t*));
-    p->complen = (size_t*) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(size_t));
-    if (!p->comp || !p->complen) {
-        goto Bail;
-    }
 
     while (!ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
         if (num == 0 && typ == 0) {
@@ -2533,12 +2526,14 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
                 }
                 if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT &&
                     p->compcnt < CCNL_MAX_NAME_COMP) {
-                        // if (ccnl_grow_prefix(p)) goto SoftBail;
+                    uint8_t *comp = buf;
+                    size_t complen = 0;
+
                     if (ccnl_ccnb_consume(typ, num, &buf, &buflen,
-                                p->comp + p->compcnt, p->complen + p->compcnt)) {
+                                          &comp, &complen) ||
+                        ccnl_prefix_appendCmp(p, comp, complen)) {
                         goto SoftBail;
                     }
-                    p->compcnt++;
                 } else {
                     if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0)) {
                         goto SoftBail;
@@ -2560,7 +2555,6 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     // should (re)verify that action=="prefixreg"
     if (faceid && p->compcnt > 0) {
         struct ccnl_face_s *f = NULL;
-        struct ccnl_forward_s **fwd2 = NULL;
         long faceid_l;
 
         errno = 0;
@@ -2576,7 +2570,7 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         DEBUGMSG(TRACE, "mgmt: adding prefix %s to faceid=%s, suite=%s\n",
                  ccnl_prefix_to_str(p,s,CCNL_MAX_PREFIX_SIZE), faceid, ccnl_suite2str(suite[0]));
 
-        for (f = ccnl->faces; f && f->faceid != fi; f = f->next);
+        f = ccnl_face_lookup_id(ccnl, fi);
         if (!f) {
             goto SoftBail;
         }
@@ -2592,11 +2586,12 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             fwd->suite = suite[0];
         }
 
-        fwd2 = &ccnl->fib;
-        while (*fwd2) {
-            fwd2 = &((*fwd2)->next);
+        if (ccnl_fib_link(ccnl, fwd)) {
+            ccnl_prefix_free(fwd->prefix);
+            ccnl_free(fwd);
+            goto SoftBail;
         }
-        *fwd2 = fwd;
+        ccnl_callback_on_fib(ccnl, fwd, 1);
         cp = "prefixreg cmd worked";
     } else {
         DEBUGMSG(TRACE, "mgmt: ignored prefixreg faceid=%s\n", faceid);
@@ -2688,7 +2683,7 @@ ccnl_mgmt_addcacheobject(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     struct ccnl_prefix_s *prefix_new;
     char s[CCNL_MAX_PREFIX_SIZE];
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
 
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
@@ -2871,7 +2866,7 @@ ccnl_mgmt_removecacheobject(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         components[i] = 0;
     }
 
-    buf = prefix->comp[3];
+    buf = ccnl_prefix_comp(prefix, 3);
     buflen = prefix->complen[3];
 
     if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ)) {
@@ -2927,7 +2922,7 @@ ccnl_mgmt_removecacheobject(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             continue;
         }
         for (i = 0; i < num_of_components; ++i) {
-            if (strcmp((char*)c2->pkt->pfx->comp[i], (char*)components[i])) {
+            if (strcmp((char*)ccnl_prefix_comp(c2->pkt->pfx, i), (char*)components[i])) {
                 break;
             }
         }
@@ -3079,7 +3074,7 @@ ccnl_mgmt(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
 {
     char cmd[1000];
     if (prefix->complen[2] < sizeof(cmd)) {
-        memcpy(cmd, prefix->comp[2], prefix->complen[2]);
+        memcpy(cmd, ccnl_prefix_comp(prefix, 2), prefix->complen[2]);
         cmd[prefix->complen[2]] = '\0';
     } else {
         strcpy(cmd, "cmd-is-too-long-to-display");
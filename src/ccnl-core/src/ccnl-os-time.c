@@ -21,6 +21,7 @@
  */
 
 #ifndef CCNL_LINUXKERNEL
+#define _DEFAULT_SOURCE // clock_gettime
 #include "ccnl-os-time.h"
 #include "ccnl-malloc.h"
 #include <stdio.h>
@@ -34,7 +35,11 @@
 
 
 
-struct ccnl_timer_s *eventqueue;
+#if defined(CCNL_UNIX) || defined (CCNL_RIOT) || defined (CCNL_ARDUINO)
+static struct ccnl_timer_s **eventqueue; // binary min-heap ordered by timeout
+static int eventcnt, eventsize;
+static struct ccnl_timer_s *sparetimers; // unarmed timers, ready for reuse
+#endif
 
 
 #if defined(CCNL_RIOT) && !(defined(__FreeBSD__) || defined(__APPLE__) || defined(__linux__))
@@ -84,7 +89,11 @@ current_time(void)
     static time_t start;
     static time_t start_usec;
 
+#if defined(CCNL_UNIX) || defined(CCNL_RIOT)
+    ccnl_get_timeval(&tv);
+#else
     gettimeofday(&tv, NULL);
+#endif
 
     if (!start) {
         start = tv.tv_sec;
@@ -126,55 +135,160 @@ timevaldelta(struct timeval *a, struct timeval *b) {
 void
 ccnl_get_timeval(struct timeval *tv)
 {
+#if defined(CCNL_UNIX) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    if (!clock_gettime(CLOCK_MONOTONIC, &ts)) {
+        tv->tv_sec = ts.tv_sec;
+        tv->tv_usec = ts.tv_nsec / 1000;
+        return;
+    }
+#endif
     gettimeofday(tv, NULL);
 }
 
+static int
+ccnl_timer_before(struct ccnl_timer_s *a, struct ccnl_timer_s *b)
+{
+    return a->timeout.tv_sec < b->timeout.tv_sec ||
+           (a->timeout.tv_sec == b->timeout.tv_sec &&
+            a->timeout.tv_usec < b->timeout.tv_usec);
+}
+
+static void
+ccnl_timer_place(struct ccnl_timer_s *t, int i)
+{
+    eventqueue[i] = t;
+    t->heapidx = i;
+}
+
+static void
+ccnl_timer_sift_up(int i)
+{
+    struct ccnl_timer_s *t = eventqueue[i];
+
+    while (i > 0 && ccnl_timer_before(t, eventqueue[(i - 1) / 2])) {
+        ccnl_timer_place(eventqueue[(i - 1) / 2], i);
+        i = (i - 1) / 2;
+    }
+    ccnl_timer_place(t, i);
+}
+
+static void
+ccnl_timer_sift_down(int i)
+{
+    struct ccnl_timer_s *t = eventqueue[i];
+    int c;
+
+    while ((c = 2 * i + 1) < eventcnt) {
+        if (c + 1 < eventcnt && ccnl_timer_before(eventqueue[c + 1], eventqueue[c])) {
+            c++;
+        }
+        if (!ccnl_timer_before(eventqueue[c], t)) {
+            break;
+        }
+        ccnl_timer_place(eventqueue[c], i);
+        i = c;
+    }
+    ccnl_timer_place(t, i);
+}
+
+static struct ccnl_timer_s*
+ccnl_timer_new(void)
+{
+    struct ccnl_timer_s *t;
+
+    if (eventcnt == eventsize) {
+        int size = eventsize ? 2 * eventsize : 16;
+        struct ccnl_timer_s **q = (struct ccnl_timer_s **)
+            ccnl_realloc(eventqueue, size * sizeof(*q));
+        if (!q) {
+            return NULL;
+        }
+        eventqueue = q;
+        eventsize = size;
+    }
+    if (sparetimers) {
+        t = sparetimers;
+        sparetimers = t->next;
+        memset(t, 0, sizeof(*t));
+    } else {
+        t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+    }
+    return t;
+}
+
+static void*
+ccnl_timer_arm(struct ccnl_timer_s *t)
+{
+    ccnl_timer_place(t, eventcnt++);
+    ccnl_timer_sift_up(t->heapidx);
+    return t;
+}
+
+// unarmed timers are kept for reuse, a handle of one now names the next user
+static void
+ccnl_timer_disarm(struct ccnl_timer_s *t)
+{
+    int i = t->heapidx;
+
+    if (--eventcnt > i) {
+        ccnl_timer_place(eventqueue[eventcnt], i);
+        ccnl_timer_sift_down(i);
+        ccnl_timer_sift_up(i);
+    }
+    t->heapidx = -1;
+    t->next = sparetimers;
+    sparetimers = t;
+}
+
 void*
 ccnl_set_timer(uint64_t usec, void (*fct)(void *aux1, void *aux2),
                  void *aux1, void *aux2)
 {
-    struct ccnl_timer_s *t, **pp;
-    //    static int handlercnt;
+    struct ccnl_timer_s *t;
 
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+    t = ccnl_timer_new();
     if (!t)
         return 0;
     t->fct2 = fct;
-    gettimeofday(&t->timeout, NULL);
+    ccnl_get_timeval(&t->timeout);
     usec += t->timeout.tv_usec;
     t->timeout.tv_sec += usec / 1000000;
     t->timeout.tv_usec = usec % 1000000;
     t->aux1 = aux1;
     t->aux2 = aux2;
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-    if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-        ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-         (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-        t->next = *pp;
-        //        t->handler = handlercnt++;
-        *pp = t;
-        return t;
-    }
-    }
-    return NULL; // ?
+    return ccnl_timer_arm(t);
 }
 
 void
 ccnl_rem_timer(void *h)
 {
-    struct ccnl_timer_s **pp;
+    struct ccnl_timer_s *t = (struct ccnl_timer_s *) h;
 
-    for (pp = &eventqueue; *pp; pp = &((*pp)->next)) {
-        if ((void*)*pp == h) {
-            struct ccnl_timer_s *e = *pp;
-            *pp = e->next;
-            ccnl_free(e);
-            break;
-        }
+    if (t && t->heapidx >= 0 && t->heapidx < eventcnt &&
+        eventqueue[t->heapidx] == t) {
+        ccnl_timer_disarm(t);
     }
 }
 
+void
+ccnl_timer_cleanup(void)
+{
+    while (eventcnt) {
+        ccnl_timer_disarm(eventqueue[eventcnt - 1]);
+    }
+    while (sparetimers) {
+        struct ccnl_timer_s *t = sparetimers;
+        sparetimers = t->next;
+        ccnl_free(t);
+    }
+    ccnl_free(eventqueue);
+    eventqueue = NULL;
+    eventsize = 0;
+}
+
 #endif
 
 #ifdef CCNL_LINUXKERNEL
@@ -269,23 +383,25 @@ ccnl_rem_timer(void *p)
 int
 ccnl_run_events(void)
 {
-    static struct timeval now;
+    struct timeval now;
     long usec;
 
-    gettimeofday(&now, 0);
-    while (eventqueue) {
-        struct ccnl_timer_s *t = eventqueue;
+    ccnl_get_timeval(&now);
+    while (eventcnt) {
+        struct ccnl_timer_s *t = eventqueue[0];
 
         usec = timevaldelta(&(t->timeout), &now);
         if (usec >= 0)
             return usec;
 
-        if (t->fct)
-            (t->fct)(t->node, t->intarg);
-        else if (t->fct2)
-            (t->fct2)(t->aux1, t->aux2);
-        eventqueue = t->next;
-        ccnl_free(t);
+        // unlink first, the callback may arm or cancel other timers and
+        // thereby reuse t
+        struct ccnl_timer_s fired = *t;
+        ccnl_timer_disarm(t);
+        if (fired.fct)
+            (fired.fct)(fired.node, fired.intarg);
+        else if (fired.fct2)
+            (fired.fct2)(fired.aux1, fired.aux2);
     }
 
     return -1;
@@ -301,28 +417,17 @@ void*
 ccnl_set_absolute_timer(struct timeval abstime, void (*fct)(void *aux1, void *aux2),
          void *aux1, void *aux2)
 {
-    struct ccnl_timer_s *t, **pp;
-    //    static int handlercnt;
+    struct ccnl_timer_s *t;
 
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+    t = ccnl_timer_new();
     if (!t)
-    return 0;
+        return 0;
     t->fct2 = fct;
     t->timeout = abstime;
     t->aux1 = aux1;
     t->aux2 = aux2;
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-    if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-        ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-         (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-        t->next = *pp;
-        //        t->handler = handlercnt++;
-        *pp = t;
-        return t;
-    }
-    }
-    return NULL; // ?
+    return ccnl_timer_arm(t);
 }
 
 #endif
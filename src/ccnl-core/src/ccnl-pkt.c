@@ -28,6 +28,8 @@
 
 #include "ccnl-prefix.h"
 #include "ccnl-malloc.h"
+#include "ccnl-pool.h"
+#include "ccnl-arena.h"
 
 #include "ccnl-logging.h"
 #else
@@ -39,6 +41,8 @@
 
 #include "../include/ccnl-prefix.h"
 #include "../include/ccnl-malloc.h"
+#include "../include/ccnl-pool.h"
+#include "../include/ccnl-arena.h"
 
 #include "../include/ccnl-logging.h"
 #endif
@@ -51,19 +55,19 @@ ccnl_pkt_free(struct ccnl_pkt_s *pkt)
             switch (pkt->pfx->suite) {
 #ifdef USE_SUITE_CCNB
             case CCNL_SUITE_CCNB:
-                ccnl_free(pkt->s.ccnb.nonce);
-                ccnl_free(pkt->s.ccnb.ppkd);
+                ccnl_buf_free(pkt->s.ccnb.nonce);
+                ccnl_buf_free(pkt->s.ccnb.ppkd);
                 break;
 #endif
 #ifdef USE_SUITE_CCNTLV
             case CCNL_SUITE_CCNTLV:
-                ccnl_free(pkt->s.ccntlv.keyid);
+                ccnl_buf_free(pkt->s.ccntlv.keyid);
                 break;
 #endif
 #ifdef USE_SUITE_NDNTLV
             case CCNL_SUITE_NDNTLV:
-                ccnl_free(pkt->s.ndntlv.nonce);
-                ccnl_free(pkt->s.ndntlv.ppkl);
+                ccnl_buf_free(pkt->s.ndntlv.nonce);
+                ccnl_buf_free(pkt->s.ndntlv.ppkl);
                 break;
 #endif
 #ifdef USE_SUITE_LOCALRPC
@@ -75,19 +79,106 @@ ccnl_pkt_free(struct ccnl_pkt_s *pkt)
             ccnl_prefix_free(pkt->pfx);
         }
         if(pkt->buf){
-            ccnl_free(pkt->buf);
+            ccnl_buf_free(pkt->buf);
         }
-        ccnl_free(pkt);
+        if (!ccnl_arena_owns(&ccnl_pkt_arena, pkt)) {
+            ccnl_pool_free(CCNL_POOL(PKT), pkt);
+        }
+    }
+}
+
+struct ccnl_pkt_s*
+ccnl_pkt_new_rx(void)
+{
+    struct ccnl_arena_s *arena = ccnl_arena_active();
+    struct ccnl_pkt_s *pkt = NULL;
+
+    if (arena) {
+        pkt = (struct ccnl_pkt_s*) ccnl_arena_calloc(arena, sizeof(*pkt));
+    }
+    if (!pkt) {
+        pkt = (struct ccnl_pkt_s*) ccnl_pool_calloc(CCNL_POOL(PKT), sizeof(*pkt));
+    }
+    return pkt;
+}
+
+// replaces an arena buffer by a long-lived copy
+static int
+ccnl_pkt_persist_buf(struct ccnl_buf_s **buf)
+{
+    struct ccnl_buf_s *b = *buf;
+
+    if (!b || !ccnl_arena_owns(&ccnl_pkt_arena, b->owner ? b->owner : b)) {
+        return 0;
+    }
+    *buf = ccnl_buf_new(b->data, b->datalen);
+    if (!*buf) {
+        *buf = b;
+        return -1;
+    }
+    ccnl_buf_free(b);
+    return 0;
+}
+
+int
+ccnl_pkt_persist(struct ccnl_pkt_s **pkt)
+{
+    struct ccnl_pkt_s *p = *pkt;
+    int rc = 0;
+
+    // with an empty arena nothing of the packet can live in it
+    if (!p || !ccnl_pkt_arena.used || !p->pfx) {
+        return 0;
+    }
+    switch (p->pfx->suite) {
+#ifdef USE_SUITE_CCNB
+    case CCNL_SUITE_CCNB:
+        rc |= ccnl_pkt_persist_buf(&p->s.ccnb.nonce);
+        rc |= ccnl_pkt_persist_buf(&p->s.ccnb.ppkd);
+        break;
+#endif
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        rc |= ccnl_pkt_persist_buf(&p->s.ccntlv.keyid);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        rc |= ccnl_pkt_persist_buf(&p->s.ndntlv.nonce);
+        rc |= ccnl_pkt_persist_buf(&p->s.ndntlv.ppkl);
+        break;
+#endif
+#ifdef USE_SUITE_LOCALRPC
+    case CCNL_SUITE_LOCALRPC:
+#endif
+    default:
+        break;
+    }
+    rc |= ccnl_prefix_persist(&p->pfx);
+    rc |= ccnl_pkt_persist_buf(&p->buf);
+    if (rc) {
+        return -1;
+    }
+    if (ccnl_arena_owns(&ccnl_pkt_arena, p)) {
+        struct ccnl_pkt_s *copy = ccnl_pool_malloc(CCNL_POOL(PKT), sizeof(*copy));
+
+        if (!copy) {
+            return -1;
+        }
+        memcpy(copy, p, sizeof(*copy));
+        *pkt = copy;
+        ccnl_pkt_arena.promotions++;
     }
+    return 0;
 }
 
 
 struct ccnl_pkt_s *
 ccnl_pkt_dup(struct ccnl_pkt_s *pkt){
-    struct ccnl_pkt_s * ret = ccnl_malloc(sizeof(struct ccnl_pkt_s));
+    struct ccnl_pkt_s * ret = ccnl_pool_malloc(CCNL_POOL(PKT), sizeof(struct ccnl_pkt_s));
     if(!pkt){
         if (ret) {
-            ccnl_free(ret);
+            ccnl_pool_free(CCNL_POOL(PKT), ret);
         }
         return NULL;
     }
@@ -0,0 +1,206 @@
+/*
+ * @f ccnl-pool.c
+ * @b CCN lite, fixed-size object pools
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-06-04 created
+ */
+
+#ifndef CCNL_LINUXKERNEL
+#include "ccnl-pool.h"
+#include "ccnl-defs.h"
+#include "ccnl-buf.h"
+#include "ccnl-pkt.h"
+#include "ccnl-prefix.h"
+#include "ccnl-interest.h"
+#include "ccnl-content.h"
+#include "ccnl-malloc.h"
+#include "ccnl-logging.h"
+#include <string.h>
+#else
+#include "../include/ccnl-pool.h"
+#include "../include/ccnl-defs.h"
+#include "../include/ccnl-buf.h"
+#include "../include/ccnl-pkt.h"
+#include "../include/ccnl-prefix.h"
+#include "../include/ccnl-interest.h"
+#include "../include/ccnl-content.h"
+#include "../include/ccnl-malloc.h"
+#include "../include/ccnl-logging.h"
+#endif
+
+#define CCNL_POOL_ALIGN         16
+
+struct ccnl_pool_s ccnl_pools[CCNL_POOL_COUNT] = {
+    [CCNL_POOL_PKT] = {
+        .name = "pkt", .objsize = sizeof(struct ccnl_pkt_s) },
+    [CCNL_POOL_PREFIX] = {
+        .name = "prefix", .objsize = sizeof(struct ccnl_prefix_s) +
+                          CCNL_MAX_NAME_COMP * (sizeof(uint64_t) +
+                                                2 * sizeof(ccnl_compoff_t)) },
+    [CCNL_POOL_BUF_TINY] = {
+        .name = "buf.tiny", .objsize = offsetof(struct ccnl_buf_s, storage) +
+                            CCNL_POOL_TINY_BUF_SIZE },
+    [CCNL_POOL_BUF_SMALL] = {
+        .name = "buf.small", .objsize = offsetof(struct ccnl_buf_s, storage) +
+                             CCNL_RX_SHARE_MIN },
+    [CCNL_POOL_BUF_LARGE] = {
+        .name = "buf.large", .objsize = offsetof(struct ccnl_buf_s, storage) +
+                             CCNL_MAX_PACKET_SIZE },
+    [CCNL_POOL_INTEREST] = {
+        .name = "interest", .objsize = sizeof(struct ccnl_interest_s) },
+    [CCNL_POOL_PENDINT] = {
+        .name = "pendint", .objsize = sizeof(struct ccnl_pendint_s) },
+    [CCNL_POOL_CONTENT] = {
+        .name = "content", .objsize = sizeof(struct ccnl_content_s) },
+};
+
+int
+ccnl_pool_reserve(struct ccnl_pool_s *pool, uint32_t capacity)
+{
+    size_t slotsize;
+    uint32_t k;
+
+    if (pool->inuse) {
+        return -1;
+    }
+    ccnl_pool_release(pool);
+    if (!capacity) {
+        return 0;
+    }
+    // room for the free list link, rounded so every slot is aligned
+    slotsize = pool->objsize > sizeof(void*) ? pool->objsize : sizeof(void*);
+    slotsize = (slotsize + CCNL_POOL_ALIGN - 1) & ~((size_t) CCNL_POOL_ALIGN - 1);
+    if (capacity > (size_t) -1 / slotsize) {
+        return -1;
+    }
+    pool->slab = (unsigned char*) ccnl_malloc(capacity * slotsize);
+    if (!pool->slab) {
+        return -1;
+    }
+    pool->slotsize = slotsize;
+    pool->capacity = capacity;
+    // thread the free list in address order
+    for (k = capacity; k > 0; k--) {
+        void **slot = (void**) (pool->slab + (k - 1) * slotsize);
+        *slot = pool->freelist;
+        pool->freelist = slot;
+    }
+    return 0;
+}
+
+void
+ccnl_pool_release(struct ccnl_pool_s *pool)
+{
+    if (!pool->slab || pool->inuse) {
+        return;
+    }
+    ccnl_free(pool->slab);
+    pool->slab = NULL;
+    pool->freelist = NULL;
+    pool->capacity = 0;
+}
+
+void*
+ccnl_pool_malloc(struct ccnl_pool_s *pool, size_t size)
+{
+    void **slot = (void**) pool->freelist;
+
+    if (slot && size <= pool->objsize) {
+        pool->freelist = *slot;
+        if (++pool->inuse > pool->peak) {
+            pool->peak = pool->inuse;
+        }
+        pool->allocs++;
+        return slot;
+    }
+    pool->fallbacks++;
+    return ccnl_malloc(size);
+}
+
+void*
+ccnl_pool_calloc(struct ccnl_pool_s *pool, size_t size)
+{
+    void *p = ccnl_pool_malloc(pool, size);
+
+    if (p) {
+        memset(p, 0, size);
+    }
+    return p;
+}
+
+int
+ccnl_pool_owns(struct ccnl_pool_s *pool, void *ptr)
+{
+    unsigned char *cp = (unsigned char*) ptr;
+
+    return pool->slab && cp >= pool->slab &&
+           cp < pool->slab + (size_t) pool->capacity * pool->slotsize;
+}
+
+void
+ccnl_pool_free(struct ccnl_pool_s *pool, void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    if (ccnl_pool_owns(pool, ptr)) {
+        *(void**) ptr = pool->freelist;
+        pool->freelist = ptr;
+        pool->inuse--;
+    } else {
+        ccnl_free(ptr);
+    }
+}
+
+int
+ccnl_pools_init(uint32_t capacity)
+{
+    int k, rc = 0;
+    size_t total = 0;
+
+    for (k = 0; k < CCNL_POOL_COUNT; k++) {
+        uint32_t cnt = k == CCNL_POOL_BUF_LARGE ? capacity / 4 : capacity;
+
+        if (ccnl_pool_reserve(ccnl_pools + k, cnt)) {
+            DEBUGMSG(WARNING, "could not reserve %u objects in pool %s\n",
+                     cnt, ccnl_pools[k].name);
+            rc = -1;
+            continue;
+        }
+        total += (size_t) ccnl_pools[k].capacity * ccnl_pools[k].slotsize;
+    }
+    DEBUGMSG(INFO, "object pools: %u objects each, %zu bytes\n",
+             capacity, total);
+    return rc;
+}
+
+void
+ccnl_pools_cleanup(void)
+{
+    int k;
+
+    for (k = 0; k < CCNL_POOL_COUNT; k++) {
+        if (ccnl_pools[k].inuse) {
+            DEBUGMSG(WARNING, "pool %s: %u objects still in use\n",
+                     ccnl_pools[k].name, ccnl_pools[k].inuse);
+        }
+        ccnl_pool_release(ccnl_pools + k);
+    }
+}
+
+// eof
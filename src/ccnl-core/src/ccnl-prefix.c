@@ -23,6 +23,9 @@
 
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-prefix.h"
+#include "ccnl-pool.h"
+#include "ccnl-arena.h"
+#include "ccnl-simd.h"
 #include "ccnl-pkt-ndntlv.h"
 #include "ccnl-pkt-ccntlv.h"
 #include <string.h>
@@ -33,42 +36,110 @@
 #endif // !defined(CCNL_RIOT) && !defined(CCNL_ANDROID)
 #else //CCNL_LINUXKERNEL
 #include "../include/ccnl-prefix.h"
+#include "../include/ccnl-pool.h"
+#include "../include/ccnl-arena.h"
+#include "../include/ccnl-simd.h"
 #include "../../ccnl-pkt/include/ccnl-pkt-ndntlv.h"
 #include "../../ccnl-pkt/include/ccnl-pkt-ccntlv.h"
 
 #endif //CCNL_LINUXKERNEL
 
 
-struct ccnl_prefix_s*
-ccnl_prefix_new(char suite, uint32_t cnt)
+// hash of the empty name, derived from the seed
+static uint64_t ccnl_prefix_hash_basis = 0x6a09e667f3bcc908ULL;
+
+// one allocation holding the prefix, room for cnt components and len
+// bytes of component copies, taken from arena if one is given
+static struct ccnl_prefix_s*
+ccnl_prefix_alloc(struct ccnl_arena_s *arena, char suite, uint32_t cnt, size_t len)
 {
-    struct ccnl_prefix_s *p;
+    struct ccnl_prefix_s *p = NULL;
+    size_t size = sizeof(struct ccnl_prefix_s) + cnt * sizeof(uint64_t) +
+                  2 * cnt * sizeof(ccnl_compoff_t) + len;
 
-    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
-    if (!p){
+    if (len > (ccnl_compoff_t) -1) {
         return NULL;
     }
-    p->comp = (uint8_t **) ccnl_malloc(cnt * sizeof(uint8_t*));
-    p->complen = (size_t *) ccnl_malloc(cnt * sizeof(size_t));
-    if (!p->comp || !p->complen) {
-        ccnl_prefix_free(p);
+    if (arena) {
+        p = (struct ccnl_prefix_s *) ccnl_arena_calloc(arena, size);
+    }
+    if (!p) {
+        p = (struct ccnl_prefix_s *) ccnl_pool_calloc(CCNL_POOL(PREFIX), size);
+    }
+    if (!p){
         return NULL;
     }
+    p->comphash = (uint64_t *) (p + 1);
+    p->compoff = (ccnl_compoff_t *) (p->comphash + cnt);
+    p->complen = p->compoff + cnt;
+    p->base = (uint8_t *) (p->complen + cnt);
     p->compcnt = cnt;
     p->suite = suite;
-    p->chunknum = NULL;
+    p->chunknum = -1;
+    p->hash = ccnl_prefix_hash_basis;
 
     return p;
 }
 
+struct ccnl_prefix_s*
+ccnl_prefix_new(char suite, uint32_t cnt)
+{
+    return ccnl_prefix_alloc(NULL, suite, cnt, 0);
+}
+
+struct ccnl_prefix_s*
+ccnl_prefix_new_rx(char suite, uint32_t cnt)
+{
+    return ccnl_prefix_alloc(ccnl_arena_active(), suite, cnt, 0);
+}
+
 void
 ccnl_prefix_free(struct ccnl_prefix_s *p)
 {
-    ccnl_free(p->bytes);
-    ccnl_free(p->comp);
-    ccnl_free(p->complen);
-    ccnl_free(p->chunknum);
-    ccnl_free(p);
+    if (p) {
+        ccnl_free(p->ext);
+        if (!ccnl_arena_owns(&ccnl_pkt_arena, p)) {
+            ccnl_pool_free(CCNL_POOL(PREFIX), p);
+        }
+    }
+}
+
+int
+ccnl_prefix_persist(struct ccnl_prefix_s **prefix)
+{
+    struct ccnl_prefix_s *old = *prefix, *p;
+
+    if (!old || !ccnl_arena_owns(&ccnl_pkt_arena, old)) {
+        return 0;
+    }
+    if (ccnl_arena_owns(&ccnl_pkt_arena, old->base)) {
+        // the component bytes would go down with the arena, copy them
+        p = ccnl_prefix_dup(old);
+        if (!p) {
+            return -1;
+        }
+        // the encoded name went with the arena too, compare by components
+        p->nameptr = NULL;
+        p->namelen = 0;
+        ccnl_prefix_free(old);
+        *prefix = p;
+        return 0;
+    }
+    p = ccnl_prefix_alloc(NULL, old->suite, old->compcnt, 0);
+    if (!p) {
+        return -1;
+    }
+    memcpy(p->comphash, old->comphash, old->compcnt * sizeof(uint64_t));
+    memcpy(p->compoff, old->compoff, old->compcnt * sizeof(ccnl_compoff_t));
+    memcpy(p->complen, old->complen, old->compcnt * sizeof(ccnl_compoff_t));
+    p->base = old->base;
+    p->hash = old->hash;
+    p->chunknum = old->chunknum;
+    p->nameptr = old->nameptr;
+    p->namelen = old->namelen;
+    ccnl_prefix_free(old);
+    *prefix = p;
+    return 0;
 }
 
 struct ccnl_prefix_s*
@@ -78,34 +149,23 @@ ccnl_prefix_dup(struct ccnl_prefix_s *prefix)
     size_t len;
     struct ccnl_prefix_s *p;
 
-    p = ccnl_prefix_new(prefix->suite, prefix->compcnt);
-    if (!p){
-        return NULL;
-    }
-
-    p->compcnt = prefix->compcnt;
-    p->chunknum = prefix->chunknum;
-
     for (i = 0, len = 0; i < prefix->compcnt; i++) {
         len += prefix->complen[i];
     }
-    p->bytes = (unsigned char*) ccnl_malloc(len);
-    if (!p->bytes) {
-        ccnl_prefix_free(p);
+    p = ccnl_prefix_alloc(NULL, prefix->suite, prefix->compcnt, len);
+    if (!p){
         return NULL;
     }
 
+    memcpy(p->comphash, prefix->comphash, prefix->compcnt * sizeof(uint64_t));
     for (i = 0, len = 0; i < prefix->compcnt; i++) {
+        p->compoff[i] = (ccnl_compoff_t) len;
         p->complen[i] = prefix->complen[i];
-        p->comp[i] = p->bytes + len;
-        memcpy(p->bytes + len, prefix->comp[i], p->complen[i]);
+        memcpy(p->base + len, ccnl_prefix_comp(prefix, i), p->complen[i]);
         len += p->complen[i];
     }
-
-    if (prefix->chunknum) {
-        p->chunknum = (uint32_t *) ccnl_malloc(sizeof(uint32_t));
-        *p->chunknum = *prefix->chunknum;
-    }
+    p->chunknum = prefix->chunknum;
+    p->hash = prefix->hash;
 
     return p;
 }
@@ -114,58 +174,52 @@ int8_t
 ccnl_prefix_appendCmp(struct ccnl_prefix_s *prefix, uint8_t *cmp,
                       size_t cmplen)
 {
-    uint32_t lastcmp = prefix->compcnt, i;
-    size_t *oldcomplen = prefix->complen;
-    uint8_t **oldcomp = prefix->comp;
-    uint8_t *oldbytes = prefix->bytes;
-
-    size_t prefixlen = 0;
+    uint32_t cnt = prefix->compcnt + 1, i;
+    uint64_t *comphash;
+    ccnl_compoff_t *compoff, *complen;
+    uint8_t *bytes;
+    size_t prefixlen = cmplen;
 
     if (prefix->compcnt >= CCNL_MAX_NAME_COMP) {
         return -1;
     }
-    for (i = 0; i < lastcmp; i++) {
+    for (i = 0; i < prefix->compcnt; i++) {
         prefixlen += prefix->complen[i];
     }
-
-    prefix->compcnt++;
-    prefix->comp = (uint8_t **) ccnl_malloc(prefix->compcnt * sizeof(unsigned char*));
-    if (!prefix->comp) {
-        prefix->comp = oldcomp;
-        return -1;
-    }
-    prefix->complen = (size_t*) ccnl_malloc(prefix->compcnt * sizeof(size_t));
-    if (!prefix->complen) {
-        ccnl_free(prefix->comp);
-        prefix->comp = oldcomp;
-        prefix->complen = oldcomplen;
+    if (prefixlen > (ccnl_compoff_t) -1) {
         return -1;
     }
-    prefix->bytes = (uint8_t *) ccnl_malloc(prefixlen + cmplen);
-    if (!prefix->bytes) {
-        ccnl_free(prefix->comp);
-        ccnl_free(prefix->complen);
-        prefix->comp = oldcomp;
-        prefix->complen = oldcomplen;
-        prefix->bytes = oldbytes;
+
+    // the inline arrays cannot grow, move everything to one new block
+    comphash = (uint64_t *) ccnl_malloc(cnt * sizeof(uint64_t) +
+                                        2 * cnt * sizeof(ccnl_compoff_t) + prefixlen);
+    if (!comphash) {
         return -1;
     }
-
-    memcpy(prefix->bytes, oldbytes, prefixlen);
-    memcpy(prefix->bytes + prefixlen, cmp, cmplen);
+    compoff = (ccnl_compoff_t *) (comphash + cnt);
+    complen = compoff + cnt;
+    bytes = (uint8_t *) (complen + cnt);
 
     prefixlen = 0;
-    for (i = 0; i < lastcmp; i++) {
-        prefix->comp[i] = &prefix->bytes[prefixlen];
-        prefix->complen[i] = oldcomplen[i];
-        prefixlen += oldcomplen[i];
-    }
-    prefix->comp[lastcmp] = &prefix->bytes[prefixlen];
-    prefix->complen[lastcmp] = cmplen;
-
-    ccnl_free(oldcomp);
-    ccnl_free(oldcomplen);
-    ccnl_free(oldbytes);
+    for (i = 0; i < prefix->compcnt; i++) {
+        compoff[i] = (ccnl_compoff_t) prefixlen;
+        complen[i] = prefix->complen[i];
+        memcpy(bytes + prefixlen, ccnl_prefix_comp(prefix, i), complen[i]);
+        prefixlen += complen[i];
+    }
+    compoff[i] = (ccnl_compoff_t) prefixlen;
+    complen[i] = (ccnl_compoff_t) cmplen;
+    memcpy(bytes + prefixlen, cmp, cmplen);
+
+    memcpy(comphash, prefix->comphash, prefix->compcnt * sizeof(uint64_t));
+    ccnl_free(prefix->ext);
+    prefix->ext = comphash;
+    prefix->comphash = comphash;
+    prefix->compoff = compoff;
+    prefix->complen = complen;
+    prefix->base = bytes;
+    prefix->compcnt = cnt;
+    ccnl_prefix_rehash(prefix);
 
     return 0;
 }
@@ -185,22 +239,13 @@ ccnl_prefix_addChunkNum(struct ccnl_prefix_s *prefix, uint32_t chunknum)
 #ifdef USE_SUITE_NDNTLV
         case CCNL_SUITE_NDNTLV: {
             uint8_t cmp[2];
-            uint32_t *oldchunknum = prefix->chunknum;
             cmp[0] = NDN_Marker_SegmentNumber;
             // TODO: this only works for chunknums smaller than 255
             cmp[1] = (uint8_t) chunknum;
             if (ccnl_prefix_appendCmp(prefix, cmp, 2) < 0) {
                 return -1;
             }
-            prefix->chunknum = (uint32_t *) ccnl_malloc(sizeof(uint32_t));
-            if (!prefix->chunknum) {
-                prefix->chunknum = oldchunknum;
-                return -1;
-            }
-            *prefix->chunknum = chunknum;
-            if (oldchunknum) {
-                ccnl_free(oldchunknum);
-            }
+            prefix->chunknum = chunknum;
         }
         break;
 #endif
@@ -208,7 +253,6 @@ ccnl_prefix_addChunkNum(struct ccnl_prefix_s *prefix, uint32_t chunknum)
 #ifdef USE_SUITE_CCNTLV
         case CCNL_SUITE_CCNTLV: {
             uint8_t cmp[5];
-            uint32_t *oldchunknum = prefix->chunknum;
             cmp[0] = 0;
             // TODO: this only works for chunknums smaller than 255
             cmp[1] = CCNX_TLV_N_Chunk;
@@ -218,15 +262,7 @@ ccnl_prefix_addChunkNum(struct ccnl_prefix_s *prefix, uint32_t chunknum)
             if(ccnl_prefix_appendCmp(prefix, cmp, 5) < 0) {
                 return -1;
             }
-            prefix->chunknum = (uint32_t *) ccnl_malloc(sizeof(uint32_t));
-            if (!prefix->chunknum) {
-                prefix->chunknum = oldchunknum;
-                return -1;
-            }
-            *prefix->chunknum = chunknum;
-            if (oldchunknum) {
-                ccnl_free(oldchunknum);
-            }
+            prefix->chunknum = chunknum;
         }
         break;
 #endif
@@ -241,6 +277,76 @@ ccnl_prefix_addChunkNum(struct ccnl_prefix_s *prefix, uint32_t chunknum)
     return 0;
 }
 
+#define CCNL_NAMEHASH_MUL       0x9e3779b97f4a7c15ULL
+
+static uint64_t
+ccnl_prefix_hash_mix(uint64_t h)
+{
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+// folds one component into the hash of the components before it, eight
+// bytes at a time, the length first so that splitting a name differently
+// changes the hash
+static uint64_t
+ccnl_prefix_hash_comp(uint64_t h, uint8_t *comp, size_t len)
+{
+    uint64_t w;
+
+    h = (h ^ len) * CCNL_NAMEHASH_MUL;
+    for (; len >= sizeof(w); comp += sizeof(w), len -= sizeof(w)) {
+        memcpy(&w, comp, sizeof(w));
+        h = (h ^ w) * CCNL_NAMEHASH_MUL;
+        h ^= h >> 29;
+    }
+    if (len) {
+        w = 0;
+        memcpy(&w, comp, len);
+        h = (h ^ w) * CCNL_NAMEHASH_MUL;
+    }
+    return ccnl_prefix_hash_mix(h);
+}
+
+uint64_t
+ccnl_prefix_hash_seed(uint64_t seed)
+{
+    uint64_t old = ccnl_prefix_hash_basis;
+
+    ccnl_prefix_hash_basis = ccnl_prefix_hash_mix(seed ^ 0x6a09e667f3bcc908ULL);
+    return old;
+}
+
+void
+ccnl_prefix_hash_restore(uint64_t basis)
+{
+    ccnl_prefix_hash_basis = basis;
+}
+
+void
+ccnl_prefix_rehash(struct ccnl_prefix_s *prefix)
+{
+    uint64_t h = ccnl_prefix_hash_basis;
+    uint32_t i;
+
+    for (i = 0; i < prefix->compcnt; i++) {
+        h = ccnl_prefix_hash_comp(h, ccnl_prefix_comp(prefix, i), prefix->complen[i]);
+        prefix->comphash[i] = h;
+    }
+    prefix->hash = h;
+}
+
+uint64_t
+ccnl_prefix_hash(struct ccnl_prefix_s *prefix, uint32_t cnt)
+{
+    if (cnt >= prefix->compcnt) {
+        return prefix->hash;
+    }
+    return cnt ? prefix->comphash[cnt - 1] : ccnl_prefix_hash_basis;
+}
+
 // TODO: move to a util file?
 uint8_t
 hex2int(char c)
@@ -321,11 +427,6 @@ ccnl_URItoPrefix(char* uri, int suite, uint32_t *chunknum)
         cnt = 0U;
     }
 
-    p = ccnl_prefix_new(suite, cnt);
-    if (!p) {
-        return NULL;
-    }
-
     for (i = 0, len = 0; i < cnt; i++) {
         len += complens[i];
     }
@@ -335,9 +436,8 @@ ccnl_URItoPrefix(char* uri, int suite, uint32_t *chunknum)
     }
 #endif
 
-    p->bytes = (unsigned char*) ccnl_malloc(len);
-    if (!p->bytes) {
-        ccnl_prefix_free(p);
+    p = ccnl_prefix_alloc(NULL, (char) suite, cnt, len);
+    if (!p) {
         return NULL;
     }
 
@@ -345,22 +445,16 @@ ccnl_URItoPrefix(char* uri, int suite, uint32_t *chunknum)
         char *cp = compvect[i];
         tlen = complens[i];
 
-        p->comp[i] = p->bytes + len;
-        tlen = ccnl_pkt_mkComponent(suite, p->comp[i], cp, tlen);
-        p->complen[i] = tlen;
+        p->compoff[i] = (ccnl_compoff_t) len;
+        tlen = ccnl_pkt_mkComponent(suite, p->base + len, cp, tlen);
+        p->complen[i] = (ccnl_compoff_t) tlen;
         len += tlen;
     }
 
-    p->compcnt = cnt;
-
     if (chunknum) {
-        p->chunknum = (uint32_t*) ccnl_malloc(sizeof(uint32_t));
-        if (!p->chunknum) {
-            ccnl_prefix_free(p);
-            return NULL;
-        }
-        *p->chunknum = *chunknum;
+        p->chunknum = *chunknum;
     }
+    ccnl_prefix_rehash(p);
 
     return p;
 }
@@ -406,22 +500,31 @@ ccnl_prefix_cmp(struct ccnl_prefix_s *pfx, unsigned char *md,
             DEBUGMSG(VERBOSE, "comp count mismatch\n");
             goto done;
         }
-        if (pfx->chunknum || nam->chunknum) {
-            if (!pfx->chunknum || !nam->chunknum) {
-                DEBUGMSG(VERBOSE, "chunk mismatch\n");
-                goto done;
-            }
-            if (*pfx->chunknum != *nam->chunknum) {
-                DEBUGMSG(VERBOSE, "chunk number mismatch\n");
-                goto done;
-            }
+        if (pfx->chunknum != nam->chunknum) {
+            DEBUGMSG(VERBOSE, "chunk number mismatch\n");
+            goto done;
+        }
+        if (!md && pfx->hash != nam->hash) {
+            DEBUGMSG(VERBOSE, "name hash mismatch\n");
+            goto done;
+        }
+        // two names decoded from the wire are equal if their encodings are
+        if (!md && pfx->nameptr && nam->nameptr && pfx->suite == nam->suite &&
+            pfx->namelen == nam->namelen &&
+            ccnl_simd_equal(pfx->nameptr, nam->nameptr, (size_t) pfx->namelen)) {
+            rc = 0;
+            goto done;
         }
     }
 
     for (i = 0; i < plen && i < nam->compcnt; ++i) {
-        comp = i < pfx->compcnt ? pfx->comp[i] : md;
+        comp = i < pfx->compcnt ? ccnl_prefix_comp(pfx, i) : md;
         clen = i < pfx->compcnt ? pfx->complen[i] : 32; // SHA256_DIGEST_LEN
-        if (clen != nam->complen[i] || memcmp(comp, nam->comp[i], nam->complen[i])) {
+        // the leading components are equal, so differing hashes mean
+        // that this one differs
+        if (clen != nam->complen[i] ||
+            (i < pfx->compcnt && pfx->comphash[i] != nam->comphash[i]) ||
+            memcmp(comp, ccnl_prefix_comp(nam, i), nam->complen[i])) {
             rc = mode == CMP_EXACT ? -1 : (int32_t) i;
             DEBUGMSG(VERBOSE, "component mismatch: %lu\n", (long unsigned) i);
             goto done;
@@ -556,7 +659,7 @@ ccnl_prefix_to_str_detailed(struct ccnl_prefix_s *pr, int ccntlv_skip, int escap
         len += result;
 
         for (j = skip; j < pr->complen[i]; j++) {
-            char c = pr->comp[i][j];
+            char c = ccnl_prefix_comp(pr, i)[j];
             char *fmt;
             fmt = (c < 0x20 || c == 0x7f
                             || (escape_components && c == '/' )) ?
@@ -656,7 +759,7 @@ ccnl_prefix_to_str(struct ccnl_prefix_s *pr, char *buf, size_t buflen) {
             len += result;
 
         for (j = skip; j < (size_t)pr->complen[i]; j++) {
-            char c = pr->comp[i][j];
+            char c = ccnl_prefix_comp(pr, i)[j];
             char *fmt;
             fmt = (c < 0x20 || c == 0x7f
                             || (0 && c == '/' )) ?
@@ -733,7 +836,7 @@ ccnl_prefix_debug_info(struct ccnl_prefix_s *p) {
     }
     len += result;
     for (i = 0; i < p->compcnt; i++) {
-        result = snprintf(buf + len, CCNL_MAX_PACKET_SIZE - len, "%zd", p->complen[i]);
+        result = snprintf(buf + len, CCNL_MAX_PACKET_SIZE - len, "%zu", (size_t) p->complen[i]);
         if (!(result > -1 && (unsigned) result < (CCNL_MAX_PACKET_SIZE - len))) {
             DEBUGMSG(ERROR, "Could not print prefix, since out of allocated memory");
             ccnl_free(buf);
@@ -766,7 +869,8 @@ ccnl_prefix_debug_info(struct ccnl_prefix_s *p) {
     }
     len += result;
     for (i = 0; i < p->compcnt; i++) {
-        result = snprintf(buf + len, CCNL_MAX_PACKET_SIZE - len, "%.*s", (int) p->complen[i], p->comp[i]);
+        result = snprintf(buf + len, CCNL_MAX_PACKET_SIZE - len, "%.*s", (int) p->complen[i],
+                          ccnl_prefix_comp(p, i));
         if (!(result > -1 && (unsigned) result < (CCNL_MAX_PACKET_SIZE - len))) {
             DEBUGMSG(ERROR, "Could not print prefix, since out of allocated memory");
             ccnl_free(buf);
@@ -0,0 +1,98 @@
+/*
+ * @f ccnl-rcu.c
+ * @b CCN lite, grace periods for tables read without locks
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-07-05 created
+ */
+
+#ifndef CCNL_LINUXKERNEL
+#include "ccnl-rcu.h"
+#else
+#include "../include/ccnl-rcu.h"
+#endif
+
+int
+ccnl_rcu_register(struct ccnl_rcu_s *rcu)
+{
+    uint32_t readers = __atomic_load_n(&rcu->readers, __ATOMIC_RELAXED);
+    int id;
+
+    for (id = 0; id < CCNL_RCU_MAX_READERS; id++) {
+        uint32_t bit = 1U << id;
+
+        if (readers & bit) {
+            continue;
+        }
+        // a new reader has seen nothing retired so far
+        __atomic_store_n(&rcu->seen[id],
+                         __atomic_load_n(&rcu->epoch, __ATOMIC_ACQUIRE),
+                         __ATOMIC_RELEASE);
+        if (!(__atomic_fetch_or(&rcu->readers, bit, __ATOMIC_SEQ_CST) & bit)) {
+            return id;
+        }
+        readers = __atomic_load_n(&rcu->readers, __ATOMIC_RELAXED);
+    }
+    return -1;
+}
+
+void
+ccnl_rcu_unregister(struct ccnl_rcu_s *rcu, int id)
+{
+    if (id >= 0 && id < CCNL_RCU_MAX_READERS) {
+        __atomic_fetch_and(&rcu->readers, ~(1U << id), __ATOMIC_SEQ_CST);
+    }
+}
+
+void
+ccnl_rcu_quiescent(struct ccnl_rcu_s *rcu, int id)
+{
+    if (id < 0 || id >= CCNL_RCU_MAX_READERS) {
+        return;
+    }
+    // everything loaded before is no longer used once the new value shows
+    __atomic_store_n(&rcu->seen[id],
+                     __atomic_load_n(&rcu->epoch, __ATOMIC_ACQUIRE),
+                     __ATOMIC_SEQ_CST);
+}
+
+uint32_t
+ccnl_rcu_retire(struct ccnl_rcu_s *rcu)
+{
+    return __atomic_add_fetch(&rcu->epoch, 1, __ATOMIC_SEQ_CST);
+}
+
+int
+ccnl_rcu_done(struct ccnl_rcu_s *rcu, uint32_t epoch)
+{
+    uint32_t readers = __atomic_load_n(&rcu->readers, __ATOMIC_SEQ_CST);
+    int id;
+
+    for (id = 0; readers; id++, readers >>= 1) {
+        uint32_t seen;
+
+        if (!(readers & 1)) {
+            continue;
+        }
+        seen = __atomic_load_n(&rcu->seen[id], __ATOMIC_ACQUIRE);
+        // epochs wrap, compare their distance
+        if ((int32_t) (seen - epoch) < 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -22,11 +22,13 @@
 
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-core.h"
+#include "ccnl-callbacks.h"
 #include <stdio.h>
 #include <inttypes.h>
 #include <assert.h>
 #else //CCNL_LINUXKERNEL
 #include "../include/ccnl-core.h"
+#include "../include/ccnl-callbacks.h"
 #endif //CCNL_LINUXKERNEL
 
 #ifdef CCNL_RIOT
@@ -59,14 +61,14 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
     DEBUGMSG_CORE(TRACE, "ccnl_get_face_or_create src=%s\n",
              ccnl_addr2ascii((sockunion*)sa));
 
-    for (f = ccnl->faces; f; f = f->next) {
-        if (!sa) {
-            if (f->ifndx == -1)
-                return f;
-            continue;
+    if (!sa) {
+        f = ccnl_face_index_lookup(ccnl, -1, NULL);
+        if (f) {
+            return f;
         }
-        if (ifndx != -1 && (f->ifndx == ifndx) &&
-            !ccnl_addr_cmp(&f->peer, (sockunion*)sa)) {
+    } else if (ifndx != -1) {
+        f = ccnl_face_index_lookup(ccnl, ifndx, (sockunion*)sa);
+        if (f) {
             f->last_used = CCNL_NOW();
 #ifdef CCNL_RIOT
             ccnl_evtimer_reset_face_timeout(f);
@@ -97,9 +99,15 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
     }
     f->faceid = ++seqno;
     f->ifndx = ifndx;
+    f->outqmax = ccnl->face_qmax;
+    f->outqdrop = ccnl->face_qdrop;
 
     if (ifndx >= 0) {
-        if (ccnl->defaultFaceScheduler) {
+        if (ccnl_sched_is_drr(ccnl->ifs[ifndx].sched)) {
+            // the face takes its turns at the interface
+            f->sched = ccnl_sched_drr_face_new((void (*)(void *, void *)) ccnl_face_CTS,
+                                               ccnl->ifs[ifndx].sched, 1);
+        } else if (ccnl->defaultFaceScheduler) {
             f->sched = ccnl->defaultFaceScheduler(ccnl,
                                                   (void (*)(void *, void *)) ccnl_face_CTS);
         }
@@ -117,7 +125,15 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
         f->ifndx = -1;
     }
     f->last_used = CCNL_NOW();
+    if (ccnl_face_index_add(ccnl, f)) {
+        DEBUGMSG_CORE(WARNING, "  no memory for face index\n");
+        ccnl_sched_destroy(f->sched);
+        ccnl_free(f);
+        return NULL;
+    }
     DBL_LINKED_LIST_ADD(ccnl->faces, f);
+    // last_used moves with every packet, the wheel catches up when due
+    ccnl_wheel_add(&ccnl->face_ageing, &f->ageing, f->last_used + CCNL_FACE_TIMEOUT);
 
     TRACEOUT();
 
@@ -133,7 +149,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
     struct ccnl_face_s *f2;
     struct ccnl_interest_s *pit;
-    struct ccnl_forward_s **ppfwd;
+    struct ccnl_forward_s *fwd;
 
     DEBUGMSG_CORE(DEBUG, "face_remove relay=%p face=%p\n",
              (void*)ccnl, (void*)f);
@@ -152,7 +168,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
             if ((*ppend)->face == f) {
                 pend = *ppend;
                 *ppend = pend->next;
-                ccnl_free(pend);
+                ccnl_pool_free(CCNL_POOL(PENDINT), pend);
             } else {
                 ppend = &(*ppend)->next;
             }
@@ -166,27 +182,22 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
         }
     }
     DEBUGMSG_CORE(TRACE, "face_remove: cleaning fwd table\n");
-    for (ppfwd = &ccnl->fib; *ppfwd;) {
-        if ((*ppfwd)->face == f) {
-            struct ccnl_forward_s *pfwd = *ppfwd;
-            ccnl_prefix_free(pfwd->prefix);
-            *ppfwd = pfwd->next;
-            ccnl_free(pfwd);
-        } else {
-            ppfwd = &(*ppfwd)->next;
+    for (fwd = ccnl->fib; fwd;) {
+        struct ccnl_forward_s *next = fwd->next;
+        if (fwd->face == f) {
+            ccnl_fib_remove(ccnl, fwd);
         }
+        fwd = next;
     }
     DEBUGMSG_CORE(TRACE, "face_remove: cleaning pkt queue\n");
-    while (f->outq) {
-        struct ccnl_buf_s *tmp = f->outq->next;
-        ccnl_free(f->outq);
-        f->outq = tmp;
-    }
+    ccnl_face_outq_clear(f);
     DEBUGMSG_CORE(TRACE, "face_remove: unlinking1 %p %p\n",
              (void*)f->next, (void*)f->prev);
     f2 = f->next;
     DEBUGMSG_CORE(TRACE, "face_remove: unlinking2\n");
     DBL_LINKED_LIST_REMOVE(ccnl->faces, f);
+    ccnl_face_index_remove(ccnl, f);
+    ccnl_wheel_remove(&ccnl->face_ageing, &f->ageing);
     DEBUGMSG_CORE(TRACE, "face_remove: unlinking3\n");
     ccnl_free(f);
 
@@ -198,6 +209,15 @@ void
 ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
                        struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
                        struct ccnl_buf_s *buf, sockunion *dest)
+{
+    ccnl_interface_enqueue_hdr(tx_done, f, ccnl, ifc, NULL, 0, buf, dest);
+}
+
+void
+ccnl_interface_enqueue_hdr(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
+                           struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+                           uint8_t *hdr, size_t hdrlen,
+                           struct ccnl_buf_s *buf, sockunion *dest)
 {
     if (ifc) {
         struct ccnl_txrequest_s *r;
@@ -208,10 +228,20 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
                   buf ? buf->datalen : 0, ifc ? ifc->qlen : 0);
         }
 
-        if (ifc->qlen >= CCNL_MAX_IF_QLEN) {
+#ifndef USE_SCHEDULER
+        // a batching interface sends once its queue fills up, not only
+        // when the I/O loop gets back to it
+        if (ifc->txbatch > 1 && ifc->qlen >= ccnl_interface_qmax(ifc)) {
+            ccnl_interface_flush(ccnl, ifc);
+        }
+#endif
+        if (ifc->qlen >= ccnl_interface_qmax(ifc)) {
             if (buf) {
                 DEBUGMSG_CORE(WARNING, "  DROPPING buf=%p\n", (void*)buf); 
-                ccnl_free(buf); 
+#ifdef USE_STATS
+                ifc->tx_drops++;
+#endif
+                ccnl_buf_free(buf); 
                 return;
             }
         }
@@ -221,12 +251,19 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
         memcpy(&r->dst, dest, sizeof(sockunion));
         r->txdone = tx_done;
         r->txdone_face = f;
+        r->hdrlen = (uint8_t) hdrlen;
+        if (hdrlen) {
+            memcpy(r->hdr, hdr, hdrlen);
+        }
         ifc->qlen++;
 
 #ifdef USE_SCHEDULER
-        ccnl_sched_RTS(ifc->sched, 1, buf->datalen, ccnl, ifc);
+        ccnl_sched_RTS(ifc->sched, 1, (int) ccnl_txrequest_len(r), ccnl, ifc);
 #else 
-        ccnl_interface_CTS(ccnl, ifc);
+        // batched sends leave the queue to ccnl_interface_flush()
+        if (ifc->txbatch <= 1 || !ccnl->ccnl_ll_TXv_ptr) {
+            ccnl_interface_CTS(ccnl, ifc);
+        }
 #endif
     }
 }
@@ -234,20 +271,10 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
 struct ccnl_buf_s*
 ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
-    struct ccnl_buf_s *pkt;
     DEBUGMSG_CORE(TRACE, "dequeue face=%p (id=%d.%d)\n",
              (void *) f, ccnl->id, f->faceid);
 
-    if (!f->outq) {
-        return NULL;
-    }
-    pkt = f->outq;
-    f->outq = pkt->next;
-    if (!pkt->next) {
-        f->outqend = NULL;
-    }
-    pkt->next = NULL;
-    return pkt;
+    return ccnl_face_outq_take(f);
 }
 
 void
@@ -261,6 +288,39 @@ ccnl_face_CTS_done(void *ptr, int cnt, int len)
 #endif
 }
 
+#ifdef USE_FRAG
+// hands the next fragment of the face to its interface, returns 0 if
+// there is none left
+static int
+ccnl_face_CTS_frag(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    uint8_t hdr[CCNL_FRAG_HDR_MAX];
+    size_t hdrlen = 0;
+    struct ccnl_buf_s *buf = NULL;
+    sockunion dst;
+    int ifndx = f->ifndx, k;
+
+    for (k = 0; k < 2 && !buf; k++) {
+        if (k) {
+            // the current packet is done, go on with the next one
+            ccnl_frag_reset(f->frag, ccnl_face_dequeue(ccnl, f), f->ifndx, &f->peer);
+        }
+        if (ccnl->ccnl_ll_TXv_ptr) {
+            // the link layer gathers header and payload, nothing is copied
+            buf = ccnl_frag_getnextslice(f->frag, hdr, &hdrlen, &ifndx, &dst);
+        } else {
+            buf = ccnl_frag_getnext(f->frag, &ifndx, &dst);
+        }
+    }
+    if (!buf) {
+        return 0;
+    }
+    ccnl_interface_enqueue_hdr(ccnl_face_CTS_done, f, ccnl, ccnl->ifs + ifndx,
+                               hdr, hdrlen, buf, &dst);
+    return 1;
+}
+#endif
+
 void
 ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
@@ -276,37 +336,20 @@ ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     }
 #ifdef USE_FRAG
     else {
-        sockunion dst;
-        int ifndx = f->ifndx;
-        buf = ccnl_frag_getnext(f->frag, &ifndx, &dst);
-        if (!buf) {
-            buf = ccnl_face_dequeue(ccnl, f);
-            ccnl_frag_reset(f->frag, buf, f->ifndx, &f->peer);
-            buf = ccnl_frag_getnext(f->frag, &ifndx, &dst);
-        }
-        if (buf) {
-            ccnl_interface_enqueue(ccnl_face_CTS_done, f,
-                                   ccnl, ccnl->ifs + ifndx, buf, &dst);
-#ifndef USE_SCHEDULER
-            ccnl_face_CTS(ccnl, f); // loop to push more fragments
+#ifdef USE_SCHEDULER
+        ccnl_face_CTS_frag(ccnl, f);
+#else
+        // push all fragments of what is queued
+        while (ccnl_face_CTS_frag(ccnl, f));
 #endif
-        }
     }
 #endif
 }
 
-int
-ccnl_send_pkt(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
-                struct ccnl_pkt_s *pkt)
+static int
+ccnl_face_enqueue2(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
+                   struct ccnl_buf_s *buf, int request)
 {
-    return ccnl_face_enqueue(ccnl, to, buf_dup(pkt->buf));
-}
-
-int
-ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
-                 struct ccnl_buf_s *buf)
-{
-    struct ccnl_buf_s *msg;
     if (buf == NULL) {
         DEBUGMSG_CORE(ERROR, "enqueue face: buf most not be NULL\n");
         return -1;
@@ -314,20 +357,10 @@ ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
     DEBUGMSG_CORE(TRACE, "enqueue face=%p (id=%d.%d) buf=%p len=%zd\n",
              (void*) to, ccnl->id, to->faceid, (void*) buf, buf ? buf->datalen : 0);
 
-    for (msg = to->outq; msg; msg = msg->next) { // already in the queue?
-        if (buf_equal(msg, buf)) {
-            DEBUGMSG_CORE(VERBOSE, "    not enqueued because already there\n");
-            ccnl_free(buf);
-            return -1;
-        }
-    }
-    buf->next = NULL;
-    if (to->outqend) {
-        to->outqend->next = buf;
-    } else {
-        to->outq = buf;
+    if (ccnl_face_outq_add(to, buf, request)) {
+        DEBUGMSG_CORE(VERBOSE, "    not enqueued, already there or queue full\n");
+        return -1;
     }
-    to->outqend = buf;
 #ifdef USE_SCHEDULER
     if (to->sched) {
 #ifdef USE_FRAG
@@ -345,6 +378,22 @@ ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
     return 0;
 }
 
+int
+ccnl_send_pkt(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
+                struct ccnl_pkt_s *pkt)
+{
+    // every face queues a reference to the same bytes
+    return ccnl_face_enqueue2(ccnl, to, ccnl_buf_share(pkt->buf),
+                              pkt->flags & CCNL_PKT_REQUEST);
+}
+
+int
+ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
+                 struct ccnl_buf_s *buf)
+{
+    return ccnl_face_enqueue2(ccnl, to, buf, 0);
+}
+
 
 struct ccnl_interest_s*
 ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
@@ -363,7 +412,7 @@ ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
 
     while (i->pending) {
         struct ccnl_pendint_s *tmp = i->pending->next;          \
-        ccnl_free(i->pending);
+        ccnl_pool_free(CCNL_POOL(PENDINT), i->pending);
         i->pending = tmp;
     }
     i2 = i->next;
@@ -371,12 +420,14 @@ ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
     ccnl->pitcnt--;
 
     DBL_LINKED_LIST_REMOVE(ccnl->pit, i);
+    ccnl_interest_index_remove(ccnl, i);
+    ccnl_wheel_remove(&ccnl->pit_ageing, &i->ageing);
 
     if (i->pkt) {
         ccnl_pkt_free(i->pkt);
     }
     if (i) {
-        ccnl_free(i);
+        ccnl_pool_free(CCNL_POOL(INTEREST), i);
     }
     return i2;
 }
@@ -385,7 +436,7 @@ void
 ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
 {
     struct ccnl_forward_s *fwd;
-    int rc = 0;
+    struct ccnl_fib_match_s m;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
@@ -402,25 +453,16 @@ ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
     // transmit an Interest Message on all listed dest faces in sequence."
     // CCNL strategy: we forward on all FWD entries with a prefix match
 
-    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
-        if (!fwd->prefix) {
-            continue;
-        }
-
-        //Only for matching suite
-        if (!i->pkt->pfx || fwd->suite != i->pkt->pfx->suite) {
-            DEBUGMSG_CORE(VERBOSE, "  not same suite (%d/%d)\n",
-                     fwd->suite, i->pkt->pfx ? i->pkt->pfx->suite : -1);
-            continue;
-        }
-
-        rc = ccnl_prefix_cmp(fwd->prefix, NULL, i->pkt->pfx, CMP_LONGEST);
+    if (!i->pkt->pfx) {
+        return;
+    }
 
+    // the FIB index yields the matching entries (same suite, prefix of the
+    // name) longest prefix first
+    ccnl_fib_match_init(ccnl, &m, i->pkt->pfx);
+    while ((fwd = ccnl_fib_match_next(ccnl, &m))) {
         DEBUGMSG_CORE(DEBUG, "  ccnl_interest_propagate, rc=%ld/%ld\n",
-                 (long) rc, (long) fwd->prefix->compcnt);
-        if (rc < (signed) fwd->prefix->compcnt) {
-            continue;
-        }
+                 (long) m.len, (long) fwd->prefix->compcnt);
 
         DEBUGMSG_CORE(DEBUG, "  ccnl_interest_propagate, fwd==%p\n", (void*)fwd);
         // suppress forwarding to origin of interest, except wireless
@@ -532,15 +574,16 @@ ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 
     c2 = c->next;
     DBL_LINKED_LIST_REMOVE(ccnl->contents, c);
+    ccnl_content_index_remove(ccnl, c);
+    ccnl_content_repl_remove(ccnl, c);
+    ccnl_wheel_remove(&ccnl->cs_ageing, &c->ageing);
 
 //    free_content(c);
     if (c->pkt) {
-        ccnl_prefix_free(c->pkt->pfx);
-        ccnl_free(c->pkt->buf);
-        ccnl_free(c->pkt);
+        ccnl_pkt_free(c->pkt);
     }
     //    ccnl_prefix_free(c->name);
-    ccnl_free(c);
+    ccnl_pool_free(CCNL_POOL(CONTENT), c);
 
     ccnl->contentcnt--;
 #ifdef CCNL_RIOT
@@ -552,42 +595,39 @@ ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 struct ccnl_content_s*
 ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 {
-    struct ccnl_content_s *cit;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
     DEBUGMSG_CORE(DEBUG, "ccnl_content_add2cache (%d/%d) --> %p = %s [%d]\n",
                   ccnl->contentcnt, ccnl->max_cache_entries,
-                  (void*)c, ccnl_prefix_to_str(c->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE), (c->pkt->pfx->chunknum)? (signed) *(c->pkt->pfx->chunknum) : -1);
+                  (void*)c, ccnl_prefix_to_str(c->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE), (signed) c->pkt->pfx->chunknum);
 
-    for (cit = ccnl->contents; cit; cit = cit->next) {
-        if (ccnl_prefix_cmp(c->pkt->pfx, NULL, cit->pkt->pfx, CMP_EXACT) == 0) {
-            DEBUGMSG_CORE(DEBUG, "--- Already in cache ---\n");
-            return NULL;
-        }
+    if (ccnl_content_index_lookup(ccnl, c->pkt->pfx)) {
+        DEBUGMSG_CORE(DEBUG, "--- Already in cache ---\n");
+        return NULL;
     }
 
     if (ccnl->max_cache_entries > 0 &&
         ccnl->contentcnt >= ccnl->max_cache_entries && !cache_strategy_remove(ccnl, c)) {
-        // remove oldest content
-        struct ccnl_content_s *c2, *oldest = NULL;
-        uint32_t age = 0;
-        for (c2 = ccnl->contents; c2; c2 = c2->next) {
-             if (!(c2->flags & CCNL_CONTENT_FLAGS_STATIC)) {
-                 if ((age == 0) || c2->last_used < age) {
-                     age = c2->last_used;
-                     oldest = c2;
-                 }
-             }
-         }
-         if (oldest) {
-             DEBUGMSG_CORE(DEBUG, " remove old entry from cache\n");
-             ccnl_content_remove(ccnl, oldest);
-         }
+        // remove the victim of the replacement policy
+        struct ccnl_content_s *victim = ccnl_content_repl_victim(ccnl);
+        if (victim) {
+            DEBUGMSG_CORE(DEBUG, " remove old entry from cache\n");
+            ccnl_content_remove(ccnl, victim);
+        }
     }
     if ((ccnl->max_cache_entries <= 0) ||
          (ccnl->contentcnt <= ccnl->max_cache_entries)) {
+            if (ccnl_content_index_add(ccnl, c)) {
+                DEBUGMSG_CORE(WARNING, "  no memory for the CS index\n");
+                return NULL;
+            }
             DBL_LINKED_LIST_ADD(ccnl->contents, c);
+            ccnl_content_repl_add(ccnl, c);
+            if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+                ccnl_wheel_add(&ccnl->cs_ageing, &c->ageing,
+                               c->last_used + CCNL_CONTENT_TIMEOUT);
+            }
             ccnl->contentcnt++;
 #ifdef CCNL_RIOT
             /* set cache timeout timer if content is not static */
@@ -600,118 +640,157 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
     return c;
 }
 
-int
-ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+/* serves the PIT entry i with c if it matches, returns the number of serves */
+static int
+ccnl_content_serve_interest(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c,
+                            struct ccnl_interest_s *i)
 {
-    struct ccnl_interest_s *i;
-    struct ccnl_face_s *f;
+    struct ccnl_pendint_s *pi;
     int cnt = 0;
-    DEBUGMSG_CORE(TRACE, "ccnl_content_serve_pending\n");
     char s[CCNL_MAX_PREFIX_SIZE];
+    (void) s;
 
-    for (f = ccnl->faces; f; f = f->next){
-                f->flags &= ~CCNL_FACE_FLAGS_SERVED; // reply on a face only once
+    if (!i->pkt->pfx) {
+        return 0;
     }
-    for (i = ccnl->pit; i;) {
-        struct ccnl_pendint_s *pi;
-        if (!i->pkt->pfx) {
-            continue;
-        }
 
-        switch (i->pkt->pfx->suite) {
+    switch (i->pkt->pfx->suite) {
 #ifdef USE_SUITE_CCNB
-        case CCNL_SUITE_CCNB:
-            if (ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ccnb.minsuffix,
-                       i->pkt->s.ccnb.maxsuffix, c) < 0) {
-                // XX must also check i->ppkd
-                i = i->next;
-                continue;
-            }
-            break;
+    case CCNL_SUITE_CCNB:
+        if (ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ccnb.minsuffix,
+                   i->pkt->s.ccnb.maxsuffix, c) < 0) {
+            // XX must also check i->ppkd
+            return 0;
+        }
+        break;
 #endif
 #ifdef USE_SUITE_CCNTLV
-        case CCNL_SUITE_CCNTLV:
-            if (ccnl_prefix_cmp(c->pkt->pfx, NULL, i->pkt->pfx, CMP_EXACT)) {
-                // XX must also check keyid
-                i = i->next;
-                continue;
-            }
-            break;
+    case CCNL_SUITE_CCNTLV:
+        if (ccnl_prefix_cmp(c->pkt->pfx, NULL, i->pkt->pfx, CMP_EXACT)) {
+            // XX must also check keyid
+            return 0;
+        }
+        break;
 #endif
 #ifdef USE_SUITE_NDNTLV
-        case CCNL_SUITE_NDNTLV:
-            if (ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ndntlv.minsuffix,
-                    i->pkt->s.ndntlv.maxsuffix, c) < 0) {
-                // XX must also check i->ppkl,
-                i = i->next;
-                continue;
-            }
-            break;
-#endif
-        default:
-            i = i->next;
-            continue;
+    case CCNL_SUITE_NDNTLV:
+        if (ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ndntlv.minsuffix,
+                i->pkt->s.ndntlv.maxsuffix, c) < 0) {
+            // XX must also check i->ppkl,
+            return 0;
         }
+        break;
+#endif
+    default:
+        return 0;
+    }
 
-        //Hook for add content to cache by callback:
-        if(i && ! i->pending){
-            DEBUGMSG_CORE(WARNING, "releasing interest 0x%p OK?\n", (void*)i);
-            c->flags |= CCNL_CONTENT_FLAGS_STATIC;
-            i = ccnl_interest_remove(ccnl, i);
+    //Hook for add content to cache by callback:
+    if (!i->pending) {
+        DEBUGMSG_CORE(WARNING, "releasing interest 0x%p OK?\n", (void*)i);
+        c->flags |= CCNL_CONTENT_FLAGS_STATIC;
+        ccnl_interest_remove(ccnl, i);
 
-            c->served_cnt++;
-            cnt++;
-            continue;
-            //return 1;
+        c->served_cnt++;
+        return 1;
+    }
 
+    // CONFORM: "Data MUST only be transmitted in response to
+    // an Interest that matches the Data."
+    for (pi = i->pending; pi; pi = pi->next) {
+        if (pi->face->served_epoch == ccnl->serve_epoch) { // reply on a face only once
+            continue;
         }
-
-        // CONFORM: "Data MUST only be transmitted in response to
-        // an Interest that matches the Data."
-        for (pi = i->pending; pi; pi = pi->next) {
-            if (pi->face->flags & CCNL_FACE_FLAGS_SERVED) {
-                continue;
-            }
-            pi->face->flags |= CCNL_FACE_FLAGS_SERVED;
-            if (pi->face->ifndx >= 0) {
-                int32_t nonce = 0;
-                if (i->pkt != NULL && i->pkt->s.ndntlv.nonce != NULL) {
-                    if (i->pkt->s.ndntlv.nonce->datalen == 4) {
-                        memcpy(&nonce, i->pkt->s.ndntlv.nonce->data, 4);
-                    }
+        pi->face->served_epoch = ccnl->serve_epoch;
+        if (pi->face->ifndx >= 0) {
+            int32_t nonce = 0;
+            if (i->pkt != NULL && i->pkt->s.ndntlv.nonce != NULL) {
+                if (i->pkt->s.ndntlv.nonce->datalen == 4) {
+                    memcpy(&nonce, i->pkt->s.ndntlv.nonce->data, 4);
                 }
+            }
 
 #ifndef CCNL_LINUXKERNEL
-                DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%"PRIi32" to=%s\n",
-                          ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
-                          ccnl_suite2str(i->pkt->pfx->suite), nonce,
-                          ccnl_addr2ascii(&pi->face->peer));
+            DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%"PRIi32" to=%s\n",
+                      ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
+                      ccnl_suite2str(i->pkt->pfx->suite), nonce,
+                      ccnl_addr2ascii(&pi->face->peer));
 #else
-                DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%d to=%s\n",
-                          ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
-                          ccnl_suite2str(i->pkt->pfx->suite), nonce,
-                          ccnl_addr2ascii(&pi->face->peer));
+            DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%d to=%s\n",
+                      ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
+                      ccnl_suite2str(i->pkt->pfx->suite), nonce,
+                      ccnl_addr2ascii(&pi->face->peer));
 #endif
-                DEBUGMSG_CORE(VERBOSE, "    Serve to face: %d (pkt=%p)\n",
-                         pi->face->faceid, (void*) c->pkt);
+            DEBUGMSG_CORE(VERBOSE, "    Serve to face: %d (pkt=%p)\n",
+                     pi->face->faceid, (void*) c->pkt);
 
-                ccnl_send_pkt(ccnl, pi->face, c->pkt);
+            ccnl_send_pkt(ccnl, pi->face, c->pkt);
 
 
-            } else {// upcall to deliver content to local client
+        } else {// upcall to deliver content to local client
 #ifdef CCNL_APP_RX
-                ccnl_app_RX(ccnl, c);
+            ccnl_app_RX(ccnl, c);
 #endif
+        }
+        c->served_cnt++;
+        cnt++;
+    }
+    ccnl_interest_remove(ccnl, i);
+
+    return cnt;
+}
+
+int
+ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_interest_s *i, *next;
+    struct ccnl_face_s *f;
+    uint64_t h;
+    int32_t k;
+    int cnt = 0;
+    DEBUGMSG_CORE(TRACE, "ccnl_content_serve_pending\n");
+
+    // a face was served with this content if it carries the current epoch
+    if (++ccnl->serve_epoch == 0) {
+        for (f = ccnl->faces; f; f = f->next) {
+            f->served_epoch = 0;
+        }
+        ccnl->serve_epoch = 1;
+    }
+
+    // every PIT entry the content can satisfy is indexed under the hash of
+    // a leading sub-prefix of the content name (see ccnl_interest_index_add)
+    k = (int32_t) (c->pkt->pfx->compcnt < CCNL_MAX_NAME_COMP ?
+                   c->pkt->pfx->compcnt : CCNL_MAX_NAME_COMP);
+    for (; k >= 0; k--) {
+        h = ccnl_prefix_hash(c->pkt->pfx, (uint32_t) k);
+        for (i = ccnl_interest_index_bucket(ccnl, h); i; i = next) {
+            next = i->hnext;
+            if (i->namehash == h) {
+                cnt += ccnl_content_serve_interest(ccnl, c, i);
             }
-            c->served_cnt++;
-            cnt++;
         }
-        i = ccnl_interest_remove(ccnl, i);
     }
+    ccnl->serve_fanout[ccnl_serve_fanout_bucket(cnt)]++;
 
     return cnt;
 }
 
+int
+ccnl_serve_fanout_bucket(int fanout)
+{
+    int b = 1, limit = 1;
+
+    if (fanout <= 0) {
+        return 0;
+    }
+    while (fanout > limit && b < CCNL_SERVE_FANOUT_BUCKETS - 1) {
+        limit <<= 1;
+        b++;
+    }
+    return b;
+}
+
 #define DEBUGMSG_AGEING(trace, debug, buf, buf_len)    \
 DEBUGMSG_CORE(TRACE, "%s %p\n", (trace), (void*) i);   \
 DEBUGMSG_CORE(DEBUG, " %s 0x%p <%s>\n", (debug),       \
@@ -723,40 +802,36 @@ ccnl_do_ageing(void *ptr, void *dummy)
 {
 
     struct ccnl_relay_s *relay = (struct ccnl_relay_s*) ptr;
-    struct ccnl_content_s *c = relay->contents;
-    struct ccnl_interest_s *i = relay->pit;
-    struct ccnl_face_s *f = relay->faces;
-    time_t t = CCNL_NOW();
+    struct ccnl_wheel_link_s *link;
+    struct ccnl_content_s *c;
+    struct ccnl_interest_s *i;
+    struct ccnl_face_s *f;
+    uint32_t t = (uint32_t) CCNL_NOW();
     DEBUGMSG_CORE(VERBOSE, "ageing t=%d\n", (int)t);
     (void) dummy;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
-    while (c) {
-        if ((c->last_used + CCNL_CONTENT_TIMEOUT) <= (uint32_t) t &&
-                                !(c->flags & CCNL_CONTENT_FLAGS_STATIC)){
+    // only entries which are due are visited, staleness of content is
+    // evaluated when it is matched, see ccnl_content_is_stale()
+    ccnl_wheel_advance(&relay->cs_ageing, t);
+    while ((link = ccnl_wheel_pop(&relay->cs_ageing))) {
+        c = CCNL_WHEEL_ENTRY(link, struct ccnl_content_s, ageing);
+        // content may have been made static after it was cached
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
             DEBUGMSG_CORE(TRACE, "AGING: CONTENT REMOVE %p\n", (void*) c);
-            c = ccnl_content_remove(relay, c);
-        }
-        else {
-#ifdef USE_SUITE_NDNTLV
-            if (c->pkt->suite == CCNL_SUITE_NDNTLV) {
-                // Mark content as stale if its freshness period expired and it is not static
-                if ((c->last_used + (c->pkt->s.ndntlv.freshnessperiod / 1000)) <= (uint32_t) t &&
-                        !(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
-                    c->flags |= CCNL_CONTENT_FLAGS_STALE;
-                }
-            }
-#endif
-            c = c->next;
+            ccnl_content_remove(relay, c);
         }
     }
-    while (i) { // CONFORM: "Entries in the PIT MUST timeout rather
-                // than being held indefinitely."
-        if ((i->last_used + i->lifetime) <= (uint32_t) t ||
+    ccnl_wheel_advance(&relay->pit_ageing, t);
+    while ((link = ccnl_wheel_pop(&relay->pit_ageing))) {
+        i = CCNL_WHEEL_ENTRY(link, struct ccnl_interest_s, ageing);
+        // CONFORM: "Entries in the PIT MUST timeout rather
+        // than being held indefinitely."
+        if ((i->last_used + i->lifetime) <= t ||
                                 i->retries >= CCNL_MAX_INTEREST_RETRANSMIT) {
                 DEBUGMSG_AGEING("AGING: REMOVE INTEREST", "timeout: remove interest", s, CCNL_MAX_PREFIX_SIZE);
-                i = ccnl_interest_remove(relay, i);
+                ccnl_interest_remove(relay, i);
         } else {
             // CONFORM: "A node MUST retransmit Interest Messages
             // periodically for pending PIT entries."
@@ -766,69 +841,105 @@ ccnl_do_ageing(void *ptr, void *dummy)
                 ccnl_interest_propagate(relay, i);
 
             i->retries++;
-            i = i->next;
+            ccnl_wheel_add(&relay->pit_ageing, &i->ageing, t + 1);
         }
     }
-    while (f) {
-        if (!(f->flags & CCNL_FACE_FLAGS_STATIC) &&
-                (f->last_used + CCNL_FACE_TIMEOUT) <= (uint32_t) t){
+    ccnl_wheel_advance(&relay->face_ageing, t);
+    while ((link = ccnl_wheel_pop(&relay->face_ageing))) {
+        f = CCNL_WHEEL_ENTRY(link, struct ccnl_face_s, ageing);
+        if (f->flags & CCNL_FACE_FLAGS_STATIC) {
+            continue;
+        }
+        if ((f->last_used + CCNL_FACE_TIMEOUT) <= t) {
             DEBUGMSG_CORE(TRACE, "AGING: FACE REMOVE %p\n", (void*) f);
-            f = ccnl_face_remove(relay, f);
+            ccnl_face_remove(relay, f);
         } else {
-            f = f->next;
+            ccnl_wheel_add(&relay->face_ageing, &f->ageing,
+                           f->last_used + CCNL_FACE_TIMEOUT);
         }
     }
 }
 
 int
-ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce)
+ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce,
+                          uint32_t lifetime)
 {
-    struct ccnl_buf_s *n, *n2 = 0;
-    int i;
+#if CCNL_MAX_NONCES > 0
+    struct ccnl_nonce_s *n, *slot = NULL;
+    uint32_t key = 0, now = (uint32_t) CCNL_NOW(), h, k;
     DEBUGMSG_CORE(TRACE, "ccnl_nonce_find_or_append\n");
 
-    for (n = ccnl->nonces, i = 0; n; n = n->next, i++) {
-        if (buf_equal(n, nonce)) {
-            return -1;
-        }
-        if (n->next) {
-            n2 = n;
+    if (nonce->datalen == sizeof(key)) {
+        memcpy(&key, nonce->data, sizeof(key));
+    } else {
+        size_t j;
+        key = 2166136261U;
+        for (j = 0; j < nonce->datalen; j++) {
+            key = (key ^ nonce->data[j]) * 16777619U;
         }
     }
-    n = ccnl_buf_new(nonce->data, nonce->datalen);
-    if (n) {
-        n->next = ccnl->nonces;
-        ccnl->nonces = n;
-        if (i >= CCNL_MAX_NONCES && n2) {
-            ccnl_free(n2->next);
-            n2->next = 0;
+    // nonces are random, but spread them anyway in case a peer counts up
+    h = key * 2654435761U;
+    h ^= h >> 16;
+
+    for (k = 0; k < CCNL_NONCE_PROBES; k++) {
+        n = ccnl->nonces + ((h + k) & (CCNL_NONCE_TABLE_SIZE - 1));
+        if (n->expires > now) {
+            if (n->nonce == key) {
+                ccnl->nonce_hits++;
+                return -1;
+            }
+            // no free slot so far: keep the live nonce which expires first
+            if (!slot || (slot->expires > now && n->expires < slot->expires)) {
+                slot = n;
+            }
+        } else if (!slot || slot->expires > now) {
+            slot = n;
         }
     }
+    if (slot->expires > now) {
+        ccnl->nonce_evictions++;
+    }
+    slot->nonce = key;
+    slot->expires = now + lifetime;
+#else
+    (void) ccnl;
+    (void) nonce;
+    (void) lifetime;
+#endif
     return 0;
 }
 
 int
 ccnl_nonce_isDup(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt)
 {
+    uint32_t lifetime;
+
     if(CCNL_MAX_NONCES < 0){
         struct ccnl_interest_s *i = NULL;
         for (i = relay->pit; i; i = i->next) {
             if(buf_equal(i->pkt->s.ndntlv.nonce, pkt->s.ndntlv.nonce)){
+                relay->nonce_hits++;
                 return 1;
             }
         }
         return 0;
     }
+    // sub-second lifetimes still have to catch immediate loops
+    lifetime = (uint32_t) ccnl_pkt_interest_lifetime(pkt);
+    if (!lifetime) {
+        lifetime = 1;
+    }
     switch (pkt->suite) {
 #ifdef USE_SUITE_CCNB
     case CCNL_SUITE_CCNB:
         return pkt->s.ccnb.nonce &&
-            ccnl_nonce_find_or_append(relay, pkt->s.ccnb.nonce);
+            ccnl_nonce_find_or_append(relay, pkt->s.ccnb.nonce, lifetime);
 #endif
 #ifdef USE_SUITE_NDNTLV
     case CCNL_SUITE_NDNTLV:
         return pkt->s.ndntlv.nonce &&
-            ccnl_nonce_find_or_append(relay, pkt->s.ndntlv.nonce);
+            ccnl_nonce_find_or_append(relay, pkt->s.ndntlv.nonce, lifetime);
 #endif
     default:
         break;
@@ -843,36 +954,32 @@ int
 ccnl_fib_add_entry(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
                    struct ccnl_face_s *face)
 {
-    struct ccnl_forward_s *fwd, **fwd2;
+    struct ccnl_forward_s *fwd;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
     DEBUGMSG_CUTL(INFO, "adding FIB for <%s>, suite %s\n",
              ccnl_prefix_to_str(pfx,s,CCNL_MAX_PREFIX_SIZE), ccnl_suite2str(pfx->suite));
 
-    for (fwd = relay->fib; fwd; fwd = fwd->next) {
-        if (fwd->suite == pfx->suite &&
-                        !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) {
-            ccnl_prefix_free(fwd->prefix);
-            fwd->prefix = NULL;
-            break;
-        }
-    }
-    if (!fwd) {
+    fwd = ccnl_fib_lookup(relay, pfx);
+    if (fwd) {
+        // same name, the entry keeps its prefix, which readers may hold
+        ccnl_prefix_free(pfx);
+    } else {
         fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
         if (!fwd) {
             return -1;
         }
-        fwd2 = &relay->fib;
-        while (*fwd2) {
-            fwd2 = &((*fwd2)->next);
-        }
-        *fwd2 = fwd;
         fwd->suite = pfx->suite;
+        fwd->prefix = pfx;
+        if (ccnl_fib_link(relay, fwd)) {
+            ccnl_free(fwd);
+            return -1;
+        }
     }
-    fwd->prefix = pfx;
-    fwd->face = face;
+    __atomic_store_n(&fwd->face, face, __ATOMIC_RELEASE);
     DEBUGMSG_CUTL(DEBUG, "added FIB via %s\n", ccnl_addr2ascii(&fwd->face->peer));
+    ccnl_callback_on_fib(relay, fwd, 1);
 
     return 0;
 }
@@ -884,7 +991,6 @@ ccnl_fib_rem_entry(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
 {
     struct ccnl_forward_s *fwd;
     int res = -1;
-    struct ccnl_forward_s *last = NULL;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
@@ -894,27 +1000,30 @@ ccnl_fib_rem_entry(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
                       ccnl_prefix_to_str(pfx,s,CCNL_MAX_PREFIX_SIZE), ccnl_suite2str(pfx->suite));
     }
 
-    for (fwd = relay->fib; fwd; last = fwd, fwd = fwd->next) {
-        if (((pfx == NULL) || (fwd->suite == pfx->suite)) &&
-            ((pfx == NULL) || !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) &&
-            ((face == NULL) || (fwd->face == face))) {
-            res = 0;
-            if (!last) {
-                relay->fib = fwd->next;
-            }
-            else {
-                last->next = fwd->next;
-            }
-            ccnl_prefix_free(fwd->prefix);
-            ccnl_free(fwd);
-            break;
+    if (pfx == NULL) {
+        fwd = relay->fib;
+        while (fwd && face != NULL && fwd->face != face) {
+            fwd = fwd->next;
+        }
+    } else {
+        struct ccnl_fib_match_s m;
+
+        // entries of the same name come first, longer ones are skipped
+        ccnl_fib_match_init(relay, &m, pfx);
+        while ((fwd = ccnl_fib_match_next(relay, &m)) &&
+               fwd->prefix->compcnt == pfx->compcnt &&
+               face != NULL && fwd->face != face);
+        if (fwd && fwd->prefix->compcnt != pfx->compcnt) {
+            fwd = NULL;
         }
     }
-
     if (fwd) {
+        res = 0;
         if (fwd->face) {
-            DEBUGMSG_CUTL(DEBUG, "added FIB via %s\n", ccnl_addr2ascii(&fwd->face->peer));
+            DEBUGMSG_CUTL(DEBUG, "removed FIB via %s\n", ccnl_addr2ascii(&fwd->face->peer));
         }
+        ccnl_callback_on_fib(relay, fwd, 0);
+        ccnl_fib_remove(relay, fwd);
     }
 
     return res;
@@ -965,7 +1074,7 @@ ccnl_cs_dump(struct ccnl_relay_s *ccnl)
     while (c) {
         printf("CS[%u]: %s [%d]: %.*s\n", i++,
                ccnl_prefix_to_str(c->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
-               (c->pkt->pfx->chunknum)? (signed) *(c->pkt->pfx->chunknum) : -1,
+               (signed) c->pkt->pfx->chunknum,
                (int) c->pkt->contlen, c->pkt->content);
         c = c->next;
     }
@@ -997,13 +1106,66 @@ ccnl_interface_CTS(void *aux1, void *aux2)
 #ifndef CCNL_LINUXKERNEL
     assert(ccnl->ccnl_ll_TX_ptr != 0);
 #endif
-    ccnl->ccnl_ll_TX_ptr(ccnl, ifc, &req.dst, req.buf);
+    if (!req.hdrlen) {
+        ccnl->ccnl_ll_TX_ptr(ccnl, ifc, &req.dst, req.buf);
+    } else if (ccnl->ccnl_ll_TXv_ptr) {
+        ccnl->ccnl_ll_TXv_ptr(ccnl, ifc, &req, 1);
+    } else {
+        struct ccnl_buf_s *flat = ccnl_txrequest_flatten(&req);
+
+        if (flat) {
+            ccnl->ccnl_ll_TX_ptr(ccnl, ifc, &req.dst, flat);
+            ccnl_buf_free(flat);
+        }
+    }
 #ifdef USE_SCHEDULER
-    ccnl_sched_CTS_done(ifc->sched, 1, req.buf->datalen);
+    ccnl_sched_CTS_done(ifc->sched, 1, (int) ccnl_txrequest_len(&req));
     if (req.txdone)
-        req.txdone(req.txdone_face, 1, req.buf->datalen);
+        req.txdone(req.txdone_face, 1, (int) ccnl_txrequest_len(&req));
+#endif
+    ccnl_buf_free(req.buf);
+}
+
+void
+ccnl_interface_flush(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc)
+{
+    while (ifc->qlen > 0) {
+        size_t n = ifc->qlen, k;
+        int sent;
+
+        if (ifc->txbatch <= 1 || !ccnl->ccnl_ll_TXv_ptr) {
+            ccnl_interface_CTS(ccnl, ifc);
+            continue;
+        }
+        // the link layer gets a contiguous part of the ring
+        if (n > CCNL_MAX_IF_QLEN - ifc->qfront) {
+            n = CCNL_MAX_IF_QLEN - ifc->qfront;
+        }
+        if (n > (size_t) ifc->txbatch) {
+            n = (size_t) ifc->txbatch;
+        }
+        sent = ccnl->ccnl_ll_TXv_ptr(ccnl, ifc, ifc->queue + ifc->qfront, (int) n);
+        DEBUGMSG_CORE(TRACE, "interface_flush interface=%p, %d of %zu sent\n",
+                      (void*)ifc, sent, n);
+        if (sent <= 0) {
+            break;
+        }
+        for (k = 0; k < (size_t) sent; k++) {
+            struct ccnl_txrequest_s *r = ifc->queue + ifc->qfront + k;
+#ifdef USE_STATS
+            ifc->tx_cnt++;
+#endif
+#ifdef USE_SCHEDULER
+            ccnl_sched_CTS_done(ifc->sched, 1, (int) ccnl_txrequest_len(r));
+            if (r->txdone)
+                r->txdone(r->txdone_face, 1, (int) ccnl_txrequest_len(r));
 #endif
-    ccnl_free(req.buf);
+            ccnl_buf_free(r->buf);
+            r->buf = NULL;
+        }
+        ifc->qfront = (ifc->qfront + (size_t) sent) % CCNL_MAX_IF_QLEN;
+        ifc->qlen -= (size_t) sent;
+    }
 }
 
 int
@@ -22,12 +22,14 @@
 
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-sched.h"
+#include "ccnl-defs.h"
 #include "ccnl-malloc.h"
 #include "ccnl-os-time.h"
 #include "ccnl-logging.h"
 #include <string.h>
 #else
 #include "../include/ccnl-sched.h"
+#include "../include/ccnl-defs.h"
 #include "../include/ccnl-malloc.h"
 #include "../include/ccnl-os-time.h"
 #include "../include/ccnl-logging.h"
@@ -128,14 +130,238 @@ ccnl_sched_pktrate_new(void (cts)(void *aux1, void *aux2),
     return s;
 }
 
+struct ccnl_sched_s*
+ccnl_sched_drr_new(void (cts)(void *aux1, void *aux2),
+                   struct ccnl_relay_s *ccnl, int quantum,
+                   int inter_packet_interval)
+{
+    struct ccnl_sched_s *s;
+
+    DEBUGMSG(TRACE, "ccnl_sched_drr_new()\n");
+
+    s = (struct ccnl_sched_s*) ccnl_calloc(1, sizeof(struct ccnl_sched_s));
+    if (!s)
+        return NULL;
+    s->mode = 2;
+    s->cts = cts;
+    s->ccnl = ccnl;
+    s->quantum = quantum > 0 ? quantum : CCNL_SCHED_DRR_QUANTUM;
+#ifndef USE_CHEMFLOW
+    ccnl_get_timeval(&(s->nextTX));
+    s->ipi = inter_packet_interval;
+#else
+    (void) inter_packet_interval;
+#endif
+
+    return s;
+}
+
+struct ccnl_sched_s*
+ccnl_sched_drr_face_new(void (cts)(void *aux1, void *aux2),
+                        struct ccnl_sched_s *drr, int weight)
+{
+    struct ccnl_sched_s *s;
+
+    DEBUGMSG(TRACE, "ccnl_sched_drr_face_new()\n");
+
+    if (!ccnl_sched_is_drr(drr) ||
+        weight < 1 || weight > CCNL_SCHED_DRR_MAX_WEIGHT)
+        return NULL;
+    s = (struct ccnl_sched_s*) ccnl_calloc(1, sizeof(struct ccnl_sched_s));
+    if (!s)
+        return NULL;
+    s->mode = 3;
+    s->cts = cts;
+    s->ccnl = drr->ccnl;
+    s->parent = drr;
+    s->weight = weight;
+    s->sibling = drr->flows;
+    drr->flows = s;
+
+    return s;
+}
+
+int
+ccnl_sched_drr_weight(struct ccnl_sched_s *s, int weight)
+{
+    if (!s || s->mode != 3 ||
+        weight < 1 || weight > CCNL_SCHED_DRR_MAX_WEIGHT)
+        return -1;
+    s->weight = weight;
+    return 0;
+}
+
+int
+ccnl_sched_is_drr(struct ccnl_sched_s *s)
+{
+    return s && s->mode == 2;
+}
+
+// puts a face at the end of the round of its interface
+static void
+ccnl_sched_drr_append(struct ccnl_sched_s *s, struct ccnl_sched_s *f)
+{
+    f->next = NULL;
+    if (s->last)
+        s->last->next = f;
+    else
+        s->active = f;
+    s->last = f;
+    f->inround = 1;
+}
+
+// ends the turn of the face at the head of the round, a face without
+// packets leaves the round and keeps no credit for later
+static void
+ccnl_sched_drr_rotate(struct ccnl_sched_s *s)
+{
+    struct ccnl_sched_s *f = s->active;
+
+    s->active = f->next;
+    if (!s->active)
+        s->last = NULL;
+    f->turn = 0;
+    if (f->cnt > 0) {
+        ccnl_sched_drr_append(s, f);
+        return;
+    }
+    f->next = NULL;
+    f->inround = 0;
+    f->cnt = 0;
+    if (f->deficit > 0)
+        f->deficit = 0;
+}
+
+// takes a face away from its interface, it then sends like a dummy
+static void
+ccnl_sched_drr_unlink(struct ccnl_sched_s *f)
+{
+    struct ccnl_sched_s *s = f->parent, **pp, *prev = NULL;
+
+    for (pp = &s->flows; *pp; pp = &(*pp)->sibling) {
+        if (*pp == f) {
+            *pp = f->sibling;
+            break;
+        }
+    }
+    if (f->inround) {
+        for (pp = &s->active; *pp != f; pp = &(*pp)->next)
+            prev = *pp;
+        *pp = f->next;
+        if (s->last == f)
+            s->last = prev;
+    }
+    if (s->serving == f)
+        s->serving = NULL;
+    f->parent = f->sibling = f->next = NULL;
+    f->inround = f->turn = 0;
+    f->mode = 0;
+}
+
+// lets the faces in the round hand packets over until the interface
+// holds CCNL_SCHED_DRR_DEPTH of them
+static void
+ccnl_sched_drr_pull(struct ccnl_sched_s *s)
+{
+    struct ccnl_sched_s *f;
+    int cnt;
+
+    while (s->cnt < CCNL_SCHED_DRR_DEPTH && (f = s->active)) {
+        if (!f->turn) {
+            f->turn = 1;
+            f->deficit += (long) s->quantum * f->weight;
+        }
+        if (f->cnt <= 0 || f->deficit <= 0) {
+            ccnl_sched_drr_rotate(s);
+            continue;
+        }
+        cnt = f->cnt;
+        s->serving = f;
+        f->cts(f->aux1, f->aux2);
+        if (s->serving && f->cnt == cnt) {
+            // nothing arrived at the interface: the queue of the face
+            // was empty, or the interface dropped the packet
+            f->cnt--;
+        }
+        s->serving = NULL;
+    }
+}
+
+static void
+ccnl_sched_drr_timeout(void *aux1, void *aux2);
+
+// serves the faces and sends what they handed over, one send at a time
+static void
+ccnl_sched_drr_run(struct ccnl_sched_s *s)
+{
+#ifndef USE_CHEMFLOW
+    struct timeval now;
+    long since;
+#endif
+
+    if (s->running) {
+        // called back from a face or the link, the loop below goes on
+        return;
+    }
+    s->running = 1;
+    for (;;) {
+        ccnl_sched_drr_pull(s);
+        if (s->cnt <= 0 || s->txbusy)
+            break;
+#ifndef USE_CHEMFLOW
+        if (s->pendingTimer)
+            break;
+        if (s->ipi) {
+            ccnl_get_timeval(&now);
+            since = timevaldelta(&(s->nextTX), &now);
+            if (since > 0) {
+                DEBUGMSG(VERBOSE, "since=%ld\n", since);
+                s->pendingTimer = ccnl_set_timer((uint64_t) since,
+                                        ccnl_sched_drr_timeout, s, NULL);
+                break;
+            }
+            now.tv_sec += s->ipi / 1000000;
+            now.tv_usec += s->ipi % 1000000;
+            memcpy(&(s->nextTX), &now, sizeof(now));
+        }
+#endif
+        // a synchronous link reports the send before cts returns
+        s->txbusy = 1;
+        s->cts(s->aux1, s->aux2);
+    }
+    s->running = 0;
+}
+
+static void
+ccnl_sched_drr_timeout(void *aux1, void *aux2)
+{
+    struct ccnl_sched_s *s = (struct ccnl_sched_s*) aux1;
+
+    (void) aux2;
+#ifndef USE_CHEMFLOW
+    s->pendingTimer = NULL;
+#endif
+    ccnl_sched_drr_run(s);
+}
+
 void
 ccnl_sched_destroy(struct ccnl_sched_s *s)
 {
   DEBUGMSG(TRACE, "ccnl_sched_destroy %p\n", (void*)s);
 
     if (s) {
+        if (s->mode == 3) {
+            ccnl_sched_drr_unlink(s);
+        } else if (s->mode == 2) {
+            while (s->flows)
+                ccnl_sched_drr_unlink(s->flows);
+#ifndef USE_CHEMFLOW
+            if (s->pendingTimer)
+                ccnl_rem_timer(s->pendingTimer);
+#endif
+        }
 #ifdef USE_CHEMFLOW
-        if (s->mode) {
+        if (s->mode == 1) {
             s->q->minput->obj.destroylock = 0;
             s->q->moutput->obj.destroylock = 0;
             s->q->obj.destroylock = 0;
@@ -175,6 +401,21 @@ ccnl_sched_RTS(struct ccnl_sched_s *s, int cnt, int len,
         s->cts(aux1, aux2);
         return;
     }
+    if (s->mode == 2) {
+        // the face being served is charged what it handed over
+        if (s->serving) {
+            s->serving->cnt -= cnt;
+            s->serving->deficit -= len;
+        }
+        ccnl_sched_drr_run(s);
+        return;
+    }
+    if (s->mode == 3) {
+        if (!s->inround)
+            ccnl_sched_drr_append(s->parent, s);
+        ccnl_sched_drr_run(s->parent);
+        return;
+    }
 
 #ifdef USE_CHEMFLOW
     for (; cnt; --cnt) {
@@ -220,7 +461,16 @@ ccnl_sched_CTS_done(struct ccnl_sched_s *s, int cnt, int len)
     DEBUGMSG(VERBOSE, "ccnl_sched_CTS_done sched=%p/%d cnt=%d len=%d (mycnt=%d)\n",
              (void*)s, s->mode, cnt, len, s->cnt);
 
+    if (s->mode == 3) {
+        // the face was charged when it handed the packet over
+        return;
+    }
     s->cnt -= cnt;
+    if (s->mode == 2) {
+        s->txbusy = 0;
+        ccnl_sched_drr_run(s);
+        return;
+    }
     if (s->cnt <= 0)
         return;
 
@@ -423,6 +673,7 @@ static void ccnl_sched_cf_timeout(void *aux1, void *aux2)
 {
     DEBUGMSG(TRACE, "%s()\n", __func__);
 
+    engine_timer = NULL;
     cf_engine_execute_pending_reactions_and_set_timer(engine, ccnl_cf_now());
 }
 
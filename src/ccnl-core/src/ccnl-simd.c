@@ -0,0 +1,200 @@
+/*
+ * @f ccnl-simd.c
+ * @b CCN lite, vectorized byte comparison, selected at runtime
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-06-18 created
+ */
+
+#ifndef CCNL_LINUXKERNEL
+#include "ccnl-simd.h"
+#include <string.h>
+#else
+#include "../include/ccnl-simd.h"
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(CCNL_LINUXKERNEL) && !defined(CCNL_RIOT) && !defined(CCNL_ARDUINO)
+# define CCNL_SIMD_X86
+# include <immintrin.h>
+#endif
+
+typedef int (*ccnl_simd_equal_fn)(const uint8_t *a, const uint8_t *b, size_t len);
+
+static int ccnl_simd_equal_resolve(const uint8_t *a, const uint8_t *b, size_t len);
+
+static ccnl_simd_equal_fn ccnl_simd_equal_impl = ccnl_simd_equal_resolve;
+static int ccnl_simd_level = -1;
+
+static int
+ccnl_simd_equal_scalar(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint64_t x, y;
+    uint32_t u, v;
+
+    // two overlapping words cover anything up to twice the word size
+    if (len >= sizeof(x)) {
+        for (; len > sizeof(x); a += sizeof(x), b += sizeof(x), len -= sizeof(x)) {
+            memcpy(&x, a, sizeof(x));
+            memcpy(&y, b, sizeof(y));
+            if (x != y) {
+                return 0;
+            }
+        }
+        memcpy(&x, a + len - sizeof(x), sizeof(x));
+        memcpy(&y, b + len - sizeof(y), sizeof(y));
+        return x == y;
+    }
+    if (len >= sizeof(u)) {
+        memcpy(&u, a, sizeof(u));
+        memcpy(&v, b, sizeof(v));
+        if (u != v) {
+            return 0;
+        }
+        memcpy(&u, a + len - sizeof(u), sizeof(u));
+        memcpy(&v, b + len - sizeof(v), sizeof(v));
+        return u == v;
+    }
+    for (; len > 0; a++, b++, len--) {
+        if (*a != *b) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#ifdef CCNL_SIMD_X86
+
+__attribute__((target("sse2")))
+static int
+ccnl_simd_equal_sse2(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    __m128i x, y;
+    size_t i;
+
+    if (len < sizeof(x)) {
+        return ccnl_simd_equal_scalar(a, b, len);
+    }
+    for (i = 0; i + sizeof(x) < len; i += sizeof(x)) {
+        x = _mm_loadu_si128((const __m128i*) (a + i));
+        y = _mm_loadu_si128((const __m128i*) (b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff) {
+            return 0;
+        }
+    }
+    // the last block overlaps the one before instead of a byte loop
+    x = _mm_loadu_si128((const __m128i*) (a + len - sizeof(x)));
+    y = _mm_loadu_si128((const __m128i*) (b + len - sizeof(y)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xffff;
+}
+
+__attribute__((target("avx2")))
+static int
+ccnl_simd_equal_avx2(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    __m256i x, y;
+    size_t i;
+
+    if (len < sizeof(x)) {
+        return ccnl_simd_equal_sse2(a, b, len);
+    }
+    for (i = 0; i + sizeof(x) < len; i += sizeof(x)) {
+        x = _mm256_loadu_si256((const __m256i*) (a + i));
+        y = _mm256_loadu_si256((const __m256i*) (b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1) {
+            return 0;
+        }
+    }
+    x = _mm256_loadu_si256((const __m256i*) (a + len - sizeof(x)));
+    y = _mm256_loadu_si256((const __m256i*) (b + len - sizeof(y)));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) == -1;
+}
+
+#endif // CCNL_SIMD_X86
+
+// the widest level the CPU and the build support
+static int
+ccnl_simd_supported(void)
+{
+#ifdef CCNL_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return CCNL_SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return CCNL_SIMD_SSE2;
+    }
+#endif
+    return CCNL_SIMD_SCALAR;
+}
+
+int
+ccnl_simd_select(int level)
+{
+    int max = ccnl_simd_supported();
+
+    if (level > max) {
+        level = max;
+    }
+    switch (level) {
+#ifdef CCNL_SIMD_X86
+    case CCNL_SIMD_AVX2:
+        ccnl_simd_equal_impl = ccnl_simd_equal_avx2;
+        break;
+    case CCNL_SIMD_SSE2:
+        ccnl_simd_equal_impl = ccnl_simd_equal_sse2;
+        break;
+#endif
+    default:
+        level = CCNL_SIMD_SCALAR;
+        ccnl_simd_equal_impl = ccnl_simd_equal_scalar;
+        break;
+    }
+    ccnl_simd_level = level;
+    return level;
+}
+
+static int
+ccnl_simd_equal_resolve(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    ccnl_simd_select(CCNL_SIMD_AVX2);
+    return ccnl_simd_equal_impl(a, b, len);
+}
+
+int
+ccnl_simd_equal(const void *a, const void *b, size_t len)
+{
+    return ccnl_simd_equal_impl((const uint8_t*) a, (const uint8_t*) b, len);
+}
+
+const char*
+ccnl_simd_name(void)
+{
+    if (ccnl_simd_level < 0) {
+        ccnl_simd_select(CCNL_SIMD_AVX2);
+    }
+    switch (ccnl_simd_level) {
+    case CCNL_SIMD_AVX2:
+        return "avx2";
+    case CCNL_SIMD_SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+// eof
@@ -192,6 +192,81 @@ ccnl_addr_cmp(sockunion *s1, sockunion *s2)
     return -1;
 }
 
+// FNV-1a step, the bytes hashed are those which ccnl_addr_cmp compares
+static uint32_t
+ccnl_addr_hash_bytes(uint32_t h, const unsigned char *p, size_t len)
+{
+    while (len--) {
+        h = (h ^ *p++) * 16777619U;
+    }
+    return h;
+}
+
+uint32_t
+ccnl_addr_hash(sockunion *su)
+{
+    uint32_t h = 2166136261U;
+
+    if (!su) {
+        return 0;
+    }
+    switch (su->sa.sa_family) {
+
+#if defined(USE_LINKLAYER) && \
+    ((!defined(__FreeBSD__) && !defined(__APPLE__)) || \
+    (defined(CCNL_RIOT) && defined(__FreeBSD__)) ||  \
+    (defined(CCNL_RIOT) && defined(__APPLE__)) )
+        case AF_PACKET: {
+            size_t len = su->linklayer.sll_halen;
+            if (len > sizeof(su->linklayer.sll_addr)) {
+                len = sizeof(su->linklayer.sll_addr);
+            }
+            return ccnl_addr_hash_bytes(h, su->linklayer.sll_addr, len);
+        }
+#endif
+#ifdef USE_WPAN
+        case AF_IEEE802154:
+            h = ccnl_addr_hash_bytes(h, (const unsigned char*) &su->wpan.addr.pan_id,
+                                     sizeof(su->wpan.addr.pan_id));
+            switch (su->wpan.addr.addr_type) {
+                case IEEE802154_ADDR_SHORT:
+                    return ccnl_addr_hash_bytes(h, (const unsigned char*) &su->wpan.addr.addr.short_addr,
+                                                sizeof(su->wpan.addr.addr.short_addr));
+                case IEEE802154_ADDR_LONG:
+                    return ccnl_addr_hash_bytes(h, su->wpan.addr.addr.hwaddr,
+                                                sizeof(su->wpan.addr.addr.hwaddr));
+                default:
+                    return h;
+            }
+#endif
+#ifdef USE_IPV4
+        case AF_INET:
+            h = ccnl_addr_hash_bytes(h, (const unsigned char*) &su->ip4.sin_addr.s_addr,
+                                     sizeof(su->ip4.sin_addr.s_addr));
+            return ccnl_addr_hash_bytes(h, (const unsigned char*) &su->ip4.sin_port,
+                                        sizeof(su->ip4.sin_port));
+#endif
+#ifdef USE_IPV6
+        case AF_INET6:
+            h = ccnl_addr_hash_bytes(h, su->ip6.sin6_addr.s6_addr, 16);
+            return ccnl_addr_hash_bytes(h, (const unsigned char*) &su->ip6.sin6_port,
+                                        sizeof(su->ip6.sin6_port));
+#endif
+#ifdef USE_UNIXSOCKET
+        case AF_UNIX: {
+            size_t len = 0;
+            while (len < sizeof(su->ux.sun_path) && su->ux.sun_path[len]) {
+                len++;
+            }
+            return ccnl_addr_hash_bytes(h, (const unsigned char*) su->ux.sun_path, len);
+        }
+#endif
+        default:
+            break;
+    }
+    return 0;
+}
+
 char*
 ll2ascii(unsigned char *addr, size_t len)
 {
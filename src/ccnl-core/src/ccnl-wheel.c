@@ -0,0 +1,125 @@
+/*
+ * @f ccnl-wheel.c
+ * @b CCN lite, timer wheel indexing table entries by the second they are due
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-06-25 created
+ */
+
+#ifndef CCNL_LINUXKERNEL
+#include "ccnl-wheel.h"
+#else
+#include "../include/ccnl-wheel.h"
+#endif
+
+#define CCNL_WHEEL_MASK (CCNL_AGEING_WHEEL_SLOTS - 1)
+
+static void
+ccnl_wheel_push(struct ccnl_wheel_link_s **head, struct ccnl_wheel_link_s *link)
+{
+    link->prev = NULL;
+    link->next = *head;
+    if (*head) {
+        (*head)->prev = link;
+    }
+    *head = link;
+    link->head = head;
+}
+
+static void
+ccnl_wheel_unlink(struct ccnl_wheel_link_s *link)
+{
+    if (link->prev) {
+        link->prev->next = link->next;
+    } else {
+        *link->head = link->next;
+    }
+    if (link->next) {
+        link->next->prev = link->prev;
+    }
+    link->next = link->prev = NULL;
+    link->head = NULL;
+}
+
+void
+ccnl_wheel_add(struct ccnl_wheel_s *wheel, struct ccnl_wheel_link_s *link,
+               uint32_t due)
+{
+    if (link->head) {
+        ccnl_wheel_unlink(link);
+    } else {
+        wheel->count++;
+    }
+    if (due < wheel->next) {
+        due = wheel->next;
+    }
+    link->due = due;
+    ccnl_wheel_push(&wheel->slots[due & CCNL_WHEEL_MASK], link);
+}
+
+void
+ccnl_wheel_remove(struct ccnl_wheel_s *wheel, struct ccnl_wheel_link_s *link)
+{
+    if (!link->head) {
+        return;
+    }
+    ccnl_wheel_unlink(link);
+    wheel->count--;
+}
+
+void
+ccnl_wheel_advance(struct ccnl_wheel_s *wheel, uint32_t now)
+{
+    struct ccnl_wheel_link_s *link, *next;
+    uint32_t sec = wheel->next;
+
+    if (now < sec) {
+        return;
+    }
+    // after a long pause every slot is visited once
+    if (now - sec >= CCNL_AGEING_WHEEL_SLOTS) {
+        sec = now - CCNL_AGEING_WHEEL_SLOTS + 1;
+    }
+    for (;; sec++) {
+        for (link = wheel->slots[sec & CCNL_WHEEL_MASK]; link; link = next) {
+            next = link->next;
+            // entries of a later turn of the wheel stay
+            if (link->due <= now) {
+                ccnl_wheel_unlink(link);
+                ccnl_wheel_push(&wheel->expired, link);
+            }
+        }
+        if (sec == now) {
+            break;
+        }
+    }
+    wheel->next = now + 1;
+}
+
+struct ccnl_wheel_link_s*
+ccnl_wheel_pop(struct ccnl_wheel_s *wheel)
+{
+    struct ccnl_wheel_link_s *link = wheel->expired;
+
+    if (link) {
+        ccnl_wheel_unlink(link);
+        wheel->count--;
+    }
+    return link;
+}
+
+// eof
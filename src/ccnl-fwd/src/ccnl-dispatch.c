@@ -26,6 +26,7 @@
 #include "ccnl-localrpc.h"
 
 #include "ccnl-relay.h"
+#include "ccnl-arena.h"
 #include "ccnl-pkt-util.h"
 
 #include "ccnl-fwd.h"
@@ -45,6 +46,7 @@
 #include "../include/ccnl-localrpc.h"
 
 #include "../../ccnl-core/include/ccnl-relay.h"
+#include "../../ccnl-core/include/ccnl-arena.h"
 #include "../../ccnl-core/include/ccnl-pkt-util.h"
 
 #include "../include/ccnl-fwd.h"
@@ -69,7 +71,7 @@ ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
     struct ccnl_face_s *from;
     int32_t enc;
     int suite = -1;
-    size_t skip;
+    size_t skip, mark;
     dispatchFct dispatch;
     (void) enc;
 
@@ -93,6 +95,8 @@ ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
                     ccnl_addr2ascii(&from->peer));
     }
 
+    // what the decoders allocate is dropped with the frame, unless persisted
+    mark = ccnl_arena_enter(&ccnl_pkt_arena);
     // loop through all packets in the received frame (UDP, Ethernet etc)
     while (datalen > 0) {
         // work through explicit code switching
@@ -104,14 +108,14 @@ ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
         if (!ccnl_isSuite(suite)) {
             DEBUGMSG_CORE(WARNING, "?unknown packet format? ccnl_core_RX ifndx=%d, %zu bytes starting with 0x%02x at offset %zd\n",
                      ifndx, datalen, *data, (data - base));
-            return;
+            break;
         }
 
         dispatch = ccnl_core_suites[suite].RX;
         if (!dispatch) {
             DEBUGMSG_CORE(ERROR, "Forwarder not initialized or dispatcher "
                      "for suite %s does not exist.\n", ccnl_suite2str(suite));
-            return;
+            break;
         }
         if (dispatch(relay, from, &data, &datalen) < 0) {
             break;
@@ -120,6 +124,7 @@ ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
             DEBUGMSG_CORE(WARNING, "ccnl_core_RX: %zu bytes left\n", datalen);
         }
     }
+    ccnl_arena_leave(&ccnl_pkt_arena, mark);
 }
 
 // ----------------------------------------------------------------------
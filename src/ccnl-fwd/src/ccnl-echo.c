@@ -42,16 +42,15 @@ ccnl_echo_request(struct ccnl_relay_s *relay, struct ccnl_face_s *inface,
 //    if (pfx->chunknum) {
         // mkSimpleContent adds the chunk number, so remove it here
       /*
-        ccnl_free(pfx->chunknum);
-        pfx->chunknum = NULL;
+        pfx->chunknum = -1;
       */
 #ifdef USE_SUITE_CCNTLV
     if (pfx->complen[pfx->compcnt-1] > 1 &&
-        pfx->comp[pfx->compcnt-1][1] == CCNX_TLV_N_Chunk) {
+        ccnl_prefix_comp(pfx, pfx->compcnt-1)[1] == CCNX_TLV_N_Chunk) {
         struct ccnl_prefix_s *pfx2 = ccnl_prefix_dup(pfx);
         pfx2->compcnt--;
-        pfx2->chunknum = (int*) ccnl_malloc(sizeof(unsigned int));
-        *(pfx2->chunknum) = 0;
+        pfx2->chunknum = 0;
+        ccnl_prefix_rehash(pfx2);
         pfx = pfx2;
     }
 #endif
@@ -72,7 +71,7 @@ ccnl_echo_request(struct ccnl_relay_s *relay, struct ccnl_face_s *inface,
     len = reply->datalen;
 
     ccnl_core_suites[(int)pfx->suite].RX(relay, NULL, &ucp, &len);
-    ccnl_free(reply);
+    ccnl_buf_free(reply);
 }
 
 // insert forwarding entry with a tap - the prefix arg is consumed
@@ -78,25 +78,23 @@ ccnl_fwd_handleContent(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
 #if defined(USE_SUITE_CCNB) && defined(USE_SIGNATURES)
 //  FIXME: mgmt messages for NDN and other suites?
-        if (pkt->pfx->compcnt == 2 && !memcmp(pkt->pfx->comp[0], "ccnx", 4)
-                && !memcmp(pkt->pfx->comp[1], "crypto", 6) &&
+        if (pkt->pfx->compcnt == 2 && !memcmp(ccnl_prefix_comp(pkt->pfx, 0), "ccnx", 4)
+                && !memcmp(ccnl_prefix_comp(pkt->pfx, 1), "crypto", 6) &&
                 from == relay->crypto_face) {
             return ccnl_crypto(relay, pkt->buf, pkt->pfx, from);
         }
 #endif /* USE_SUITE_CCNB && USE_SIGNATURES*/
 #ifndef CCNL_LINUXKERNEL
-    if (ccnl_callback_rx_on_data(relay, from, *pkt)) {
+    if (ccnl_callback_rx_on_data(relay, from, pkt)) {
         *pkt = NULL;
         return 0;
     }
 #endif
 
     // CONFORM: Step 1:
-    for (c = relay->contents; c; c = c->next) {
-        if (ccnl_prefix_cmp(c->pkt->pfx, NULL, (*pkt)->pfx, CMP_EXACT) == 0) {
-            DEBUGMSG_CFWD(TRACE, "  content is duplicate, ignoring\n");
-            return 0; // content is dup, do nothing
-        }
+    if (ccnl_content_index_lookup(relay, (*pkt)->pfx)) {
+        DEBUGMSG_CFWD(TRACE, "  content is duplicate, ignoring\n");
+        return 0; // content is dup, do nothing
     }
 
     c = ccnl_content_new(pkt);
@@ -107,13 +105,19 @@ ccnl_fwd_handleContent(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     if (!ccnl_content_serve_pending(relay, c)) { // unsolicited content
         // CONFORM: "A node MUST NOT forward unsolicited data [...]"
         DEBUGMSG_CFWD(DEBUG, "  removed because no matching interest\n");
+#ifndef CCNL_LINUXKERNEL
+        ccnl_callback_on_unsolicited(relay, from, c->pkt);
+#endif
         ccnl_content_free(c);
         return 0;
     }
 
     if (relay->max_cache_entries != 0 && cache_strategy_cache(relay,c)) {
         DEBUGMSG_CFWD(DEBUG, "  adding content to cache\n");
-        ccnl_content_add2cache(relay, c);
+        if (!ccnl_content_add2cache(relay, c)) {
+            ccnl_content_free(c);
+            return 0;
+        }
         int contlen = (int) (c->pkt->contlen > INT_MAX ? INT_MAX : c->pkt->contlen);
         DEBUGMSG_CFWD(INFO, "data after creating packet %.*s\n", contlen, c->pkt->content);
     } else {
@@ -124,11 +128,11 @@ ccnl_fwd_handleContent(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 #ifdef USE_RONR
     /* if we receive a chunk, we assume more chunks of this content may be
      * retrieved along the same path */
-    if (c->pkt->pfx->chunknum) {
+    if (c->pkt->pfx->chunknum >= 0) {
         struct ccnl_prefix_s *pfx_wo_chunk = ccnl_prefix_dup(c->pkt->pfx);
         pfx_wo_chunk->compcnt--;
-        ccnl_free(pfx_wo_chunk->chunknum);
-        pfx_wo_chunk->chunknum = NULL;
+        pfx_wo_chunk->chunknum = -1;
+        ccnl_prefix_rehash(pfx_wo_chunk);
         ccnl_fib_add_entry(relay, pfx_wo_chunk, from);
     }
 #endif
@@ -141,8 +145,8 @@ int
 ccnl_fwd_handleFragment(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                         struct ccnl_pkt_s **pkt, dispatchFct callback)
 {
-    unsigned char *data = (*pkt)->content;
-    int datalen = (*pkt)->contlen;
+    uint8_t *data = (*pkt)->content;
+    size_t datalen = (*pkt)->contlen;
 
     if (from) {
         char *from_as_str = ccnl_addr2ascii(&(from->peer));
@@ -228,7 +232,7 @@ ccnl_fwd_handleInterest(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 #endif
 #if defined(USE_SUITE_CCNB) && defined(USE_MGMT)
     if ((*pkt)->suite == CCNL_SUITE_CCNB && (*pkt)->pfx->compcnt == 4 &&
-                                  !memcmp((*pkt)->pfx->comp[0], "ccnx", 4)) {
+                                  !memcmp(ccnl_prefix_comp((*pkt)->pfx, 0), "ccnx", 4)) {
         DEBUGMSG_CFWD(INFO, "  found a mgmt message\n");
         ccnl_mgmt(relay, (*pkt)->buf, (*pkt)->pfx, from); // use return value? // TODO uncomment
         return 0;
@@ -237,7 +241,7 @@ ccnl_fwd_handleInterest(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
 #ifdef USE_SUITE_NDNTLV
     if ((*pkt)->suite == CCNL_SUITE_NDNTLV && (*pkt)->pfx->compcnt == 4 &&
-        !memcmp((*pkt)->pfx->comp[0], "ccnx", 4)) {
+        !memcmp(ccnl_prefix_comp((*pkt)->pfx, 0), "ccnx", 4)) {
         DEBUGMSG_CFWD(INFO, "  found a mgmt message\n");
 #ifdef USE_MGMT
         ccnl_mgmt(relay, (*pkt)->buf, (*pkt)->pfx, from); // use return value?
@@ -249,13 +253,11 @@ ccnl_fwd_handleInterest(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
             // Step 1: search in content store
     DEBUGMSG_CFWD(DEBUG, "  searching in CS\n");
 
-    for (c = relay->contents; c; c = c->next) {
-        if (c->pkt->pfx->suite != (*pkt)->pfx->suite)
-            continue;
-        if (cMatch(*pkt, c))
-            continue;
-
+    c = ccnl_content_index_match(relay, *pkt, cMatch);
+    if (c) {
         DEBUGMSG_CFWD(DEBUG, "  found matching content %p\n", (void *) c);
+        c->served_cnt++;
+        ccnl_content_repl_touch(relay, c);
 
         if (from) {
             if (from->ifndx >= 0) {
@@ -271,9 +273,7 @@ ccnl_fwd_handleInterest(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     }
 
     // CONFORM: Step 2: check whether interest is already known
-    for (i = relay->pit; i; i = i->next)
-        if (ccnl_interest_isSame(i, *pkt))
-            break;
+    i = ccnl_interest_index_lookup(relay, *pkt);
 
     if (!i) { // this is a new/unknown I request: create and propagate
         propagate = 1;
@@ -311,7 +311,7 @@ ccnl_ccnb_fwd(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
     DEBUGMSG_CFWD(DEBUG, "ccnb fwd (%zu bytes left)\n", *datalen);
 
-    pkt = ccnl_ccnb_bytes2pkt(*data - 2, data, datalen);
+    pkt = ccnl_ccnb_bytes2pkt_rx(*data - 2, data, datalen, relay->rxbuf);
     if (!pkt) {
         DEBUGMSG_CFWD(WARNING, "  parsing error or no prefix\n");
         goto Done;
@@ -460,7 +460,7 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 #ifdef USE_FRAG
     if (hp->pkttype == CCNX_PT_Fragment) {
         uint16_t *sp = (uint16_t*) *data;
-        int fraglen = ntohs(*(sp+1));
+        size_t fraglen = ntohs(*(sp+1));
 
         if (ntohs(*sp) == CCNX_TLV_TL_Fragment && fraglen == (payloadlen-4)) {
             uint16_t fragfields; // = *(uint16_t *) &hp->fill;
@@ -475,15 +475,15 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                             relay->ifs[from->ifndx].mtu, fragfields >> 14,
                             fragfields & 0x3fff, data, datalen);
 
-            DEBUGMSG_CFWD(TRACE, "  done (fraglen=%d, payloadlen=%d, *datalen=%d)\n",
+            DEBUGMSG_CFWD(TRACE, "  done (fraglen=%zu, payloadlen=%zu, *datalen=%zu)\n",
                      fraglen, payloadlen, *datalen);
         } else {
-            DEBUGMSG_CFWD(DEBUG, "  problem with frag type or length (%d, %d, %d)\n",
+            DEBUGMSG_CFWD(DEBUG, "  problem with frag type or length (%d, %zu, %zu)\n",
                      ntohs(*sp), fraglen, payloadlen);
             *data += payloadlen;
             *datalen -= payloadlen;
         }
-        DEBUGMSG_CFWD(TRACE, "  returning after fragment: %d bytes\n", *datalen);
+        DEBUGMSG_CFWD(TRACE, "  returning after fragment: %zu bytes\n", *datalen);
         return 0;
     } else {
         DEBUGMSG_CFWD(TRACE, "  not a fragment, continueing\n");
@@ -494,7 +494,7 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         DEBUGMSG_CFWD(TRACE, "  local data, datalen=%zu\n", *datalen);
     }
 
-    pkt = ccnl_ccntlv_bytes2pkt(start, data, datalen);
+    pkt = ccnl_ccntlv_bytes2pkt_rx(start, data, datalen, relay->rxbuf);
     if (!pkt) {
         DEBUGMSG_CFWD(WARNING, "  parsing error or no prefix\n");
         goto Done;
@@ -555,7 +555,8 @@ ccnl_ndntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         DEBUGMSG_CFWD(TRACE, "  invalid packet format\n");
         return -1;
     }
-    pkt = ccnl_ndntlv_bytes2pkt(typ, start, data, datalen);
+    pkt = ccnl_ndntlv_bytes2pkt_rx(typ, start, data, datalen,
+                                   relay->rxbuf);
     if (!pkt) {
         DEBUGMSG_CFWD(INFO, "  ndntlv packet coding problem\n");
         goto Done;
@@ -598,7 +599,7 @@ int
 ccnl_set_tap(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
              tapCallback callback)
 {
-    struct ccnl_forward_s *fwd, **fwd2;
+    struct ccnl_forward_s *fwd;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
@@ -606,25 +607,21 @@ ccnl_set_tap(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
              ccnl_prefix_to_str(pfx,s,CCNL_MAX_PREFIX_SIZE),
              ccnl_suite2str(pfx->suite));
 
-    for (fwd = relay->fib; fwd; fwd = fwd->next) {
-        if (fwd->suite == pfx->suite &&
-                        !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) {
-            ccnl_prefix_free(fwd->prefix);
-            fwd->prefix = NULL;
-            break;
-        }
-    }
-    if (!fwd) {
+    fwd = ccnl_fib_lookup(relay, pfx);
+    if (fwd) {
+        // the entry keeps its prefix, which readers may hold
+        ccnl_prefix_free(pfx);
+    } else {
         fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
         if (!fwd)
             return -1;
-        fwd2 = &relay->fib;
-        while (*fwd2)
-            fwd2 = &((*fwd2)->next);
-        *fwd2 = fwd;
         fwd->suite = pfx->suite;
+        fwd->prefix = pfx;
+        if (ccnl_fib_link(relay, fwd)) {
+            ccnl_free(fwd);
+            return -1;
+        }
     }
-    fwd->prefix = pfx;
     fwd->tap = callback;
     return 0;
 }
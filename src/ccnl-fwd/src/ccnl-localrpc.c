@@ -218,7 +218,7 @@ ccnl_emit_RpcReturn(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     len = sizeof(tmp);
     if (ccnl_switch_prependCoding(CCNL_ENC_LOCALRPC, &len, tmp, &switchlen)) {
         ccnl_rdr_free(seq);
-        ccnl_free(pkt);
+        ccnl_buf_free(pkt);
         return -1;
     }
 
@@ -227,7 +227,7 @@ ccnl_emit_RpcReturn(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     if (ccnl_rdr_serialize(seq, pkt->data + switchlen,
                            pkt->datalen - switchlen, &len)) {
         ccnl_rdr_free(seq);
-        ccnl_free(pkt);
+        ccnl_buf_free(pkt);
         return -1;
     }
     ccnl_rdr_free(seq);
@@ -125,6 +125,8 @@ kfree(ptr);
 #include "../../ccnl-core/src/ccnl-sched.c"
 #include "../../ccnl-core/src/ccnl-interest.c"
 #include "../../ccnl-core/src/ccnl-content.c"
+#include "../../ccnl-core/src/ccnl-forward.c"
+#include "../../ccnl-core/src/ccnl-face.c"
 #include "../../ccnl-core/src/ccnl-if.c"
 #include "../../ccnl-core/src/ccnl-buf.c"
 #include "../../ccnl-core/src/ccnl-pkt-util.c"
@@ -94,6 +94,18 @@ ccnl_ccnb_dehead(uint8_t **buf, size_t *len, uint64_t *num, uint8_t *typ);
 struct ccnl_pkt_s*
 ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen);
 
+/**
+ * @brief Like \ref ccnl_ccnb_bytes2pkt, but keeps the packet in @p rxbuf
+ *
+ * If the packet lies within @p rxbuf, the returned packet's buf is a
+ * share of it, see \ref ccnl_buf_slice, instead of a copy.
+ *
+ * @param[in] rxbuf The buffer the packet was received into, may be NULL
+ */
+struct ccnl_pkt_s*
+ccnl_ccnb_bytes2pkt_rx(uint8_t *start, uint8_t **data, size_t *datalen,
+                       struct ccnl_buf_s *rxbuf);
+
 int8_t
 ccnl_ccnb_cMatch(struct ccnl_pkt_s *p, struct ccnl_content_s *c);
 
@@ -185,6 +185,18 @@ ccnl_ccntlv_dehead(uint8_t **buf, size_t *len,
 struct ccnl_pkt_s*
 ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen);
 
+/**
+ * @brief Like \ref ccnl_ccntlv_bytes2pkt, but keeps the packet in @p rxbuf
+ *
+ * If the packet lies within @p rxbuf, the returned packet's buf is a
+ * share of it, see \ref ccnl_buf_slice, instead of a copy.
+ *
+ * @param[in] rxbuf The buffer the packet was received into, may be NULL
+ */
+struct ccnl_pkt_s*
+ccnl_ccntlv_bytes2pkt_rx(uint8_t *start, uint8_t **data, size_t *datalen,
+                         struct ccnl_buf_s *rxbuf);
+
 int8_t
 ccnl_ccntlv_cMatch(struct ccnl_pkt_s *p, struct ccnl_content_s *c);
 
@@ -222,4 +234,21 @@ ccnl_ccntlv_prependFixedHdr(uint8_t ver,
                             uint8_t hoplimit,
                             size_t *offset, uint8_t *buf);
 
+#ifdef USE_FRAG
+struct ccnl_frag_s;
+
+/**
+ * @brief Writes the header of the next BeginEnd2015 fragment of fr->bigpkt
+ *
+ * Same as \ref ccnl_ndntlv_mkFragHdr, for a fixed header and a Fragment
+ * TLV.
+ */
+int8_t
+ccnl_ccntlv_mkFragHdr(struct ccnl_frag_s *fr, uint8_t *hdr,
+                      size_t *hdrlen, size_t *datalen);
+
+struct ccnl_buf_s*
+ccnl_ccntlv_mkFrag(struct ccnl_frag_s *fr, unsigned int *consumed);
+#endif
+
 #endif // eof
@@ -36,6 +36,7 @@
 #include "../../ccnl-core/include/ccnl-content.h"
 #endif
 
+struct ccnl_buf_s;
 
 /**
  * Default interest lifetime in milliseconds. If the element is omitted by a user, a default
@@ -174,6 +175,19 @@ struct ccnl_pkt_s*
 ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
                       uint8_t **data, size_t *datalen);
 
+/**
+ * @brief Like \ref ccnl_ndntlv_bytes2pkt, but keeps the packet in @p rxbuf
+ *
+ * If the packet lies within @p rxbuf, the returned packet's buf is a
+ * share of it, see \ref ccnl_buf_slice, instead of a copy.
+ *
+ * @param[in] rxbuf The buffer the packet was received into, may be NULL
+ */
+struct ccnl_pkt_s*
+ccnl_ndntlv_bytes2pkt_rx(uint64_t pkttype, uint8_t *start,
+                         uint8_t **data, size_t *datalen,
+                         struct ccnl_buf_s *rxbuf);
+
 int8_t
 ccnl_ndntlv_cMatch(struct ccnl_pkt_s *p, struct ccnl_content_s *c);
 
@@ -207,4 +221,28 @@ int8_t
 ccnl_ndntlv_prependName(struct ccnl_prefix_s *name,
                         size_t *offset, uint8_t *buf);
 
+#ifdef USE_FRAG
+struct ccnl_frag_s;
+
+/**
+ * @brief Writes the header of the next BeginEnd2015 fragment of fr->bigpkt
+ *
+ * The fragment carries the @p datalen bytes at fr->sendoffs right after
+ * the header. Nothing in @p fr is changed.
+ *
+ * @param[in]  fr      The fragmentation state of the face
+ * @param[out] hdr     Receives the header, room for CCNL_FRAG_HDR_MAX bytes
+ * @param[out] hdrlen  Length of the header
+ * @param[out] datalen Bytes of the packet the fragment carries
+ *
+ * @return 0 on success, -1 if the mtu leaves no room for data
+ */
+int8_t
+ccnl_ndntlv_mkFragHdr(struct ccnl_frag_s *fr, uint8_t *hdr,
+                      size_t *hdrlen, size_t *datalen);
+
+struct ccnl_buf_s*
+ccnl_ndntlv_mkFrag(struct ccnl_frag_s *fr, unsigned int *consumed);
+#endif
+
 #endif // EOF
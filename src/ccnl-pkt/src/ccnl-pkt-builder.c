@@ -148,20 +148,20 @@ ccnl_isFragment(uint8_t *buf, size_t len, int suite)
 struct ccnl_interest_s *
 ccnl_mkInterestObject(struct ccnl_prefix_s *name, ccnl_interest_opts_u *opts)
 {
-    struct ccnl_interest_s *i = (struct ccnl_interest_s *) ccnl_calloc(1,
-                                                                       sizeof(struct ccnl_interest_s));
+    struct ccnl_interest_s *i = (struct ccnl_interest_s *) ccnl_pool_calloc(CCNL_POOL(INTEREST),
+                                                                            sizeof(struct ccnl_interest_s));
     if (!i) {
         return NULL;
     }
-    i->pkt = (struct ccnl_pkt_s *) ccnl_calloc(1, sizeof(struct ccnl_pkt_s));
+    i->pkt = (struct ccnl_pkt_s *) ccnl_pool_calloc(CCNL_POOL(PKT), sizeof(struct ccnl_pkt_s));
     if (!i->pkt) {
-        ccnl_free(i);
+        ccnl_pool_free(CCNL_POOL(INTEREST), i);
         return NULL;
     }
     i->pkt->buf = ccnl_mkSimpleInterest(name, opts);
     if (!i->pkt->buf) {
         ccnl_pkt_free(i->pkt);
-        ccnl_free(i);
+        ccnl_pool_free(CCNL_POOL(INTEREST), i);
         return NULL;
     }
     i->pkt->pfx = ccnl_prefix_dup(name);
@@ -169,30 +169,51 @@ ccnl_mkInterestObject(struct ccnl_prefix_s *name, ccnl_interest_opts_u *opts)
     return i;
 }
 
+// encoding scratch space, from the packet arena when it has room
+static uint8_t*
+ccnl_mkScratch(size_t *mark)
+{
+    uint8_t *tmp;
+
+    *mark = ccnl_arena_mark(&ccnl_pkt_arena);
+    tmp = (uint8_t*) ccnl_arena_alloc(&ccnl_pkt_arena, CCNL_MAX_PACKET_SIZE);
+    return tmp ? tmp : (uint8_t*) ccnl_malloc(CCNL_MAX_PACKET_SIZE);
+}
+
+static void
+ccnl_freeScratch(uint8_t *tmp, size_t mark)
+{
+    if (ccnl_arena_owns(&ccnl_pkt_arena, tmp)) {
+        ccnl_arena_reset(&ccnl_pkt_arena, mark);
+    } else {
+        ccnl_free(tmp);
+    }
+}
+
 struct ccnl_buf_s*
 ccnl_mkSimpleInterest(struct ccnl_prefix_s *name, ccnl_interest_opts_u *opts)
 {
     struct ccnl_buf_s *buf = NULL;
     uint8_t *tmp;
-    size_t len = 0, offs;
+    size_t len = 0, offs, mark;
     struct ccnl_prefix_s *prefix;
     (void)prefix;
 
-    tmp = (uint8_t*) ccnl_malloc(CCNL_MAX_PACKET_SIZE);
+    tmp = ccnl_mkScratch(&mark);
     if (!tmp) {
         return NULL;
     }
     offs = CCNL_MAX_PACKET_SIZE;
 
     if (ccnl_mkInterest(name, opts, tmp, tmp + CCNL_MAX_PACKET_SIZE, &len, &offs)) {
-        ccnl_free(tmp);
+        ccnl_freeScratch(tmp, mark);
         return NULL;
     }
 
     if (len > 0) {
         buf = ccnl_buf_new(tmp + offs, len);
     }
-    ccnl_free(tmp);
+    ccnl_freeScratch(tmp, mark);
 
     return buf;
 }
@@ -253,7 +274,7 @@ ccnl_mkContentObject(struct ccnl_prefix_s *name,
                      ccnl_data_opts_u *opts)
 {
     size_t dataoffset = 0;
-    struct ccnl_pkt_s *c_p = ccnl_calloc(1, sizeof(struct ccnl_pkt_s));
+    struct ccnl_pkt_s *c_p = ccnl_pool_calloc(CCNL_POOL(PKT), sizeof(struct ccnl_pkt_s));
     if (!c_p) {
         return NULL;
     }
@@ -280,7 +301,7 @@ ccnl_mkSimpleContent(struct ccnl_prefix_s *name,
 {
     struct ccnl_buf_s *buf = NULL;
     uint8_t *tmp;
-    size_t len = 0, contentpos = 0, offs;
+    size_t len = 0, contentpos = 0, offs, mark;
     struct ccnl_prefix_s *prefix;
     (void)prefix;
     char s[CCNL_MAX_PREFIX_SIZE];
@@ -290,14 +311,14 @@ ccnl_mkSimpleContent(struct ccnl_prefix_s *name,
                   ccnl_prefix_to_str(name, s, CCNL_MAX_PREFIX_SIZE),
                   paylen);
 
-    tmp = (uint8_t*) ccnl_malloc(CCNL_MAX_PACKET_SIZE);
+    tmp = ccnl_mkScratch(&mark);
     if (!tmp) {
         return NULL;
     }
     offs = CCNL_MAX_PACKET_SIZE;
 
     if (ccnl_mkContent(name, payload, paylen, tmp, &len, &contentpos, &offs, opts)) {
-        ccnl_free(tmp);
+        ccnl_freeScratch(tmp, mark);
         return NULL;
     }
 
@@ -307,7 +328,7 @@ ccnl_mkSimpleContent(struct ccnl_prefix_s *name,
             *payoffset = contentpos;
         }
     }
-    ccnl_free(tmp);
+    ccnl_freeScratch(tmp, mark);
 
     return buf;
 }
@@ -134,8 +134,58 @@ ccnl_ccnb_data2uint(uint8_t *cp, size_t len, uint64_t *retval)
     return 0;
 }
 
+// Walks the components of a Name up to its end marker: counts them and,
+// if p is given, stores them in p relative to start.
+static int8_t
+ccnl_ccnb_walkName(uint8_t *start, uint8_t **data, size_t *datalen,
+                   struct ccnl_prefix_s *p, uint32_t *cnt)
+{
+    uint64_t num;
+    uint8_t typ;
+
+    *cnt = 0;
+    for (;;) {
+        if (ccnl_ccnb_dehead(data, datalen, &num, &typ)) {
+            return -1;
+        }
+        if (num == 0 && typ == 0) {
+            break;
+        }
+        if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT &&
+            *cnt < CCNL_MAX_NAME_COMP) {
+            uint8_t *comp = *data;
+            size_t complen = 0;
+
+            if (ccnl_ccnb_hunt_for_end(data, datalen, &comp, &complen)) {
+                return -1;
+            }
+            if (p) {
+                if ((size_t) (comp - start) > (ccnl_compoff_t) -1 ||
+                    complen > (ccnl_compoff_t) -1) {
+                    return -1;
+                }
+                p->compoff[*cnt] = (ccnl_compoff_t) (comp - start);
+                p->complen[*cnt] = (ccnl_compoff_t) complen;
+            }
+            (*cnt)++;
+        } else {
+            if (ccnl_ccnb_consume(typ, num, data, datalen, 0, 0)) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
 struct ccnl_pkt_s*
 ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
+{
+    return ccnl_ccnb_bytes2pkt_rx(start, data, datalen, NULL);
+}
+
+struct ccnl_pkt_s*
+ccnl_ccnb_bytes2pkt_rx(uint8_t *start, uint8_t **data, size_t *datalen,
+                       struct ccnl_buf_s *rxbuf)
 {
     struct ccnl_pkt_s *pkt;
     uint8_t *cp;
@@ -146,8 +196,7 @@ ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
 
     DEBUGMSG(TRACE, "ccnl_ccnb_extract\n");
 
-    //pkt = (struct ccnl_pkt_s *) ccnl_calloc(1, sizeof(*pkt));
-    pkt = (struct ccnl_pkt_s *) ccnl_calloc(1, sizeof(*pkt));
+    pkt = ccnl_pkt_new_rx();
     if (!pkt) {
         return NULL;
     }
@@ -157,12 +206,7 @@ ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
     pkt->s.ccnb.aok = 3;
     pkt->s.ccnb.maxsuffix = CCNL_MAX_NAME_COMP;
 
-    pkt->pfx = p = ccnl_prefix_new(CCNL_SUITE_CCNB, CCNL_MAX_NAME_COMP);
-    if (!p) {
-        ccnl_free(pkt);
-        return NULL;
-    }
-    p->compcnt = 0;
+    p = NULL;
 
     oldpos = *data - start;
     while (!ccnl_ccnb_dehead(data, datalen, &num, &typ)) {
@@ -171,30 +215,32 @@ ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
         }
         if (typ == CCN_TT_DTAG) {
             switch (num) {
-            case CCN_DTAG_NAME:
+            case CCN_DTAG_NAME: {
+                uint8_t *cp = *data;
+                size_t len2 = *datalen;
+                uint32_t cnt;
+
+                if (p) {
+                    DEBUGMSG(WARNING, "  ccnb: name already defined\n");
+                    goto Bail;
+                }
+                // count the components first, the prefix is allocated to fit
+                if (ccnl_ccnb_walkName(start, &cp, &len2, NULL, &cnt)) {
+                    goto Bail;
+                }
+                pkt->pfx = p = ccnl_prefix_new_rx(CCNL_SUITE_CCNB, cnt);
+                if (!p) {
+                    goto Bail;
+                }
+                p->base = start;
                 p->nameptr = start + oldpos;
-                for (;;) {
-                    if (ccnl_ccnb_dehead(data, datalen, &num, &typ)) {
-                        goto Bail;
-                    }
-                    if (num == 0 && typ == 0) {
-                        break;
-                    }
-                    if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT &&
-                        p->compcnt < CCNL_MAX_NAME_COMP) {
-                        if (ccnl_ccnb_hunt_for_end(data, datalen, p->comp + p->compcnt,
-                                                   (p->complen + p->compcnt))) {
-                            goto Bail;
-                        }
-                        p->compcnt++;
-                    } else {
-                        if (ccnl_ccnb_consume(typ, num, data, datalen, 0, 0)) {
-                            goto Bail;
-                        }
-                    }
+                if (ccnl_ccnb_walkName(start, data, datalen, p, &p->compcnt)) {
+                    goto Bail;
                 }
                 p->namelen = *data - p->nameptr;
+                ccnl_prefix_rehash(p);
                 break;
+            }
             case CCN_DTAG_CONTENT: {
                 if (ccnl_ccnb_consume(typ, num, data, datalen,
                                       &pkt->content, &pkt->contlen)) {
@@ -254,7 +300,7 @@ ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
                 }
                 case CCN_DTAG_NONCE:
                     if (!pkt->s.ccnb.nonce) {
-                        pkt->s.ccnb.nonce = ccnl_buf_new(cp, len);
+                        pkt->s.ccnb.nonce = ccnl_buf_new_rx(cp, len);
                         if (!pkt->s.ccnb.nonce) {
                             goto Bail;
                         }
@@ -262,7 +308,7 @@ ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
                     break;
                 case CCN_DTAG_PUBPUBKDIGEST:
                     if (!pkt->s.ccnb.ppkd) {
-                        pkt->s.ccnb.ppkd = ccnl_buf_new(cp, len);
+                        pkt->s.ccnb.ppkd = ccnl_buf_new_rx(cp, len);
                         if (!pkt->s.ccnb.ppkd) {
                             goto Bail;
                         }
@@ -289,15 +335,25 @@ ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
         }
         oldpos = *data - start;
     }
-    pkt->pfx = p;
+    if (!p) {
+        pkt->pfx = p = ccnl_prefix_new_rx(CCNL_SUITE_CCNB, 0);
+        if (!p) {
+            goto Bail;
+        }
+    }
+    pkt->buf = ccnl_buf_slice(rxbuf, start, *data - start);
+    if (pkt->buf) {
+        return pkt;
+    }
     pkt->buf = ccnl_buf_new(start, *data - start);
+    if (!pkt->buf) {
+        goto Bail;
+    }
     // carefully rebase ptrs to new buf because of 64bit pointers:
     if (pkt->content) {
         pkt->content = pkt->buf->data + (pkt->content - start);
     }
-    for (num = 0; num < p->compcnt; num++) {
-        p->comp[num] = pkt->buf->data + (p->comp[num] - start);
-    }
+    p->base = pkt->buf->data;
     if (p->nameptr) {
         p->nameptr = pkt->buf->data + (p->nameptr - start);
     }
@@ -527,7 +583,7 @@ ccnl_ccnb_mkName(struct ccnl_prefix_s *name, uint8_t *out, const uint8_t *bufend
         return -1;
     }
     for (i = 0; i < name->compcnt; i++) {
-        if (ccnl_ccnb_mkComponent(name->comp[i], name->complen[i], out+len, bufend, &len)) {
+        if (ccnl_ccnb_mkComponent(ccnl_prefix_comp(name, i), name->complen[i], out+len, bufend, &len)) {
             return -1;
         }
     }
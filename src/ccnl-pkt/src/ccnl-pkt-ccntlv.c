@@ -109,10 +109,79 @@ ccnl_ccntlv_dehead(uint8_t **buf, size_t *len,
     return 0;
 }
 
+// Walks the components in the value of a Name TLV: counts them and, if p
+// is given, stores them in p relative to start.
+static int8_t
+ccnl_ccntlv_walkName(uint8_t *start, uint8_t *cp, size_t len2,
+                     struct ccnl_prefix_s *p, uint32_t *cnt)
+{
+    uint8_t *cp2;
+    size_t len3;
+    uint16_t typ;
+
+    *cnt = 0;
+    while (len2 > 0) {
+        cp2 = cp;
+        if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3)) {
+            return -1;
+        }
+
+        switch (typ) {
+        case CCNX_TLV_N_Chunk:
+            // We extract the chunknum to the prefix but keep it
+            // in the name component for now. In the future we
+            // possibly want to remove the chunk segment from the
+            // name components and rely on the chunknum field in
+            // the prefix.
+            if (p) {
+                uint32_t chunknum;
+
+                if (ccnl_ccnltv_extractNetworkVarInt(cp, len3, &chunknum) < 0) {
+                    DEBUGMSG_PCNX(WARNING, "Error in NetworkVarInt for chunk\n");
+                    return -1;
+                }
+                p->chunknum = chunknum;
+            }
+            // fall through
+        case CCNX_TLV_N_NameSegment:
+            if (*cnt < CCNL_MAX_NAME_COMP) {
+                if (p) {
+                    if ((size_t) (cp2 - start) > (ccnl_compoff_t) -1 ||
+                        (size_t) (cp - cp2) + len3 > (ccnl_compoff_t) -1) {
+                        return -1;
+                    }
+                    p->compoff[*cnt] = (ccnl_compoff_t) (cp2 - start);
+                    p->complen[*cnt] = (ccnl_compoff_t) (cp - cp2 + len3);
+                }
+                (*cnt)++;
+            } // else out of name component memory: skip
+            break;
+        case CCNX_TLV_N_Meta:
+            if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3)) {
+                DEBUGMSG_PCNX(WARNING, "error when extracting CCNX_TLV_M_MetaData\n");
+                return -1;
+            }
+            break;
+        default:
+            break;
+        }
+        cp += len3;
+        len2 -= len3;
+    }
+    return 0;
+}
+
 // We use one extraction procedure for both interest and data pkts.
 // This proc assumes that the packet header was already processed and consumed
 struct ccnl_pkt_s*
 ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
+{
+    return ccnl_ccntlv_bytes2pkt_rx(start, data, datalen, NULL);
+}
+
+struct ccnl_pkt_s*
+ccnl_ccntlv_bytes2pkt_rx(uint8_t *start, uint8_t **data, size_t *datalen,
+                         struct ccnl_buf_s *rxbuf)
 {
     struct ccnl_pkt_s *pkt;
     struct ccnl_prefix_s *p;
@@ -126,17 +195,12 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
 
     DEBUGMSG_PCNX(TRACE, "ccnl_ccntlv_bytes2pkt len=%zu\n", *datalen);
 
-    pkt = (struct ccnl_pkt_s*) ccnl_calloc(1, sizeof(*pkt));
+    pkt = ccnl_pkt_new_rx();
     if (!pkt) {
         return NULL;
     }
 
-    pkt->pfx = p = ccnl_prefix_new(CCNL_SUITE_CCNTLV, CCNL_MAX_NAME_COMP);
-    if (!p) {
-        ccnl_free(pkt);
-        return NULL;
-    }
-    p->compcnt = 0;
+    p = NULL;
 
 #ifdef USE_HMAC256
     pkt->hmacStart = *data;
@@ -156,7 +220,7 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
     // checks, as some packets with wrong L values can bring this to crash
     oldpos = *data - start;
     while (ccnl_ccntlv_dehead(data, datalen, &typ, &len) == 0) {
-        uint8_t *cp = *data, *cp2;
+        uint8_t *cp = *data;
         size_t len2 = len;
         size_t len3;
 
@@ -165,52 +229,25 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
         }
         switch (typ) {
         case CCNX_TLV_M_Name:
+            if (p) {
+                DEBUGMSG_PCNX(WARNING, "name already defined\n");
+                goto Bail;
+            }
+            // count the components first, the prefix is allocated to fit
+            if (ccnl_ccntlv_walkName(start, cp, len2, NULL, &i)) {
+                goto Bail;
+            }
+            pkt->pfx = p = ccnl_prefix_new_rx(CCNL_SUITE_CCNTLV, i);
+            if (!p) {
+                goto Bail;
+            }
+            p->base = start;
             p->nameptr = start + oldpos;
-            while (len2 > 0) {
-                cp2 = cp;
-                if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3) || len>*datalen) {
-                    goto Bail;
-                }
-
-                switch (typ) {
-                case CCNX_TLV_N_Chunk:
-                    // We extract the chunknum to the prefix but keep it
-                    // in the name component for now. In the future we
-                    // possibly want to remove the chunk segment from the
-                    // name components and rely on the chunknum field in
-                    // the prefix.
-                  p->chunknum = (uint32_t *) ccnl_malloc(sizeof(uint32_t));
-
-                    if (ccnl_ccnltv_extractNetworkVarInt(cp, len3, p->chunknum) < 0) {
-                        DEBUGMSG_PCNX(WARNING, "Error in NetworkVarInt for chunk\n");
-                        goto Bail;
-                    }
-                    if (p->compcnt < CCNL_MAX_NAME_COMP) {
-                        p->comp[p->compcnt] = cp2;
-                        p->complen[p->compcnt] = cp - cp2 + len3;
-                        p->compcnt++;
-                    } // else out of name component memory: skip
-                    break;
-                case CCNX_TLV_N_NameSegment:
-                    if (p->compcnt < CCNL_MAX_NAME_COMP) {
-                        p->comp[p->compcnt] = cp2;
-                        p->complen[p->compcnt] = cp - cp2 + len3;
-                        p->compcnt++;
-                    } // else out of name component memory: skip
-                    break;
-                case CCNX_TLV_N_Meta:
-                    if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3) || len > *datalen) {
-                        DEBUGMSG_PCNX(WARNING, "error when extracting CCNX_TLV_M_MetaData\n");
-                        goto Bail;
-                    }
-                    break;
-                default:
-                    break;
-                }
-                cp += len3;
-                len2 -= len3;
+            if (ccnl_ccntlv_walkName(start, cp, len2, p, &p->compcnt)) {
+                goto Bail;
             }
-            p->namelen = *data - p->nameptr;
+            p->namelen = *data + len - p->nameptr;
+            ccnl_prefix_rehash(p);
             break;
         case CCNX_TLV_M_ENDChunk: {
             uint32_t final_block_id;
@@ -255,7 +292,16 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
         goto Bail;
     }
 
-    pkt->pfx = p;
+    if (!p) {
+        pkt->pfx = p = ccnl_prefix_new_rx(CCNL_SUITE_CCNTLV, 0);
+        if (!p) {
+            goto Bail;
+        }
+    }
+    pkt->buf = ccnl_buf_slice(rxbuf, start, *data - start);
+    if (pkt->buf) {
+        return pkt;
+    }
     pkt->buf = ccnl_buf_new(start, *data - start);
     if (!pkt->buf) {
         goto Bail;
@@ -264,9 +310,7 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
     if (pkt->content) {
         pkt->content = pkt->buf->data + (pkt->content - start);
     }
-    for (i = 0; i < p->compcnt; i++) {
-        p->comp[i] = pkt->buf->data + (p->comp[i] - start);
-    }
+    p->base = pkt->buf->data;
     if (p->nameptr) {
         p->nameptr = pkt->buf->data + (p->nameptr - start);
     }
@@ -437,9 +481,9 @@ ccnl_ccntlv_prependName(struct ccnl_prefix_s *name,
 
     nameend = *offset;
 
-    if (name->chunknum &&
+    if (name->chunknum >= 0 &&
         ccnl_ccntlv_prependNetworkVarUInt(CCNX_TLV_N_Chunk,
-                                          *name->chunknum, offset, buf)) {
+                                          (uint32_t) name->chunknum, offset, buf)) {
         return -1;
     }
 
@@ -451,7 +495,7 @@ ccnl_ccntlv_prependName(struct ccnl_prefix_s *name,
             return -1;
         }
         *offset -= name->complen[cnt-1];
-        memcpy(buf + *offset, name->comp[cnt-1], name->complen[cnt-1]);
+        memcpy(buf + *offset, ccnl_prefix_comp(name, cnt-1), name->complen[cnt-1]);
     }
     if (ccnl_ccntlv_prependTL(CCNX_TLV_M_Name, nameend - *offset,
                               offset, buf)) {
@@ -575,56 +619,77 @@ ccnl_ccntlv_prependContentWithHdr(struct ccnl_prefix_s *name,
 
 #ifdef USE_FRAG
 
-// produces a full FRAG packet. It does not write, just read the fields in *fr
-struct ccnl_buf_s*
-ccnl_ccntlv_mkFrag(struct ccnl_frag_s *fr, unsigned int *consumed)
+int8_t
+ccnl_ccntlv_mkFragHdr(struct ccnl_frag_s *fr, uint8_t *hdr,
+                      size_t *hdrlen, size_t *datalen)
 {
-    size_t datalen;
-    struct ccnl_buf_s *buf;
-    struct ccnx_tlvhdr_ccnx2015_s *fp;
+    struct ccnx_tlvhdr_ccnx2015_s fp;
+    size_t len, left;
     uint16_t tmp;
 
-    DEBUGMSG_PCNX(TRACE, "ccnl_ccntlv_mkFrag seqno=%u\n", fr->sendseq);
+    DEBUGMSG_PCNX(TRACE, "ccnl_ccntlv_mkFragHdr seqno=%u\n", fr->sendseq);
 
-    datalen = fr->mtu - sizeof(*fp) - 4;
-    if (datalen > (fr->bigpkt->datalen - fr->sendoffs)) {
-        datalen = fr->bigpkt->datalen - fr->sendoffs;
+    if (fr->mtu <= (int) sizeof(fp) + 4) {
+        return -1;
     }
-    if (datalen > UINT16_MAX) {
-        return NULL;
+    left = fr->bigpkt->datalen - fr->sendoffs;
+    len = (size_t) fr->mtu - sizeof(fp) - 4;
+    if (len > left) {
+        len = left;
     }
-
-    buf = ccnl_buf_new(NULL, sizeof(*fp) + 4 + datalen);
-    if (!buf) {
-        return NULL;
+    if (len > UINT16_MAX - sizeof(fp) - 4) {
+        return -1;
     }
-    fp = (struct ccnx_tlvhdr_ccnx2015_s*) buf->data;
-    memset(fp, 0, sizeof(*fp));
-    fp->version = CCNX_TLV_V1;
-    fp->pkttype = CCNX_PT_Fragment;
-    fp->hdrlen = sizeof(*fp);
-    fp->pktlen = htons(sizeof(*fp) + 4 + datalen);
 
-    tmp = htons(CCNX_TLV_TL_Fragment);
-    memcpy(fp+1, &tmp, 2);
-    tmp = htons((uint16_t) datalen);
-    memcpy((char*)(fp+1) + 2, &tmp, 2);
-    memcpy((char*)(fp+1) + 4, fr->bigpkt->data + fr->sendoffs, datalen);
+    memset(&fp, 0, sizeof(fp));
+    fp.version = CCNX_TLV_V1;
+    fp.pkttype = CCNX_PT_Fragment;
+    fp.hdrlen = sizeof(fp);
+    fp.pktlen = htons((uint16_t) (sizeof(fp) + 4 + len));
 
-    tmp = fr->sendseq & 0x03fff;
-    if (datalen >= fr->bigpkt->datalen) {   // single
+    tmp = fr->sendseq & CCNL_BEFRAG_SEQ_MASK;
+    if (len >= fr->bigpkt->datalen) {       // single
         tmp |= CCNL_BEFRAG_FLAG_SINGLE << 14;
-    } else if (fr->sendoffs == 0) {          // start
+    } else if (fr->sendoffs == 0) {         // start
         tmp |= CCNL_BEFRAG_FLAG_FIRST  << 14;
-    } else if(datalen >= (fr->bigpkt->datalen - fr->sendoffs)) { // end
+    } else if (len >= left) {               // end
         tmp |= CCNL_BEFRAG_FLAG_LAST   << 14;
-    } else {                                  // middle
+    } else {                                // middle
         tmp |= CCNL_BEFRAG_FLAG_MID    << 14;
     }
     tmp = htons(tmp);
-    memcpy(fp->fill, &tmp, 2);
+    memcpy(fp.fill, &tmp, 2);
+
+    memcpy(hdr, &fp, sizeof(fp));
+    tmp = htons(CCNX_TLV_TL_Fragment);
+    memcpy(hdr + sizeof(fp), &tmp, 2);
+    tmp = htons((uint16_t) len);
+    memcpy(hdr + sizeof(fp) + 2, &tmp, 2);
+
+    *hdrlen = sizeof(fp) + 4;
+    *datalen = len;
+    return 0;
+}
+
+// produces a full FRAG packet. It does not write, just read the fields in *fr
+struct ccnl_buf_s*
+ccnl_ccntlv_mkFrag(struct ccnl_frag_s *fr, unsigned int *consumed)
+{
+    uint8_t hdr[CCNL_FRAG_HDR_MAX];
+    size_t hdrlen, datalen;
+    struct ccnl_buf_s *buf;
+
+    if (ccnl_ccntlv_mkFragHdr(fr, hdr, &hdrlen, &datalen)) {
+        return NULL;
+    }
+    buf = ccnl_buf_new(NULL, hdrlen + datalen);
+    if (!buf) {
+        return NULL;
+    }
+    memcpy(buf->data, hdr, hdrlen);
+    memcpy(buf->data + hdrlen, fr->bigpkt->data + fr->sendoffs, datalen);
 
-    *consumed = datalen;
+    *consumed = (unsigned int) datalen;
     return buf;
 }
 #endif
@@ -48,7 +48,10 @@
 int8_t
 ccnl_ndntlv_varlenint(uint8_t **buf, size_t *len, uint64_t *val)
 {
-    if (**buf < 253 && *len >= 1) {
+    if (*len < 1) {
+        return -1;
+    }
+    if (**buf < 253) {
         *val = **buf;
         *buf += 1;
         *len -= 1;
@@ -88,6 +91,15 @@ ccnl_ndntlv_dehead(uint8_t **buf, size_t *len,
 {
     size_t maxlen = *len;
     uint64_t vallen_int = 0;
+
+    // names, nonces and most fields use one byte each for type and length
+    if (*len >= 2 && (*buf)[0] < 253 && (*buf)[1] < 253) {
+        *typ = (*buf)[0];
+        *vallen = (*buf)[1];
+        *buf += 2;
+        *len -= 2;
+        return *vallen > maxlen ? -1 : 0;
+    }
     if (ccnl_ndntlv_varlenint(buf, len, typ)) {
         return -1;
     }
@@ -108,6 +120,14 @@ ccnl_ndntlv_dehead(uint8_t **buf, size_t *len,
 struct ccnl_pkt_s*
 ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
                       uint8_t **data, size_t *datalen)
+{
+    return ccnl_ndntlv_bytes2pkt_rx(pkttype, start, data, datalen, NULL);
+}
+
+struct ccnl_pkt_s*
+ccnl_ndntlv_bytes2pkt_rx(uint64_t pkttype, uint8_t *start,
+                         uint8_t **data, size_t *datalen,
+                         struct ccnl_buf_s *rxbuf)
 {
     struct ccnl_pkt_s *pkt;
     size_t oldpos, len, i;
@@ -120,7 +140,7 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
 
     DEBUGMSG(DEBUG, "ccnl_ndntlv_bytes2pkt len=%zu\n", *datalen);
 
-    pkt = (struct ccnl_pkt_s*) ccnl_calloc(1, sizeof(struct ccnl_pkt_s));
+    pkt = ccnl_pkt_new_rx();
     if (!pkt) {
         return NULL;
     }
@@ -159,47 +179,59 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
         size_t len2 = len;
 
         switch (typ) {
-        case NDN_TLV_Name:
+        case NDN_TLV_Name: {
+            ccnl_compoff_t compoff[CCNL_MAX_NAME_COMP], complen[CCNL_MAX_NAME_COMP];
+            int64_t chunknum = -1;
+            uint32_t cnt = 0;
+
             if (prefix) {
                 DEBUGMSG(WARNING, " ndntlv: name already defined\n");
                 goto Bail;
             }
-            prefix = ccnl_prefix_new(CCNL_SUITE_NDNTLV, CCNL_MAX_NAME_COMP);
-            if (!prefix) {
-                goto Bail;
-            }
-            prefix->compcnt = 0;
-            pkt->pfx = prefix;
-            pkt->val.final_block_id = -1;
-
-            prefix->nameptr = start + oldpos;
+            // one walk over the components, the prefix is allocated to fit
             while (len2 > 0) {
-                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i)) {
+                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i) || i > len2) {
                     goto Bail;
                 }
-                if (typ == NDN_TLV_NameComponent &&
-                            prefix->compcnt < CCNL_MAX_NAME_COMP) {
-                    if(cp[0] == NDN_Marker_SegmentNumber) {
-                        uint64_t chunknum;
-                        prefix->chunknum = (uint32_t *) ccnl_malloc(sizeof(uint32_t));
+                if (typ == NDN_TLV_NameComponent && cnt < CCNL_MAX_NAME_COMP) {
+                    if ((size_t) (cp - start) > (ccnl_compoff_t) -1 ||
+                        i > (ccnl_compoff_t) -1) {
+                        goto Bail;
+                    }
+                    if (i > 0 && cp[0] == NDN_Marker_SegmentNumber) {
+                        uint64_t num;
                         // TODO: requires ccnl_ndntlv_includedNonNegInt which includes the length of the marker
                         // it is implemented for encode, the decode is not yet implemented
-                        chunknum = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
-                        if (chunknum > UINT32_MAX) {
+                        num = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
+                        if (num > UINT32_MAX) {
                             goto Bail;
                         }
-                        *prefix->chunknum = (uint32_t) chunknum;
+                        chunknum = (int64_t) num;
                     }
-                    prefix->comp[prefix->compcnt] = cp;
-                    prefix->complen[prefix->compcnt] = i; //FIXME, what if the len value inside the TLV is wrong -> can this lead to overruns inside
-                    prefix->compcnt++;
+                    compoff[cnt] = (ccnl_compoff_t) (cp - start);
+                    complen[cnt] = (ccnl_compoff_t) i;
+                    cnt++;
                 }  // else unknown type: skip
                 cp += i;
                 len2 -= i;
             }
-            prefix->namelen = *data - prefix->nameptr;
+            prefix = ccnl_prefix_new_rx(CCNL_SUITE_NDNTLV, cnt);
+            if (!prefix) {
+                goto Bail;
+            }
+            memcpy(prefix->compoff, compoff, cnt * sizeof(ccnl_compoff_t));
+            memcpy(prefix->complen, complen, cnt * sizeof(ccnl_compoff_t));
+            prefix->base = start;
+            prefix->chunknum = chunknum;
+            pkt->pfx = prefix;
+            pkt->val.final_block_id = -1;
+
+            prefix->nameptr = start + oldpos;
+            prefix->namelen = *data + len - prefix->nameptr;
+            ccnl_prefix_rehash(prefix);
             DEBUGMSG(DEBUG, "  check interest type\n");
             break;
+        }
         case NDN_TLV_Selectors:
             while (len2 > 0) {
                 if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i)) {
@@ -227,7 +259,7 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
             }
             break;
         case NDN_TLV_Nonce:
-            pkt->s.ndntlv.nonce = ccnl_buf_new(*data, len);
+            pkt->s.ndntlv.nonce = ccnl_buf_new_rx(*data, len);
             break;
         case NDN_TLV_Scope:
             pkt->s.ndntlv.scope = ccnl_ndntlv_nonNegInt(*data, len);
@@ -314,6 +346,10 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
     }
 
     pkt->pfx = prefix;
+    pkt->buf = ccnl_buf_slice(rxbuf, start, *data - start);
+    if (pkt->buf) {
+        return pkt;
+    }
     pkt->buf = ccnl_buf_new(start, *data - start);
     if (!pkt->buf) {
         goto Bail;
@@ -323,9 +359,7 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
         pkt->content = pkt->buf->data + (pkt->content - start);
     }
     if (prefix) {
-        for (i = 0; i < prefix->compcnt; i++) {
-            prefix->comp[i] = pkt->buf->data + (prefix->comp[i] - start);
-        }
+        prefix->base = pkt->buf->data;
         if (prefix->nameptr) {
             prefix->nameptr = pkt->buf->data + (prefix->nameptr - start);
         }
@@ -354,7 +388,7 @@ ccnl_ndntlv_cMatch(struct ccnl_pkt_s *p, struct ccnl_content_s *c)
         return -1;
     }
 
-    if (p->s.ndntlv.mbf && ((c->flags & CCNL_CONTENT_FLAGS_STALE) != 0)) {
+    if (p->s.ndntlv.mbf && ccnl_content_is_stale(c)) {
         DEBUGMSG(DEBUG, "ignore stale content\n");
         return -1;
     }
@@ -503,9 +537,9 @@ ccnl_ndntlv_prependName(struct ccnl_prefix_s *name,
     size_t oldoffset = *offset;
     uint64_t cnt;
 
-    if (name->chunknum) {
+    if (name->chunknum >= 0) {
         if (ccnl_ndntlv_prependIncludedNonNegInt(NDN_TLV_NameComponent,
-                                                 *name->chunknum,
+                                                 (uint64_t) name->chunknum,
                                                  NDN_Marker_SegmentNumber,
                                                  offset, buf) < 0) {
             return -1;
@@ -513,7 +547,7 @@ ccnl_ndntlv_prependName(struct ccnl_prefix_s *name,
     }
 
     for (cnt = name->compcnt; cnt > 0; cnt--) {
-        if (ccnl_ndntlv_prependBlob(NDN_TLV_NameComponent, name->comp[cnt-1],
+        if (ccnl_ndntlv_prependBlob(NDN_TLV_NameComponent, ccnl_prefix_comp(name, cnt-1),
                                     name->complen[cnt-1], offset, buf) < 0) {
             return -1;
         }
@@ -680,69 +714,92 @@ ccnl_ndntlv_prependContent(struct ccnl_prefix_s *name,
 
 #ifdef USE_FRAG
 
+// Fragment { BeginEndFields, NdnlpFragment } for len bytes, prepended
+// before tmp[*offset]
+static int8_t
+ccnl_ndntlv_prependFragHdr(size_t len, uint16_t bits,
+                           size_t *offset, uint8_t *tmp)
+{
+    size_t end = *offset;
+
+    if (ccnl_ndntlv_prependTL(NDN_TLV_NdnlpFragment, len, offset, tmp) ||
+        *offset < 2) {
+        return -1;
+    }
+    *offset -= 2;
+    tmp[*offset] = (uint8_t) (bits >> 8);
+    tmp[*offset + 1] = (uint8_t) bits;
+    if (ccnl_ndntlv_prependTL(NDN_TLV_Frag_BeginEndFields, 2, offset, tmp) ||
+        ccnl_ndntlv_prependTL(NDN_TLV_Fragment, end - *offset + len,
+                              offset, tmp)) {
+        return -1;
+    }
+    return 0;
+}
+
+int8_t
+ccnl_ndntlv_mkFragHdr(struct ccnl_frag_s *fr, uint8_t *hdr,
+                      size_t *hdrlen, size_t *datalen)
+{
+    uint8_t tmp[CCNL_FRAG_HDR_MAX];
+    size_t offset = sizeof(tmp), len, left;
+    uint16_t bits;
+
+    DEBUGMSG(TRACE, "ccnl_ndntlv_mkFragHdr seqno=%u\n", fr->sendseq);
+
+    left = fr->bigpkt->datalen - fr->sendoffs;
+    len = left;
+    if (fr->mtu > 0 && len > (size_t) fr->mtu) {
+        len = (size_t) fr->mtu;
+    }
+    // the header for that many bytes tells what is left of the mtu
+    if (ccnl_ndntlv_prependFragHdr(len, 0, &offset, tmp) ||
+        fr->mtu <= (int) (sizeof(tmp) - offset)) {
+        return -1;
+    }
+    if (len > (size_t) fr->mtu - (sizeof(tmp) - offset)) {
+        len = (size_t) fr->mtu - (sizeof(tmp) - offset);
+    }
+
+    bits = fr->sendseq & CCNL_BEFRAG_SEQ_MASK;
+    if (len >= fr->bigpkt->datalen) {               // single
+        bits |= CCNL_BEFRAG_FLAG_SINGLE << 14;
+    } else if (fr->sendoffs == 0) {                 // start
+        bits |= CCNL_BEFRAG_FLAG_FIRST << 14;
+    } else if (len >= left) {                       // end
+        bits |= CCNL_BEFRAG_FLAG_LAST << 14;
+    } else {                                        // middle
+        bits |= CCNL_BEFRAG_FLAG_MID << 14;
+    }
+    offset = sizeof(tmp);
+    if (ccnl_ndntlv_prependFragHdr(len, bits, &offset, tmp)) {
+        return -1;
+    }
+    *hdrlen = sizeof(tmp) - offset;
+    memcpy(hdr, tmp + offset, *hdrlen);
+    *datalen = len;
+    return 0;
+}
+
 // produces a full FRAG packet. It does not write, just read the fields in *fr
 struct ccnl_buf_s*
 ccnl_ndntlv_mkFrag(struct ccnl_frag_s *fr, unsigned int *consumed)
 {
-    unsigned char test[20];
-    size_t offset, hdrlen;
-    long datalen;
+    uint8_t hdr[CCNL_FRAG_HDR_MAX];
+    size_t hdrlen, datalen;
     struct ccnl_buf_s *buf;
-    uint16_t tmp = 0;
-
-    DEBUGMSG(TRACE, "ccnl_ndntlv_mkFrag seqno=%d\n", fr->sendseq);
 
-    // pre-compute overhead, first
-    datalen = fr->bigpkt->datalen - fr->sendoffs;
-    if (datalen > fr->mtu) {
-        datalen = fr->mtu;
+    if (ccnl_ndntlv_mkFragHdr(fr, hdr, &hdrlen, &datalen)) {
+        return NULL;
     }
-    offset = sizeof(test);
-    hdrlen = ccnl_ndntlv_prependTL(NDN_TLV_NdnlpFragment, datalen,
-                                   &offset, test);
-    hdrlen += ccnl_ndntlv_prependTL(NDN_TLV_Frag_BeginEndFields, 2,
-                                    &offset, test) + 2;
-    hdrlen += ccnl_ndntlv_prependTL(NDN_TLV_Fragment, hdrlen + datalen,
-                                    &offset, test);
-
-    // with real values:
-    datalen = fr->bigpkt->datalen - fr->sendoffs;
-    if (datalen > (fr->mtu - hdrlen)) {
-        datalen = fr->mtu - hdrlen;
+    buf = ccnl_buf_new(NULL, hdrlen + datalen);
+    if (!buf) {
+        return NULL;
     }
+    memcpy(buf->data, hdr, hdrlen);
+    memcpy(buf->data + hdrlen, fr->bigpkt->data + fr->sendoffs, datalen);
 
-    buf = ccnl_buf_new(NULL, datalen + hdrlen);
-    if (!buf) {
-        return 0;
-    }
-    offset = buf->datalen - datalen;
-    memcpy(buf->data + offset,
-           fr->bigpkt->data + fr->sendoffs, datalen);
-    ccnl_ndntlv_prependTL(NDN_TLV_NdnlpFragment, datalen,
-                          &offset, buf->data);
-
-    tmp = fr->sendseq & 0x03fff;
-    if (datalen >= fr->bigpkt->datalen) {            // single
-        tmp |= CCNL_DTAG_FRAG_FLAG_SINGLE << 14;
-    } else if (fr->sendoffs == 0) {                  // start
-        tmp |= CCNL_DTAG_FRAG_FLAG_FIRST << 14;
-    } else if((unsigned) datalen >= (fr->bigpkt->datalen - fr->sendoffs)) { // end
-        tmp |= CCNL_DTAG_FRAG_FLAG_LAST << 14;
-    } else
-        tmp |= CCNL_DTAG_FRAG_FLAG_MID << 14;        // middle
-    offset -= 2;
-    *(uint16_t*) (buf->data + offset) = htons(tmp);
-    tmp = ccnl_ndntlv_prependTL(NDN_TLV_Frag_BeginEndFields, 2,
-                          &offset, buf->data);
-    tmp = ccnl_ndntlv_prependTL(NDN_TLV_Fragment, buf->datalen - offset,
-                          &offset, buf->data);
-
-    if (offset > 0) {
-        buf->datalen -= offset;
-        memmove(buf->data, buf->data + offset, buf->datalen);
-    }
-
-    *consumed = datalen;
+    *consumed = (unsigned int) datalen;
     return buf;
 }
 #endif // USE_FRAG
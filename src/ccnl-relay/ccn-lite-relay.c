@@ -37,6 +37,7 @@
 #include "ccnl-core.h"
 
 #include "ccnl-dispatch.h"
+#include "ccnl-shard.h"
 
 /*
 
@@ -151,6 +152,7 @@ main(int argc, char **argv)
     char *datadir = NULL, *ethdev = NULL, *crypto_sock_path = NULL;
     char *wpandev = NULL;
     int suite = CCNL_SUITE_DEFAULT;
+    int replacement = CCNL_CS_REPLACE_LRU;
     struct ccnl_relay_s *theRelay = ccnl_calloc(1, sizeof(struct ccnl_relay_s));
 #ifdef USE_UNIXSOCKET
     char *uxpath = CCNL_DEFAULT_UNIXSOCKNAME;
@@ -160,17 +162,56 @@ main(int argc, char **argv)
 #ifdef USE_ECHO
     char *echopfx = NULL;
 #endif
+#ifdef CCNL_HAVE_EPOLL
+    int use_epoll = 1;
+#endif
+#ifdef USE_SCHEDULER
+    int fair_quantum = 0;
+#endif
+    int txqlen = 0, txbatch = 0, workers = 1;
+    uint32_t pool_capacity = CCNL_POOL_CAPACITY;
 
     time(&theRelay->startup_time);
     unsigned int seed = time(NULL) * getpid();
 #ifdef __linux__
     srand(seed);
+    ccnl_prefix_hash_seed(((uint64_t) rand() << 31) ^ (uint64_t) rand());
 #else
     srandom(seed);
+    ccnl_prefix_hash_seed(((uint64_t) random() << 31) ^ (uint64_t) random());
 #endif
 
-    while ((opt = getopt(argc, argv, "hc:d:e:g:i:o:p:s:t:u:6:v:w:x:")) != -1) {
+    while ((opt = getopt(argc, argv, "b:B:hc:d:D:e:f:g:i:o:p:P:q:Q:r:s:t:T:u:6:v:w:W:x:")) != -1) {
         switch (opt) {
+        case 'b':
+            if (!strcmp(optarg, "select")) {
+#ifdef CCNL_HAVE_EPOLL
+                use_epoll = 0;
+#endif
+            }
+#ifdef CCNL_HAVE_EPOLL
+            else if (!strcmp(optarg, "epoll")) {
+                use_epoll = 1;
+            }
+#endif
+            else {
+                goto usage;
+            }
+            break;
+        case 'B': {
+            long rxbatch_l;
+            int rxbatch;
+            errno = 0;
+            rxbatch_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || rxbatch_l < 1 || rxbatch_l > INT_MAX) {
+                goto usage;
+            }
+            rxbatch = ccnl_io_set_rxbatch((int) rxbatch_l);
+            if (rxbatch != rxbatch_l) {
+                DEBUGMSG(WARNING, "receive batch limited to %d\n", rxbatch);
+            }
+            break;
+        }
         case 'c': {
             long max_cache_entries_l;
             errno = 0;
@@ -184,9 +225,26 @@ main(int argc, char **argv)
         case 'd':
             datadir = optarg;
             break;
+        case 'D':
+            theRelay->face_qdrop = ccnl_face_drop_str2policy(optarg);
+            if (theRelay->face_qdrop < 0)
+                goto usage;
+            break;
         case 'e':
             ethdev = optarg;
             break;
+#ifdef USE_SCHEDULER
+        case 'f': {
+            long fair_quantum_l;
+            errno = 0;
+            fair_quantum_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || fair_quantum_l < 1 || fair_quantum_l > INT_MAX) {
+                goto usage;
+            }
+            fair_quantum = (int) fair_quantum_l;
+            break;
+        }
+#endif
         case 'g': {
             long inter_pkt_interval_l;
             errno = 0;
@@ -215,6 +273,41 @@ main(int argc, char **argv)
         case 'p':
             crypto_sock_path = optarg;
             break;
+        case 'P': {
+            long pool_capacity_l;
+            errno = 0;
+            pool_capacity_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || pool_capacity_l < 0 || pool_capacity_l > INT_MAX) {
+                goto usage;
+            }
+            pool_capacity = (uint32_t) pool_capacity_l;
+            break;
+        }
+        case 'q': {
+            long txqlen_l;
+            errno = 0;
+            txqlen_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || txqlen_l < 1 || txqlen_l > CCNL_MAX_IF_QLEN) {
+                goto usage;
+            }
+            txqlen = (int) txqlen_l;
+            break;
+        }
+        case 'Q': {
+            long faceqlen_l;
+            errno = 0;
+            faceqlen_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || faceqlen_l < 1 || faceqlen_l > CCNL_MAX_FACE_QLEN) {
+                goto usage;
+            }
+            theRelay->face_qmax = (size_t) faceqlen_l;
+            break;
+        }
+        case 'r':
+            replacement = ccnl_content_repl_str2policy(optarg);
+            if (replacement < 0)
+                goto usage;
+            break;
         case 's':
             suite = ccnl_str2suite(optarg);
             if (!ccnl_isSuite(suite))
@@ -230,6 +323,16 @@ main(int argc, char **argv)
             httpport = (int) httpport_l;
             break;
         }
+        case 'T': {
+            long txbatch_l;
+            errno = 0;
+            txbatch_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || txbatch_l < 1 || txbatch_l > CCNL_MAX_IF_QLEN) {
+                goto usage;
+            }
+            txbatch = (int) txbatch_l;
+            break;
+        }
         case 'u':
             if (udpport1 == -1) {
                 long udpport1_l;
@@ -288,6 +391,16 @@ main(int argc, char **argv)
             wpandev = optarg;
             break;
 #endif
+        case 'W': {
+            long workers_l;
+            errno = 0;
+            workers_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || workers_l < 1 || workers_l > CCNL_MAX_WORKERS) {
+                goto usage;
+            }
+            workers = (int) workers_l;
+            break;
+        }
         case 'x':
             uxpath = optarg;
             break;
@@ -296,9 +409,19 @@ main(int argc, char **argv)
 usage:
             fprintf(stderr,
                     "usage: %s [options]\n"
+#ifdef CCNL_HAVE_EPOLL
+                    "  -b IO_BACKEND (epoll, select)\n"
+#else
+                    "  -b IO_BACKEND (select)\n"
+#endif
+                    "  -B RX_BATCH (datagrams per receive call)\n"
                     "  -c MAX_CONTENT_ENTRIES\n"
                     "  -d databasedir\n"
+                    "  -D FACE_DROP (tail, head, prio)\n"
                     "  -e ethdev\n"
+#ifdef USE_SCHEDULER
+                    "  -f FAIR_QUANTUM (bytes per turn, faces share interfaces by weight)\n"
+#endif
                     "  -g MIN_INTER_PACKET_INTERVAL\n"
                     "  -h\n"
                     "  -i MIN_INTER_CCNMSG_INTERVAL\n"
@@ -306,8 +429,13 @@ usage:
                     "  -o echo_prefix\n"
 #endif
                     "  -p crypto_face_ux_socket\n"
+                    "  -P POOL_CAPACITY (objects preallocated per pool, 0 for none)\n"
+                    "  -q TX_QUEUE_DEPTH (per interface, at most %d)\n"
+                    "  -Q FACE_QUEUE_DEPTH (per face, at most %d)\n"
+                    "  -r CACHE_REPLACEMENT (lru, clock, lfu)\n"
                     "  -s SUITE (ccnb, ccnx2015, ndn2013)\n"
                     "  -t tcpport (for HTML status page)\n"
+                    "  -T TX_BATCH (datagrams per send call)\n"
                     "  -u udpport (can be specified twice)\n"
                     "  -6 udp6port (can be specified twice)\n"
 
@@ -317,10 +445,11 @@ usage:
 #ifdef USE_WPAN
                     "  -w wpandev\n"
 #endif
+                    "  -W WORKERS (processes sharing the UDP ports, at most %d)\n"
 #ifdef USE_UNIXSOCKET
                     "  -x unixpath\n"
 #endif
-                    , argv[0]);
+                    , argv[0], CCNL_MAX_IF_QLEN, CCNL_MAX_FACE_QLEN, CCNL_MAX_WORKERS);
             exit(EXIT_FAILURE);
         }
     }
@@ -334,6 +463,10 @@ usage:
     }
 
     ccnl_core_init();
+    ccnl_pools_init(pool_capacity);
+    if (ccnl_arena_reserve(&ccnl_pkt_arena, CCNL_ARENA_SIZE)) {
+        DEBUGMSG(WARNING, "could not reserve the packet arena\n");
+    }
 
     DEBUGMSG(INFO, "This is ccn-lite-relay, starting at %s",
              ctime(&theRelay->startup_time) + 4);
@@ -343,9 +476,26 @@ usage:
     DEBUGMSG(INFO, "  seed: %u\n", seed);
 //    DEBUGMSG(INFO, "using suite %s\n", ccnl_suite2str(suite));
 
+    if (ccnl_shard_init(workers)) {
+        DEBUGMSG(ERROR, "cannot set up %d workers\n", workers);
+        exit(EXIT_FAILURE);
+    }
     ccnl_relay_config(theRelay, ethdev, wpandev, udpport1, udpport2,
                       udp6port1, udp6port2, httpport,
                       uxpath, suite, max_cache_entries, crypto_sock_path);
+    ccnl_content_repl_set_policy(theRelay, (ccnl_cs_replacement) replacement);
+    for (opt = 0; opt < theRelay->ifcount; opt++) {
+        theRelay->ifs[opt].qmax = (size_t) txqlen;
+        theRelay->ifs[opt].txbatch = txbatch;
+#ifdef USE_SCHEDULER
+        if (fair_quantum) {
+            // faces take turns at the interface instead of first come
+            ccnl_sched_destroy(theRelay->ifs[opt].sched);
+            theRelay->ifs[opt].sched = ccnl_sched_drr_new(ccnl_interface_CTS,
+                          theRelay, fair_quantum, inter_pkt_interval);
+        }
+#endif
+    }
     if (datadir) {
         ccnl_populate_cache(theRelay, datadir);
     }
@@ -362,16 +512,26 @@ usage:
     }
 #endif
 
+    // the workers start out with the same tables, the cache included
+    if (ccnl_shard_fork(theRelay) < 0) {
+        exit(EXIT_FAILURE);
+    }
+
+#ifdef CCNL_HAVE_EPOLL
+    if (use_epoll) {
+        ccnl_io_loop_epoll(theRelay);
+    } else
+#endif
     ccnl_io_loop(theRelay);
 
-    while (eventqueue) {
-        ccnl_rem_timer(eventqueue);
-    }
+    ccnl_timer_cleanup();
 
     ccnl_core_cleanup(theRelay);
 #ifdef USE_HTTP_STATUS
     theRelay->http = ccnl_http_cleanup(theRelay->http);
 #endif
+    ccnl_pools_cleanup();
+    ccnl_arena_release(&ccnl_pkt_arena);
 #ifdef USE_DEBUG_MALLOC
     debug_memdump();
 #endif
@@ -25,6 +25,4 @@
 
 #include "ccnl-os-time.h"
 
-extern struct ccnl_timer_s *eventqueue;
-
 #endif // EOF
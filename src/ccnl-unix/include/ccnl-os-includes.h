@@ -42,6 +42,14 @@
 # include <sys/time.h>
 # include <sys/un.h>
 # include <sys/utsname.h>
+# ifdef __linux__
+#  include <sys/epoll.h>
+#  define CCNL_HAVE_EPOLL
+#  ifdef _GNU_SOURCE
+#   define CCNL_HAVE_RECVMMSG
+#   define CCNL_HAVE_SENDMMSG
+#  endif
+# endif
 
 #ifndef _DEFAULT_SOURCE
 #  define __USE_MISC
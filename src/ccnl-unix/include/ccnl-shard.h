@@ -0,0 +1,214 @@
+/*
+ * @f ccnl-shard.h
+ * @b CCN lite, relay workers sharing the UDP ports, PIT and CS split by name
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-07-02 created
+ */
+
+#ifndef CCNL_SHARD_H
+#define CCNL_SHARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ccnl-defs.h"
+#include "ccnl-sockunion.h"
+
+struct ccnl_relay_s;
+
+/**
+ * @brief What a slot of a ring carries
+ */
+enum ccnl_shard_kind_e {
+    CCNL_SHARD_DATAGRAM = 0,            /**< a datagram owned by the receiver */
+    CCNL_SHARD_FIB_ADD,                 /**< a FIB entry added by the sender */
+    CCNL_SHARD_FIB_REM,                 /**< a FIB entry removed by the sender */
+    CCNL_SHARD_OFFER                    /**< Data its owner had no PIT entry for */
+};
+
+/**
+ * @brief A datagram or FIB change handed from one worker to another
+ */
+struct ccnl_shard_slot_s {
+    int kind;                           /**< see \ref ccnl_shard_kind_e */
+    size_t len;                         /**< length of the datagram */
+    int ifndx;                          /**< interface it was received on */
+    sockunion addr;                     /**< the peer which sent it */
+    uint8_t data[CCNL_MAX_PACKET_SIZE]; /**< the datagram */
+};
+
+/**
+ * @brief Single producer, single consumer ring between two workers
+ *
+ * Lives in memory shared by all workers. Only the producer moves tail and
+ * only the consumer moves head, each on its own cache line.
+ */
+struct ccnl_shard_ring_s {
+    uint32_t tail;                      /**< slots filled so far */
+    uint8_t pad1[64 - sizeof(uint32_t)];
+    uint32_t head;                      /**< slots consumed so far */
+    uint8_t pad2[64 - sizeof(uint32_t)];
+    struct ccnl_shard_slot_s slots[CCNL_SHARD_RING_SLOTS];
+};
+
+/**
+ * @brief Counters of a worker, in shared memory
+ */
+struct ccnl_shard_stats_s {
+    uint32_t wake_pending;  /**< the worker was signalled and has not drained yet */
+    uint32_t handed;        /**< datagrams passed to the worker owning them */
+    uint32_t received;      /**< datagrams other workers passed to this one */
+    uint32_t dropped;       /**< datagrams lost because the ring to the owner was full */
+    uint32_t backlog;       /**< FIB changes of the worker waiting for room in a ring */
+};
+
+/**
+ * @brief Prepares the relay to run as several worker processes
+ *
+ * Must be called before the interfaces are opened: UDP sockets are bound
+ * with SO_REUSEPORT from then on, so that every worker can receive on its
+ * own socket bound to the same port. Sets up the rings between the workers
+ * and their wakeup pipes.
+ *
+ * @param[in] workers   Number of workers, 1 .. CCNL_MAX_WORKERS
+ *
+ * @return 0 on success, -1 if the shared memory or a pipe is not available
+ */
+int
+ccnl_shard_init(int workers);
+
+/**
+ * @brief Starts the workers of a configured relay
+ *
+ * The calling process becomes worker 0, the others are forked from it and
+ * inherit its tables, the FIB included. A forked worker opens UDP sockets
+ * of its own for the ports of the relay, the other interfaces and the
+ * HTTP status page remain with worker 0. From then on, FIB entries added or
+ * removed by one worker are passed on to all others.
+ *
+ * @param[in] relay     The relay, configured but not yet running
+ *
+ * @return The index of the worker in this process, -1 if fork() failed
+ */
+int
+ccnl_shard_fork(struct ccnl_relay_s *relay);
+
+/**
+ * @brief Makes the calling process run \p relay as worker \p worker
+ *
+ * Done by \ref ccnl_shard_fork in every worker. A worker other than 0
+ * gives up what remains with worker 0. From then on FIB changes and Data
+ * nobody waited for are passed on to the other workers.
+ *
+ * @param[in] relay     The relay of this worker
+ * @param[in] worker    Its index, 0 .. ccnl_shard_workers() - 1
+ */
+void
+ccnl_shard_join(struct ccnl_relay_s *relay, int worker);
+
+/**
+ * @brief Returns the number of workers, 1 if the relay is not sharded
+ */
+int
+ccnl_shard_workers(void);
+
+/**
+ * @brief Returns the index of the worker in this process, 0 if not sharded
+ */
+int
+ccnl_shard_self(void);
+
+/**
+ * @brief Returns the worker whose PIT and CS hold the name of a datagram
+ *
+ * The worker is picked by a hash over the first \ref CCNL_SHARD_NAME_COMPS
+ * name components, so an Interest and the Data answering it meet at the
+ * same worker. Only the name is looked at, the bytes are not changed.
+ *
+ * Some Interests wait elsewhere: those with fewer components, and those
+ * received on other than UDP interfaces, which stay with worker 0. Data
+ * its owner finds no PIT entry for is therefore offered to the other
+ * workers once.
+ *
+ * @param[in] data      The datagram
+ * @param[in] len       Its length
+ *
+ * @return The owning worker, -1 if the datagram has no name the relay
+ *         knows how to find, such as a fragment or a management request
+ */
+int
+ccnl_shard_owner(uint8_t *data, size_t len);
+
+/**
+ * @brief Hands a received datagram to the worker owning it
+ *
+ * Called for every datagram before it is passed to ccnl_core_RX(). UDP
+ * datagrams owned by another worker are copied into the ring to that
+ * worker, which is woken up if needed.
+ *
+ * @param[in] relay     The relay of this worker
+ * @param[in] ifndx     The interface the datagram was received on
+ * @param[in] data      The datagram
+ * @param[in] len       Its length
+ * @param[in] src       The peer which sent it
+ *
+ * @return 1 if the datagram was handed over or dropped, 0 if it is
+ *         processed here
+ */
+int
+ccnl_shard_steer(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
+                 size_t len, sockunion *src);
+
+/**
+ * @brief Returns the file descriptor that is readable when datagrams were
+ *        handed to this worker, -1 if the relay is not sharded
+ */
+int
+ccnl_shard_fd(void);
+
+/**
+ * @brief Passes on the FIB changes which found the ring to a worker full
+ *
+ * FIB changes are not dropped like datagrams: they wait in a backlog of
+ * the sending worker, in order, until the worker receiving them drained
+ * its ring and woke the sender up. Called every round of the event loop,
+ * before datagrams are handed over.
+ *
+ * @return Number of FIB changes still waiting
+ */
+int
+ccnl_shard_flush(void);
+
+/**
+ * @brief Processes the datagrams and FIB changes other workers handed to
+ *        this one
+ *
+ * @param[in] relay     The relay of this worker
+ *
+ * @return Number of slots processed
+ */
+int
+ccnl_shard_drain(struct ccnl_relay_s *relay);
+
+/**
+ * @brief Returns the shared counters of a worker, NULL if there is none
+ */
+struct ccnl_shard_stats_s*
+ccnl_shard_stats(int worker);
+
+#endif // CCNL_SHARD_H
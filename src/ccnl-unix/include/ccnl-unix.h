@@ -97,6 +97,26 @@ void
 ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
            sockunion *dest, struct ccnl_buf_s *buf);
 
+/**
+ * @brief Sends a run of queued requests of one interface with sendmmsg()
+ *
+ * Used as ccnl_ll_TXv_ptr where sendmmsg() is available. UDP, UNIX and
+ * AF_PACKET destinations are batched, anything else is sent on its own
+ * through \ref ccnl_ll_TX. The header of a fragment and the share of the
+ * packet it carries are gathered into one datagram without copying.
+ *
+ * @param[in] ccnl The relay
+ * @param[in] ifc  The interface the requests are queued at
+ * @param[in] reqs The requests, in sending order
+ * @param[in] cnt  Number of requests
+ *
+ * @return Number of requests that are done with, sent or failed, and 0
+ *         if the socket would block
+ */
+int
+ccnl_ll_TXv(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+            struct ccnl_txrequest_s *reqs, int cnt);
+
 void
 ccnl_relay_config(struct ccnl_relay_s *relay, char *ethdev, char *wpandev,
                   int32_t udpport1, int32_t udpport2,
@@ -104,9 +124,40 @@ ccnl_relay_config(struct ccnl_relay_s *relay, char *ethdev, char *wpandev,
                   char *uxpath, int suite, int max_cache_entries,
                   char *crypto_face_path);
 
+/**
+ * @brief Sets how many datagrams the I/O loops fetch per receive call
+ *
+ * With a batch larger than one, a readable socket is drained with
+ * recvmmsg() into a ring of preallocated buffers and each datagram is
+ * passed to ccnl_core_RX(). Takes effect when an I/O loop is started.
+ *
+ * @param[in] batch Requested batch size
+ *
+ * @return The batch size in use, clamped to 1 .. CCNL_MAX_RX_BATCH and 1
+ *         where recvmmsg() is not available
+ */
+int
+ccnl_io_set_rxbatch(int batch);
+
 int
 ccnl_io_loop(struct ccnl_relay_s *ccnl);
 
+#ifdef CCNL_HAVE_EPOLL
+/**
+ * @brief Runs the relay's event and I/O loop on top of epoll
+ *
+ * Same contract as ccnl_io_loop(), but interface sockets are registered
+ * edge triggered and drained with a per wakeup budget, and EPOLLOUT is
+ * only armed while an interface has packets queued.
+ *
+ * @param[in] ccnl The relay to run
+ *
+ * @return 0 once the relay's halt_flag is set
+ */
+int
+ccnl_io_loop_epoll(struct ccnl_relay_s *ccnl);
+#endif
+
 void
 ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path);
 
@@ -0,0 +1,684 @@
+/*
+ * @f ccnl-shard.c
+ * @b CCN lite, relay workers sharing the UDP ports, PIT and CS split by name
+ *
+ * Copyright (C) 2018, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-07-02 created
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE // MAP_ANONYMOUS
+#endif
+
+#include "ccnl-shard.h"
+#include "ccnl-unix.h"
+
+#include "ccnl-os-includes.h"
+
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#include <signal.h>
+
+#include "ccnl-core.h"
+#include "ccnl-pkt-ccntlv.h"
+#include "ccnl-pkt-ndntlv.h"
+#include "ccnl-pkt-switch.h"
+#include "ccnl-dispatch.h"
+#include "ccnl-callbacks.h"
+#ifdef USE_HTTP_STATUS
+#include "ccnl-http-status.h"
+#endif
+
+// a FIB change waiting for room in the ring to a worker
+struct ccnl_shard_msg_s {
+    struct ccnl_shard_msg_s *next;
+    int kind;
+    int ifndx;
+    sockunion addr;
+    size_t len;
+    uint8_t data[1];
+};
+
+/*
+ * The core keeps process wide state: the object pools, the packet arena,
+ * the allocator and the event list. Workers are therefore processes, each
+ * with a relay of its own, and share nothing but the rings between them.
+ */
+static struct {
+    int workers;
+    int self;
+    int wakefd[CCNL_MAX_WORKERS][2];
+    struct ccnl_shard_ring_s *rings;    // workers * workers, from * workers + to
+    struct ccnl_shard_stats_s *stats;   // one per worker
+    int applying;                       // a FIB change of another worker
+    int offered;                        // Data another worker had no use for
+    struct ccnl_shard_msg_s *backlog[CCNL_MAX_WORKERS]; // FIB changes to each worker, oldest first
+    struct ccnl_shard_msg_s *backlog_last[CCNL_MAX_WORKERS];
+} ccnl_shard = { 1, 0, {{0}}, NULL, NULL, 0, 0, {0}, {0} };
+
+#define CCNL_SHARD_RING(from, to) \
+    (ccnl_shard.rings + (from) * ccnl_shard.workers + (to))
+
+int
+ccnl_shard_init(int workers)
+{
+    size_t size;
+    void *mem;
+    int i;
+
+    if (workers < 1 || workers > CCNL_MAX_WORKERS) {
+        return -1;
+    }
+    for (i = 0; i < CCNL_MAX_WORKERS; i++) {
+        while (ccnl_shard.backlog[i]) {
+            struct ccnl_shard_msg_s *m = ccnl_shard.backlog[i];
+
+            ccnl_shard.backlog[i] = m->next;
+            ccnl_free(m);
+        }
+    }
+    ccnl_shard.workers = workers;
+    ccnl_shard.self = 0;
+    if (workers == 1) {
+        return 0;
+    }
+
+    size = (size_t) (workers * workers) * sizeof(struct ccnl_shard_ring_s) +
+           (size_t) workers * sizeof(struct ccnl_shard_stats_s);
+    // pages are only backed once a ring gets used
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("shard mmap");
+        ccnl_shard.workers = 1;
+        return -1;
+    }
+    ccnl_shard.rings = (struct ccnl_shard_ring_s*) mem;
+    ccnl_shard.stats = (struct ccnl_shard_stats_s*) (ccnl_shard.rings +
+                                                     workers * workers);
+    for (i = 0; i < workers; i++) {
+        if (pipe(ccnl_shard.wakefd[i])) {
+            perror("shard pipe");
+            return -1;
+        }
+        fcntl(ccnl_shard.wakefd[i][0], F_SETFL, O_NONBLOCK);
+        fcntl(ccnl_shard.wakefd[i][1], F_SETFL, O_NONBLOCK);
+    }
+    DEBUGMSG(INFO, "relay runs as %d workers\n", workers);
+    return 0;
+}
+
+int
+ccnl_shard_workers(void)
+{
+    return ccnl_shard.workers;
+}
+
+int
+ccnl_shard_self(void)
+{
+    return ccnl_shard.self;
+}
+
+int
+ccnl_shard_fd(void)
+{
+    if (ccnl_shard.workers == 1) {
+        return -1;
+    }
+    return ccnl_shard.wakefd[ccnl_shard.self][0];
+}
+
+struct ccnl_shard_stats_s*
+ccnl_shard_stats(int worker)
+{
+    if (!ccnl_shard.stats || worker < 0 || worker >= ccnl_shard.workers) {
+        return NULL;
+    }
+    return ccnl_shard.stats + worker;
+}
+
+// what a forked worker leaves to worker 0: everything but the UDP
+// interfaces, which it opens anew to get a socket of its own
+static void
+ccnl_shard_detach(struct ccnl_relay_s *relay)
+{
+    int i;
+
+    for (i = 0; i < relay->ifcount; i++) {
+        struct ccnl_if_s *ifc = relay->ifs + i;
+        int sock = ifc->sock;
+
+        if (sock < 0) {
+            continue;
+        }
+        ifc->sock = -1;
+#ifdef USE_IPV4
+        if (ifc->addr.sa.sa_family == AF_INET) {
+            ifc->sock = ccnl_open_udpdev(ntohs(ifc->addr.ip4.sin_port),
+                                         &ifc->addr.ip4);
+        }
+#endif
+#ifdef USE_IPV6
+        if (ifc->addr.sa.sa_family == AF_INET6) {
+            ifc->sock = ccnl_open_udp6dev(ntohs(ifc->addr.ip6.sin6_port),
+                                          &ifc->addr.ip6);
+        }
+#endif
+        close(sock);
+    }
+#ifdef USE_HTTP_STATUS
+    relay->http = ccnl_http_cleanup(relay->http);
+#endif
+}
+
+static size_t
+ccnl_shard_addrlen(sockunion *su)
+{
+    switch (su->sa.sa_family) {
+#ifdef USE_IPV4
+    case AF_INET:
+        return sizeof(su->ip4);
+#endif
+#ifdef USE_IPV6
+    case AF_INET6:
+        return sizeof(su->ip6);
+#endif
+    default:
+        return 0;
+    }
+}
+
+static void
+ccnl_shard_wake(int to)
+{
+    // one wakeup until the receiver drains, see ccnl_shard_drain()
+    if (!__atomic_exchange_n(&ccnl_shard.stats[to].wake_pending, 1, __ATOMIC_SEQ_CST)) {
+        char c = 0;
+        if (write(ccnl_shard.wakefd[to][1], &c, 1) < 0 && errno != EAGAIN) {
+            perror("shard wakeup");
+        }
+    }
+}
+
+// appends a slot to the ring to worker 'to', -1 if the ring is full
+static int
+ccnl_shard_push(int to, int kind, int ifndx, sockunion *addr, uint8_t *data,
+                size_t len)
+{
+    struct ccnl_shard_ring_s *ring = CCNL_SHARD_RING(ccnl_shard.self, to);
+    struct ccnl_shard_slot_s *slot;
+    uint32_t tail = ring->tail;
+
+    if (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) >= CCNL_SHARD_RING_SLOTS) {
+        return -1;
+    }
+    slot = ring->slots + (tail & (CCNL_SHARD_RING_SLOTS - 1));
+    slot->kind = kind;
+    slot->len = len;
+    slot->ifndx = ifndx;
+    memcpy(&slot->addr, addr, ccnl_shard_addrlen(addr));
+    memcpy(slot->data, data, len);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    ccnl_shard_wake(to);
+    return 0;
+}
+
+int
+ccnl_shard_flush(void)
+{
+    struct ccnl_shard_stats_s *me;
+    int w;
+
+    if (ccnl_shard.workers == 1) {
+        return 0;
+    }
+    me = ccnl_shard.stats + ccnl_shard.self;
+    for (w = 0; w < ccnl_shard.workers; w++) {
+        struct ccnl_shard_msg_s *m;
+
+        if (w == ccnl_shard.self) {
+            continue;
+        }
+        while ((m = ccnl_shard.backlog[w]) != NULL &&
+               !ccnl_shard_push(w, m->kind, m->ifndx, &m->addr, m->data, m->len)) {
+            ccnl_shard.backlog[w] = m->next;
+            ccnl_free(m);
+            __atomic_fetch_sub(&me->backlog, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+    return (int) __atomic_load_n(&me->backlog, __ATOMIC_SEQ_CST);
+}
+
+// a FIB change is never dropped, it waits behind those to the same worker
+// which found the ring full
+static void
+ccnl_shard_push_fib(int to, int kind, int ifndx, sockunion *addr,
+                    uint8_t *data, size_t len)
+{
+    struct ccnl_shard_msg_s *m;
+
+    if (!ccnl_shard.backlog[to] &&
+        !ccnl_shard_push(to, kind, ifndx, addr, data, len)) {
+        return;
+    }
+    m = (struct ccnl_shard_msg_s*) ccnl_malloc(
+                offsetof(struct ccnl_shard_msg_s, data) + len);
+    if (!m) {
+        DEBUGMSG(ERROR, "shard: no memory, FIB change to worker %d lost\n", to);
+        return;
+    }
+    m->next = NULL;
+    m->kind = kind;
+    m->ifndx = ifndx;
+    memcpy(&m->addr, addr, sizeof(*addr));
+    m->len = len;
+    memcpy(m->data, data, len);
+    if (ccnl_shard.backlog[to]) {
+        ccnl_shard.backlog_last[to]->next = m;
+    } else {
+        ccnl_shard.backlog[to] = m;
+    }
+    ccnl_shard.backlog_last[to] = m;
+
+    // counted before trying again: a receiver draining from now on sees
+    // the count and wakes this worker, one which drained before made room
+    __atomic_fetch_add(&ccnl_shard.stats[ccnl_shard.self].backlog, 1,
+                       __ATOMIC_SEQ_CST);
+    ccnl_shard_flush();
+}
+
+/*
+ * A FIB change is passed on as the face it points to, given by interface
+ * and peer, its flags and the name: suite, flags, component count, then
+ * each component as 16 bit length and bytes.
+ */
+static void
+ccnl_shard_on_fib(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd,
+                  int added)
+{
+    struct ccnl_prefix_s *pfx = fwd->prefix;
+    uint8_t msg[CCNL_MAX_PACKET_SIZE];
+    size_t len = 0;
+    uint32_t i;
+    int w;
+    (void) relay;
+
+    if (ccnl_shard.applying || !pfx || !fwd->face || fwd->face->ifndx < 0 ||
+        !ccnl_shard_addrlen(&fwd->face->peer)) {
+        return;
+    }
+    msg[len++] = (uint8_t) pfx->suite;
+    msg[len++] = (uint8_t) fwd->face->flags;
+    memcpy(msg + len, &pfx->compcnt, sizeof(pfx->compcnt));
+    len += sizeof(pfx->compcnt);
+    for (i = 0; i < pfx->compcnt; i++) {
+        uint16_t cl = (uint16_t) pfx->complen[i];
+
+        if (len + sizeof(cl) + cl > sizeof(msg)) {
+            DEBUGMSG(WARNING, "shard: FIB name too long to pass on\n");
+            return;
+        }
+        memcpy(msg + len, &cl, sizeof(cl));
+        len += sizeof(cl);
+        memcpy(msg + len, ccnl_prefix_comp(pfx, i), cl);
+        len += cl;
+    }
+
+    for (w = 0; w < ccnl_shard.workers; w++) {
+        if (w == ccnl_shard.self) {
+            continue;
+        }
+        ccnl_shard_push_fib(w, added ? CCNL_SHARD_FIB_ADD : CCNL_SHARD_FIB_REM,
+                            fwd->face->ifndx, &fwd->face->peer, msg, len);
+    }
+}
+
+/*
+ * Data nobody waited for at this worker may answer an Interest another one
+ * holds, see ccnl_shard_owner(). Each worker is offered it once, those do
+ * not pass it on again.
+ */
+static void
+ccnl_shard_on_unsolicited(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+                          struct ccnl_pkt_s *pkt)
+{
+    int w;
+    (void) relay;
+
+    if (ccnl_shard.offered || !from || from->ifndx < 0 ||
+        !ccnl_shard_addrlen(&from->peer) || !pkt->buf ||
+        pkt->buf->datalen > CCNL_MAX_PACKET_SIZE) {
+        return;
+    }
+    for (w = 0; w < ccnl_shard.workers; w++) {
+        if (w == ccnl_shard.self) {
+            continue;
+        }
+        if (ccnl_shard_push(w, CCNL_SHARD_OFFER, from->ifndx, &from->peer,
+                            pkt->buf->data, pkt->buf->datalen)) {
+            __atomic_fetch_add(&ccnl_shard.stats[w].dropped, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void
+ccnl_shard_apply_fib(struct ccnl_relay_s *relay, struct ccnl_shard_slot_s *slot)
+{
+    struct ccnl_prefix_s *tmp, *pfx;
+    struct ccnl_face_s *face;
+    uint8_t *p = slot->data, *end = slot->data + slot->len;
+    uint32_t cnt, i;
+    char suite;
+    uint8_t flags;
+
+    if (slot->len < 2 + sizeof(cnt)) {
+        return;
+    }
+    suite = (char) *p++;
+    flags = *p++;
+    memcpy(&cnt, p, sizeof(cnt));
+    p += sizeof(cnt);
+    if (cnt > CCNL_MAX_NAME_COMP) {
+        return;
+    }
+    // the components are read in place, the slot is reused once drained
+    tmp = ccnl_prefix_new(suite, cnt);
+    if (!tmp) {
+        return;
+    }
+    tmp->base = slot->data;
+    for (i = 0; i < cnt; i++) {
+        uint16_t cl;
+
+        if (p + sizeof(cl) > end) {
+            break;
+        }
+        memcpy(&cl, p, sizeof(cl));
+        p += sizeof(cl);
+        if (p + cl > end) {
+            break;
+        }
+        tmp->compoff[i] = (ccnl_compoff_t) (p - slot->data);
+        tmp->complen[i] = cl;
+        p += cl;
+    }
+    if (i < cnt) {
+        ccnl_prefix_free(tmp);
+        return;
+    }
+    ccnl_prefix_rehash(tmp);
+    pfx = ccnl_prefix_dup(tmp);
+    ccnl_prefix_free(tmp);
+    face = ccnl_get_face_or_create(relay, slot->ifndx, &slot->addr.sa,
+                                   ccnl_shard_addrlen(&slot->addr));
+    if (!face || !pfx) {
+        ccnl_prefix_free(pfx);
+        return;
+    }
+    face->flags |= flags & CCNL_FACE_FLAGS_STATIC;
+
+    ccnl_shard.applying = 1;
+    if (slot->kind == CCNL_SHARD_FIB_ADD) {
+        if (ccnl_fib_add_entry(relay, pfx, face)) {
+            ccnl_prefix_free(pfx);
+        }
+    } else {
+        ccnl_fib_rem_entry(relay, pfx, face);
+        ccnl_prefix_free(pfx);
+    }
+    ccnl_shard.applying = 0;
+}
+
+void
+ccnl_shard_join(struct ccnl_relay_s *relay, int worker)
+{
+    ccnl_shard.self = worker;
+    if (worker > 0) {
+        ccnl_shard_detach(relay);
+    }
+    ccnl_set_cb_on_fib(ccnl_shard_on_fib);
+    ccnl_set_cb_on_unsolicited(ccnl_shard_on_unsolicited);
+}
+
+int
+ccnl_shard_fork(struct ccnl_relay_s *relay)
+{
+    int w;
+
+    for (w = 1; w < ccnl_shard.workers; w++) {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            perror("shard fork");
+            return -1;
+        }
+        if (pid == 0) {
+#ifdef __linux__
+            // a worker does not outlive the relay
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+            srand((unsigned int) rand() ^ (unsigned int) getpid());
+            ccnl_shard_join(relay, w);
+            DEBUGMSG(INFO, "worker %d started (pid %d)\n", w, (int) getpid());
+            return w;
+        }
+    }
+    if (ccnl_shard.workers > 1) {
+        // changes before the fork were inherited, not passed on
+        ccnl_shard_join(relay, 0);
+    }
+    return 0;
+}
+
+static uint64_t
+ccnl_shard_hash(uint64_t h, uint8_t *p, size_t len)
+{
+    while (len-- > 0) {
+        h = (h ^ *p++) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+#ifdef USE_SUITE_NDNTLV
+static int
+ccnl_shard_ndntlv_key(uint8_t *data, size_t len, uint64_t *key)
+{
+    uint64_t typ;
+    size_t vallen;
+    int cnt = 0;
+
+    if (ccnl_ndntlv_dehead(&data, &len, &typ, &vallen) ||
+        (typ != NDN_TLV_Interest && typ != NDN_TLV_Data)) {
+        return -1;
+    }
+    len = vallen;
+    // the name comes first in Interests and Data
+    if (ccnl_ndntlv_dehead(&data, &len, &typ, &vallen) || typ != NDN_TLV_Name) {
+        return -1;
+    }
+    len = vallen;
+    while (len > 0 && cnt < CCNL_SHARD_NAME_COMPS) {
+        uint8_t *comp = data;
+
+        if (ccnl_ndntlv_dehead(&data, &len, &typ, &vallen) || vallen > len) {
+            return -1;
+        }
+        // what the decoder does not take as a component is left out
+        if (typ == NDN_TLV_NameComponent) {
+            *key = ccnl_shard_hash(*key, comp, (size_t) (data - comp) + vallen);
+            cnt++;
+        }
+        data += vallen;
+        len -= vallen;
+    }
+    return 0;
+}
+#endif
+
+#ifdef USE_SUITE_CCNTLV
+static int
+ccnl_shard_ccntlv_key(uint8_t *data, size_t len, uint64_t *key)
+{
+    struct ccnx_tlvhdr_ccnx2015_s *hp = (struct ccnx_tlvhdr_ccnx2015_s*) data;
+    uint16_t typ;
+    size_t vallen;
+    int cnt = 0;
+
+    if (len < sizeof(*hp) || hp->hdrlen > len ||
+        (hp->pkttype != CCNX_PT_Interest && hp->pkttype != CCNX_PT_Data)) {
+        return -1;
+    }
+    data += hp->hdrlen;
+    len -= hp->hdrlen;
+    if (ccnl_ccntlv_dehead(&data, &len, &typ, &vallen) ||
+        (typ != CCNX_TLV_TL_Interest && typ != CCNX_TLV_TL_Object)) {
+        return -1;
+    }
+    len = vallen;
+    if (ccnl_ccntlv_dehead(&data, &len, &typ, &vallen) || typ != CCNX_TLV_M_Name) {
+        return -1;
+    }
+    len = vallen;
+    while (len > 0 && cnt < CCNL_SHARD_NAME_COMPS) {
+        uint8_t *comp = data;
+
+        if (ccnl_ccntlv_dehead(&data, &len, &typ, &vallen) || vallen > len) {
+            return -1;
+        }
+        *key = ccnl_shard_hash(*key, comp, 4 + vallen);
+        cnt++;
+        data += vallen;
+        len -= vallen;
+    }
+    return 0;
+}
+#endif
+
+int
+ccnl_shard_owner(uint8_t *data, size_t len)
+{
+    uint64_t key = 0xcbf29ce484222325ULL;
+    size_t skip;
+    int rc = -1;
+
+    switch (ccnl_pkt2suite(data, len, &skip)) {
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        rc = ccnl_shard_ndntlv_key(data + skip, len - skip, &key);
+        break;
+#endif
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        rc = ccnl_shard_ccntlv_key(data + skip, len - skip, &key);
+        break;
+#endif
+    default:
+        break;
+    }
+    if (rc) {
+        return -1;
+    }
+    key ^= key >> 29;
+    return (int) (key % (uint64_t) ccnl_shard.workers);
+}
+
+int
+ccnl_shard_steer(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
+                 size_t len, sockunion *src)
+{
+    struct ccnl_shard_stats_s *to;
+    int owner;
+    (void) relay;
+
+    if (ccnl_shard.workers == 1 || !ccnl_shard_addrlen(src)) {
+        return 0;
+    }
+    owner = ccnl_shard_owner(data, len);
+    if (owner < 0 || owner == ccnl_shard.self || len > CCNL_MAX_PACKET_SIZE) {
+        return 0;
+    }
+
+    to = ccnl_shard.stats + owner;
+    if (ccnl_shard_push(owner, CCNL_SHARD_DATAGRAM, ifndx, src, data, len)) {
+        DEBUGMSG(DEBUG, "  ring to worker %d full, datagram dropped\n", owner);
+        __atomic_fetch_add(&to->dropped, 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_add(&to->handed, 1, __ATOMIC_RELAXED);
+    }
+    return 1;
+}
+
+int
+ccnl_shard_drain(struct ccnl_relay_s *relay)
+{
+    struct ccnl_shard_stats_s *me;
+    char buf[64];
+    int from, cnt = 0;
+    uint32_t datagrams = 0;
+
+    if (ccnl_shard.workers == 1) {
+        return 0;
+    }
+    me = ccnl_shard.stats + ccnl_shard.self;
+    while (read(ccnl_shard.wakefd[ccnl_shard.self][0], buf, sizeof(buf)) > 0);
+    // cleared before looking at the rings: what is handed over from now on
+    // is either seen below or signalled again
+    __atomic_store_n(&me->wake_pending, 0, __ATOMIC_SEQ_CST);
+
+    for (from = 0; from < ccnl_shard.workers; from++) {
+        struct ccnl_shard_ring_s *ring = CCNL_SHARD_RING(from, ccnl_shard.self);
+        uint32_t head = ring->head;
+        uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+        if (from == ccnl_shard.self || head == tail) {
+            continue;
+        }
+        for (; head != tail; head++) {
+            struct ccnl_shard_slot_s *slot;
+
+            slot = ring->slots + (head & (CCNL_SHARD_RING_SLOTS - 1));
+            if (slot->kind == CCNL_SHARD_DATAGRAM ||
+                slot->kind == CCNL_SHARD_OFFER) {
+                // the slot is reused once head moves on, nothing may be
+                // parsed in place
+                relay->rxbuf = NULL;
+                ccnl_shard.offered = slot->kind == CCNL_SHARD_OFFER;
+                ccnl_core_RX(relay, slot->ifndx, slot->data, slot->len,
+                             &slot->addr.sa, ccnl_shard_addrlen(&slot->addr));
+                ccnl_shard.offered = 0;
+                datagrams++;
+            } else {
+                ccnl_shard_apply_fib(relay, slot);
+            }
+            __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+            cnt++;
+        }
+        // a sender whose FIB changes found the ring full is told there is
+        // room now, see ccnl_shard_push_fib()
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ccnl_shard.stats[from].backlog, __ATOMIC_SEQ_CST)) {
+            ccnl_shard_wake(from);
+        }
+    }
+    __atomic_fetch_add(&me->received, datagrams, __ATOMIC_RELAXED);
+    return cnt;
+}
+
+// eof
@@ -20,7 +20,12 @@
  * 2017-06-16 created
  */
 
+#ifdef __linux__
+#define _GNU_SOURCE // recvmmsg()
+#endif
+
 #include "ccnl-unix.h"
+#include "ccnl-shard.h"
 
 #include "ccnl-os-includes.h"
 
@@ -41,6 +46,7 @@
  * ccnl_unix.c
  */
 static int lasthour = -1;
+static int rxbatch = 1;
 #ifdef USE_SCHEDULER
 static int inter_ccn_interval = 0; // in usec
 static int inter_pkt_interval = 0; // in usec
@@ -169,6 +175,14 @@ ccnl_open_udpdev(uint16_t port, struct sockaddr_in *si)
     si->sin_addr.s_addr = INADDR_ANY;
     si->sin_port = htons(port);
     si->sin_family = PF_INET;
+#ifdef SO_REUSEPORT
+    // every worker binds a socket of its own to the port
+    opt_value = 1;
+    if (ccnl_shard_workers() > 1 &&
+        setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &opt_value, sizeof(opt_value)) < 0) {
+        perror("udp sock reuseport");
+    }
+#endif
     if (bind(s, (struct sockaddr *)si, sizeof(*si)) < 0) {
         perror("udp sock bind");
         return -1;
@@ -203,6 +217,14 @@ ccnl_open_udp6dev(uint16_t port, struct sockaddr_in6 *sin)
     sin->sin6_addr = in6addr_any;
     sin->sin6_port = htons(port);
     sin->sin6_family = PF_INET6;
+#ifdef SO_REUSEPORT
+    if (ccnl_shard_workers() > 1) {
+        int opt_value = 1;
+        if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &opt_value, sizeof(opt_value)) < 0) {
+            perror("udp6 sock reuseport");
+        }
+    }
+#endif
     if (bind(s, (struct sockaddr *)sin, sizeof(*sin)) < 0) {
         perror("udp sock bind");
         return -1;
@@ -417,6 +439,109 @@ ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
     (void) rc; // just to silence a compiler warning (if USE_DEBUG is not set)
 }
 
+#ifdef CCNL_HAVE_SENDMMSG
+int
+ccnl_ll_TXv(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+            struct ccnl_txrequest_s *reqs, int cnt)
+{
+    struct mmsghdr msgs[CCNL_MAX_IF_QLEN];
+    // link layer header, fragment header and payload
+    struct iovec iov[CCNL_MAX_IF_QLEN][3];
+#ifdef USE_LINKLAYER
+    uint8_t ethhdr[CCNL_MAX_IF_QLEN][14];
+    uint16_t type = htons(CCNL_ETH_TYPE);
+#endif
+    int k, n;
+
+    if (cnt > CCNL_MAX_IF_QLEN) {
+        cnt = CCNL_MAX_IF_QLEN;
+    }
+    memset(msgs, 0, (size_t) cnt * sizeof(*msgs));
+    for (k = 0; k < cnt; k++) {
+        sockunion *dest = &reqs[k].dst;
+        struct msghdr *m = &msgs[k].msg_hdr;
+        struct iovec *v = iov[k];
+        int nv = 0;
+
+        switch (dest->sa.sa_family) {
+#ifdef USE_IPV4
+        case AF_INET:
+            m->msg_name = &dest->ip4;
+            m->msg_namelen = sizeof(struct sockaddr_in);
+            break;
+#endif
+#ifdef USE_IPV6
+        case AF_INET6:
+            m->msg_name = &dest->ip6;
+            m->msg_namelen = sizeof(struct sockaddr_in6);
+            break;
+#endif
+#ifdef USE_UNIXSOCKET
+        case AF_UNIX:
+            m->msg_name = &dest->ux;
+            m->msg_namelen = sizeof(struct sockaddr_un);
+            break;
+#endif
+#ifdef USE_LINKLAYER
+        case AF_PACKET:
+            // same framing as ccnl_eth_sendto(), the header is gathered
+            // from a buffer of its own
+            memcpy(ethhdr[k], dest->linklayer.sll_addr, 6);
+            memcpy(ethhdr[k] + 6, ifc->addr.linklayer.sll_addr, 6);
+            memcpy(ethhdr[k] + 12, &type, sizeof(type));
+            v[nv].iov_base = ethhdr[k];
+            v[nv++].iov_len = sizeof(ethhdr[k]);
+            break;
+#endif
+        default:
+            nv = -1; // not batched
+            break;
+        }
+        if (nv < 0) {
+            break;
+        }
+        if (reqs[k].hdrlen) {
+            v[nv].iov_base = reqs[k].hdr;
+            v[nv++].iov_len = reqs[k].hdrlen;
+        }
+        v[nv].iov_base = reqs[k].buf->data;
+        v[nv++].iov_len = reqs[k].buf->datalen;
+#ifdef USE_LINKLAYER
+        if (dest->sa.sa_family == AF_PACKET) {
+            size_t room = 2000 - sizeof(ethhdr[k]) - reqs[k].hdrlen;
+
+            if (v[nv - 1].iov_len > room) {
+                v[nv - 1].iov_len = room;
+            }
+        }
+#endif
+        m->msg_iov = v;
+        m->msg_iovlen = (size_t) nv;
+    }
+    if (k == 0) {
+        struct ccnl_buf_s *flat = ccnl_txrequest_flatten(&reqs[0]);
+
+        if (flat) {
+            ccnl_ll_TX(ccnl, ifc, &reqs[0].dst, flat);
+            ccnl_buf_free(flat);
+        }
+        return 1;
+    }
+
+    n = sendmmsg(ifc->sock, msgs, (unsigned int) k, 0);
+    DEBUGMSG(DEBUG, "sendmmsg %d datagrams returned %d\n", k, n);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        // like a failed sendto(), the first datagram is lost
+        DEBUGMSG(DEBUG, "  sendmmsg failed: %s\n", strerror(errno));
+        return 1;
+    }
+    return n;
+}
+#endif // CCNL_HAVE_SENDMMSG
+
 void
 ccnl_relay_config(struct ccnl_relay_s *relay, char *ethdev, char *wpandev,
                   int32_t udpport1, int32_t udpport2,
@@ -438,10 +563,12 @@ ccnl_relay_config(struct ccnl_relay_s *relay, char *ethdev, char *wpandev,
     relay->pit = NULL;
     relay->fib = NULL;
     relay->faces = NULL;
-    relay->nonces = NULL;
     relay->max_cache_entries = max_cache_entries;
     relay->max_pit_entries = CCNL_DEFAULT_MAX_PIT_ENTRIES;
     relay->ccnl_ll_TX_ptr = &ccnl_ll_TX;
+#ifdef CCNL_HAVE_SENDMMSG
+    relay->ccnl_ll_TXv_ptr = &ccnl_ll_TXv;
+#endif
 
 #ifdef USE_SCHEDULER
     relay->defaultFaceScheduler = ccnl_relay_defaultFaceScheduler;
@@ -559,43 +686,295 @@ ccnl_relay_config(struct ccnl_relay_s *relay, char *ethdev, char *wpandev,
     ccnl_set_timer(1000000, ccnl_ageing, relay, 0);
 }
 
+// hands a datagram received on interface i to the core, large ones are
+// parsed in place and may keep rxbuf beyond this call
+static void
+ccnl_io_dispatch(struct ccnl_relay_s *ccnl, int i, struct ccnl_buf_s *rxbuf,
+                 size_t len, sockunion *src_addr)
+{
+    unsigned char *buf = rxbuf->data;
+
+    // the worker owning the name takes the datagram, see ccnl-shard.c
+    if (ccnl_shard_steer(ccnl, i, buf, len, src_addr)) {
+        return;
+    }
+    // a Data parsed in place pins the whole receive buffer in the content
+    // store, small datagrams are cheaper to copy
+    ccnl->rxbuf = len >= CCNL_RX_SHARE_MIN ? rxbuf : NULL;
+    if (0) {}
+#ifdef USE_IPV4
+    else if (src_addr->sa.sa_family == AF_INET) {
+        ccnl_core_RX(ccnl, i, buf, len,
+                     &src_addr->sa, sizeof(src_addr->ip4));
+    }
+#endif
+#ifdef USE_IPV6
+    else if (src_addr->sa.sa_family == AF_INET6) {
+        ccnl_core_RX(ccnl, i, buf, len,
+                     &src_addr->sa, sizeof(src_addr->ip6));
+    }
+#endif
+#ifdef USE_LINKLAYER
+    else if (src_addr->sa.sa_family == AF_PACKET) {
+        if (len > 14) {
+            ccnl_core_RX(ccnl, i, buf + 14, len - 14,
+                         &src_addr->sa, sizeof(src_addr->linklayer));
+        }
+    }
+#endif
+#ifdef USE_WPAN
+    else if (src_addr->sa.sa_family == AF_IEEE802154) {
+        if (len > 14) {
+            ccnl_core_RX(ccnl, i, buf, len,
+                         &src_addr->sa, sizeof(src_addr->linklayer));
+        }
+    }
+#endif
+#ifdef USE_UNIXSOCKET
+    else if (src_addr->sa.sa_family == AF_UNIX) {
+        ccnl_core_RX(ccnl, i, buf, len,
+                     &src_addr->sa, sizeof(src_addr->ux));
+    }
+#endif
+    ccnl->rxbuf = NULL;
+}
+
+int
+ccnl_io_set_rxbatch(int batch)
+{
+#ifdef CCNL_HAVE_RECVMMSG
+    if (batch > CCNL_MAX_RX_BATCH) {
+        batch = CCNL_MAX_RX_BATCH;
+    }
+#else
+    batch = 1;
+#endif
+    if (batch < 1) {
+        batch = 1;
+    }
+    return rxbatch = batch;
+}
+
+// receive buffers of one I/O loop, rxbatch packets for recvmmsg(). The
+// buffers are pooled: one still referenced by a parsed packet is replaced
+// before the next receive, the others are reused.
+struct ccnl_rxring_s {
+    int cnt;
+    struct ccnl_buf_s **buf;
+#ifdef CCNL_HAVE_RECVMMSG
+    struct mmsghdr *msgs;
+    struct iovec *iov;
+    sockunion *addr;
+#endif
+};
+
+// makes buffer k of the ring free to receive into, returns -1 if
+// no replacement could be allocated
+static int
+ccnl_rxring_reclaim(struct ccnl_rxring_s *ring, int k)
+{
+    struct ccnl_buf_s *b = ring->buf[k];
+
+    if (b && b->refcnt == 1) {
+        return 0;
+    }
+    b = ccnl_buf_new(NULL, CCNL_MAX_PACKET_SIZE);
+    if (!b) {
+        return -1;
+    }
+    ccnl_buf_free(ring->buf[k]);
+    ring->buf[k] = b;
+#ifdef CCNL_HAVE_RECVMMSG
+    if (ring->iov) {
+        ring->iov[k].iov_base = b->data;
+        ring->iov[k].iov_len = b->datalen;
+    }
+#endif
+    return 0;
+}
+
+static void
+ccnl_rxring_free(struct ccnl_rxring_s *ring)
+{
+    int k;
+
+#ifdef CCNL_HAVE_RECVMMSG
+    ccnl_free(ring->msgs);
+    ccnl_free(ring->iov);
+    ccnl_free(ring->addr);
+#endif
+    if (ring->buf) {
+        for (k = 0; k < ring->cnt; k++) {
+            ccnl_buf_free(ring->buf[k]);
+        }
+        ccnl_free(ring->buf);
+    }
+}
+
+static int
+ccnl_rxring_init(struct ccnl_rxring_s *ring)
+{
+    int k;
+
+    memset(ring, 0, sizeof(*ring));
+    ring->cnt = rxbatch;
+    ring->buf = ccnl_calloc(ring->cnt, sizeof(*ring->buf));
+    if (!ring->buf) {
+        return -1;
+    }
+#ifdef CCNL_HAVE_RECVMMSG
+    if (ring->cnt > 1) {
+        ring->msgs = ccnl_calloc(ring->cnt, sizeof(*ring->msgs));
+        ring->iov = ccnl_calloc(ring->cnt, sizeof(*ring->iov));
+        ring->addr = ccnl_calloc(ring->cnt, sizeof(*ring->addr));
+        if (!ring->msgs || !ring->iov || !ring->addr) {
+            return -1;
+        }
+        for (k = 0; k < ring->cnt; k++) {
+            ring->msgs[k].msg_hdr.msg_iov = ring->iov + k;
+            ring->msgs[k].msg_hdr.msg_iovlen = 1;
+        }
+    }
+#endif
+    for (k = 0; k < ring->cnt; k++) {
+        if (ccnl_rxring_reclaim(ring, k)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// receives up to one batch of datagrams from interface i and hands them
+// to the core, returns the number of datagrams or -1 as recvfrom() does
+static int
+ccnl_io_recv(struct ccnl_relay_s *ccnl, int i, struct ccnl_rxring_s *ring,
+             int flags)
+{
+    sockunion src_addr;
+    socklen_t addrlen = sizeof(sockunion);
+    ssize_t recvlen;
+
+#ifdef CCNL_HAVE_RECVMMSG
+    if (ring->cnt > 1) {
+        int k, n;
+
+        for (k = 0; k < ring->cnt; k++) {
+            if (ccnl_rxring_reclaim(ring, k)) {
+                DEBUGMSG(ERROR, "cannot allocate a receive buffer\n");
+                return -1;
+            }
+            ring->msgs[k].msg_hdr.msg_name = ring->addr + k;
+            ring->msgs[k].msg_hdr.msg_namelen = sizeof(sockunion);
+        }
+        // the socket was reported readable, take what is there
+        n = recvmmsg(ccnl->ifs[i].sock, ring->msgs, (unsigned int) ring->cnt,
+                     flags | MSG_DONTWAIT, NULL);
+        for (k = 0; k < n; k++) {
+            if (ring->msgs[k].msg_len > 0) {
+                ccnl_io_dispatch(ccnl, i, ring->buf[k],
+                                 ring->msgs[k].msg_len, ring->addr + k);
+            }
+        }
+        return n;
+    }
+#endif
+    if (ccnl_rxring_reclaim(ring, 0)) {
+        DEBUGMSG(ERROR, "cannot allocate a receive buffer\n");
+        return -1;
+    }
+    if ((recvlen = recvfrom(ccnl->ifs[i].sock, ring->buf[0]->data,
+                            ring->buf[0]->datalen, flags,
+                            (struct sockaddr*) &src_addr, &addrlen)) > 0) {
+        ccnl_io_dispatch(ccnl, i, ring->buf[0], (size_t) recvlen, &src_addr);
+    }
+    return recvlen < 0 ? -1 : 1;
+}
+
+// whether the loop waits for an interface to become writable: a queue
+// left over by a send that would block. A scheduler sends from its timers,
+// a send outside it would bypass the pacing and its accounting.
+#ifndef USE_SCHEDULER
+# define CCNL_IO_WRITABLE(ifc)  ((ifc)->qlen > 0)
+#else
+# define CCNL_IO_WRITABLE(ifc)  0
+#endif
+
+// sends what batching interfaces queued since the last round, a
+// scheduler instead paces its interfaces itself
+static void
+ccnl_io_flush(struct ccnl_relay_s *ccnl)
+{
+#ifndef USE_SCHEDULER
+    int i;
+
+    for (i = 0; i < ccnl->ifcount; i++) {
+        if (ccnl->ifs[i].qlen > 0 && ccnl->ifs[i].txbatch > 1) {
+            ccnl_interface_flush(ccnl, ccnl->ifs + i);
+        }
+    }
+#else
+    (void) ccnl;
+#endif
+}
+
 int
 ccnl_io_loop(struct ccnl_relay_s *ccnl)
 {
-    int i, maxfd = -1, rc;
-    size_t len;
+    int i, maxfd = -1, rc, shardfd = ccnl_shard_fd(), reader;
     fd_set readfs, writefs;
-    unsigned char buf[CCNL_MAX_PACKET_SIZE];
+    struct ccnl_rxring_s ring;
 
     if (ccnl->ifcount == 0) {
         DEBUGMSG(ERROR, "no socket to work with, not good, quitting\n");
         exit(EXIT_FAILURE);
     }
+    if (ccnl_rxring_init(&ring)) {
+        DEBUGMSG(ERROR, "cannot allocate %d receive buffers\n", ring.cnt);
+        exit(EXIT_FAILURE);
+    }
     for (i = 0; i < ccnl->ifcount; i++) {
         if (ccnl->ifs[i].sock > maxfd) {
             maxfd = ccnl->ifs[i].sock;
         }
     }
+    if (shardfd > maxfd) {
+        maxfd = shardfd;
+    }
     maxfd++;
+    reader = ccnl_rcu_register(&ccnl->fib_rcu);
 
     DEBUGMSG(INFO, "starting main event and IO loop\n");
     while (!ccnl->halt_flag) {
         int usec;
 
+        // no FIB entry is held from one round to the next
+        ccnl_rcu_quiescent(&ccnl->fib_rcu, reader);
+        ccnl_fib_reclaim(ccnl);
+        // FIB changes go in before the datagrams received this round
+        ccnl_shard_flush();
+
         FD_ZERO(&readfs);
         FD_ZERO(&writefs);
 
 #ifdef USE_HTTP_STATUS
         ccnl_http_anteselect(ccnl, ccnl->http, &readfs, &writefs, &maxfd);
 #endif
+        usec = ccnl_run_events();
+        ccnl_io_flush(ccnl);
         for (i = 0; i < ccnl->ifcount; i++) {
+            // interfaces left to another worker are closed
+            if (ccnl->ifs[i].sock < 0) {
+                continue;
+            }
             FD_SET(ccnl->ifs[i].sock, &readfs);
-            if (ccnl->ifs[i].qlen > 0) {
+            if (CCNL_IO_WRITABLE(ccnl->ifs + i)) {
                 FD_SET(ccnl->ifs[i].sock, &writefs);
             }
         }
+        if (shardfd >= 0) {
+            FD_SET(shardfd, &readfs);
+        }
 
-        usec = ccnl_run_events();
         if (usec >= 0) {
             struct timeval deadline;
             deadline.tv_sec = usec / 1000000;
@@ -613,61 +992,216 @@ ccnl_io_loop(struct ccnl_relay_s *ccnl)
 #ifdef USE_HTTP_STATUS
         ccnl_http_postselect(ccnl, ccnl->http, &readfs, &writefs);
 #endif
+        if (shardfd >= 0 && FD_ISSET(shardfd, &readfs)) {
+            ccnl_shard_drain(ccnl);
+        }
         for (i = 0; i < ccnl->ifcount; i++) {
+            if (ccnl->ifs[i].sock < 0) {
+                continue;
+            }
             if (FD_ISSET(ccnl->ifs[i].sock, &readfs)) {
-                sockunion src_addr;
-                socklen_t addrlen = sizeof(sockunion);
-                ssize_t recvlen;
-                if ((recvlen = recvfrom(ccnl->ifs[i].sock, buf, sizeof(buf), 0,
-                                (struct sockaddr*) &src_addr, &addrlen)) > 0) {
-                    len = (size_t) recvlen;
-                    if (0) {}
-#ifdef USE_IPV4
-                    else if (src_addr.sa.sa_family == AF_INET) {
-                        ccnl_core_RX(ccnl, i, buf, len,
-                                     &src_addr.sa, sizeof(src_addr.ip4));
-                    }
-#endif
-#ifdef USE_IPV6
-                    else if (src_addr.sa.sa_family == AF_INET6) {
-                        ccnl_core_RX(ccnl, i, buf, len,
-                                     &src_addr.sa, sizeof(src_addr.ip6));
-                    }
-#endif
-#ifdef USE_LINKLAYER
-                    else if (src_addr.sa.sa_family == AF_PACKET) {
-                        if (len > 14) {
-                            ccnl_core_RX(ccnl, i, buf + 14, len - 14,
-                                         &src_addr.sa, sizeof(src_addr.linklayer));
-                        }
-                    }
+                ccnl_io_recv(ccnl, i, &ring, 0);
+            }
+
+            if (FD_ISSET(ccnl->ifs[i].sock, &writefs)) {
+                if (ccnl->ifs[i].txbatch > 1) {
+                    ccnl_interface_flush(ccnl, ccnl->ifs + i);
+                } else {
+                    ccnl_interface_CTS(ccnl, ccnl->ifs + i);
+                }
+            }
+        }
+    }
+
+    ccnl_rcu_unregister(&ccnl->fib_rcu, reader);
+    ccnl_rxring_free(&ring);
+    return 0;
+}
+
+#ifdef CCNL_HAVE_EPOLL
+
+#define CCNL_EPOLL_HTTP_SERVER  CCNL_MAX_INTERFACES
+#define CCNL_EPOLL_HTTP_CLIENT  (CCNL_MAX_INTERFACES + 1)
+#define CCNL_EPOLL_SHARD        (CCNL_MAX_INTERFACES + 2)
+
+// brings the registration of fd in line with the wanted events, where no
+// events means not registered
+static void
+ccnl_io_epoll_sync(int epfd, int fd, uint32_t id, uint32_t want, uint32_t *have)
+{
+    struct epoll_event ev;
+    int rc = 0;
+
+    if (want == *have) {
+        return;
+    }
+    ev.events = want;
+    ev.data.u32 = id;
+    if (!*have) {
+        rc = epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    } else if (!want) {
+        // closing a socket already dropped its registration
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev);
+    } else if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) && errno == ENOENT) {
+        rc = epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+    if (rc) {
+        perror("epoll_ctl(): ");
+        exit(EXIT_FAILURE);
+    }
+    *have = want;
+}
+
+int
+ccnl_io_loop_epoll(struct ccnl_relay_s *ccnl)
+{
+    struct epoll_event events[CCNL_MAX_INTERFACES + 3];
+    uint32_t ifevents[CCNL_MAX_INTERFACES];
+    int ready[CCNL_MAX_INTERFACES], isready[CCNL_MAX_INTERFACES];
+    int i, k, n, epfd, nready = 0, reader;
+    uint32_t shardevents = 0;
+#ifdef USE_HTTP_STATUS
+    uint32_t serverevents = 0, clientevents = 0;
+    int clientfd = 0;
 #endif
-#ifdef USE_WPAN
-                    else if (src_addr.sa.sa_family == AF_IEEE802154) {
-                        if (len > 14) {
-                            ccnl_core_RX(ccnl, i, buf, len,
-                                         &src_addr.sa, sizeof(src_addr.linklayer));
-                        }
-                    }
+    struct ccnl_rxring_s ring;
+
+    if (ccnl->ifcount == 0) {
+        DEBUGMSG(ERROR, "no socket to work with, not good, quitting\n");
+        exit(EXIT_FAILURE);
+    }
+    if (ccnl_rxring_init(&ring)) {
+        DEBUGMSG(ERROR, "cannot allocate %d receive buffers\n", ring.cnt);
+        exit(EXIT_FAILURE);
+    }
+    epfd = epoll_create1(0);
+    if (epfd < 0) {
+        perror("epoll_create1(): ");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < ccnl->ifcount; i++) {
+        ifevents[i] = isready[i] = 0;
+        // interfaces left to another worker are closed
+        if (ccnl->ifs[i].sock >= 0) {
+            ccnl_io_epoll_sync(epfd, ccnl->ifs[i].sock, i, EPOLLIN | EPOLLET, ifevents + i);
+        }
+    }
+    if (ccnl_shard_fd() >= 0) {
+        ccnl_io_epoll_sync(epfd, ccnl_shard_fd(), CCNL_EPOLL_SHARD, EPOLLIN, &shardevents);
+    }
+    reader = ccnl_rcu_register(&ccnl->fib_rcu);
+
+    DEBUGMSG(INFO, "starting main event and IO loop (epoll)\n");
+    while (!ccnl->halt_flag) {
+        int usec, timeout;
+
+        // no FIB entry is held from one round to the next
+        ccnl_rcu_quiescent(&ccnl->fib_rcu, reader);
+        ccnl_fib_reclaim(ccnl);
+        // FIB changes go in before the datagrams received this round
+        ccnl_shard_flush();
+
+#ifdef USE_HTTP_STATUS
+        if (ccnl->http) {
+            struct ccnl_http_s *http = ccnl->http;
+            if (clientfd != http->client) {
+                ccnl_io_epoll_sync(epfd, clientfd, CCNL_EPOLL_HTTP_CLIENT, 0, &clientevents);
+                clientfd = http->client;
+            }
+            ccnl_io_epoll_sync(epfd, http->server, CCNL_EPOLL_HTTP_SERVER,
+                               http->client ? 0 : EPOLLIN, &serverevents);
+            if (http->client) {
+                ccnl_io_epoll_sync(epfd, http->client, CCNL_EPOLL_HTTP_CLIENT,
+                                   ((unsigned long)http->inlen < sizeof(http->in) ? EPOLLIN : 0) |
+                                   (http->outlen > 0 ? EPOLLOUT : 0), &clientevents);
+            }
+        }
 #endif
-#ifdef USE_UNIXSOCKET
-                    else if (src_addr.sa.sa_family == AF_UNIX) {
-                        ccnl_core_RX(ccnl, i, buf, len,
-                                     &src_addr.sa, sizeof(src_addr.ux));
-                    }
+
+        usec = ccnl_run_events();
+        ccnl_io_flush(ccnl);
+        // a queue is left over if a scheduler paces it or a send would
+        // block, only the latter waits for the socket
+        for (i = 0; i < ccnl->ifcount; i++) {
+            if (ccnl->ifs[i].sock < 0) {
+                continue;
+            }
+            ccnl_io_epoll_sync(epfd, ccnl->ifs[i].sock, i, EPOLLIN | EPOLLET |
+                               (CCNL_IO_WRITABLE(ccnl->ifs + i) ? EPOLLOUT : 0),
+                               ifevents + i);
+        }
+
+        // interfaces left undrained last round must not wait for a new edge
+        timeout = nready ? 0 : usec < 0 ? -1 : (usec + 999) / 1000;
+        n = epoll_wait(epfd, events, sizeof(events) / sizeof(events[0]), timeout);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait(): ");
+            exit(EXIT_FAILURE);
+        }
+
+        for (k = 0; k < n; k++) {
+            uint32_t id = events[k].data.u32;
+            if (id == CCNL_EPOLL_SHARD) {
+                ccnl_shard_drain(ccnl);
+                continue;
+            }
+#ifdef USE_HTTP_STATUS
+            if (id == CCNL_EPOLL_HTTP_SERVER || id == CCNL_EPOLL_HTTP_CLIENT) {
+                continue;
+            }
 #endif
+            if (events[k].events & (EPOLLIN | EPOLLERR) && !isready[id]) {
+                isready[id] = 1;
+                ready[nready++] = id;
+            }
+            if (events[k].events & EPOLLOUT) {
+                ccnl_interface_flush(ccnl, ccnl->ifs + id);
+            }
+        }
+#ifdef USE_HTTP_STATUS
+        if (ccnl->http) {
+            int server_readable = 0, client_readable = 0, client_writable = 0;
+            for (k = 0; k < n; k++) {
+                if (events[k].data.u32 == CCNL_EPOLL_HTTP_SERVER) {
+                    server_readable = 1;
+                } else if (events[k].data.u32 == CCNL_EPOLL_HTTP_CLIENT) {
+                    client_readable = (events[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0;
+                    client_writable = (events[k].events & EPOLLOUT) != 0;
                 }
             }
+            ccnl_http_handle(ccnl, ccnl->http, server_readable,
+                             client_readable, client_writable);
+        }
+#endif
 
-            if (FD_ISSET(ccnl->ifs[i].sock, &writefs)) {
-              ccnl_interface_CTS(ccnl, ccnl->ifs + i);
+        // edge triggered: read until the socket is empty, but bounded so
+        // that timers and other interfaces get their turn
+        for (k = i = 0; k < nready; k++) {
+            int id = ready[k], budget = CCNL_EPOLL_RX_BUDGET, rc = 1;
+            while (budget > 0 &&
+                   (rc = ccnl_io_recv(ccnl, id, &ring, MSG_DONTWAIT)) >= 0) {
+                budget -= rc > 0 ? rc : 1;
+            }
+            if (rc >= 0) {
+                ready[i++] = id;
+            } else {
+                isready[id] = 0;
             }
         }
+        nready = i;
     }
 
+    ccnl_rcu_unregister(&ccnl->fib_rcu, reader);
+    close(epfd);
+    ccnl_rxring_free(&ring);
     return 0;
 }
 
+#endif // CCNL_HAVE_EPOLL
+
 void
 ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
 {
@@ -726,7 +1260,7 @@ ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
             continue;
         }
 
-        buf = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*buf) + s.st_size);
+        buf = ccnl_buf_new(NULL, (size_t) s.st_size);
         if (buf) {
             recvlen = read(fd, buf->data, flen);
         } else {
@@ -810,12 +1344,12 @@ ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
         c->flags |= CCNL_CONTENT_FLAGS_STATIC;
 Done:
         ccnl_pkt_free(pk);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
         continue;
 #if defined(USE_SUITE_CCNB) || defined(USE_SUITE_NDNTLV)
 notacontent:
         DEBUGMSG(WARNING, "not a content object (%s)\n", de->d_name);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
 #endif
     }
 
@@ -1187,19 +1187,15 @@ mkAddToRelayCacheRequest(uint8_t *out, size_t outlen, char *fname,
         goto Bail;
     }
 
-    if (!prefix->chunknum){
-        prefix->chunknum = ccnl_malloc(sizeof(uint32_t));
-        if (!prefix->chunknum) {
-            goto Bail;
-        }
-        *prefix->chunknum = 0;
+    if (prefix->chunknum < 0) {
+        prefix->chunknum = 0;
         chunkflag = 0;
     } else {
         chunkflag = 1;
     }
 
     memset(h, '\0', sizeof(h));
-    snprintf((char*)h, sizeof(h), "%d", *prefix->chunknum);
+    snprintf((char*)h, sizeof(h), "%d", (int) prefix->chunknum);
     if (ccnl_ccnb_mkBlob(contentobj+len2, contentobj + 4000, CCNL_DTAG_CHUNKNUM, CCN_TT_DTAG,  // chunknum
                             (char*) h, strlen((char*)h), &len2)) {
         goto Bail;
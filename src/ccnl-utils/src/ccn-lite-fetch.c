@@ -150,7 +150,7 @@ ccnl_prefix_removeChunkNumComponent(int suite,
 #ifdef USE_SUITE_CCNTLV
     case CCNL_SUITE_CCNTLV:
         // TODO: asumes that chunk is at the end!
-        if(prefix->comp[prefix->compcnt-1][1] == CCNX_TLV_N_Chunk) {
+        if(ccnl_prefix_comp(prefix, prefix->compcnt-1)[1] == CCNX_TLV_N_Chunk) {
             prefix->compcnt--;
         } else {
             DEBUGMSG(WARNING, "Tried to remove chunknum from CCNTLV prefix, but either prefix does not have a chunknum "
@@ -161,7 +161,7 @@ ccnl_prefix_removeChunkNumComponent(int suite,
 #endif
 #ifdef USE_SUITE_NDNTLV
     case CCNL_SUITE_NDNTLV:
-        if(prefix->comp[prefix->compcnt-1][0] == NDN_Marker_SegmentNumber) {
+        if(ccnl_prefix_comp(prefix, prefix->compcnt-1)[0] == NDN_Marker_SegmentNumber) {
             prefix->compcnt--;
         }
         break;
@@ -170,6 +170,7 @@ ccnl_prefix_removeChunkNumComponent(int suite,
         DEBUGMSG(ERROR, "removeChunkNum: suite %d not implemented\n", suite);
         return -1;
     }
+    ccnl_prefix_rehash(prefix);
 
     return 0;
 }
@@ -289,14 +290,7 @@ usage:
     while (retry < maxretry) {
 
         if (curchunknum) {
-            if (!prefix->chunknum) {
-                prefix->chunknum = ccnl_malloc(sizeof(uint32_t));
-                if (!prefix->chunknum) {
-                    DEBUGMSG(ERROR, "Failed to allocate memory: %d", errno);
-                    exit(1);
-                }
-            }
-            *(prefix->chunknum) = *curchunknum;
+            prefix->chunknum = *curchunknum;
             DEBUGMSG(INFO, "fetching chunk %d for prefix '%s'\n", *curchunknum, ccnl_prefix_to_path(prefix));
         } else {
             DEBUGMSG(DEBUG, "fetching first chunk...\n");
@@ -330,12 +324,12 @@ usage:
                 prefix = nextprefix;
 
                 // Check if the fetched content is a chunk
-                if (!(prefix->chunknum)) {
+                if (prefix->chunknum < 0) {
                     // Response is not chunked, print content and exit
                     write(1, content, contlen);
                     goto Done;
                 } else {
-                    uint32_t chunknum = *(prefix->chunknum);
+                    uint32_t chunknum = (uint32_t) prefix->chunknum;
 
                     // allocate curchunknum because it is the first fetched chunk
                     if (!curchunknum) {
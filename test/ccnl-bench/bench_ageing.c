@@ -0,0 +1,122 @@
+/**
+ * @file bench_ageing.c
+ * @brief Benchmark of the periodic ageing of the content store
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-pkt.h"
+#include "ccnl-content.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
+#include "ccnl-os-time.h"
+
+#define ROUNDS          20
+#define EXPIRED_SHARE   100  // one content in this many is due
+
+/* the content part of ccnl_do_ageing before the ageing wheels */
+static int
+sweep(struct ccnl_relay_s *relay, uint32_t t)
+{
+    struct ccnl_content_s *c;
+    int stale = 0;
+
+    for (c = relay->contents; c; c = c->next) {
+        if ((c->last_used + CCNL_CONTENT_TIMEOUT) <= t &&
+            !(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            continue;
+        }
+        if (c->pkt->suite == CCNL_SUITE_NDNTLV &&
+            (c->last_used + (c->pkt->s.ndntlv.freshnessperiod / 1000)) <= t &&
+            !(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            c->flags |= CCNL_CONTENT_FLAGS_STALE;
+            stale++;
+        }
+    }
+    return stale;
+}
+
+static void
+run(int size)
+{
+    struct ccnl_relay_s *relay = calloc(1, sizeof(*relay));
+    uint32_t now = (uint32_t) CCNL_NOW();
+    uint64_t t0, t_sweep, t_wheel, t_expire;
+    char uri[64];
+    int i, k, expired = 0;
+
+    relay->max_cache_entries = -1;
+    for (i = 0; i < size; i++) {
+        struct ccnl_pkt_s *pkt = calloc(1, sizeof(*pkt));
+        struct ccnl_content_s *c;
+
+        snprintf(uri, sizeof(uri), "/bench/ageing/object%d/chunk%d", i / 16, i % 16);
+        pkt->pfx = ccnl_URItoPrefix(uri, CCNL_SUITE_NDNTLV, NULL);
+        pkt->suite = CCNL_SUITE_NDNTLV;
+        pkt->s.ndntlv.freshnessperiod = 3600 * 1000;
+        c = ccnl_content_new(&pkt);
+        if (i % EXPIRED_SHARE == 0) {
+            // cached long enough ago to time out with the next round
+            c->last_used = now - CCNL_CONTENT_TIMEOUT;
+            expired++;
+        }
+        ccnl_content_add2cache(relay, c);
+    }
+
+    t0 = bench_now_ns();
+    for (k = 0; k < ROUNDS; k++) {
+        sweep(relay, now);
+    }
+    t_sweep = (bench_now_ns() - t0) / ROUNDS;
+
+    // the first round removes what is due
+    t0 = bench_now_ns();
+    ccnl_do_ageing(relay, NULL);
+    t_expire = bench_now_ns() - t0;
+
+    t0 = bench_now_ns();
+    for (k = 0; k < ROUNDS; k++) {
+        // a fresh second each round so that the wheel has a slot to visit
+        relay->cs_ageing.next--;
+        ccnl_do_ageing(relay, NULL);
+    }
+    t_wheel = (bench_now_ns() - t0) / ROUNDS;
+
+    printf("%8d | %14.3f | %14.3f | %8d | %14.1f | %d\n", size,
+           t_sweep / 1e6, t_wheel / 1e3, expired,
+           expired ? (double) t_expire / expired : 0.0,
+           relay->contentcnt == size - expired);
+
+    // contents are owned by the relay, leave them to the process exit
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[] = { 10000, 100000, 1000000 };
+    unsigned i;
+    (void) argc;
+    (void) argv;
+
+    printf("%8s | %14s | %14s | %8s | %14s | %s\n", "entries",
+           "sweep ms/round", "wheel us/round", "expired", "ns/expired", "ok");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        run(sizes[i]);
+    }
+    return 0;
+}
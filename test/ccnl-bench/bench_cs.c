@@ -0,0 +1,159 @@
+/**
+ * @file bench_cs.c
+ * @brief Benchmark of the Content Store lookup and eviction cost versus cache size
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-pkt.h"
+#include "ccnl-malloc.h"
+#include "ccnl-content.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
+
+#define LOOKUPS         100000
+#define LINEAR_LOOKUPS  1000
+#define EVICTIONS       100000
+#define LINEAR_EVICTIONS 1000
+
+static struct ccnl_content_s*
+linear_lookup(struct ccnl_relay_s *relay, struct ccnl_prefix_s *prefix)
+{
+    struct ccnl_content_s *c;
+
+    for (c = relay->contents; c; c = c->next) {
+        if (ccnl_prefix_cmp(c->pkt->pfx, NULL, prefix, CMP_EXACT) == 0) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+/* the victim selection ccnl_content_add2cache used before the replacement engine */
+static struct ccnl_content_s*
+linear_victim(struct ccnl_relay_s *relay)
+{
+    struct ccnl_content_s *c, *oldest = NULL;
+    uint32_t age = 0;
+
+    for (c = relay->contents; c; c = c->next) {
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC) &&
+            ((age == 0) || c->last_used < age)) {
+            age = c->last_used;
+            oldest = c;
+        }
+    }
+    return oldest;
+}
+
+/* replaces the victim by a "new" content, half of the operations are cache hits */
+static double
+evict(struct ccnl_relay_s *relay, struct ccnl_content_s **cs, int size,
+      int policy, int ops)
+{
+    uint32_t seed = 0x9e3779b9;
+    uint64_t t0;
+    int i;
+
+    if (policy >= 0) {
+        ccnl_content_repl_set_policy(relay, (ccnl_cs_replacement) policy);
+    }
+    t0 = bench_now_ns();
+    for (i = 0; i < ops; i++) {
+        struct ccnl_content_s *c = cs[bench_rand(&seed) % size];
+
+        c->served_cnt++;
+        c->last_used++;
+        if (policy >= 0) {
+            ccnl_content_repl_touch(relay, c);
+            c = ccnl_content_repl_victim(relay);
+            ccnl_content_repl_remove(relay, c);
+            c->served_cnt = 0;
+            ccnl_content_repl_add(relay, c);
+        } else {
+            c = linear_victim(relay);
+            c->last_used += ops;
+        }
+    }
+    return (double) (bench_now_ns() - t0) / ops;
+}
+
+static void
+run(int size)
+{
+    struct ccnl_relay_s *relay = calloc(1, sizeof(*relay));
+    struct ccnl_prefix_s **names = calloc(size, sizeof(*names));
+    struct ccnl_content_s **cs = calloc(size, sizeof(*cs));
+    uint32_t seed = 0x2545f491;
+    uint64_t t0, t_index, t_linear;
+    char uri[64];
+    int i, hits = 0;
+
+    relay->max_cache_entries = -1;
+    for (i = 0; i < size; i++) {
+        struct ccnl_pkt_s *pkt = calloc(1, sizeof(*pkt));
+        struct ccnl_content_s *c;
+
+        snprintf(uri, sizeof(uri), "/bench/cs/object%d/chunk%d", i / 16, i % 16);
+        pkt->pfx = ccnl_URItoPrefix(uri, 0, NULL);
+        c = ccnl_content_new(&pkt);
+        ccnl_content_add2cache(relay, c);
+        names[i] = c->pkt->pfx;
+        cs[i] = c;
+    }
+
+    t0 = bench_now_ns();
+    for (i = 0; i < LOOKUPS; i++) {
+        hits += ccnl_content_index_lookup(relay, names[bench_rand(&seed) % size]) != NULL;
+    }
+    t_index = bench_now_ns() - t0;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < LINEAR_LOOKUPS; i++) {
+        hits += linear_lookup(relay, names[bench_rand(&seed) % size]) != NULL;
+    }
+    t_linear = bench_now_ns() - t0;
+
+    printf("%8d | %12.1f | %12.1f | %5.1f | %5.1f | %5.1f | %12.1f | %d\n", size,
+           (double) t_index / LOOKUPS, (double) t_linear / LINEAR_LOOKUPS,
+           evict(relay, cs, size, CCNL_CS_REPLACE_LRU, EVICTIONS),
+           evict(relay, cs, size, CCNL_CS_REPLACE_CLOCK, EVICTIONS),
+           evict(relay, cs, size, CCNL_CS_REPLACE_LFU, EVICTIONS),
+           evict(relay, cs, size, -1, LINEAR_EVICTIONS),
+           hits == LOOKUPS + LINEAR_LOOKUPS);
+
+    // contents are owned by the relay, leave them to the process exit
+    free(names);
+    free(cs);
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[] = { 100, 1000, 10000, 100000 };
+    unsigned i;
+    (void) argc;
+    (void) argv;
+
+    printf("%8s | %12s | %12s | %5s | %5s | %5s | %12s | %s\n", "entries",
+           "index ns/op", "linear ns/op", "lru", "clock", "lfu", "scan ns/evict", "ok");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        run(sizes[i]);
+    }
+    return 0;
+}
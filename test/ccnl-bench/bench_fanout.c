@@ -0,0 +1,122 @@
+/**
+ * @file bench_fanout.c
+ * @brief Benchmark of sending one packet to many faces, copied versus shared
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * usage: bench_fanout [packet_size [sends]]
+ *
+ * A packet is passed to ccnl_send_pkt() for every face of a relay, as when
+ * a Data satisfies a PIT entry with many downstream faces. The copying
+ * variant is what ccnl_send_pkt() did before buffers were shared: one
+ * buf_dup() per face. The link layer only counts bytes, so the numbers
+ * are the cost of the face and interface queues plus the copies.
+ *
+ * The default build uses the armoring allocator, which never returns
+ * memory, configure with -DCCNL_DEBUG_MALLOC=OFF for meaningful numbers.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-malloc.h"
+#include "ccnl-buf.h"
+#include "ccnl-pkt.h"
+#include "ccnl-relay.h"
+
+static uint64_t txbytes;
+
+static void
+bench_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+         sockunion *dest, struct ccnl_buf_s *buf)
+{
+    (void) ccnl;
+    (void) ifc;
+    (void) dest;
+    txbytes += buf->datalen + buf->data[buf->datalen - 1];
+}
+
+static double
+run(int faces, size_t size, uint32_t sends, int share)
+{
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(*relay));
+    struct ccnl_face_s **f = ccnl_calloc(faces, sizeof(*f));
+    struct ccnl_pkt_s *pkt = ccnl_calloc(1, sizeof(*pkt));
+    uint32_t rounds = sends / faces, r;
+    uint64_t t0, t;
+    int i;
+
+    relay->ccnl_ll_TX_ptr = bench_TX;
+    relay->ifcount = 1;
+    for (i = 0; i < faces; i++) {
+        sockunion su;
+
+        memset(&su, 0, sizeof(su));
+        su.ip4.sin_family = AF_INET;
+        su.ip4.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        su.ip4.sin_port = htons(10000 + i);
+        f[i] = ccnl_get_face_or_create(relay, 0, &su.sa, sizeof(su.ip4));
+    }
+    pkt->buf = ccnl_buf_new(NULL, size);
+    memset(pkt->buf->data, 0x42, size);
+
+    if (!rounds) {
+        rounds = 1;
+    }
+    t0 = bench_now_ns();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < faces; i++) {
+            if (share) {
+                ccnl_send_pkt(relay, f[i], pkt);
+            } else {
+                ccnl_face_enqueue(relay, f[i], buf_dup(pkt->buf));
+            }
+        }
+    }
+    t = bench_now_ns() - t0;
+
+    ccnl_buf_free(pkt->buf);
+    ccnl_free(pkt);
+    while (relay->faces) {
+        ccnl_face_remove(relay, relay->faces);
+    }
+    ccnl_face_index_free(relay);
+    ccnl_free(f);
+    ccnl_free(relay);
+    return rounds * 1e9 / (double) t;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t size = argc > 1 ? (size_t) atol(argv[1]) : 1400;
+    uint32_t sends = argc > 2 ? (uint32_t) atol(argv[2]) : 100000;
+    int faces[] = {1, 4, 16, 64, 256};
+    unsigned k;
+
+    if (size < 1) {
+        size = 1;
+    }
+    printf("packet size %zu bytes, %u sends per run\n", size, sends);
+    printf("%6s %14s %14s %8s\n", "faces", "copy pkts/s", "share pkts/s", "speedup");
+    for (k = 0; k < sizeof(faces) / sizeof(faces[0]); k++) {
+        double copy = run(faces[k], size, sends, 0);
+        double share = run(faces[k], size, sends, 1);
+        printf("%6d %14.0f %14.0f %7.2fx\n", faces[k], copy, share, share / copy);
+    }
+    return txbytes == 0;
+}
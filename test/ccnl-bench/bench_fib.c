@@ -0,0 +1,122 @@
+/**
+ * @file bench_fib.c
+ * @brief Benchmark of the FIB longest prefix match cost versus FIB size
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-malloc.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
+#include "ccnl-forward.h"
+
+#define LOOKUPS         100000
+#define LINEAR_LOOKUPS  1000
+#define NAMES           1024
+
+/* the match ccnl_interest_propagate did before the FIB index */
+static struct ccnl_forward_s*
+linear_lpm(struct ccnl_relay_s *relay, struct ccnl_prefix_s *name)
+{
+    struct ccnl_forward_s *fwd, *best = NULL;
+    int32_t rc;
+
+    for (fwd = relay->fib; fwd; fwd = fwd->next) {
+        if (fwd->suite != name->suite) {
+            continue;
+        }
+        rc = ccnl_prefix_cmp(fwd->prefix, NULL, name, CMP_LONGEST);
+        if (rc >= (int32_t) fwd->prefix->compcnt &&
+            (!best || fwd->prefix->compcnt > best->prefix->compcnt)) {
+            best = fwd;
+        }
+    }
+    return best;
+}
+
+static void
+run(int size)
+{
+    struct ccnl_relay_s *relay = calloc(1, sizeof(*relay));
+    struct ccnl_prefix_s *names[NAMES];
+    uint32_t seed = 0x2545f491;
+    uint64_t t0, t_index, t_linear;
+    char uri[96];
+    int i, hits = 0;
+
+    // routes are announced with 2 to 4 components below a few top level names
+    for (i = 0; i < size; i++) {
+        struct ccnl_forward_s *fwd = calloc(1, sizeof(*fwd));
+
+        switch (i % 3) {
+        case 0:
+            snprintf(uri, sizeof(uri), "/site%d/org%d", i % 16, i);
+            break;
+        case 1:
+            snprintf(uri, sizeof(uri), "/site%d/org%d/app", i % 16, i - 1);
+            break;
+        default:
+            snprintf(uri, sizeof(uri), "/site%d/org%d/app/v%d", i % 16, i - 2, i);
+            break;
+        }
+        fwd->prefix = ccnl_URItoPrefix(uri, 0, NULL);
+        ccnl_fib_link(relay, fwd);
+    }
+    for (i = 0; i < NAMES; i++) {
+        int r = (int) (bench_rand(&seed) % size) / 3 * 3;
+        snprintf(uri, sizeof(uri), "/site%d/org%d/app/v%d/video/frame%d/chunk%d",
+                 r % 16, r, r + 2, i, i % 7);
+        names[i] = ccnl_URItoPrefix(uri, 0, NULL);
+    }
+
+    t0 = bench_now_ns();
+    for (i = 0; i < LOOKUPS; i++) {
+        hits += ccnl_fib_lpm(relay, names[i % NAMES]) != NULL;
+    }
+    t_index = bench_now_ns() - t0;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < LINEAR_LOOKUPS; i++) {
+        hits += linear_lpm(relay, names[i % NAMES]) != NULL;
+    }
+    t_linear = bench_now_ns() - t0;
+
+    printf("%8d | %12.1f | %12.1f | %d\n", size,
+           (double) t_index / LOOKUPS, (double) t_linear / LINEAR_LOOKUPS,
+           hits == LOOKUPS + LINEAR_LOOKUPS);
+
+    // routes are owned by the relay, leave them to the process exit
+    for (i = 0; i < NAMES; i++) {
+        ccnl_prefix_free(names[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[] = { 99, 999, 9999, 99999 };
+    unsigned i;
+    (void) argc;
+    (void) argv;
+
+    printf("%8s | %12s | %12s | %s\n", "routes", "index ns/op", "linear ns/op", "ok");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        run(sizes[i]);
+    }
+    return 0;
+}
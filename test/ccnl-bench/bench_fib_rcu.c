@@ -0,0 +1,189 @@
+/**
+ * @file bench_fib_rcu.c
+ * @brief Benchmark of FIB lookups from a second thread during route pushes
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * usage: bench_fib_rcu [routes [rounds]]
+ *
+ * A static set of routes is always installed. The writer pushes a full
+ * table of further routes and withdraws it again, round after round, while
+ * a reader thread keeps matching names against the static routes and
+ * reports a quiescent state every few lookups. Inline shows what a single
+ * loop doing both sees: lookups wait for the whole push.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "ccnl-malloc.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
+#include "ccnl-forward.h"
+
+#define STATIC_ROUTES   1000
+#define NAMES           1024
+#define QUIESCE_EVERY   64
+
+struct reader_s {
+    struct ccnl_relay_s *relay;
+    struct ccnl_prefix_s **names;
+    int stop;
+    uint64_t lookups, total_ns, max_ns, misses;
+};
+
+static struct ccnl_forward_s*
+mkroute(const char *fmt, int i)
+{
+    struct ccnl_forward_s *fwd = ccnl_calloc(1, sizeof(*fwd));
+    char uri[64];
+
+    snprintf(uri, sizeof(uri), fmt, i % 16, i);
+    fwd->prefix = ccnl_URItoPrefix(uri, 0, NULL);
+    return fwd;
+}
+
+static void
+push(struct ccnl_relay_s *relay, struct ccnl_forward_s **routes, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        routes[i] = mkroute("/push%d/route%d", i);
+        ccnl_fib_link(relay, routes[i]);
+    }
+    for (i = 0; i < n; i++) {
+        ccnl_fib_remove(relay, routes[i]);
+    }
+}
+
+static void*
+reader_main(void *arg)
+{
+    struct reader_s *r = arg;
+    int id = ccnl_rcu_register(&r->relay->fib_rcu);
+    uint64_t i;
+
+    for (i = 0; !__atomic_load_n(&r->stop, __ATOMIC_ACQUIRE); i++) {
+        uint64_t t0 = bench_now_ns(), dt;
+
+        r->misses += ccnl_fib_lpm(r->relay, r->names[i % NAMES]) == NULL;
+        dt = bench_now_ns() - t0;
+        r->total_ns += dt;
+        if (dt > r->max_ns) {
+            r->max_ns = dt;
+        }
+        if (i % QUIESCE_EVERY == QUIESCE_EVERY - 1) {
+            ccnl_rcu_quiescent(&r->relay->fib_rcu, id);
+        }
+    }
+    r->lookups = i;
+    ccnl_rcu_unregister(&r->relay->fib_rcu, id);
+    return NULL;
+}
+
+static void
+report(const char *mode, struct reader_s *r, uint64_t push_ns, int updates)
+{
+    printf("%-10s | %12.1f | %12.1f | %12.1f | %llu\n", mode,
+           r->lookups ? (double) r->total_ns / r->lookups : 0.0,
+           r->max_ns / 1000.0, (double) push_ns / updates,
+           (unsigned long long) r->misses);
+}
+
+int main(int argc, char **argv)
+{
+    int routes = argc > 1 ? atoi(argv[1]) : 10000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(*relay));
+    struct ccnl_forward_s **pushed;
+    struct ccnl_prefix_s *names[NAMES];
+    struct reader_s r;
+    pthread_t tid;
+    uint64_t t0, push_ns;
+    char uri[96];
+    int i;
+
+    if (routes < 1 || rounds < 1) {
+        fprintf(stderr, "usage: %s [routes [rounds]]\n", argv[0]);
+        return 1;
+    }
+    pushed = ccnl_calloc((size_t) routes, sizeof(*pushed));
+    for (i = 0; i < STATIC_ROUTES; i++) {
+        ccnl_fib_link(relay, mkroute("/site%d/org%d", i));
+    }
+    for (i = 0; i < NAMES; i++) {
+        snprintf(uri, sizeof(uri), "/site%d/org%d/app/frame%d/chunk%d",
+                 i % STATIC_ROUTES % 16, i % STATIC_ROUTES, i, i % 7);
+        names[i] = ccnl_URItoPrefix(uri, 0, NULL);
+    }
+
+    printf("%d routes pushed and withdrawn %d times\n", routes, rounds);
+    printf("%-10s | %12s | %12s | %12s | %s\n", "mode", "lookup ns",
+           "max lookup us", "ns/update", "misses");
+
+    // a single loop: the lookups of a round wait for its push
+    memset(&r, 0, sizeof(r));
+    r.relay = relay;
+    r.names = names;
+    push_ns = 0;
+    for (i = 0; i < rounds; i++) {
+        uint64_t t1 = bench_now_ns(), dt;
+        int k;
+
+        push(relay, pushed, routes);
+        push_ns += bench_now_ns() - t1;
+        for (k = 0; k < NAMES; k++) {
+            r.misses += ccnl_fib_lpm(relay, names[k]) == NULL;
+            dt = bench_now_ns() - t1;
+            r.total_ns += dt;
+            if (dt > r.max_ns) {
+                r.max_ns = dt;
+            }
+        }
+        r.lookups += NAMES;
+    }
+    report("inline", &r, push_ns, 2 * routes * rounds);
+
+    // the reader runs beside the writer and is never held up by it
+    memset(&r, 0, sizeof(r));
+    r.relay = relay;
+    r.names = names;
+    if (pthread_create(&tid, NULL, reader_main, &r)) {
+        perror("pthread_create");
+        return 1;
+    }
+    t0 = bench_now_ns();
+    for (i = 0; i < rounds; i++) {
+        push(relay, pushed, routes);
+    }
+    push_ns = bench_now_ns() - t0;
+    __atomic_store_n(&r.stop, 1, __ATOMIC_RELEASE);
+    pthread_join(tid, NULL);
+    ccnl_fib_reclaim(relay);
+    report("concurrent", &r, push_ns, 2 * routes * rounds);
+
+    printf("%ld cores online, retired left: %s\n", sysconf(_SC_NPROCESSORS_ONLN),
+           relay->fib_retired ? "yes" : "no");
+
+    for (i = 0; i < NAMES; i++) {
+        ccnl_prefix_free(names[i]);
+    }
+    ccnl_free(pushed);
+    return 0;
+}
@@ -0,0 +1,338 @@
+/**
+ * @file bench_frag.c
+ * @brief Benchmark of BeginEnd2015 fragment reassembly under loss and reordering
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * usage: bench_frag [loss% [reorder% [fragment_size]]]
+ *
+ * NDN packets of 1 to 64 fragments are cut the way the sender does and fed
+ * to the receiving side of a face. Each fragment is lost with the given
+ * probability, and with the reorder probability swapped with one of the
+ * next few. The legacy column is the reassembly ccnl_frag_RX_BeginEnd2015()
+ * did before: one packet at a time, grown by a copy per fragment, dropped
+ * at the first gap in the sequence numbers.
+ *
+ * The second table is the sending side: cutting the same packets into
+ * fragments copied into buffers of their own, as ccnl_frag_getnext()
+ * does, or into headers and shares of the packet with
+ * ccnl_frag_getnextslice().
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-malloc.h"
+#include "ccnl-buf.h"
+#include "ccnl-face.h"
+#include "ccnl-frag.h"
+
+#define FRAGMENTS       200000  // per run, whatever the packet size
+#define DISTINCT        8
+#define REORDER_SPAN    4
+
+struct frag_s {
+    unsigned int bits;
+    unsigned int seqno;
+    uint8_t *data;
+    size_t len;
+};
+
+struct legacy_s {
+    unsigned int recvseq;
+    struct ccnl_buf_s *defrag;
+};
+
+static size_t pktlen;
+static uint64_t delivered, bad;
+static volatile uint8_t sink;   // keeps the fragments from being optimized out
+
+static int8_t
+deliver(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+        uint8_t **data, size_t *datalen)
+{
+    (void) relay;
+    (void) from;
+    delivered++;
+    bad += *datalen != pktlen || (*data)[0] != 0x06;
+    *data += *datalen;
+    *datalen = 0;
+    return 0;
+}
+
+/* the receive path before the reassembly contexts, kept for comparison */
+static void
+legacy_rx(struct legacy_s *e, unsigned int bits, unsigned int seqno,
+          uint8_t *data, size_t datalen)
+{
+    struct ccnl_buf_s *buf = NULL;
+
+    if (e->recvseq != seqno) {
+        if (e->defrag) {
+            ccnl_free(e->defrag);
+            e->defrag = NULL;
+        }
+        e->recvseq = seqno;
+    }
+    switch (bits & CCNL_BEFRAG_FLAG_MASK) {
+    case CCNL_BEFRAG_FLAG_SINGLE:
+        if (e->defrag) {
+            ccnl_free(e->defrag);
+            e->defrag = NULL;
+        }
+        e->recvseq++;
+        deliver(NULL, NULL, &data, &datalen);
+        return;
+    case CCNL_BEFRAG_FLAG_FIRST:
+        if (e->defrag) {
+            ccnl_free(e->defrag);
+        }
+        e->defrag = ccnl_buf_new(data, datalen);
+        break;
+    case CCNL_BEFRAG_FLAG_LAST:
+        if (!e->defrag) {
+            break;
+        }
+        buf = ccnl_buf_new(NULL, e->defrag->datalen + datalen);
+        if (buf) {
+            memcpy(buf->data, e->defrag->data, e->defrag->datalen);
+            memcpy(buf->data + e->defrag->datalen, data, datalen);
+        }
+        ccnl_free(e->defrag);
+        e->defrag = NULL;
+        break;
+    default:
+        if (!e->defrag) {
+            break;
+        }
+        buf = ccnl_buf_new(NULL, e->defrag->datalen + datalen);
+        if (buf) {
+            memcpy(buf->data, e->defrag->data, e->defrag->datalen);
+            memcpy(buf->data + e->defrag->datalen, data, datalen);
+            ccnl_free(e->defrag);
+            e->defrag = buf;
+            buf = NULL;
+        } else {
+            ccnl_free(e->defrag);
+            e->defrag = NULL;
+        }
+        break;
+    }
+    e->recvseq++;
+    if (buf) {
+        uint8_t *frag = buf->data;
+        size_t fraglen = buf->datalen;
+
+        deliver(NULL, NULL, &frag, &fraglen);
+        ccnl_buf_free(buf);
+    }
+}
+
+/* an NDN Data packet of len bytes, the length in its header */
+static uint8_t*
+mkpkt(size_t len, uint8_t tag)
+{
+    uint8_t *pkt = ccnl_malloc(len);
+    size_t i;
+
+    pkt[0] = 0x06;
+    pkt[1] = 253;
+    pkt[2] = (uint8_t) ((len - 4) >> 8);
+    pkt[3] = (uint8_t) (len - 4);
+    for (i = 4; i < len; i++) {
+        pkt[i] = (uint8_t) (tag + i);
+    }
+    return pkt;
+}
+
+/* cuts packets into a stream of fragments, then loses and swaps some */
+static int
+mkstream(struct frag_s *s, uint8_t **pkts, int packets, int nfrags,
+         size_t fraglen, int loss, int reorder, uint32_t *rnd)
+{
+    unsigned int seqno = 0;
+    int i, k, n = 0, m = 0;
+
+    for (i = 0; i < packets; i++) {
+        for (k = 0; k < nfrags; k++, n++) {
+            s[n].seqno = seqno++ & CCNL_BEFRAG_SEQ_MASK;
+            s[n].data = pkts[i % DISTINCT] + k * fraglen;
+            s[n].len = k == nfrags - 1 ? pktlen - k * fraglen : fraglen;
+            if (nfrags == 1) {
+                s[n].bits = CCNL_BEFRAG_FLAG_SINGLE;
+            } else if (k == 0) {
+                s[n].bits = CCNL_BEFRAG_FLAG_FIRST;
+            } else if (k == nfrags - 1) {
+                s[n].bits = CCNL_BEFRAG_FLAG_LAST;
+            } else {
+                s[n].bits = CCNL_BEFRAG_FLAG_MID;
+            }
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if ((int) (bench_rand(rnd) % 100) < reorder && i + 1 < n) {
+            struct frag_s t = s[i];
+            int j = i + 1 + (int) (bench_rand(rnd) % REORDER_SPAN);
+
+            if (j >= n) {
+                j = n - 1;
+            }
+            s[i] = s[j];
+            s[j] = t;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if ((int) (bench_rand(rnd) % 100) >= loss) {
+            s[m++] = s[i];
+        }
+    }
+    return m;
+}
+
+/* cuts packets into fragments for sending, returns the nanoseconds */
+static uint64_t
+cut(struct ccnl_buf_s *pkt, int packets, int mtu, int slice)
+{
+    struct ccnl_frag_s *fr = ccnl_frag_new(CCNL_FRAG_BEGINEND2015, mtu);
+    uint8_t hdr[CCNL_FRAG_HDR_MAX];
+    struct ccnl_buf_s *b;
+    size_t hdrlen;
+    sockunion dst;
+    uint64_t t0 = bench_now_ns();
+    int i;
+
+    memset(&dst, 0, sizeof(dst));
+    for (i = 0; i < packets; i++) {
+        ccnl_frag_reset(fr, ccnl_buf_share(pkt), 0, &dst);
+        for (;;) {
+            b = slice ? ccnl_frag_getnextslice(fr, hdr, &hdrlen, NULL, NULL)
+                      : ccnl_frag_getnext(fr, NULL, NULL);
+            if (!b) {
+                break;
+            }
+            sink = b->data[0];
+            ccnl_buf_free(b);
+        }
+    }
+    t0 = bench_now_ns() - t0;
+    ccnl_frag_destroy(fr);
+    return t0;
+}
+
+static void
+report(const char *mode, int nfrags, int packets, uint64_t ns)
+{
+    double secs = ns / 1e9;
+
+    printf("%6d | %-8s | %12.0f | %10.1f | %10.1f | %llu\n", nfrags, mode,
+           delivered / secs, delivered * pktlen / secs / 1e6,
+           100.0 * delivered / packets, (unsigned long long) bad);
+}
+
+int main(int argc, char **argv)
+{
+    int loss = argc > 1 ? atoi(argv[1]) : 0;
+    int reorder = argc > 2 ? atoi(argv[2]) : 0;
+    size_t fraglen = argc > 3 ? (size_t) atoi(argv[3]) : 1000;
+    struct frag_s *stream = ccnl_malloc(FRAGMENTS * sizeof(*stream));
+    uint32_t rnd = 0x2545f491;
+    int nfrags;
+
+    if (loss < 0 || loss > 100 || reorder < 0 || reorder > 100 ||
+        fraglen < 16 || fraglen > CCNL_MAX_PACKET_SIZE ||
+        fraglen * CCNL_FRAG_MAX_FRAGS > 65535 + 4) {
+        fprintf(stderr, "usage: %s [loss%% [reorder%% [fragment_size]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    printf("%d%% loss, %d%% reordered within %d, %zu byte fragments\n",
+           loss, reorder, REORDER_SPAN, fraglen);
+    printf("%6s | %-8s | %12s | %10s | %10s | %s\n", "frags", "mode",
+           "packets/s", "MB/s", "delivered%", "bad");
+
+    for (nfrags = 1; nfrags <= CCNL_FRAG_MAX_FRAGS; nfrags *= 2) {
+        int packets = FRAGMENTS / nfrags, n, i;
+        uint8_t *pkts[DISTINCT];
+        struct ccnl_face_s face;
+        struct legacy_s legacy;
+        uint64_t t0;
+
+        pktlen = nfrags * fraglen - fraglen / 2;
+        if (nfrags == 1) {
+            pktlen = fraglen;
+        }
+        for (i = 0; i < DISTINCT; i++) {
+            pkts[i] = mkpkt(pktlen, (uint8_t) i);
+        }
+        n = mkstream(stream, pkts, packets, nfrags, fraglen, loss, reorder,
+                     &rnd);
+
+        memset(&legacy, 0, sizeof(legacy));
+        delivered = bad = 0;
+        t0 = bench_now_ns();
+        for (i = 0; i < n; i++) {
+            legacy_rx(&legacy, stream[i].bits, stream[i].seqno,
+                      stream[i].data, stream[i].len);
+        }
+        report("legacy", nfrags, packets, bench_now_ns() - t0);
+        ccnl_free(legacy.defrag);
+
+        memset(&face, 0, sizeof(face));
+        delivered = bad = 0;
+        t0 = bench_now_ns();
+        for (i = 0; i < n; i++) {
+            uint8_t *data = stream[i].data;
+            size_t len = stream[i].len;
+
+            ccnl_frag_RX_BeginEnd2015(deliver, NULL, &face, (int) fraglen,
+                                      stream[i].bits, stream[i].seqno,
+                                      &data, &len);
+        }
+        report("reasm", nfrags, packets, bench_now_ns() - t0);
+        ccnl_frag_destroy(face.frag);
+
+        for (i = 0; i < DISTINCT; i++) {
+            ccnl_free(pkts[i]);
+        }
+    }
+
+    // sending: each fragment copied into a buffer of its own, or its
+    // header written and the bytes left where they are
+    printf("\n%6s | %-8s | %12s | %10s\n", "frags", "cut", "packets/s", "MB/s");
+    for (nfrags = 2; nfrags <= CCNL_FRAG_MAX_FRAGS; nfrags *= 2) {
+        int packets = FRAGMENTS / nfrags, slice;
+        struct ccnl_buf_s *pkt;
+        uint8_t *bytes;
+
+        pktlen = nfrags * fraglen - fraglen / 2;
+        bytes = mkpkt(pktlen, 0);
+        pkt = ccnl_buf_new(bytes, pktlen);
+        ccnl_free(bytes);
+        for (slice = 0; slice < 2; slice++) {
+            double secs = cut(pkt, packets, (int) (fraglen + CCNL_FRAG_HDR_MAX),
+                              slice) / 1e9;
+
+            printf("%6d | %-8s | %12.0f | %10.1f\n", nfrags,
+                   slice ? "slice" : "copy", packets / secs,
+                   packets * pktlen / secs / 1e6);
+        }
+        ccnl_buf_free(pkt);
+    }
+
+    ccnl_free(stream);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file bench_io.c
+ * @brief Benchmark of the relay's receive path, select versus epoll loop
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * usage: bench_io [interfaces [packets [spare_fds [rx_batch]]]]
+ *
+ * A timer inside the relay's own loop sends bursts of small datagrams
+ * from a client socket to the relay's UDP interfaces on 127.0.0.1 and
+ * waits until the relay has received all of them before sending the next
+ * burst. The datagrams are not valid packets, so the cost measured is the
+ * loop, recvfrom() and the face lookup in ccnl_core_RX. Spare file
+ * descriptors push the interface sockets to high numbers, where select()
+ * has to scan the whole descriptor set on every wakeup. A receive batch
+ * above one makes both loops read with recvmmsg().
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-os-time.h"
+#include "ccnl-logging.h"
+#include "ccnl-malloc.h"
+#include "ccnl-relay.h"
+#include "ccnl-dispatch.h"
+#include "ccnl-unix.h"
+
+#define BURST           64
+#define PAYLOAD         64
+
+struct bench_s {
+    struct ccnl_relay_s *relay;
+    int client;
+    uint32_t sent, target;
+};
+
+static uint32_t
+bench_received(struct ccnl_relay_s *relay)
+{
+    uint32_t cnt = 0;
+    int i;
+
+    for (i = 0; i < relay->ifcount; i++) {
+        cnt += relay->ifs[i].rx_cnt;
+    }
+    return cnt;
+}
+
+static void
+bench_refill(void *ptr, void *aux)
+{
+    struct bench_s *b = (struct bench_s *) ptr;
+    struct ccnl_relay_s *relay = b->relay;
+    unsigned char payload[PAYLOAD];
+    int i;
+    (void) aux;
+
+    if (bench_received(relay) >= b->target) {
+        // the loop looks at the flag once its wait returns, the timer
+        // below keeps that wait short
+        relay->halt_flag = 1;
+    } else if (bench_received(relay) >= b->sent) {
+        memset(payload, 0xff, sizeof(payload));
+        for (i = 0; i < BURST && b->sent < b->target; i++, b->sent++) {
+            struct ccnl_if_s *ifc = relay->ifs + b->sent % relay->ifcount;
+            struct sockaddr_in dst = ifc->addr.ip4;
+
+            dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (sendto(b->client, payload, sizeof(payload), 0,
+                       (struct sockaddr *) &dst, sizeof(dst)) < 0) {
+                perror("sendto");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    ccnl_set_timer(0, bench_refill, b, NULL);
+}
+
+static void
+run(int ifcount, uint32_t packets, int epoll, int batch)
+{
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(*relay));
+    struct bench_s b;
+    uint64_t t0, t;
+    int i, maxfd = 0;
+
+    b.relay = relay;
+    b.sent = 0;
+    b.target = packets;
+    b.client = socket(PF_INET, SOCK_DGRAM, 0);
+    for (i = 0; i < ifcount; i++) {
+        int bufsize = BURST * 2048;
+        struct ccnl_if_s *ifc = relay->ifs + relay->ifcount;
+
+        ifc->sock = ccnl_open_udpdev(0, &ifc->addr.ip4);
+        if (ifc->sock < 0) {
+            exit(EXIT_FAILURE);
+        }
+        setsockopt(ifc->sock, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+        if (ifc->sock > maxfd) {
+            maxfd = ifc->sock;
+        }
+        relay->ifcount++;
+    }
+
+    if (!epoll && maxfd >= FD_SETSIZE) {
+        printf("%-6s %3d ifs  maxfd=%-5d skipped, above FD_SETSIZE\n",
+               "select", ifcount, maxfd);
+    } else {
+        ccnl_set_timer(0, bench_refill, &b, NULL);
+        t0 = bench_now_ns();
+#ifdef CCNL_HAVE_EPOLL
+        if (epoll) {
+            ccnl_io_loop_epoll(relay);
+        } else
+#endif
+        ccnl_io_loop(relay);
+        t = bench_now_ns() - t0;
+        ccnl_timer_cleanup();
+
+        printf("%-6s %3d ifs  maxfd=%-5d batch=%-3d %10.0f pkts/s\n",
+               epoll ? "epoll" : "select", ifcount, maxfd, batch,
+               bench_received(relay) * 1e9 / (double) t);
+    }
+
+    for (i = 0; i < relay->ifcount; i++) {
+        close(relay->ifs[i].sock);
+    }
+    close(b.client);
+    while (relay->faces) {
+        ccnl_face_remove(relay, relay->faces);
+    }
+    ccnl_face_index_free(relay);
+    ccnl_free(relay);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ifcount = argc > 1 ? atoi(argv[1]) : 4;
+    uint32_t packets = argc > 2 ? (uint32_t) atol(argv[2]) : 1000000;
+    int spare = argc > 3 ? atoi(argv[3]) : 0;
+    int batch = ccnl_io_set_rxbatch(argc > 4 ? atoi(argv[4]) : 1);
+    int i;
+
+    if (ifcount < 1 || ifcount > CCNL_MAX_INTERFACES) {
+        fprintf(stderr, "interfaces must be between 1 and %d\n",
+                CCNL_MAX_INTERFACES);
+        return 1;
+    }
+    debug_level = FATAL;
+    ccnl_core_init();
+
+    // descriptors we never use, only to move the interface sockets up
+    for (i = 0; i < spare; i++) {
+        if (dup(STDERR_FILENO) < 0) {
+            perror("dup");
+            break;
+        }
+    }
+
+    run(ifcount, packets, 0, batch);
+#ifdef CCNL_HAVE_EPOLL
+    run(ifcount, packets, 1, batch);
+#endif
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file bench_name.c
+ * @brief Benchmark of NDN name decoding and comparison per instruction set
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-pkt.h"
+#include "ccnl-prefix.h"
+#include "ccnl-simd.h"
+#include "ccnl-pkt-ndntlv.h"
+
+#define NAMES           1024
+#define ROUNDS          200
+#define MAX_WIRE        256
+
+struct wire_s {
+    uint8_t bytes[MAX_WIRE];
+    size_t len;
+};
+
+static size_t
+put_tl(uint8_t *out, uint8_t typ, size_t len)
+{
+    out[0] = typ;
+    out[1] = (uint8_t) len;
+    return 2;
+}
+
+/* an Interest carrying the name of uri and a nonce, all lengths below 253 */
+static void
+encode_interest(struct wire_s *w, char *uri, uint32_t nonce)
+{
+    uint8_t name[MAX_WIRE];
+    size_t nlen = 0, clen;
+    char *comp = strtok(uri, "/");
+
+    for (; comp; comp = strtok(NULL, "/")) {
+        clen = strlen(comp);
+        nlen += put_tl(name + nlen, NDN_TLV_NameComponent, clen);
+        memcpy(name + nlen, comp, clen);
+        nlen += clen;
+    }
+    w->len = put_tl(w->bytes, NDN_TLV_Interest, 2 + nlen + 6);
+    w->len += put_tl(w->bytes + w->len, NDN_TLV_Name, nlen);
+    memcpy(w->bytes + w->len, name, nlen);
+    w->len += nlen;
+    w->len += put_tl(w->bytes + w->len, NDN_TLV_Nonce, 4);
+    memcpy(w->bytes + w->len, &nonce, 4);
+    w->len += 4;
+}
+
+/* a mix of short sensor names, video segments and names with a digest */
+static void
+make_uri(char *uri, size_t size, int i, uint32_t *seed)
+{
+    uint32_t r = bench_rand(seed);
+
+    switch (r % 3) {
+    case 0:
+        snprintf(uri, size, "/iot/bldg%u/floor%u/room%u/temp",
+                 r % 7, (r >> 4) % 9, i);
+        break;
+    case 1:
+        snprintf(uri, size, "/site%u/org%u/video/title%d/1080p/seg=%u",
+                 r % 16, (r >> 8) % 64, i, (r >> 16) % 4096);
+        break;
+    default:
+        snprintf(uri, size, "/ndn/edu/univ%u/user%d/%08x%08x%08x%08x",
+                 r % 32, i, r, r * 2654435761U, r ^ 0x5bd1e995U, ~r);
+        break;
+    }
+}
+
+static struct ccnl_pkt_s*
+decode(struct wire_s *w)
+{
+    uint8_t *data = w->bytes;
+    size_t datalen = w->len, len;
+    uint64_t typ;
+
+    if (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len)) {
+        return NULL;
+    }
+    return ccnl_ndntlv_bytes2pkt(typ, w->bytes, &data, &datalen);
+}
+
+int main(int argc, char **argv)
+{
+    static struct wire_s wire[NAMES], again[NAMES];
+    struct ccnl_pkt_s *a[NAMES], *b[NAMES];
+    struct ccnl_prefix_s *u[NAMES];
+    int levels[] = { CCNL_SIMD_SCALAR, CCNL_SIMD_SSE2, CCNL_SIMD_AVX2 };
+    uint32_t seed = 0x2545f491;
+    uint64_t t0, t;
+    char uri[128], copy[128];
+    int i, k, l, ok = 1;
+    size_t total = 0;
+    (void) argc;
+    (void) argv;
+
+    for (i = 0; i < NAMES; i++) {
+        make_uri(uri, sizeof(uri), i, &seed);
+        strcpy(copy, uri);
+        encode_interest(wire + i, copy, (uint32_t) i);
+        strcpy(copy, uri);
+        encode_interest(again + i, copy, (uint32_t) ~i);
+        u[i] = ccnl_URItoPrefix(uri, CCNL_SUITE_NDNTLV, NULL);
+        total += wire[i].len;
+    }
+    printf("%d names, %.1f bytes per interest on average\n\n",
+           NAMES, (double) total / NAMES);
+
+    t0 = bench_now_ns();
+    for (k = 0; k < ROUNDS; k++) {
+        for (i = 0; i < NAMES; i++) {
+            struct ccnl_pkt_s *pkt = decode(wire + i);
+
+            ok &= pkt != NULL;
+            ccnl_pkt_free(pkt);
+        }
+    }
+    t = bench_now_ns() - t0;
+    printf("%-28s %8.1f ns/op\n", "decode interest", (double) t / (ROUNDS * NAMES));
+
+    for (i = 0; i < NAMES; i++) {
+        a[i] = decode(wire + i);
+        b[i] = decode(again + i);
+    }
+
+    /* duplicates from different packets, as the CS and PIT see them */
+    t0 = bench_now_ns();
+    for (k = 0; k < ROUNDS; k++) {
+        for (i = 0; i < NAMES; i++) {
+            ok &= ccnl_prefix_cmp(u[i], NULL, a[i]->pfx, CMP_EXACT) == 0;
+        }
+    }
+    t = bench_now_ns() - t0;
+    printf("%-28s %8.1f ns/op\n", "exact, per component", (double) t / (ROUNDS * NAMES));
+
+    printf("\n%-8s | %12s | %12s | %12s\n", "isa", "exact ns/op", "equal ns/op", "memcmp ns/op");
+    for (l = 0; l < (int) (sizeof(levels) / sizeof(levels[0])); l++) {
+        uint64_t t_cmp, t_eq, t_memcmp;
+
+        if (ccnl_simd_select(levels[l]) != levels[l]) {
+            continue;
+        }
+        t0 = bench_now_ns();
+        for (k = 0; k < ROUNDS; k++) {
+            for (i = 0; i < NAMES; i++) {
+                ok &= ccnl_prefix_cmp(a[i]->pfx, NULL, b[i]->pfx, CMP_EXACT) == 0;
+            }
+        }
+        t_cmp = bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        for (k = 0; k < ROUNDS; k++) {
+            for (i = 0; i < NAMES; i++) {
+                ok &= ccnl_simd_equal(a[i]->pfx->nameptr, b[i]->pfx->nameptr,
+                                      (size_t) a[i]->pfx->namelen);
+            }
+        }
+        t_eq = bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        for (k = 0; k < ROUNDS; k++) {
+            for (i = 0; i < NAMES; i++) {
+                ok &= !memcmp(a[i]->pfx->nameptr, b[i]->pfx->nameptr,
+                              (size_t) a[i]->pfx->namelen);
+            }
+        }
+        t_memcmp = bench_now_ns() - t0;
+
+        printf("%-8s | %12.1f | %12.1f | %12.1f\n", ccnl_simd_name(),
+               (double) t_cmp / (ROUNDS * NAMES), (double) t_eq / (ROUNDS * NAMES),
+               (double) t_memcmp / (ROUNDS * NAMES));
+    }
+    printf("\nok: %d\n", ok);
+
+    for (i = 0; i < NAMES; i++) {
+        ccnl_pkt_free(a[i]);
+        ccnl_pkt_free(b[i]);
+        ccnl_prefix_free(u[i]);
+    }
+    return !ok;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file bench_outq.c
+ * @brief Benchmark of queueing packets to a face
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * usage: bench_outq [packet_size]
+ *
+ * The queue of a face is held at a given depth while packets of the same
+ * length pass through it, one in, one out. The packets differ either early,
+ * like the chunk number of a name, or in their last bytes only. The list
+ * column is the duplicate check ccnl_face_enqueue() did before the queue
+ * was a ring: compare the new packet with every queued one.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-malloc.h"
+#include "ccnl-buf.h"
+#include "ccnl-relay.h"
+
+#define PACKETS         200000
+#define DISTINCT        256     // packets in flight, cycled to stay in the cache
+#define DIFF_OFFSET     40
+
+static struct ccnl_buf_s **bufs;
+
+static void
+mkbufs(size_t size, int late)
+{
+    size_t off = late ? size - sizeof(uint32_t) : DIFF_OFFSET;
+    uint32_t i;
+
+    for (i = 0; i < DISTINCT; i++) {
+        bufs[i] = ccnl_buf_new(NULL, size);
+        memset(bufs[i]->data, 0x42, size);
+        memcpy(bufs[i]->data + off, &i, sizeof(i));
+    }
+}
+
+static void
+freebufs(void)
+{
+    int i;
+
+    for (i = 0; i < DISTINCT; i++) {
+        ccnl_buf_free(bufs[i]);
+    }
+}
+
+/* the queue of ccnl_face_enqueue() before the ring */
+static uint64_t
+run_list(int depth)
+{
+    struct ccnl_buf_s *outq = NULL, *outqend = NULL, *msg;
+    uint64_t t0, t = 0;
+    int i, dups = 0;
+
+    for (i = 0; i < PACKETS; i++) {
+        struct ccnl_buf_s *buf = bufs[i % DISTINCT];
+
+        t0 = bench_now_ns();
+        for (msg = outq; msg; msg = msg->next) {
+            if (buf_equal(msg, buf)) {
+                dups++;
+                break;
+            }
+        }
+        if (!msg) {
+            buf->next = NULL;
+            if (outqend) {
+                outqend->next = buf;
+            } else {
+                outq = buf;
+            }
+            outqend = buf;
+        }
+        t += bench_now_ns() - t0;
+
+        if (i >= depth) {
+            outq = outq->next;
+            if (!outq) {
+                outqend = NULL;
+            }
+        }
+    }
+    return dups ? 0 : t;
+}
+
+static uint64_t
+run_ring(struct ccnl_face_s *f, int depth)
+{
+    uint64_t t0, t = 0;
+    int i, dups = 0;
+
+    for (i = 0; i < PACKETS; i++) {
+        // the face would free the packet when dropping it, keep it around
+        struct ccnl_buf_s *buf = ccnl_buf_share(bufs[i % DISTINCT]);
+
+        t0 = bench_now_ns();
+        dups += ccnl_face_outq_add(f, buf, 0) != 0;
+        t += bench_now_ns() - t0;
+
+        if (i >= depth) {
+            ccnl_buf_free(ccnl_face_outq_take(f));
+        }
+    }
+    ccnl_face_outq_clear(f);
+    return dups ? 0 : t;
+}
+
+int main(int argc, char **argv)
+{
+    int depths[] = { 1, 4, 8, 16, 31 };
+    size_t size = argc > 1 ? (size_t) atoi(argv[1]) : 1200;
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(*relay));
+    struct ccnl_face_s *f;
+    sockunion su;
+    unsigned k;
+    int late;
+
+    if (size < DIFF_OFFSET + sizeof(uint32_t)) {
+        size = DIFF_OFFSET + sizeof(uint32_t);
+    }
+    relay->ifcount = 1;
+    memset(&su, 0, sizeof(su));
+    su.ip4.sin_family = AF_INET;
+    su.ip4.sin_addr.s_addr = htonl(0x0a000001);
+    su.ip4.sin_port = htons(9695);
+    f = ccnl_get_face_or_create(relay, 0, &su.sa, sizeof(su.ip4));
+    bufs = ccnl_calloc(DISTINCT, sizeof(*bufs));
+
+    printf("packet size %zu, list and ring time a packet joining the queue\n", size);
+    printf("%8s | %6s | %14s | %14s\n", "differ", "depth", "list ns/pkt", "ring ns/pkt");
+    for (late = 0; late <= 1; late++) {
+        mkbufs(size, late);
+        for (k = 0; k < sizeof(depths) / sizeof(depths[0]); k++) {
+            uint64_t t_list = run_list(depths[k]);
+            uint64_t t_ring = run_ring(f, depths[k]);
+
+            printf("%8s | %6d | %14.1f | %14.1f\n", late ? "late" : "early",
+                   depths[k], (double) t_list / PACKETS,
+                   (double) t_ring / PACKETS);
+        }
+        freebufs();
+    }
+
+    ccnl_free(bufs);
+    ccnl_face_remove(relay, f);
+    ccnl_face_index_free(relay);
+    ccnl_free(relay);
+    return 0;
+}
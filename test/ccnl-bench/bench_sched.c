@@ -0,0 +1,291 @@
+/**
+ * @file bench_sched.c
+ * @brief Benchmark of faces sharing an interface, first come or by turns
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * usage: bench_sched [seconds]
+ *
+ * Faces offer packets to one interface of 10 Mbit/s, in simulated time.
+ * The schedulers are the ones of the relay, the faces and the link are
+ * modelled as the relay drives them: a face queues CCNL_MAX_FACE_QLEN
+ * packets, the interface CCNL_MAX_IF_QLEN sends. First come is what the
+ * interface does without a fair scheduler: faces pass their packets on at
+ * once, whoever fills the interface queue has the link. With deficit
+ * round robin the faces keep their packets until it is their turn.
+ *
+ * The fair share of a face is its max-min share by weight: what it offers,
+ * or less if the link is short. Jain's index of the sent to fair ratios is
+ * 1 if every face gets its fair share. The cost column is wall clock time
+ * per packet sent, the simulation included.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-defs.h"
+#include "ccnl-sched.h"
+
+#define FACES_MAX       4
+#define LINK_BPS        10000000ULL
+#define BYTE_NS         (8 * 1000000000ULL / LINK_BPS)
+
+struct pkt_s {
+    int face, len;
+    uint64_t t;         // when it was offered
+};
+
+struct link_s {
+    struct ccnl_sched_s *sched;
+    struct pkt_s ring[CCNL_MAX_IF_QLEN];
+    int qfront, qlen;
+    struct pkt_s wire;
+    int busy;
+    uint64_t wire_end, now, busy_ns;
+    uint32_t rnd;
+};
+
+struct face_s {
+    struct link_s *link;
+    struct ccnl_sched_s *sched;
+    int id;
+    struct pkt_s q[CCNL_MAX_FACE_QLEN];
+    int qfront, qlen;
+    uint64_t next;      // time of the next offer
+    uint64_t offered, sent, lost, pkts, delay_ns;
+};
+
+struct scenario_s {
+    const char *name;
+    int faces;
+    int load[FACES_MAX];        // offered, in percent of the link
+    int weight[FACES_MAX];
+    int minlen[FACES_MAX], maxlen[FACES_MAX];
+};
+
+static const struct scenario_s scenarios[] = {
+    { "one face floods, three send a little", 4,
+      { 300, 20, 20, 20 }, { 1, 1, 1, 1 },
+      { 1400, 100, 100, 100 }, { 1400, 1400, 1400, 1400 } },
+    { "all flood, weights 1:1:2:4, packet sizes differ", 4,
+      { 200, 200, 200, 200 }, { 1, 1, 2, 4 },
+      { 1400, 100, 700, 200 }, { 1400, 300, 700, 1400 } },
+};
+
+static void
+link_cts(void *aux1, void *aux2)
+{
+    struct link_s *l = aux1;
+
+    (void) aux2;
+    // first come asks for every packet, the link takes one at a time
+    if (l->busy || !l->qlen) {
+        return;
+    }
+    l->wire = l->ring[l->qfront];
+    l->qfront = (l->qfront + 1) % CCNL_MAX_IF_QLEN;
+    l->qlen--;
+    l->busy = 1;
+    l->wire_end = l->now + (uint64_t) l->wire.len * BYTE_NS;
+}
+
+static void
+face_cts(void *aux1, void *aux2)
+{
+    struct link_s *l = aux1;
+    struct face_s *f = aux2;
+    struct pkt_s p;
+
+    if (!f->qlen) {
+        return;
+    }
+    p = f->q[f->qfront];
+    f->qfront = (f->qfront + 1) % CCNL_MAX_FACE_QLEN;
+    f->qlen--;
+    if (l->qlen == CCNL_MAX_IF_QLEN) {
+        // dropped as ccnl_interface_enqueue() does
+        f->lost += p.len;
+        return;
+    }
+    l->ring[(l->qfront + l->qlen) % CCNL_MAX_IF_QLEN] = p;
+    l->qlen++;
+    ccnl_sched_RTS(l->sched, 1, p.len, l, NULL);
+}
+
+static void
+offer(const struct scenario_s *sc, struct face_s *f)
+{
+    struct link_s *l = f->link;
+    int span = sc->maxlen[f->id] - sc->minlen[f->id] + 1;
+    int len = sc->minlen[f->id] + (int) (bench_rand(&l->rnd) % (uint32_t) span);
+    uint64_t gap = (uint64_t) len * BYTE_NS * 100 / (uint64_t) sc->load[f->id];
+
+    // packets come in bursts and gaps, the mean rate is the load
+    f->next = l->now + gap / 2 + gap * (bench_rand(&l->rnd) % 1024) / 1024;
+    f->offered += len;
+    if (f->qlen == CCNL_MAX_FACE_QLEN) {
+        f->lost += len;
+        return;
+    }
+    f->q[(f->qfront + f->qlen) % CCNL_MAX_FACE_QLEN].face = f->id;
+    f->q[(f->qfront + f->qlen) % CCNL_MAX_FACE_QLEN].len = len;
+    f->q[(f->qfront + f->qlen) % CCNL_MAX_FACE_QLEN].t = l->now;
+    f->qlen++;
+    ccnl_sched_RTS(f->sched, 1, len, l, f);
+}
+
+static void
+complete(struct link_s *l, struct face_s *faces)
+{
+    struct face_s *f = faces + l->wire.face;
+    int len = l->wire.len;
+
+    l->busy = 0;
+    l->busy_ns += (uint64_t) len * BYTE_NS;
+    f->sent += len;
+    f->pkts++;
+    f->delay_ns += l->now - l->wire.t;
+    // the relay tells the interface, then the face the packet came from
+    ccnl_sched_CTS_done(l->sched, 1, len);
+    ccnl_sched_CTS_done(f->sched, 1, len);
+}
+
+// max-min fair shares by weight, in percent of the link
+static void
+fair_shares(const struct scenario_s *sc, double *fair)
+{
+    double left = 100;
+    int done[FACES_MAX] = { 0 }, i, more = 1;
+
+    while (more) {
+        double w = 0;
+
+        more = 0;
+        for (i = 0; i < sc->faces; i++) {
+            w += done[i] ? 0 : sc->weight[i];
+        }
+        if (w == 0) {
+            break;
+        }
+        // faces offering less than their share get what they offer
+        for (i = 0; i < sc->faces; i++) {
+            if (!done[i] && sc->load[i] <= left * sc->weight[i] / w) {
+                fair[i] = sc->load[i];
+                left -= sc->load[i];
+                done[i] = more = 1;
+            }
+        }
+        if (!more) {
+            for (i = 0; i < sc->faces; i++) {
+                if (!done[i]) {
+                    fair[i] = left * sc->weight[i] / w;
+                }
+            }
+        }
+    }
+}
+
+static void
+run(const struct scenario_s *sc, int drr, uint64_t duration)
+{
+    static struct link_s l;
+    static struct face_s faces[FACES_MAX];
+    double fair[FACES_MAX], x, sx = 0, sxx = 0;
+    uint64_t t0, wall, pkts = 0;
+    int i;
+
+    memset(&l, 0, sizeof(l));
+    memset(faces, 0, sizeof(faces));
+    l.rnd = 0x5eed;
+    l.sched = drr ? ccnl_sched_drr_new(link_cts, NULL, 0, 0)
+                  : ccnl_sched_dummy_new(link_cts, NULL);
+    for (i = 0; i < sc->faces; i++) {
+        faces[i].link = &l;
+        faces[i].id = i;
+        faces[i].sched = drr
+            ? ccnl_sched_drr_face_new(face_cts, l.sched, sc->weight[i])
+            : ccnl_sched_dummy_new(face_cts, NULL);
+    }
+    for (i = 0; i < sc->faces; i++) {
+        offer(sc, faces + i);
+    }
+
+    t0 = bench_now_ns();
+    while (l.now < duration) {
+        uint64_t t = l.busy ? l.wire_end : UINT64_MAX;
+        int k = -1;
+
+        for (i = 0; i < sc->faces; i++) {
+            if (faces[i].next < t) {
+                t = faces[i].next;
+                k = i;
+            }
+        }
+        l.now = t;
+        if (k < 0) {
+            complete(&l, faces);
+        } else {
+            offer(sc, faces + k);
+        }
+    }
+    wall = bench_now_ns() - t0;
+
+    fair_shares(sc, fair);
+    for (i = 0; i < sc->faces; i++) {
+        struct face_s *f = faces + i;
+        double sent = 100.0 * f->sent * BYTE_NS / duration;
+
+        x = sent / fair[i];
+        sx += x;
+        sxx += x * x;
+        pkts += f->pkts;
+        printf("%-11s | %4d | %6d | %8.1f | %6.1f | %6.1f | %6.1f | %9.2f\n",
+               i ? "" : (drr ? "round robin" : "first come"), i,
+               sc->weight[i], 100.0 * f->offered * BYTE_NS / duration,
+               fair[i], sent, f->offered ? 100.0 * f->lost / f->offered : 0,
+               f->pkts ? f->delay_ns / 1e6 / f->pkts : 0);
+    }
+    printf("%-11s   jain %.3f, link busy %.1f%%, %.0f ns per packet\n", "",
+           sx * sx / (sc->faces * sxx), 100.0 * l.busy_ns / duration,
+           pkts ? (double) wall / pkts : 0);
+
+    for (i = 0; i < sc->faces; i++) {
+        ccnl_sched_destroy(faces[i].sched);
+    }
+    ccnl_sched_destroy(l.sched);
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 60;
+    size_t k;
+
+    if (seconds < 1) {
+        fprintf(stderr, "usage: %s [seconds]\n", argv[0]);
+        return 1;
+    }
+    printf("%d s at %llu Mbit/s, quantum %d bytes\n", seconds,
+           (unsigned long long) (LINK_BPS / 1000000), CCNL_SCHED_DRR_QUANTUM);
+    for (k = 0; k < sizeof(scenarios) / sizeof(scenarios[0]); k++) {
+        printf("\n%s\n", scenarios[k].name);
+        printf("%-11s | %4s | %6s | %8s | %6s | %6s | %6s | %9s\n", "mode",
+               "face", "weight", "offered%", "fair%", "sent%", "lost%",
+               "delay ms");
+        run(scenarios + k, 0, seconds * 1000000000ULL);
+        run(scenarios + k, 1, seconds * 1000000000ULL);
+    }
+    return 0;
+}
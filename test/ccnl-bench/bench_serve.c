@@ -0,0 +1,136 @@
+/**
+ * @file bench_serve.c
+ * @brief Benchmark of Data satisfying a PIT entry on a relay with many faces
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Every Data matches one PIT entry with a single downstream face. The
+ * reset column is the walk over all faces ccnl_content_serve_pending()
+ * did for every Data before faces were marked by epoch.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-malloc.h"
+#include "ccnl-buf.h"
+#include "ccnl-pkt.h"
+#include "ccnl-prefix.h"
+#include "ccnl-content.h"
+#include "ccnl-interest.h"
+#include "ccnl-relay.h"
+
+#define DATA            20000
+#define FLAGS_SERVED    4       // the bit of the former CCNL_FACE_FLAGS_SERVED, unused since
+
+static void
+bench_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+         sockunion *dest, struct ccnl_buf_s *buf)
+{
+    (void) ccnl;
+    (void) ifc;
+    (void) dest;
+    (void) buf;
+}
+
+static struct ccnl_pkt_s*
+mkpkt(char *uri)
+{
+    struct ccnl_pkt_s *pkt = ccnl_calloc(1, sizeof(*pkt));
+
+    pkt->pfx = ccnl_URItoPrefix(uri, CCNL_SUITE_NDNTLV, NULL);
+    pkt->suite = CCNL_SUITE_NDNTLV;
+    pkt->s.ndntlv.maxsuffix = CCNL_MAX_NAME_COMP;
+    pkt->buf = ccnl_buf_new(NULL, 64);
+    memset(pkt->buf->data, 0x42, 64);
+    return pkt;
+}
+
+static void
+run(int faces)
+{
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(*relay));
+    struct ccnl_face_s **f = ccnl_calloc(faces, sizeof(*f));
+    struct ccnl_pkt_s *pkt;
+    struct ccnl_content_s *c;
+    uint64_t t0, t_serve = 0, t_reset = 0;
+    char uri[64];
+    int i, served = 0;
+
+    relay->ccnl_ll_TX_ptr = bench_TX;
+    relay->ifcount = 1;
+    relay->max_pit_entries = -1;
+    for (i = 0; i < faces; i++) {
+        sockunion su;
+
+        memset(&su, 0, sizeof(su));
+        su.ip4.sin_family = AF_INET;
+        su.ip4.sin_addr.s_addr = htonl(0x0a000000 + i);
+        su.ip4.sin_port = htons(9695);
+        f[i] = ccnl_get_face_or_create(relay, 0, &su.sa, sizeof(su.ip4));
+    }
+    strcpy(uri, "/bench/serve/data");
+    pkt = mkpkt(uri);
+    c = ccnl_content_new(&pkt);
+
+    for (i = 0; i < DATA; i++) {
+        struct ccnl_face_s *face;
+        struct ccnl_interest_s *pit;
+
+        strcpy(uri, "/bench/serve/data");
+        pkt = mkpkt(uri);
+        pit = ccnl_interest_new(relay, f[i % faces], &pkt);
+        ccnl_interest_append_pending(pit, f[i % faces]);
+
+        t0 = bench_now_ns();
+        served += ccnl_content_serve_pending(relay, c);
+        t_serve += bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        for (face = relay->faces; face; face = face->next) {
+            face->flags &= ~FLAGS_SERVED;
+        }
+        t_reset += bench_now_ns() - t0;
+    }
+
+    printf("%8d | %14.1f | %14.1f | %d\n", faces, (double) t_serve / DATA,
+           (double) t_reset / DATA,
+           served == DATA && relay->serve_fanout[ccnl_serve_fanout_bucket(1)] == DATA);
+
+    ccnl_content_free(c);
+    while (relay->faces) {
+        ccnl_face_remove(relay, relay->faces);
+    }
+    ccnl_face_index_free(relay);
+    ccnl_interest_index_free(relay);
+    ccnl_free(f);
+    ccnl_free(relay);
+}
+
+int main(int argc, char **argv)
+{
+    int faces[] = { 1, 100, 1000, 10000, 100000 };
+    unsigned k;
+    (void) argc;
+    (void) argv;
+
+    printf("%8s | %14s | %14s | %s\n", "faces", "serve ns/Data", "reset ns/Data", "ok");
+    for (k = 0; k < sizeof(faces) / sizeof(faces[0]); k++) {
+        run(faces[k]);
+    }
+    return 0;
+}
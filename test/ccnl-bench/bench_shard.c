@@ -0,0 +1,240 @@
+/**
+ * @file bench_shard.c
+ * @brief Benchmark of a relay running as several workers
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * usage: bench_shard [max_workers [seconds]]
+ *
+ * A relay on 127.0.0.1 holds Data for a set of names in its content store
+ * and runs with 1 .. max_workers workers. Clients on as many UDP ports
+ * keep a window of Interests for those names outstanding and count the
+ * Data coming back. The kernel spreads the clients over the workers'
+ * sockets, so most Interests arrive at a worker not owning their name and
+ * take the ring to the owner. The rate can only grow with the workers as
+ * far as there are cores for them and for the clients.
+ */
+#include "ccnl-bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-os-time.h"
+#include "ccnl-logging.h"
+#include "ccnl-malloc.h"
+#include "ccnl-prefix.h"
+#include "ccnl-content.h"
+#include "ccnl-relay.h"
+#include "ccnl-dispatch.h"
+#include "ccnl-pkt-builder.h"
+#include "ccnl-unix.h"
+#include "ccnl-shard.h"
+
+#define PORT            19695
+#define NAMES           1024
+#define CLIENTS         16
+#define WINDOW          64
+#define PAYLOAD         256
+#define NONCE           0x7e7e7e7e
+
+static struct ccnl_buf_s *interests[NAMES];
+static size_t nonceoff[NAMES];
+
+static void
+pause_ms(long ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static struct ccnl_prefix_s*
+mkname(int i)
+{
+    char uri[64];
+
+    snprintf(uri, sizeof(uri), "/bench/%d/shard/data", i);
+    return ccnl_URItoPrefix(uri, CCNL_SUITE_NDNTLV, NULL);
+}
+
+static void
+mkinterests(void)
+{
+    ccnl_interest_opts_u opts;
+    uint32_t nonce = NONCE;
+    int i;
+
+    for (i = 0; i < NAMES; i++) {
+        struct ccnl_prefix_s *pfx = mkname(i);
+        size_t k;
+
+        memset(&opts, 0, sizeof(opts));
+        opts.ndntlv.nonce = (int32_t) nonce;
+        interests[i] = ccnl_mkSimpleInterest(pfx, &opts);
+        ccnl_prefix_free(pfx);
+        // the nonce changes with every send, or the relay drops duplicates
+        for (k = 0; k + sizeof(nonce) <= interests[i]->datalen; k++) {
+            if (!memcmp(interests[i]->data + k, &nonce, sizeof(nonce))) {
+                break;
+            }
+        }
+        nonceoff[i] = k;
+    }
+}
+
+static void
+relay_main(void)
+{
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(*relay));
+    uint8_t payload[PAYLOAD];
+    int i;
+
+    memset(payload, 'x', sizeof(payload));
+    ccnl_relay_config(relay, NULL, NULL, PORT, -1, -1, -1, -1, NULL,
+                      CCNL_SUITE_NDNTLV, -1, NULL);
+    for (i = 0; i < NAMES; i++) {
+        struct ccnl_prefix_s *pfx = mkname(i);
+        struct ccnl_content_s *c = ccnl_mkContentObject(pfx, payload,
+                                                        sizeof(payload), NULL);
+
+        ccnl_prefix_free(pfx);
+        if (!c) {
+            exit(EXIT_FAILURE);
+        }
+        ccnl_content_add2cache(relay, c);
+        c->flags |= CCNL_CONTENT_FLAGS_STATIC;
+    }
+    if (ccnl_shard_fork(relay) < 0) {
+        exit(EXIT_FAILURE);
+    }
+#ifdef CCNL_HAVE_EPOLL
+    ccnl_io_loop_epoll(relay);
+#else
+    ccnl_io_loop(relay);
+#endif
+    exit(EXIT_SUCCESS);
+}
+
+static int
+client_open(void)
+{
+    struct sockaddr_in dst;
+    int s = socket(PF_INET, SOCK_DGRAM, 0);
+
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    dst.sin_port = htons(PORT);
+    if (s < 0 || connect(s, (struct sockaddr *) &dst, sizeof(dst))) {
+        perror("client");
+        exit(EXIT_FAILURE);
+    }
+    fcntl(s, F_SETFL, O_NONBLOCK);
+    return s;
+}
+
+static void
+run(int workers, int seconds)
+{
+    int clients[CLIENTS];
+    uint8_t buf[CCNL_MAX_PACKET_SIZE];
+    uint64_t t0, now, last;
+    uint32_t sent = 0, received = 0, nonce = 1, handed = 0, dropped = 0;
+    int outstanding = 0, i;
+    pid_t pid;
+
+    if (ccnl_shard_init(workers)) {
+        exit(EXIT_FAILURE);
+    }
+    pid = fork();
+    if (pid == 0) {
+        relay_main();
+    }
+    pause_ms(300);
+    for (i = 0; i < CLIENTS; i++) {
+        clients[i] = client_open();
+    }
+
+    t0 = last = bench_now_ns();
+    do {
+        for (; outstanding < WINDOW; sent++, outstanding++) {
+            struct ccnl_buf_s *in = interests[sent % NAMES];
+
+            nonce++;
+            memcpy(in->data + nonceoff[sent % NAMES], &nonce, sizeof(nonce));
+            if (send(clients[sent % CLIENTS], in->data, in->datalen, 0) < 0) {
+                break;
+            }
+        }
+        now = bench_now_ns();
+        for (i = 0; i < CLIENTS; i++) {
+            while (recv(clients[i], buf, sizeof(buf), 0) > 0) {
+                received++;
+                outstanding--;
+                last = now;
+            }
+        }
+        // what got lost on the way is not waited for
+        if (now - last > 20000000ULL) {
+            outstanding = 0;
+            last = now;
+        }
+    } while (now - t0 < (uint64_t) seconds * 1000000000ULL);
+
+    for (i = 0; i < workers; i++) {
+        struct ccnl_shard_stats_s *st = ccnl_shard_stats(i);
+
+        if (st) {
+            handed += st->handed;
+            dropped += st->dropped;
+        }
+    }
+    printf("%8d | %12.0f | %8.1f | %8u\n", workers,
+           received * 1e9 / (double) (now - t0),
+           received ? 100.0 * handed / received : 0.0, dropped);
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    for (i = 0; i < CLIENTS; i++) {
+        close(clients[i]);
+    }
+    // the workers die with their parent, give the port a moment
+    pause_ms(200);
+}
+
+int
+main(int argc, char **argv)
+{
+    int maxw = argc > 1 ? atoi(argv[1]) : 4;
+    int seconds = argc > 2 ? atoi(argv[2]) : 2;
+    int w;
+
+    if (maxw < 1 || maxw > CCNL_MAX_WORKERS) {
+        fprintf(stderr, "workers must be between 1 and %d\n", CCNL_MAX_WORKERS);
+        return 1;
+    }
+    debug_level = FATAL;
+    ccnl_core_init();
+    mkinterests();
+
+    printf("%ld cores online\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%8s | %12s | %8s | %8s\n", "workers", "Data/s", "handed%", "dropped");
+    for (w = 1; w <= maxw; w++) {
+        run(w, seconds);
+    }
+    return 0;
+}
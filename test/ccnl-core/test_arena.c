@@ -0,0 +1,292 @@
+/**
+ * @file test_arena.c
+ * @brief Tests for the per-packet arena
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <cmocka.h>
+
+#include "ccnl-arena.h"
+#include "ccnl-buf.h"
+#include "ccnl-pkt.h"
+#include "ccnl-pool.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
+#include "ccnl-dispatch.h"
+#include "ccnl-pkt-builder.h"
+#include "ccnl-pkt-ndntlv.h"
+
+static int sent;
+
+static void
+count_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+         sockunion *dest, struct ccnl_buf_s *buf)
+{
+    (void) ccnl;
+    (void) ifc;
+    (void) dest;
+    (void) buf;
+    sent++;
+}
+
+static void
+peer(sockunion *su, uint32_t ip)
+{
+    memset(su, 0, sizeof(*su));
+    su->ip4.sin_family = AF_INET;
+    su->ip4.sin_addr.s_addr = htonl(ip);
+    su->ip4.sin_port = htons(9695);
+}
+
+void test_ccnl_arena_alloc()
+{
+    struct ccnl_arena_s arena;
+    unsigned char *a, *b, *c;
+    size_t mark;
+
+    memset(&arena, 0, sizeof(arena));
+    /** without memory nothing is handed out, and nothing is counted */
+    assert_null(ccnl_arena_alloc(&arena, 8));
+    assert_int_equal(arena.overflows, 0);
+
+    assert_int_equal(ccnl_arena_reserve(&arena, 64), 0);
+    a = ccnl_arena_alloc(&arena, 3);
+    b = ccnl_arena_calloc(&arena, 8);
+    assert_non_null(a);
+    assert_non_null(b);
+    assert_true(b >= a + 3);
+    assert_int_equal((size_t) b % 16, (size_t) a % 16);
+    assert_true(ccnl_arena_owns(&arena, b));
+    assert_false(ccnl_arena_owns(&arena, &arena));
+
+    /** a reset drops what came after the mark */
+    mark = ccnl_arena_mark(&arena);
+    c = ccnl_arena_alloc(&arena, 16);
+    assert_non_null(c);
+    ccnl_arena_reset(&arena, mark);
+    assert_true(ccnl_arena_alloc(&arena, 16) == c);
+
+    /** requests that do not fit fail */
+    assert_null(ccnl_arena_alloc(&arena, 64));
+    assert_int_equal(arena.overflows, 1);
+    assert_true(arena.peak <= 64);
+
+    /** the memory stays while in use */
+    assert_int_equal(ccnl_arena_reserve(&arena, 128), -1);
+    ccnl_arena_reset(&arena, 0);
+    assert_int_equal(arena.used, 0);
+    ccnl_arena_release(&arena);
+    assert_null(arena.base);
+}
+
+void test_ccnl_arena_frames()
+{
+    size_t outer, inner;
+
+    assert_int_equal(ccnl_arena_reserve(&ccnl_pkt_arena, 256), 0);
+    assert_null(ccnl_arena_active());
+
+    /** a nested frame only drops its own allocations */
+    outer = ccnl_arena_enter(&ccnl_pkt_arena);
+    assert_true(ccnl_arena_active() == &ccnl_pkt_arena);
+    assert_non_null(ccnl_arena_alloc(&ccnl_pkt_arena, 32));
+    inner = ccnl_arena_enter(&ccnl_pkt_arena);
+    assert_non_null(ccnl_arena_alloc(&ccnl_pkt_arena, 32));
+    ccnl_arena_leave(&ccnl_pkt_arena, inner);
+    assert_int_equal(ccnl_pkt_arena.used, 32);
+    ccnl_arena_leave(&ccnl_pkt_arena, outer);
+    assert_int_equal(ccnl_pkt_arena.used, 0);
+    assert_null(ccnl_arena_active());
+
+    ccnl_arena_release(&ccnl_pkt_arena);
+}
+
+void test_ccnl_pkt_persist()
+{
+    uint8_t interest[] = {
+        0x05, 0x0d,                         // Interest
+        0x07, 0x05, 0x08, 0x03, 'a', 'b', 'c',  // Name /abc
+        0x0a, 0x04, 0x01, 0x02, 0x03, 0x04, // Nonce
+    };
+    struct ccnl_pkt_s *pkt, *kept;
+    uint8_t *data;
+    uint64_t typ;
+    size_t len, datalen, mark;
+
+    assert_int_equal(ccnl_arena_reserve(&ccnl_pkt_arena, 1024), 0);
+
+    /** while a frame is handled the decoder allocates from the arena */
+    mark = ccnl_arena_enter(&ccnl_pkt_arena);
+    data = interest;
+    datalen = sizeof(interest);
+    assert_int_equal(ccnl_ndntlv_dehead(&data, &datalen, &typ, &len), 0);
+    pkt = ccnl_ndntlv_bytes2pkt(typ, interest, &data, &datalen);
+    assert_non_null(pkt);
+    assert_true(ccnl_arena_owns(&ccnl_pkt_arena, pkt));
+    assert_true(ccnl_arena_owns(&ccnl_pkt_arena, pkt->pfx));
+    assert_false(ccnl_arena_owns(&ccnl_pkt_arena, pkt->buf));
+
+    /** a share of an arena buffer is a copy */
+    if (pkt->s.ndntlv.nonce) {
+        struct ccnl_buf_s *share = ccnl_buf_share(pkt->s.ndntlv.nonce);
+
+        assert_true(ccnl_arena_owns(&ccnl_pkt_arena, pkt->s.ndntlv.nonce));
+        assert_false(ccnl_arena_owns(&ccnl_pkt_arena, share));
+        ccnl_buf_free(share);
+    }
+
+    /** persisting moves the pkt out, the name still points at the packet */
+    kept = pkt;
+    assert_int_equal(ccnl_pkt_persist(&kept), 0);
+    assert_false(ccnl_arena_owns(&ccnl_pkt_arena, kept));
+    assert_false(ccnl_arena_owns(&ccnl_pkt_arena, kept->pfx));
+    assert_int_equal(ccnl_pkt_arena.promotions, 1);
+    assert_int_equal(kept->pfx->compcnt, 1);
+    assert_true(ccnl_prefix_comp(kept->pfx, 0) == kept->buf->data + 6);
+    if (kept->s.ndntlv.nonce) {
+        assert_false(ccnl_arena_owns(&ccnl_pkt_arena, kept->s.ndntlv.nonce));
+    }
+    ccnl_arena_leave(&ccnl_pkt_arena, mark);
+
+    /** and survives the end of the frame */
+    assert_int_equal(memcmp(ccnl_prefix_comp(kept->pfx, 0), "abc", 3), 0);
+    assert_int_equal(ccnl_pkt_persist(&kept), 0);
+    assert_int_equal(ccnl_pkt_arena.promotions, 1);
+    ccnl_pkt_free(kept);
+
+    /** outside of a frame the decoder does not use the arena */
+    data = interest;
+    datalen = sizeof(interest);
+    assert_int_equal(ccnl_ndntlv_dehead(&data, &datalen, &typ, &len), 0);
+    pkt = ccnl_ndntlv_bytes2pkt(typ, interest, &data, &datalen);
+    assert_non_null(pkt);
+    assert_false(ccnl_arena_owns(&ccnl_pkt_arena, pkt));
+    assert_int_equal(ccnl_pkt_arena.used, 0);
+    ccnl_pkt_free(pkt);
+
+    ccnl_arena_release(&ccnl_pkt_arena);
+}
+
+void test_ccnl_prefix_persist_base()
+{
+    struct ccnl_prefix_s *p;
+    uint8_t *name;
+    size_t mark;
+
+    assert_int_equal(ccnl_arena_reserve(&ccnl_pkt_arena, 1024), 0);
+
+    /** a name whose bytes live in the arena is copied out */
+    mark = ccnl_arena_enter(&ccnl_pkt_arena);
+    name = ccnl_arena_alloc(&ccnl_pkt_arena, 5);
+    assert_non_null(name);
+    memcpy(name, "\x08\x03" "abc", 5);
+    p = ccnl_prefix_new_rx(CCNL_SUITE_DEFAULT, 1);
+    assert_non_null(p);
+    assert_true(ccnl_arena_owns(&ccnl_pkt_arena, p));
+    p->base = name + 2;
+    p->compoff[0] = 0;
+    p->complen[0] = 3;
+    p->comphash[0] = 0;
+    p->nameptr = name;
+    p->namelen = 5;
+    assert_int_equal(ccnl_prefix_persist(&p), 0);
+    assert_false(ccnl_arena_owns(&ccnl_pkt_arena, p));
+    assert_false(ccnl_arena_owns(&ccnl_pkt_arena, p->base));
+    /** nothing of it may point into the arena any more */
+    assert_null(p->nameptr);
+    assert_int_equal(p->namelen, 0);
+    ccnl_arena_leave(&ccnl_pkt_arena, mark);
+
+    assert_int_equal(memcmp(ccnl_prefix_comp(p, 0), "abc", 3), 0);
+    ccnl_prefix_free(p);
+    ccnl_arena_release(&ccnl_pkt_arena);
+}
+
+void test_ccnl_content_duplicate()
+{
+    static struct ccnl_relay_s relay;
+    char uri[] = "/arena/dup";
+    struct ccnl_prefix_s *pfx = ccnl_URItoPrefix(uri, CCNL_SUITE_DEFAULT, NULL);
+    ccnl_interest_opts_u opts;
+    struct ccnl_buf_s *ibuf, *dbuf;
+    sockunion consumer, producer;
+    uint32_t pkts, prefixes, promotions;
+
+    assert_int_equal(ccnl_arena_reserve(&ccnl_pkt_arena, CCNL_ARENA_SIZE), 0);
+    assert_int_equal(ccnl_pools_init(16), 0);
+    ccnl_core_init();
+    memset(&relay, 0, sizeof(relay));
+    relay.ccnl_ll_TX_ptr = count_TX;
+    relay.ifcount = 1;
+    relay.max_pit_entries = -1;
+    relay.max_cache_entries = -1;
+    peer(&consumer, 0x0a000001);
+    peer(&producer, 0x0a000002);
+    memset(&opts, 0, sizeof(opts));
+    opts.ndntlv.nonce = 42;
+    ibuf = ccnl_mkSimpleInterest(pfx, &opts);
+    dbuf = ccnl_mkSimpleContent(pfx, (uint8_t*) "dup", 3, NULL, NULL);
+    assert_non_null(ibuf);
+    assert_non_null(dbuf);
+    sent = 0;
+
+    /** Data answering an Interest is moved out and cached */
+    ccnl_core_RX(&relay, 0, ibuf->data, ibuf->datalen,
+                 &consumer.sa, sizeof(consumer.ip4));
+    ccnl_core_RX(&relay, 0, dbuf->data, dbuf->datalen,
+                 &producer.sa, sizeof(producer.ip4));
+    assert_int_equal(sent, 1);
+    assert_int_equal(relay.contentcnt, 1);
+    assert_true(ccnl_pkt_arena.promotions > 0);
+
+    /** a duplicate of it is dropped with the frame, nothing is moved out */
+    pkts = CCNL_POOL(PKT)->allocs + CCNL_POOL(PKT)->fallbacks;
+    prefixes = CCNL_POOL(PREFIX)->allocs + CCNL_POOL(PREFIX)->fallbacks;
+    promotions = ccnl_pkt_arena.promotions;
+    ccnl_core_RX(&relay, 0, dbuf->data, dbuf->datalen,
+                 &producer.sa, sizeof(producer.ip4));
+    assert_int_equal(relay.contentcnt, 1);
+    assert_int_equal(sent, 1);
+    assert_int_equal(ccnl_pkt_arena.promotions, promotions);
+    assert_int_equal(CCNL_POOL(PKT)->allocs + CCNL_POOL(PKT)->fallbacks, pkts);
+    assert_int_equal(CCNL_POOL(PREFIX)->allocs + CCNL_POOL(PREFIX)->fallbacks,
+                     prefixes);
+
+    ccnl_core_cleanup(&relay);
+    ccnl_buf_free(ibuf);
+    ccnl_buf_free(dbuf);
+    ccnl_prefix_free(pfx);
+    ccnl_pools_cleanup();
+    ccnl_arena_release(&ccnl_pkt_arena);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_arena_alloc),
+        unit_test(test_ccnl_arena_frames),
+        unit_test(test_ccnl_pkt_persist),
+        unit_test(test_ccnl_prefix_persist_base),
+        unit_test(test_ccnl_content_duplicate),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_buf.c
+ * @brief Tests for the shared packet buffers
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ccnl-buf.h"
+#include "ccnl-pkt.h"
+#include "ccnl-prefix.h"
+#include "ccnl-pkt-ndntlv.h"
+
+void test_ccnl_buf_share()
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new("hello", 5);
+    struct ccnl_buf_s *s1, *s2;
+
+    assert_non_null(buf);
+    assert_int_equal(buf->refcnt, 1);
+    assert_null(ccnl_buf_share(NULL));
+
+    s1 = ccnl_buf_share(buf);
+    assert_non_null(s1);
+    assert_true(s1->data == buf->data);
+    assert_int_equal(s1->datalen, 5);
+    assert_int_equal(buf->refcnt, 2);
+
+    /** a share of a share references the owner */
+    s2 = ccnl_buf_share(s1);
+    assert_true(s2->owner == buf);
+    assert_int_equal(buf->refcnt, 3);
+
+    /** shares are separate headers, they can be queued independently */
+    assert_true(s1 != s2);
+    s1->next = s2;
+    assert_null(buf->next);
+    s1->next = NULL;
+
+    /** the bytes outlive the owner's own reference */
+    ccnl_buf_free(buf);
+    assert_int_equal(s1->owner->refcnt, 2);
+    assert_int_equal(memcmp(s2->data, "hello", 5), 0);
+
+    ccnl_buf_free(s1);
+    assert_int_equal(s2->owner->refcnt, 1);
+    ccnl_buf_free(s2);
+    ccnl_buf_free(NULL);
+}
+
+void test_ccnl_buf_new()
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new(NULL, 3);
+
+    assert_non_null(buf);
+    assert_null(buf->owner);
+    assert_true(buf->data == buf->storage);
+    assert_int_equal(buf->datalen, 3);
+
+    ccnl_buf_free(buf);
+}
+
+void test_ccnl_buf_slice()
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new("hello world", 11);
+    struct ccnl_buf_s *s1, *s2;
+
+    assert_null(ccnl_buf_slice(NULL, buf->data, 1));
+    assert_null(ccnl_buf_slice(buf, buf->data + 6, 6));
+    assert_null(ccnl_buf_slice(buf, buf->data - 1, 2));
+    assert_null(ccnl_buf_slice(buf, buf->data + 12, 0));
+
+    s1 = ccnl_buf_slice(buf, buf->data + 6, 5);
+    assert_non_null(s1);
+    assert_true(s1->owner == buf);
+    assert_int_equal(s1->datalen, 5);
+    assert_int_equal(memcmp(s1->data, "world", 5), 0);
+    assert_int_equal(buf->refcnt, 2);
+
+    /** a slice of a slice still references the owner */
+    s2 = ccnl_buf_slice(s1, s1->data + 1, 3);
+    assert_non_null(s2);
+    assert_true(s2->owner == buf);
+    assert_int_equal(memcmp(s2->data, "orl", 3), 0);
+    assert_null(ccnl_buf_slice(s1, s1->data, 6));
+
+    ccnl_buf_free(buf);
+    ccnl_buf_free(s1);
+    assert_int_equal(s2->owner->refcnt, 1);
+    ccnl_buf_free(s2);
+}
+
+void test_ccnl_ndntlv_bytes2pkt_rx()
+{
+    uint8_t interest[] = {
+        0x05, 0x0d,                         // Interest
+        0x07, 0x05, 0x08, 0x03, 'a', 'b', 'c',  // Name /abc
+        0x0a, 0x04, 0x01, 0x02, 0x03, 0x04, // Nonce
+    };
+    struct ccnl_buf_s *rxbuf = ccnl_buf_new(NULL, 64);
+    struct ccnl_pkt_s *pkt;
+    uint8_t *start, *data;
+    uint64_t typ;
+    size_t len, datalen;
+
+    /** the datagram sits in the middle of a receive buffer */
+    start = rxbuf->data + 8;
+    memcpy(start, interest, sizeof(interest));
+    data = start;
+    datalen = sizeof(interest);
+    assert_int_equal(ccnl_ndntlv_dehead(&data, &datalen, &typ, &len), 0);
+
+    pkt = ccnl_ndntlv_bytes2pkt_rx(typ, start, &data, &datalen, rxbuf);
+    assert_non_null(pkt);
+    assert_true(pkt->buf->owner == rxbuf);
+    assert_true(pkt->buf->data == start);
+    assert_int_equal(pkt->buf->datalen, sizeof(interest));
+    assert_int_equal(rxbuf->refcnt, 2);
+    assert_int_equal(pkt->pfx->compcnt, 1);
+    assert_true(ccnl_prefix_comp(pkt->pfx, 0) == start + 6);
+
+    /** the packet keeps the bytes after the receiver dropped them */
+    ccnl_buf_free(rxbuf);
+    assert_int_equal(memcmp(ccnl_prefix_comp(pkt->pfx, 0), "abc", 3), 0);
+    ccnl_pkt_free(pkt);
+
+    /** bytes outside the buffer are copied as before */
+    data = interest;
+    datalen = sizeof(interest);
+    assert_int_equal(ccnl_ndntlv_dehead(&data, &datalen, &typ, &len), 0);
+    rxbuf = ccnl_buf_new(NULL, 64);
+    pkt = ccnl_ndntlv_bytes2pkt_rx(typ, interest, &data, &datalen, rxbuf);
+    assert_non_null(pkt);
+    assert_null(pkt->buf->owner);
+    assert_int_equal(rxbuf->refcnt, 1);
+    assert_true(ccnl_prefix_comp(pkt->pfx, 0) == pkt->buf->data + 6);
+    ccnl_pkt_free(pkt);
+    ccnl_buf_free(rxbuf);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_buf_share),
+        unit_test(test_ccnl_buf_new),
+        unit_test(test_ccnl_buf_slice),
+        unit_test(test_ccnl_ndntlv_bytes2pkt_rx),
+    };
+
+    return run_tests(tests);
+}
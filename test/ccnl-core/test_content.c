@@ -19,11 +19,14 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
+#include <stdio.h>
 #include <cmocka.h>
  
 #include "ccnl-pkt.h"
 #include "ccnl-malloc.h"
 #include "ccnl-content.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
 
 void test_ccnl_content_new_invalid()
 {
@@ -67,6 +70,170 @@ void test_ccnl_content_free_valid()
     assert_int_equal(result, 0);
 }
 
+static struct ccnl_content_s*
+create_content(char *uri)
+{
+    struct ccnl_pkt_s *packet = ccnl_calloc(1, sizeof(struct ccnl_pkt_s));
+    packet->pfx = ccnl_URItoPrefix(uri, 0, NULL);
+    return ccnl_content_new(&packet);
+}
+
+static void
+destroy_content(struct ccnl_content_s *content)
+{
+    ccnl_prefix_free(content->pkt->pfx);
+    ccnl_free(content->pkt);
+    content->pkt = NULL;
+    ccnl_content_free(content);
+}
+
+void test_ccnl_content_index_lookup()
+{
+    struct ccnl_relay_s relay;
+    char uri1[] = "/path/to/data", uri2[] = "/path/to/other", uri3[] = "/path/to/data";
+    memset(&relay, 0, sizeof(relay));
+
+    struct ccnl_content_s *c1 = create_content(uri1);
+    struct ccnl_content_s *c2 = create_content(uri2);
+    struct ccnl_prefix_s *name = ccnl_URItoPrefix(uri3, 0, NULL);
+
+    assert_null(ccnl_content_index_lookup(&relay, name));
+    assert_int_equal(ccnl_content_index_add(&relay, c1), 0);
+    relay.contentcnt++;
+    assert_int_equal(ccnl_content_index_add(&relay, c2), 0);
+    relay.contentcnt++;
+
+    assert_true(ccnl_content_index_lookup(&relay, name) == c1);
+    assert_true(ccnl_content_index_lookup(&relay, c2->pkt->pfx) == c2);
+
+    ccnl_content_index_remove(&relay, c1);
+    assert_null(ccnl_content_index_lookup(&relay, name));
+    assert_true(ccnl_content_index_lookup(&relay, c2->pkt->pfx) == c2);
+
+    ccnl_content_index_free(&relay);
+    assert_null(ccnl_content_index_lookup(&relay, c2->pkt->pfx));
+
+    ccnl_prefix_free(name);
+    destroy_content(c1);
+    destroy_content(c2);
+}
+
+void test_ccnl_content_index_grow()
+{
+    struct ccnl_relay_s relay;
+    struct ccnl_content_s *c[3 * CCNL_CS_INDEX_MIN_SIZE];
+    char uri[32];
+    int i;
+    memset(&relay, 0, sizeof(relay));
+
+    for (i = 0; i < 3 * CCNL_CS_INDEX_MIN_SIZE; i++) {
+        snprintf(uri, sizeof(uri), "/data/%d", i);
+        c[i] = create_content(uri);
+        assert_int_equal(ccnl_content_index_add(&relay, c[i]), 0);
+        relay.contentcnt++;
+    }
+    assert_true(relay.cs_index_size >= 3 * CCNL_CS_INDEX_MIN_SIZE);
+    for (i = 0; i < 3 * CCNL_CS_INDEX_MIN_SIZE; i++) {
+        assert_true(ccnl_content_index_lookup(&relay, c[i]->pkt->pfx) == c[i]);
+    }
+    ccnl_content_index_free(&relay);
+    for (i = 0; i < 3 * CCNL_CS_INDEX_MIN_SIZE; i++) {
+        destroy_content(c[i]);
+    }
+}
+
+void test_ccnl_content_repl_lru()
+{
+    struct ccnl_relay_s relay;
+    char uri1[] = "/a", uri2[] = "/b", uri3[] = "/c";
+    memset(&relay, 0, sizeof(relay));
+
+    struct ccnl_content_s *c1 = create_content(uri1);
+    struct ccnl_content_s *c2 = create_content(uri2);
+    struct ccnl_content_s *c3 = create_content(uri3);
+    ccnl_content_repl_add(&relay, c1);
+    ccnl_content_repl_add(&relay, c2);
+    ccnl_content_repl_add(&relay, c3);
+
+    assert_true(ccnl_content_repl_victim(&relay) == c1);
+    ccnl_content_repl_touch(&relay, c1);
+    assert_true(ccnl_content_repl_victim(&relay) == c2);
+
+    c2->flags |= CCNL_CONTENT_FLAGS_STATIC;
+    assert_true(ccnl_content_repl_victim(&relay) == c3);
+    ccnl_content_repl_remove(&relay, c3);
+    assert_true(ccnl_content_repl_victim(&relay) == c1);
+    ccnl_content_repl_remove(&relay, c1);
+    assert_null(ccnl_content_repl_victim(&relay));
+
+    destroy_content(c1);
+    destroy_content(c2);
+    destroy_content(c3);
+}
+
+void test_ccnl_content_repl_clock()
+{
+    struct ccnl_relay_s relay;
+    char uri1[] = "/a", uri2[] = "/b", uri3[] = "/c";
+    memset(&relay, 0, sizeof(relay));
+    relay.cs_replacement = CCNL_CS_REPLACE_CLOCK;
+
+    struct ccnl_content_s *c1 = create_content(uri1);
+    struct ccnl_content_s *c2 = create_content(uri2);
+    struct ccnl_content_s *c3 = create_content(uri3);
+    ccnl_content_repl_add(&relay, c1);
+    ccnl_content_repl_add(&relay, c2);
+
+    ccnl_content_repl_touch(&relay, c1);
+    assert_true(ccnl_content_repl_victim(&relay) == c2);
+    ccnl_content_repl_remove(&relay, c2);
+
+    // c1 has lost its second chance, the new content is inspected last
+    ccnl_content_repl_add(&relay, c3);
+    assert_true(ccnl_content_repl_victim(&relay) == c1);
+    ccnl_content_repl_remove(&relay, c1);
+    assert_true(ccnl_content_repl_victim(&relay) == c3);
+    ccnl_content_repl_remove(&relay, c3);
+    assert_null(ccnl_content_repl_victim(&relay));
+
+    destroy_content(c1);
+    destroy_content(c2);
+    destroy_content(c3);
+}
+
+void test_ccnl_content_repl_lfu()
+{
+    struct ccnl_relay_s relay;
+    char uri1[] = "/a", uri2[] = "/b", uri3[] = "/c";
+    memset(&relay, 0, sizeof(relay));
+
+    struct ccnl_content_s *c1 = create_content(uri1);
+    struct ccnl_content_s *c2 = create_content(uri2);
+    struct ccnl_content_s *c3 = create_content(uri3);
+    DBL_LINKED_LIST_ADD(relay.contents, c1);
+    DBL_LINKED_LIST_ADD(relay.contents, c2);
+    DBL_LINKED_LIST_ADD(relay.contents, c3);
+    ccnl_content_repl_set_policy(&relay, CCNL_CS_REPLACE_LFU);
+    assert_true(ccnl_content_repl_victim(&relay) == c1);
+
+    c1->served_cnt = 2;
+    ccnl_content_repl_touch(&relay, c1);
+    c2->served_cnt = 1;
+    ccnl_content_repl_touch(&relay, c2);
+    assert_true(ccnl_content_repl_victim(&relay) == c3);
+    ccnl_content_repl_remove(&relay, c3);
+    assert_true(ccnl_content_repl_victim(&relay) == c2);
+
+    ccnl_content_repl_set_policy(&relay, CCNL_CS_REPLACE_LRU);
+    assert_true(ccnl_content_repl_victim(&relay) == c1);
+
+    ccnl_content_repl_remove(&relay, c1);
+    ccnl_content_repl_remove(&relay, c2);
+    destroy_content(c1);
+    destroy_content(c2);
+    destroy_content(c3);
+}
+
 int main(void)
 {
     const UnitTest tests[] = {
@@ -74,6 +241,11 @@ int main(void)
         unit_test(test_ccnl_content_new_valid),
         unit_test(test_ccnl_content_free_invalid),
         unit_test(test_ccnl_content_free_valid),
+        unit_test(test_ccnl_content_index_lookup),
+        unit_test(test_ccnl_content_index_grow),
+        unit_test(test_ccnl_content_repl_lru),
+        unit_test(test_ccnl_content_repl_clock),
+        unit_test(test_ccnl_content_repl_lfu),
     };
     
     return run_tests(tests);
@@ -0,0 +1,276 @@
+/**
+ * @file test_face.c
+ * @brief Tests for the face indices
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <cmocka.h>
+
+#include "ccnl-malloc.h"
+#include "ccnl-buf.h"
+#include "ccnl-relay.h"
+#include "ccnl-face.h"
+
+/**
+ * The library may be built with more address families than the tests, which
+ * enlarges the interfaces following the face fields of the relay. Allocate a
+ * zeroed relay with room to spare so the library never reads past it.
+ */
+static struct ccnl_relay_s*
+create_relay(void)
+{
+    return (struct ccnl_relay_s*) ccnl_calloc(4, sizeof(struct ccnl_relay_s));
+}
+
+static void
+destroy_relay(struct ccnl_relay_s *relay)
+{
+    while (relay->faces) {
+        ccnl_face_remove(relay, relay->faces);
+    }
+    ccnl_face_index_free(relay);
+    ccnl_free(relay);
+}
+
+static struct ccnl_face_s*
+get_face(struct ccnl_relay_s *relay, int ifndx, uint32_t ip, uint16_t port)
+{
+    sockunion su;
+
+    memset(&su, 0, sizeof(su));
+    su.ip4.sin_family = AF_INET;
+    su.ip4.sin_addr.s_addr = htonl(ip);
+    su.ip4.sin_port = htons(port);
+    return ccnl_get_face_or_create(relay, ifndx, &su.sa, sizeof(su.ip4));
+}
+
+void test_ccnl_face_index()
+{
+    struct ccnl_relay_s *relay = create_relay();
+
+    struct ccnl_face_s *f1 = get_face(relay, 0, 0x0a000001, 9695);
+    struct ccnl_face_s *f2 = get_face(relay, 0, 0x0a000001, 9696);
+    struct ccnl_face_s *f3 = get_face(relay, 1, 0x0a000001, 9695);
+    struct ccnl_face_s *local = ccnl_get_face_or_create(relay, -1, NULL, 0);
+
+    assert_non_null(f1);
+    assert_non_null(f2);
+    assert_non_null(f3);
+    assert_non_null(local);
+    assert_true(f1 != f2 && f1 != f3 && f2 != f3);
+    assert_int_equal(relay->facecnt, 4);
+
+    assert_true(get_face(relay, 0, 0x0a000001, 9695) == f1);
+    assert_true(get_face(relay, 1, 0x0a000001, 9695) == f3);
+    assert_true(ccnl_get_face_or_create(relay, -1, NULL, 0) == local);
+    assert_int_equal(relay->facecnt, 4);
+
+    assert_true(ccnl_face_lookup_id(relay, f2->faceid) == f2);
+    assert_true(ccnl_face_lookup_id(relay, local->faceid) == local);
+    assert_null(ccnl_face_lookup_id(relay, -1));
+
+    int id = f1->faceid;
+    ccnl_face_remove(relay, f1);
+    assert_int_equal(relay->facecnt, 3);
+    assert_null(ccnl_face_lookup_id(relay, id));
+    f1 = get_face(relay, 0, 0x0a000001, 9695);
+    assert_non_null(f1);
+    assert_true(f1->faceid != id);
+
+    destroy_relay(relay);
+}
+
+void test_ccnl_face_index_grow()
+{
+    struct ccnl_relay_s *relay = create_relay();
+    struct ccnl_face_s *faces[4 * CCNL_FACE_INDEX_MIN_SIZE];
+    uint32_t i, n = sizeof(faces) / sizeof(faces[0]);
+
+    for (i = 0; i < n; i++) {
+        faces[i] = get_face(relay, 0, 0x0a000000 + i, 9695);
+        assert_non_null(faces[i]);
+    }
+    assert_int_equal(relay->facecnt, n);
+    assert_true(relay->face_index_size >= n);
+
+    for (i = 0; i < n; i++) {
+        assert_true(get_face(relay, 0, 0x0a000000 + i, 9695) == faces[i]);
+        assert_true(ccnl_face_lookup_id(relay, faces[i]->faceid) == faces[i]);
+    }
+    assert_int_equal(relay->facecnt, n);
+
+    destroy_relay(relay);
+}
+
+static struct ccnl_buf_s*
+mkbuf(char c)
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new(NULL, 100);
+
+    memset(buf->data, c, buf->datalen);
+    return buf;
+}
+
+/** takes the next queued packet and returns its first byte, 0 if none */
+static char
+take(struct ccnl_face_s *f)
+{
+    struct ccnl_buf_s *buf = ccnl_face_outq_take(f);
+    char c;
+
+    if (!buf) {
+        return 0;
+    }
+    c = (char) buf->data[0];
+    ccnl_buf_free(buf);
+    return c;
+}
+
+void test_ccnl_face_outq_dedupe()
+{
+    struct ccnl_relay_s *relay = create_relay();
+    struct ccnl_face_s *f = get_face(relay, 0, 0x0a000001, 9695);
+
+    /** the first packet is queued unhashed, the second one hashes it */
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('a'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('b'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('a'), 0), -1);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('b'), 1), -1);
+    assert_int_equal(take(f), 'a');
+
+    /** a packet which left the queue may be queued again */
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('a'), 0), 0);
+    assert_int_equal(take(f), 'b');
+    assert_int_equal(take(f), 'a');
+    assert_int_equal(take(f), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('a'), 0), 0);
+
+    destroy_relay(relay);
+}
+
+void test_ccnl_face_outq_drop_tail()
+{
+    struct ccnl_relay_s *relay = create_relay();
+    struct ccnl_face_s *f;
+
+    relay->face_qmax = 2;
+    f = get_face(relay, 0, 0x0a000001, 9695);
+    assert_int_equal(ccnl_face_qmax(f), 2);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('a'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('b'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('c'), 0), -1);
+    assert_int_equal(take(f), 'a');
+    assert_int_equal(take(f), 'b');
+    assert_int_equal(take(f), 0);
+
+    destroy_relay(relay);
+}
+
+void test_ccnl_face_outq_drop_head()
+{
+    struct ccnl_relay_s *relay = create_relay();
+    struct ccnl_face_s *f;
+
+    relay->face_qmax = 2;
+    relay->face_qdrop = ccnl_face_drop_str2policy("head");
+    f = get_face(relay, 0, 0x0a000001, 9695);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('a'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('b'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('c'), 0), 0);
+    /** the dropped packet is no duplicate anymore */
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('a'), 0), 0);
+    assert_int_equal(take(f), 'c');
+    assert_int_equal(take(f), 'a');
+    assert_int_equal(take(f), 0);
+
+    destroy_relay(relay);
+}
+
+void test_ccnl_face_outq_drop_prio()
+{
+    struct ccnl_relay_s *relay = create_relay();
+    struct ccnl_face_s *f;
+
+    relay->face_qmax = 3;
+    relay->face_qdrop = ccnl_face_drop_str2policy("prio");
+    f = get_face(relay, 0, 0x0a000001, 9695);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('d'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('i'), 1), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('j'), 1), 0);
+
+    /** an Interest does not push out other packets */
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('k'), 1), -1);
+    /** Data push out the oldest Interest, the others keep their order */
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('e'), 0), 0);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('f'), 0), 0);
+    /** with no Interest left Data are dropped as well */
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('g'), 0), -1);
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf('i'), 1), -1);
+    assert_int_equal(take(f), 'd');
+    assert_int_equal(take(f), 'e');
+    assert_int_equal(take(f), 'f');
+    assert_int_equal(take(f), 0);
+
+    assert_int_equal(ccnl_face_drop_str2policy("tail"), CCNL_FACE_DROP_TAIL);
+    assert_int_equal(ccnl_face_drop_str2policy("red"), -1);
+
+    destroy_relay(relay);
+}
+
+void test_ccnl_face_outq_wrap()
+{
+    struct ccnl_relay_s *relay = create_relay();
+    struct ccnl_face_s *f = get_face(relay, 0, 0x0a000001, 9695);
+    int i;
+
+    assert_int_equal(ccnl_face_qmax(f), CCNL_MAX_FACE_QLEN);
+    /** keep the queue half full while the ring turns several times */
+    for (i = 0; i < CCNL_MAX_FACE_QLEN / 2; i++) {
+        assert_int_equal(ccnl_face_outq_add(f, mkbuf((char) (1 + i)), 0), 0);
+    }
+    for (; i < 4 * CCNL_MAX_FACE_QLEN; i++) {
+        assert_int_equal(ccnl_face_outq_add(f, mkbuf((char) (1 + i)), 0), 0);
+        assert_int_equal(ccnl_face_outq_add(f, mkbuf((char) (1 + i)), 0), -1);
+        assert_int_equal(take(f), (char) (1 + i - CCNL_MAX_FACE_QLEN / 2));
+    }
+    /** fill it up, the queue is left to ccnl_face_remove() */
+    for (i = 0; i < CCNL_MAX_FACE_QLEN / 2; i++) {
+        assert_int_equal(ccnl_face_outq_add(f, mkbuf((char) (200 + i)), 0), 0);
+    }
+    assert_int_equal(ccnl_face_outq_add(f, mkbuf(0), 0), -1);
+
+    destroy_relay(relay);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_face_index),
+        unit_test(test_ccnl_face_index_grow),
+        unit_test(test_ccnl_face_outq_dedupe),
+        unit_test(test_ccnl_face_outq_drop_tail),
+        unit_test(test_ccnl_face_outq_drop_head),
+        unit_test(test_ccnl_face_outq_drop_prio),
+        unit_test(test_ccnl_face_outq_wrap),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,220 @@
+/**
+ * @file test_forward.c
+ * @brief Tests for the FIB index and its deferred reclamation
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <cmocka.h>
+
+#include "ccnl-malloc.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
+#include "ccnl-forward.h"
+
+static struct ccnl_forward_s*
+create_fwd(struct ccnl_relay_s *relay, char *uri)
+{
+    struct ccnl_forward_s *fwd = ccnl_calloc(1, sizeof(struct ccnl_forward_s));
+    fwd->prefix = ccnl_URItoPrefix(uri, 0, NULL);
+    fwd->suite = 0;
+    assert_int_equal(ccnl_fib_link(relay, fwd), 0);
+    return fwd;
+}
+
+static void
+destroy_fwd(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd)
+{
+    ccnl_fib_unlink(relay, fwd);
+    ccnl_prefix_free(fwd->prefix);
+    ccnl_free(fwd);
+}
+
+void test_ccnl_fib_lpm()
+{
+    struct ccnl_relay_s relay;
+    char u1[] = "/a", u2[] = "/a/b", u3[] = "/a/b/c", u4[] = "/x";
+    char n1[] = "/a/b/d", n2[] = "/a/b/c/d", n3[] = "/y/z", n4[] = "/a/b";
+    memset(&relay, 0, sizeof(relay));
+
+    struct ccnl_forward_s *a = create_fwd(&relay, u1);
+    struct ccnl_forward_s *ab = create_fwd(&relay, u2);
+    struct ccnl_forward_s *abc = create_fwd(&relay, u3);
+    struct ccnl_forward_s *x = create_fwd(&relay, u4);
+    struct ccnl_prefix_s *name1 = ccnl_URItoPrefix(n1, 0, NULL);
+    struct ccnl_prefix_s *name2 = ccnl_URItoPrefix(n2, 0, NULL);
+    struct ccnl_prefix_s *name3 = ccnl_URItoPrefix(n3, 0, NULL);
+    struct ccnl_prefix_s *name4 = ccnl_URItoPrefix(n4, 0, NULL);
+    struct ccnl_fib_match_s m;
+
+    assert_int_equal(relay.fibcnt, 4);
+    assert_true(ccnl_fib_lookup(&relay, name4) == ab);
+    assert_null(ccnl_fib_lookup(&relay, name1));
+
+    assert_true(ccnl_fib_lpm(&relay, name1) == ab);
+    assert_null(ccnl_fib_lpm(&relay, name3));
+
+    ccnl_fib_match_init(&relay, &m, name2);
+    assert_true(ccnl_fib_match_next(&relay, &m) == abc);
+    assert_true(ccnl_fib_match_next(&relay, &m) == ab);
+    assert_true(ccnl_fib_match_next(&relay, &m) == a);
+    assert_null(ccnl_fib_match_next(&relay, &m));
+
+    destroy_fwd(&relay, ab);
+    assert_true(ccnl_fib_lpm(&relay, name1) == a);
+
+    destroy_fwd(&relay, a);
+    destroy_fwd(&relay, abc);
+    destroy_fwd(&relay, x);
+    assert_null(relay.fib);
+    assert_int_equal(relay.fibcnt, 0);
+    ccnl_fib_index_free(&relay);
+
+    ccnl_prefix_free(name1);
+    ccnl_prefix_free(name2);
+    ccnl_prefix_free(name3);
+    ccnl_prefix_free(name4);
+}
+
+void test_ccnl_fib_index_grow()
+{
+    struct ccnl_relay_s relay;
+    struct ccnl_forward_s *fwd[3 * CCNL_FIB_INDEX_MIN_SIZE];
+    char uri[32];
+    int i;
+    memset(&relay, 0, sizeof(relay));
+
+    for (i = 0; i < 3 * CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        snprintf(uri, sizeof(uri), "/route/%d", i);
+        fwd[i] = create_fwd(&relay, uri);
+    }
+    assert_true(relay.fib_index->size >= 3 * CCNL_FIB_INDEX_MIN_SIZE);
+    for (i = 0; i < 3 * CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        assert_true(ccnl_fib_lpm(&relay, fwd[i]->prefix) == fwd[i]);
+    }
+    for (i = 0; i < 3 * CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        destroy_fwd(&relay, fwd[i]);
+    }
+    ccnl_fib_index_free(&relay);
+}
+
+void test_ccnl_fib_remove_deferred()
+{
+    struct ccnl_relay_s relay;
+    char u1[] = "/a/b", u2[] = "/a";
+    memset(&relay, 0, sizeof(relay));
+
+    struct ccnl_forward_s *ab = create_fwd(&relay, u1);
+    struct ccnl_forward_s *a = create_fwd(&relay, u2);
+    struct ccnl_fib_match_s m;
+    int reader = ccnl_rcu_register(&relay.fib_rcu);
+
+    assert_true(reader >= 0);
+    ccnl_fib_match_init(&relay, &m, ab->prefix);
+    assert_true(ccnl_fib_match_next(&relay, &m) == ab);
+
+    /** a reader may still stand on the entry, it stays retired */
+    ccnl_fib_remove(&relay, ab);
+    assert_int_equal(relay.fibcnt, 1);
+    assert_true(relay.fib_retired == ab);
+    assert_true(ccnl_fib_lpm(&relay, ab->prefix) == a);
+    /** and the walk it is on goes on behind it */
+    assert_true(ccnl_fib_match_next(&relay, &m) == a);
+
+    ccnl_fib_reclaim(&relay);
+    assert_true(relay.fib_retired == ab);
+    ccnl_rcu_quiescent(&relay.fib_rcu, reader);
+    ccnl_fib_reclaim(&relay);
+    assert_null(relay.fib_retired);
+
+    /** without readers nothing is held back */
+    ccnl_rcu_unregister(&relay.fib_rcu, reader);
+    ccnl_fib_remove(&relay, a);
+    assert_null(relay.fib_retired);
+    assert_null(relay.fib);
+    ccnl_fib_index_free(&relay);
+}
+
+void test_ccnl_fib_grow_deferred()
+{
+    struct ccnl_relay_s relay;
+    struct ccnl_forward_s *fwd[4 * CCNL_FIB_INDEX_MIN_SIZE];
+    struct ccnl_fib_index_s *first;
+    struct ccnl_fib_match_s m;
+    char uri[32];
+    int i, reader;
+    memset(&relay, 0, sizeof(relay));
+
+    reader = ccnl_rcu_register(&relay.fib_rcu);
+    for (i = 0; i < CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        snprintf(uri, sizeof(uri), "/route/%d", i);
+        fwd[i] = create_fwd(&relay, uri);
+    }
+    first = relay.fib_index;
+    ccnl_fib_match_init(&relay, &m, fwd[0]->prefix);
+
+    /** the grown index is built beside the one the reader holds */
+    for (; i < 2 * CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        snprintf(uri, sizeof(uri), "/route/%d", i);
+        fwd[i] = create_fwd(&relay, uri);
+    }
+    assert_true(relay.fib_index != first);
+    assert_non_null(relay.fib_retired_index);
+    assert_true(ccnl_fib_match_next(&relay, &m) == fwd[0]);
+
+    /** a further grow waits until the old index is gone */
+    for (; i < 4 * CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        snprintf(uri, sizeof(uri), "/route/%d", i);
+        fwd[i] = create_fwd(&relay, uri);
+    }
+    assert_int_equal(relay.fib_index->size, 2 * CCNL_FIB_INDEX_MIN_SIZE);
+    for (i = 0; i < 4 * CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        assert_true(ccnl_fib_lpm(&relay, fwd[i]->prefix) == fwd[i]);
+    }
+
+    ccnl_rcu_quiescent(&relay.fib_rcu, reader);
+    snprintf(uri, sizeof(uri), "/route/%d", i);
+    create_fwd(&relay, uri);
+    assert_int_equal(relay.fib_index->size, 4 * CCNL_FIB_INDEX_MIN_SIZE);
+    for (i = 0; i < 4 * CCNL_FIB_INDEX_MIN_SIZE; i++) {
+        assert_true(ccnl_fib_lpm(&relay, fwd[i]->prefix) == fwd[i]);
+    }
+
+    ccnl_rcu_unregister(&relay.fib_rcu, reader);
+    while (relay.fib) {
+        ccnl_fib_remove(&relay, relay.fib);
+    }
+    /** entries go at once, the old index with the writer's next reclaim */
+    assert_null(relay.fib_retired);
+    assert_non_null(relay.fib_retired_index);
+    ccnl_fib_reclaim(&relay);
+    assert_null(relay.fib_retired_index);
+    ccnl_fib_index_free(&relay);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_fib_lpm),
+        unit_test(test_ccnl_fib_index_grow),
+        unit_test(test_ccnl_fib_remove_deferred),
+        unit_test(test_ccnl_fib_grow_deferred),
+    };
+
+    return run_tests(tests);
+}
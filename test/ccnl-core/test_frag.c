@@ -0,0 +1,351 @@
+/**
+ * @file test_frag.c
+ * @brief Tests for the BeginEnd2015 fragment reassembly
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ccnl-malloc.h"
+#include "ccnl-buf.h"
+#include "ccnl-face.h"
+#include "ccnl-frag.h"
+#include "ccnl-pkt-ndntlv.h"
+
+#define MTU             300
+#define MAXFRAGS        32
+
+struct frag_s {
+    unsigned int bits;
+    unsigned int seqno;
+    uint8_t *data;
+    size_t len;
+    struct ccnl_buf_s *buf;
+};
+
+static uint8_t delivered[4][4096];
+static size_t deliveredlen[4];
+static int deliveries;
+
+static int8_t
+deliver(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+        uint8_t **data, size_t *datalen)
+{
+    (void) relay;
+    (void) from;
+    assert_true(deliveries < 4 && *datalen <= sizeof(delivered[0]));
+    memcpy(delivered[deliveries], *data, *datalen);
+    deliveredlen[deliveries++] = *datalen;
+    *data += *datalen;
+    *datalen = 0;
+    return 0;
+}
+
+/* an NDN Data packet of len bytes, its bytes following from tag */
+static struct ccnl_buf_s*
+mkpkt(size_t len, uint8_t tag)
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new(NULL, len);
+    size_t i;
+
+    buf->data[0] = 0x06;
+    buf->data[1] = 253;
+    buf->data[2] = (uint8_t) ((len - 4) >> 8);
+    buf->data[3] = (uint8_t) (len - 4);
+    for (i = 4; i < len; i++) {
+        buf->data[i] = (uint8_t) (tag + i);
+    }
+    return buf;
+}
+
+/* splits pkt with the fragmenter of the relay, returns the count */
+static int
+fragment(struct ccnl_frag_s *fr, struct ccnl_buf_s *pkt, struct frag_s *frags)
+{
+    sockunion dst;
+    int n = 0;
+
+    memset(&dst, 0, sizeof(dst));
+    ccnl_frag_reset(fr, pkt, 0, &dst);
+    while ((frags[n].buf = ccnl_frag_getnext(fr, NULL, NULL))) {
+        uint8_t *cp = frags[n].buf->data;
+        size_t len = frags[n].buf->datalen, vallen;
+        uint64_t typ;
+
+        /* Fragment { BeginEndFields, NdnlpFragment } */
+        assert_int_equal(ccnl_ndntlv_dehead(&cp, &len, &typ, &vallen), 0);
+        assert_int_equal(typ, NDN_TLV_Fragment);
+        assert_int_equal(ccnl_ndntlv_dehead(&cp, &len, &typ, &vallen), 0);
+        assert_int_equal(typ, NDN_TLV_Frag_BeginEndFields);
+        frags[n].bits = cp[0] >> 6;
+        frags[n].seqno = ((cp[0] << 8) | cp[1]) & CCNL_BEFRAG_SEQ_MASK;
+        cp += vallen;
+        len -= vallen;
+        assert_int_equal(ccnl_ndntlv_dehead(&cp, &len, &typ, &vallen), 0);
+        assert_int_equal(typ, NDN_TLV_NdnlpFragment);
+        frags[n].data = cp;
+        frags[n].len = vallen;
+        assert_true(++n < MAXFRAGS);
+    }
+    return n;
+}
+
+static void
+rx(struct ccnl_face_s *face, struct frag_s *f)
+{
+    uint8_t *data = f->data;
+    size_t len = f->len;
+
+    assert_int_equal(ccnl_frag_RX_BeginEnd2015(deliver, NULL, face, MTU, f->bits,
+                                               f->seqno, &data, &len), 1);
+}
+
+static void
+release(struct frag_s *frags, int n)
+{
+    while (n--) {
+        ccnl_buf_free(frags[n].buf);
+    }
+}
+
+static void
+setup(struct ccnl_face_s *face, struct ccnl_frag_s **fr)
+{
+    memset(face, 0, sizeof(*face));
+    *fr = ccnl_frag_new(CCNL_FRAG_BEGINEND2015, MTU);
+    deliveries = 0;
+}
+
+static void
+teardown(struct ccnl_face_s *face, struct ccnl_frag_s *fr)
+{
+    ccnl_frag_destroy(face->frag);
+    ccnl_frag_destroy(fr);
+}
+
+void test_ccnl_frag_in_order()
+{
+    struct ccnl_face_s face;
+    struct ccnl_frag_s *fr;
+    struct frag_s frags[MAXFRAGS];
+    struct ccnl_buf_s *pkt = mkpkt(2000, 1), *copy;
+    int i, n;
+
+    setup(&face, &fr);
+    copy = ccnl_buf_new(pkt->data, pkt->datalen);
+    n = fragment(fr, pkt, frags);
+    assert_true(n > 5);
+    assert_int_equal(frags[0].bits, CCNL_BEFRAG_FLAG_FIRST);
+    assert_int_equal(frags[n - 1].bits, CCNL_BEFRAG_FLAG_LAST);
+
+    for (i = 0; i < n; i++) {
+        assert_int_equal(deliveries, 0);
+        rx(&face, frags + i);
+    }
+    assert_int_equal(deliveries, 1);
+    assert_int_equal(deliveredlen[0], copy->datalen);
+    assert_true(!memcmp(delivered[0], copy->data, copy->datalen));
+    assert_int_equal(face.frag->reasmcnt, 1);
+
+    /** a packet fitting one fragment is passed on as it is */
+    release(frags, n);
+    n = fragment(fr, mkpkt(100, 2), frags);
+    assert_int_equal(n, 1);
+    assert_int_equal(frags[0].bits, CCNL_BEFRAG_FLAG_SINGLE);
+    rx(&face, frags);
+    assert_int_equal(deliveries, 2);
+    assert_int_equal(deliveredlen[1], 100);
+
+    release(frags, n);
+    ccnl_buf_free(copy);
+    teardown(&face, fr);
+}
+
+void test_ccnl_frag_reordered()
+{
+    struct ccnl_face_s face;
+    struct ccnl_frag_s *fr;
+    struct frag_s frags[MAXFRAGS];
+    struct ccnl_buf_s *pkt = mkpkt(1500, 3), *copy;
+    int i, n;
+
+    setup(&face, &fr);
+    copy = ccnl_buf_new(pkt->data, pkt->datalen);
+    n = fragment(fr, pkt, frags);
+
+    /** the first fragment arriving last still finds all others */
+    for (i = n - 1; i >= 0; i--) {
+        rx(&face, frags + i);
+    }
+    assert_int_equal(deliveries, 1);
+    assert_int_equal(deliveredlen[0], copy->datalen);
+    assert_true(!memcmp(delivered[0], copy->data, copy->datalen));
+
+    /** duplicates after the packet is done start nothing */
+    rx(&face, frags + 1);
+    rx(&face, frags + 2);
+    assert_int_equal(deliveries, 1);
+
+    release(frags, n);
+    ccnl_buf_free(copy);
+    teardown(&face, fr);
+}
+
+void test_ccnl_frag_interleaved()
+{
+    struct ccnl_face_s face;
+    struct ccnl_frag_s *fr;
+    struct frag_s a[MAXFRAGS], b[MAXFRAGS];
+    struct ccnl_buf_s *pa = mkpkt(900, 4), *pb = mkpkt(1100, 5), *ca, *cb;
+    int i, na, nb;
+
+    setup(&face, &fr);
+    ca = ccnl_buf_new(pa->data, pa->datalen);
+    cb = ccnl_buf_new(pb->data, pb->datalen);
+    na = fragment(fr, pa, a);
+    nb = fragment(fr, pb, b);
+    assert_int_equal(b[0].seqno, a[na - 1].seqno + 1);
+
+    /** the second packet's middle overtakes the end of the first, its own
+     *  first fragment comes late, and one fragment comes twice */
+    rx(&face, a);
+    rx(&face, a + 1);
+    rx(&face, b + 1);
+    rx(&face, b + 2);
+    rx(&face, a + 1);
+    for (i = 2; i < na; i++) {
+        rx(&face, a + i);
+    }
+    assert_int_equal(deliveries, 1);
+    assert_true(!memcmp(delivered[0], ca->data, ca->datalen));
+    for (i = 3; i < nb; i++) {
+        rx(&face, b + i);
+    }
+    assert_int_equal(deliveries, 1);
+    rx(&face, b);
+    assert_int_equal(deliveries, 2);
+    assert_int_equal(deliveredlen[1], cb->datalen);
+    assert_true(!memcmp(delivered[1], cb->data, cb->datalen));
+    assert_int_equal(face.frag->dropcnt, 0);
+    assert_null(face.frag->early);
+
+    release(a, na);
+    release(b, nb);
+    ccnl_buf_free(ca);
+    ccnl_buf_free(cb);
+    teardown(&face, fr);
+}
+
+void test_ccnl_frag_loss()
+{
+    struct ccnl_face_s face;
+    struct ccnl_frag_s *fr;
+    struct frag_s frags[CCNL_FRAG_REASM_SLOTS + 2][MAXFRAGS];
+    int cnt[CCNL_FRAG_REASM_SLOTS + 2];
+    int i, k;
+
+    setup(&face, &fr);
+    for (k = 0; k < CCNL_FRAG_REASM_SLOTS + 2; k++) {
+        cnt[k] = fragment(fr, mkpkt(700, (uint8_t) k), frags[k]);
+    }
+
+    /** a lost fragment leaves its packet behind, not the next ones */
+    for (i = 0; i < cnt[0]; i++) {
+        if (i != 1) {
+            rx(&face, frags[0] + i);
+        }
+    }
+    for (i = 0; i < cnt[1]; i++) {
+        rx(&face, frags[1] + i);
+    }
+    assert_int_equal(deliveries, 1);
+    assert_int_equal(deliveredlen[0], 700);
+
+    /** once all slots hold partial packets, the oldest gives way */
+    for (k = 2; k < CCNL_FRAG_REASM_SLOTS + 2; k++) {
+        rx(&face, frags[k]);
+    }
+    assert_int_equal(face.frag->dropcnt, 1);
+    rx(&face, frags[0] + 1);
+    assert_int_equal(deliveries, 1);
+
+    for (k = 0; k < CCNL_FRAG_REASM_SLOTS + 2; k++) {
+        release(frags[k], cnt[k]);
+    }
+    teardown(&face, fr);
+}
+
+static void
+check_slices(int suite)
+{
+    struct ccnl_frag_s *copier = ccnl_frag_new(CCNL_FRAG_BEGINEND2015, MTU);
+    struct ccnl_frag_s *slicer = ccnl_frag_new(CCNL_FRAG_BEGINEND2015, MTU);
+    struct ccnl_buf_s *pkt = mkpkt(3000, 6), *copy, *slice;
+    uint8_t hdr[CCNL_FRAG_HDR_MAX];
+    size_t hdrlen;
+    sockunion dst;
+    int n = 0;
+
+    memset(&dst, 0, sizeof(dst));
+    ccnl_frag_reset(copier, ccnl_buf_share(pkt), 0, &dst);
+    ccnl_frag_reset(slicer, ccnl_buf_share(pkt), 0, &dst);
+    copier->outsuite = slicer->outsuite = suite;
+
+    /** the same bytes go out, the payload read from the packet itself */
+    while ((copy = ccnl_frag_getnext(copier, NULL, NULL))) {
+        slice = ccnl_frag_getnextslice(slicer, hdr, &hdrlen, NULL, NULL);
+        assert_non_null(slice);
+        assert_true(hdrlen > 0 && hdrlen <= CCNL_FRAG_HDR_MAX);
+        assert_int_equal(hdrlen + slice->datalen, copy->datalen);
+        assert_true(copy->datalen <= MTU);
+        assert_true(!memcmp(copy->data, hdr, hdrlen));
+        assert_true(!memcmp(copy->data + hdrlen, slice->data, slice->datalen));
+        assert_true(slice->data >= pkt->data &&
+                    slice->data + slice->datalen <= pkt->data + pkt->datalen);
+        ccnl_buf_free(copy);
+        ccnl_buf_free(slice);
+        n++;
+    }
+    assert_true(n > 10);
+    assert_null(ccnl_frag_getnextslice(slicer, hdr, &hdrlen, NULL, NULL));
+    assert_int_equal(pkt->refcnt, 1);
+
+    ccnl_buf_free(pkt);
+    ccnl_frag_destroy(copier);
+    ccnl_frag_destroy(slicer);
+}
+
+void test_ccnl_frag_slices()
+{
+    check_slices(CCNL_SUITE_NDNTLV);
+    check_slices(CCNL_SUITE_CCNTLV);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_frag_in_order),
+        unit_test(test_ccnl_frag_reordered),
+        unit_test(test_ccnl_frag_interleaved),
+        unit_test(test_ccnl_frag_loss),
+        unit_test(test_ccnl_frag_slices),
+    };
+
+    return run_tests(tests);
+}
@@ -19,9 +19,13 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
+#include <string.h>
 #include <cmocka.h>
  
 #include "ccnl-interest.h"
+#include "ccnl-malloc.h"
+#include "ccnl-prefix.h"
+#include "ccnl-relay.h"
 
 
 void test_ccnl_interest_append_pending_invalid_parameters()
@@ -54,6 +58,71 @@ void test_ccnl_interest_remove_pending_invalid_parameters()
     assert_int_equal(result, -2); 
 }
 
+/* the library is built with more options (e.g. USE_HMAC256) than the tests,
+ * leave room for its larger and zeroed struct ccnl_pkt_s */
+#define TEST_PKT_SIZE (sizeof(struct ccnl_pkt_s) + 64)
+
+static struct ccnl_interest_s*
+create_interest(struct ccnl_relay_s *relay, char *uri)
+{
+    struct ccnl_interest_s *i = ccnl_calloc(1, sizeof(struct ccnl_interest_s));
+    i->pkt = ccnl_calloc(1, TEST_PKT_SIZE);
+    i->pkt->pfx = ccnl_URItoPrefix(uri, 0, NULL);
+    assert_int_equal(ccnl_interest_index_add(relay, i), 0);
+    relay->pitcnt++;
+    return i;
+}
+
+static void
+destroy_interest(struct ccnl_relay_s *relay, struct ccnl_interest_s *i)
+{
+    ccnl_interest_index_remove(relay, i);
+    relay->pitcnt--;
+    ccnl_prefix_free(i->pkt->pfx);
+    ccnl_free(i->pkt);
+    ccnl_free(i);
+}
+
+void test_ccnl_interest_index()
+{
+    struct ccnl_relay_s relay;
+    char uri1[] = "/path/to/data", uri2[] = "/path/to", uri3[] = "/path/to/data";
+    uint8_t digest[32];
+    struct ccnl_interest_s *i, *found = NULL;
+    memset(&relay, 0, sizeof(relay));
+    memset(digest, 0xab, sizeof(digest));
+
+    struct ccnl_interest_s *i1 = create_interest(&relay, uri1);
+    struct ccnl_interest_s *i2 = create_interest(&relay, uri2);
+    struct ccnl_pkt_s *pkt = ccnl_calloc(1, TEST_PKT_SIZE);
+    pkt->pfx = ccnl_URItoPrefix(uri3, 0, NULL);
+
+    assert_true(ccnl_interest_index_lookup(&relay, pkt) == i1);
+    assert_true(ccnl_interest_index_lookup(&relay, i2->pkt) == i2);
+
+    // an Interest for /path/to/data plus its implicit digest is found with
+    // the hash of the content name
+    ccnl_prefix_appendCmp(pkt->pfx, digest, sizeof(digest));
+    assert_null(ccnl_interest_index_lookup(&relay, pkt));
+    struct ccnl_interest_s *i3 = ccnl_calloc(1, sizeof(struct ccnl_interest_s));
+    i3->pkt = pkt;
+    assert_int_equal(ccnl_interest_index_add(&relay, i3), 0);
+    relay.pitcnt++;
+    assert_true(ccnl_interest_index_lookup(&relay, pkt) == i3);
+    for (i = ccnl_interest_index_bucket(&relay, ccnl_prefix_hash(i1->pkt->pfx, 3)); i; i = i->hnext) {
+        if (i == i3) {
+            found = i;
+        }
+    }
+    assert_true(found == i3);
+
+    destroy_interest(&relay, i1);
+    assert_true(ccnl_interest_index_lookup(&relay, i2->pkt) == i2);
+    destroy_interest(&relay, i3);
+    destroy_interest(&relay, i2);
+    ccnl_interest_index_free(&relay);
+}
+
 void test1()
 {
   int result = 0;
@@ -67,6 +136,7 @@ int main(void)
     unit_test(test_ccnl_interest_is_same_invalid_parameters),
     unit_test(test_ccnl_interest_remove_pending_invalid_parameters),
     unit_test(test_ccnl_interest_append_pending_invalid_parameters),
+    unit_test(test_ccnl_interest_index),
   };
  
   return run_tests(tests);
@@ -0,0 +1,102 @@
+/**
+ * @file test_os-time.c
+ * @brief Tests for the timer event queue
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#define _DEFAULT_SOURCE
+#define CCNL_UNIX
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <cmocka.h>
+
+#include "ccnl-os-time.h"
+
+static int fired[16];
+static int firedcnt;
+
+static void
+record(void *aux1, void *aux2)
+{
+    (void) aux2;
+    fired[firedcnt++] = (int) (intptr_t) aux1;
+}
+
+void test_ccnl_timer_order()
+{
+    int delays[] = { 3000, 1000, 5000, 2000, 4000 };
+    void *h[5];
+    int i;
+
+    firedcnt = 0;
+    for (i = 0; i < 5; i++) {
+        h[i] = ccnl_set_timer(delays[i], record, (void*) (intptr_t) delays[i], NULL);
+        assert_non_null(h[i]);
+    }
+    ccnl_rem_timer(h[3]);
+    ccnl_rem_timer(h[3]);
+    assert_non_null(ccnl_set_timer(60000000, record, (void*) 60, NULL));
+
+    usleep(10000);
+    assert_true(ccnl_run_events() > 0);
+    assert_int_equal(firedcnt, 4);
+    assert_int_equal(fired[0], 1000);
+    assert_int_equal(fired[1], 3000);
+    assert_int_equal(fired[2], 4000);
+    assert_int_equal(fired[3], 5000);
+
+    /** handles of fired timers are ignored */
+    ccnl_rem_timer(h[0]);
+    ccnl_timer_cleanup();
+    assert_int_equal(ccnl_run_events(), -1);
+}
+
+void test_ccnl_timer_many()
+{
+    void *h[64];
+    int i;
+
+    firedcnt = 0;
+    for (i = 0; i < 64; i++) {
+        h[i] = ccnl_set_timer(1000000 + (i * 7919) % 64, record, NULL, NULL);
+        assert_non_null(h[i]);
+    }
+    /** cancel every timer but one, in an order unrelated to the deadlines */
+    for (i = 0; i < 64; i++) {
+        if (i != 42) {
+            ccnl_rem_timer(h[(i * 5) % 64]);
+        }
+    }
+    assert_true(ccnl_run_events() > 0);
+    assert_int_equal(firedcnt, 0);
+    ccnl_rem_timer(h[(42 * 5) % 64]);
+    assert_int_equal(ccnl_run_events(), -1);
+
+    ccnl_timer_cleanup();
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_timer_order),
+        unit_test(test_ccnl_timer_many),
+    };
+
+    return run_tests(tests);
+}
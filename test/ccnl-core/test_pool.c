@@ -0,0 +1,128 @@
+/**
+ * @file test_pool.c
+ * @brief Tests for the fixed-size object pools
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ccnl-pool.h"
+#include "ccnl-buf.h"
+#include "ccnl-prefix.h"
+
+void test_ccnl_pool_alloc()
+{
+    struct ccnl_pool_s pool = { .name = "test", .objsize = 24 };
+    void *a, *b, *c;
+
+    /** without a slab every object comes from the heap */
+    a = ccnl_pool_malloc(&pool, 24);
+    assert_non_null(a);
+    assert_false(ccnl_pool_owns(&pool, a));
+    assert_int_equal(pool.fallbacks, 1);
+    ccnl_pool_free(&pool, a);
+
+    assert_int_equal(ccnl_pool_reserve(&pool, 2), 0);
+    assert_int_equal(pool.capacity, 2);
+    a = ccnl_pool_malloc(&pool, 24);
+    b = ccnl_pool_calloc(&pool, 16);
+    assert_true(ccnl_pool_owns(&pool, a));
+    assert_true(ccnl_pool_owns(&pool, b));
+    assert_int_equal(pool.inuse, 2);
+    assert_int_equal(pool.allocs, 2);
+
+    /** an exhausted slab falls back to the heap */
+    c = ccnl_pool_malloc(&pool, 24);
+    assert_non_null(c);
+    assert_false(ccnl_pool_owns(&pool, c));
+    assert_int_equal(pool.fallbacks, 2);
+    ccnl_pool_free(&pool, c);
+
+    /** a freed slot is handed out again */
+    ccnl_pool_free(&pool, b);
+    assert_int_equal(pool.inuse, 1);
+    assert_true(ccnl_pool_malloc(&pool, 8) == b);
+    assert_int_equal(pool.peak, 2);
+
+    /** the slab stays while objects are in use */
+    assert_int_equal(ccnl_pool_reserve(&pool, 4), -1);
+    ccnl_pool_release(&pool);
+    assert_true(ccnl_pool_owns(&pool, a));
+
+    ccnl_pool_free(&pool, a);
+    ccnl_pool_free(&pool, b);
+    ccnl_pool_free(&pool, NULL);
+    assert_int_equal(pool.inuse, 0);
+    ccnl_pool_release(&pool);
+    assert_int_equal(pool.capacity, 0);
+}
+
+void test_ccnl_pool_oversize()
+{
+    struct ccnl_pool_s pool = { .name = "test", .objsize = 8 };
+    void *p;
+
+    assert_int_equal(ccnl_pool_reserve(&pool, 1), 0);
+    p = ccnl_pool_malloc(&pool, 9);
+    assert_non_null(p);
+    assert_false(ccnl_pool_owns(&pool, p));
+    assert_int_equal(pool.inuse, 0);
+    ccnl_pool_free(&pool, p);
+    ccnl_pool_release(&pool);
+}
+
+void test_ccnl_pools_buf()
+{
+    struct ccnl_buf_s *small, *share, *big;
+    struct ccnl_prefix_s *pfx;
+
+    assert_int_equal(ccnl_pools_init(4), 0);
+
+    small = ccnl_buf_new("nonce", 5);
+    assert_true(ccnl_pool_owns(CCNL_POOL(BUF_TINY), small));
+    share = ccnl_buf_share(small);
+    assert_true(ccnl_pool_owns(CCNL_POOL(BUF_TINY), share));
+    big = ccnl_buf_new(NULL, CCNL_POOL_TINY_BUF_SIZE + 1);
+    assert_true(ccnl_pool_owns(CCNL_POOL(BUF_SMALL), big));
+    pfx = ccnl_prefix_new(0, 3);
+    assert_true(ccnl_pool_owns(CCNL_POOL(PREFIX), pfx));
+
+    ccnl_buf_free(small);
+    ccnl_buf_free(share);
+    ccnl_buf_free(big);
+    ccnl_prefix_free(pfx);
+    assert_int_equal(CCNL_POOL(BUF_TINY)->inuse, 0);
+    assert_int_equal(CCNL_POOL(BUF_SMALL)->inuse, 0);
+    assert_int_equal(CCNL_POOL(PREFIX)->inuse, 0);
+
+    ccnl_pools_cleanup();
+    assert_int_equal(CCNL_POOL(PKT)->capacity, 0);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_pool_alloc),
+        unit_test(test_ccnl_pool_oversize),
+        unit_test(test_ccnl_pools_buf),
+    };
+
+    return run_tests(tests);
+}
@@ -8,20 +8,16 @@
 void test_prefix_to_path()
 {
     char *result = "/path/to/data";
-    struct ccnl_prefix_s *p = ccnl_malloc(sizeof(struct ccnl_prefix_s));
-    p->compcnt = 3;
-    p->comp = (unsigned char**)ccnl_malloc(sizeof(unsigned char*) * p->compcnt);
-    p->complen = ccnl_malloc(sizeof(size_t) * p->compcnt);
-    p->comp[0] = (unsigned char*)"path";
+    struct ccnl_prefix_s *p = ccnl_prefix_new(0, 3);
+    p->base = (unsigned char*)"pathtodata";
+    p->compoff[0] = 0;
     p->complen[0] = 4;
-    p->comp[1] = (unsigned char*)"to";
+    p->compoff[1] = 4;
     p->complen[1] = 2;
-    p->comp[2] = (unsigned char*)"data";
+    p->compoff[2] = 6;
     p->complen[2] = 4;
     assert_string_equal(result, ccnl_prefix_to_path(p));
-    ccnl_free(p->comp);
-    ccnl_free(p->complen);
-    ccnl_free(p);
+    ccnl_prefix_free(p);
 }
 
 void test_uri_to_prefix(){
@@ -127,6 +123,97 @@ void test_prefix_no_longest_match()
     assert_int_equal(0, res);
 }
 
+void test_prefix_dup()
+{
+    char *c = ccnl_malloc(100);
+    strcpy(c, "/path/to/data");
+    uint32_t chunknum = 7;
+    struct ccnl_prefix_s *p1 = ccnl_URItoPrefix(c, 0, &chunknum);
+    struct ccnl_prefix_s *p2 = ccnl_prefix_dup(p1);
+
+    assert_non_null(p2);
+    assert_int_equal(p2->compcnt, 3);
+    assert_int_equal(p2->chunknum, 7);
+    assert_int_equal(p2->hash, p1->hash);
+    assert_int_equal(0, ccnl_prefix_cmp(p1, 0, p2, CMP_EXACT));
+
+    /** hashes, components, lengths and bytes share the prefix' allocation */
+    assert_null(p2->ext);
+    assert_true((unsigned char*) p2->comphash == (unsigned char*) (p2 + 1));
+    assert_true((unsigned char*) p2->compoff == (unsigned char*) (p2->comphash + 3));
+    assert_true(ccnl_prefix_comp(p2, 0) == (unsigned char*) (p2->complen + 3));
+    assert_int_equal(0, memcmp(ccnl_prefix_comp(p2, 2), "data", 4));
+
+    ccnl_prefix_free(p1);
+    ccnl_prefix_free(p2);
+    ccnl_free(c);
+}
+
+void test_prefix_hash_after_append()
+{
+    char *c1 = ccnl_malloc(100);
+    char *c2 = ccnl_malloc(100);
+    strcpy(c1, "/path/to");
+    strcpy(c2, "/path/to/data");
+    struct ccnl_prefix_s *p1 = ccnl_URItoPrefix(c1, 0, NULL);
+    struct ccnl_prefix_s *p2 = ccnl_URItoPrefix(c2, 0, NULL);
+
+    assert_int_equal(p1->chunknum, -1);
+    assert_true(p1->hash != p2->hash);
+    assert_int_equal(p1->hash, ccnl_prefix_hash(p2, 2));
+    ccnl_prefix_appendCmp(p1, (unsigned char*) "data", 4);
+    assert_int_equal(p1->hash, p2->hash);
+    assert_int_equal(0, ccnl_prefix_cmp(p1, 0, p2, CMP_EXACT));
+
+    ccnl_prefix_free(p1);
+    ccnl_prefix_free(p2);
+    ccnl_free(c1);
+    ccnl_free(c2);
+}
+
+void test_prefix_hash_cumulative()
+{
+    char *c1 = ccnl_malloc(100);
+    char *c2 = ccnl_malloc(100);
+    strcpy(c1, "/path/to/data");
+    strcpy(c2, "/path/to/dat/a");
+    struct ccnl_prefix_s *p1 = ccnl_URItoPrefix(c1, 0, NULL);
+    struct ccnl_prefix_s *p2 = ccnl_URItoPrefix(c2, 0, NULL);
+    struct ccnl_prefix_s *p3 = ccnl_prefix_new(0, 0);
+    uint64_t h1 = p1->hash;
+    uint64_t basis;
+
+    /** every leading sub-prefix has its hash cached */
+    assert_true(ccnl_prefix_hash(p1, 1) == p1->comphash[0]);
+    assert_true(ccnl_prefix_hash(p1, 2) == ccnl_prefix_hash(p2, 2));
+    assert_true(ccnl_prefix_hash(p1, 0) == ccnl_prefix_hash(p3, 0));
+    assert_true(p3->hash == ccnl_prefix_hash(p1, 0));
+
+    /** the component boundaries are part of the hash */
+    assert_true(ccnl_prefix_hash(p1, 3) != ccnl_prefix_hash(p2, 3));
+    assert_int_equal(2, ccnl_prefix_cmp(p1, 0, p2, CMP_LONGEST));
+    assert_int_equal(-1, ccnl_prefix_cmp(p1, 0, p2, CMP_EXACT));
+
+    /** a new seed changes every hash, names built afterwards agree again */
+    basis = ccnl_prefix_hash_seed(42);
+    ccnl_prefix_rehash(p1);
+    assert_true(p1->hash != h1);
+    ccnl_prefix_rehash(p2);
+    assert_true(ccnl_prefix_hash(p1, 2) == ccnl_prefix_hash(p2, 2));
+    assert_int_equal(2, ccnl_prefix_cmp(p2, 0, p1, CMP_MATCH));
+
+    /** later tests hash under the seed they started with */
+    ccnl_prefix_hash_restore(basis);
+    ccnl_prefix_rehash(p1);
+    assert_true(p1->hash == h1);
+
+    ccnl_prefix_free(p1);
+    ccnl_prefix_free(p2);
+    ccnl_prefix_free(p3);
+    ccnl_free(c1);
+    ccnl_free(c2);
+}
+
 int main(void)
 {
   const UnitTest tests[] = {
@@ -137,6 +224,9 @@ int main(void)
     unit_test(test_prefix_no_exact_match),
     unit_test(test_prefix_longest_match),
     unit_test(test_prefix_no_longest_match),
+    unit_test(test_prefix_dup),
+    unit_test(test_prefix_hash_after_append),
+    unit_test(test_prefix_hash_cumulative),
   };
  
   return run_tests(tests);
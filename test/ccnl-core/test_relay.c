@@ -0,0 +1,241 @@
+/**
+ * @file test_relay.c
+ * @brief Tests for the duplicate nonce detection and the serving of the relay
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-malloc.h"
+#include "ccnl-buf.h"
+#include "ccnl-pkt.h"
+#include "ccnl-prefix.h"
+#include "ccnl-content.h"
+#include "ccnl-interest.h"
+#include "ccnl-relay.h"
+
+#define FACES   3
+
+static int sent[FACES];
+
+static void
+count_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+         sockunion *dest, struct ccnl_buf_s *buf)
+{
+    (void) ccnl;
+    (void) ifc;
+    (void) buf;
+    sent[ntohl(dest->ip4.sin_addr.s_addr) - 0x0a000000]++;
+}
+
+static struct ccnl_pkt_s*
+create_pkt(const char *uri)
+{
+    struct ccnl_pkt_s *pkt = ccnl_calloc(1, sizeof(*pkt));
+    char s[64];
+
+    strcpy(s, uri);
+    pkt->pfx = ccnl_URItoPrefix(s, CCNL_SUITE_DEFAULT, NULL);
+    pkt->suite = CCNL_SUITE_DEFAULT;
+    pkt->s.ndntlv.maxsuffix = CCNL_MAX_NAME_COMP;
+    pkt->buf = ccnl_buf_new(NULL, 16);
+    memset(pkt->buf->data, 0x42, 16);
+    return pkt;
+}
+
+static struct ccnl_relay_s*
+create_relay(struct ccnl_face_s **f)
+{
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(*relay));
+    int i;
+
+    relay->ccnl_ll_TX_ptr = count_TX;
+    relay->ifcount = 1;
+    relay->max_pit_entries = -1;
+    for (i = 0; i < FACES; i++) {
+        sockunion su;
+
+        memset(&su, 0, sizeof(su));
+        su.ip4.sin_family = AF_INET;
+        su.ip4.sin_addr.s_addr = htonl(0x0a000000 + i);
+        su.ip4.sin_port = htons(9695);
+        f[i] = ccnl_get_face_or_create(relay, 0, &su.sa, sizeof(su.ip4));
+        assert_non_null(f[i]);
+    }
+    memset(sent, 0, sizeof(sent));
+    return relay;
+}
+
+static void
+free_relay(struct ccnl_relay_s *relay)
+{
+    ccnl_core_cleanup(relay);
+    ccnl_free(relay);
+}
+
+static struct ccnl_buf_s*
+create_nonce(uint32_t value, size_t len)
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new(NULL, 8);
+    memset(buf->data, 0, 8);
+    memcpy(buf->data, &value, sizeof(value));
+    buf->datalen = len;
+    return buf;
+}
+
+void test_ccnl_nonce_find_or_append()
+{
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(struct ccnl_relay_s));
+    struct ccnl_buf_s *n1 = create_nonce(0x12345678, 4);
+    struct ccnl_buf_s *n2 = create_nonce(0x12345679, 4);
+    struct ccnl_buf_s *n3 = create_nonce(0x12345678, 6);
+
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n1, 10), 0);
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n1, 10), -1);
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n2, 10), 0);
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n3, 10), 0);
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n3, 10), -1);
+    assert_int_equal(relay->nonce_hits, 2);
+
+    /** a nonce without lifetime has already expired when it is seen again */
+    n1->data[3]++;
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n1, 0), 0);
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n1, 0), 0);
+    assert_int_equal(relay->nonce_hits, 2);
+    assert_int_equal(relay->nonce_evictions, 0);
+
+    ccnl_buf_free(n1);
+    ccnl_buf_free(n2);
+    ccnl_buf_free(n3);
+    ccnl_free(relay);
+}
+
+void test_ccnl_nonce_evict()
+{
+    struct ccnl_relay_s *relay = ccnl_calloc(1, sizeof(struct ccnl_relay_s));
+    struct ccnl_buf_s *n = create_nonce(0, 4);
+    uint32_t i;
+
+    for (i = 0; i < 4 * CCNL_NONCE_TABLE_SIZE; i++) {
+        memcpy(n->data, &i, sizeof(i));
+        assert_int_equal(ccnl_nonce_find_or_append(relay, n, 10), 0);
+    }
+    assert_true(relay->nonce_evictions >= 3 * CCNL_NONCE_TABLE_SIZE);
+    assert_int_equal(relay->nonce_hits, 0);
+
+    /** the most recent nonce always survives */
+    assert_int_equal(ccnl_nonce_find_or_append(relay, n, 10), -1);
+
+    ccnl_buf_free(n);
+    ccnl_free(relay);
+}
+
+void test_ccnl_serve_fanout_bucket()
+{
+    assert_int_equal(ccnl_serve_fanout_bucket(-1), 0);
+    assert_int_equal(ccnl_serve_fanout_bucket(0), 0);
+    assert_int_equal(ccnl_serve_fanout_bucket(1), 1);
+    assert_int_equal(ccnl_serve_fanout_bucket(2), 2);
+    assert_int_equal(ccnl_serve_fanout_bucket(3), 3);
+    assert_int_equal(ccnl_serve_fanout_bucket(4), 3);
+    assert_int_equal(ccnl_serve_fanout_bucket(5), 4);
+    assert_int_equal(ccnl_serve_fanout_bucket(8), 4);
+    assert_int_equal(ccnl_serve_fanout_bucket(9), 5);
+
+    /** the last bucket takes everything above */
+    assert_int_equal(ccnl_serve_fanout_bucket(1 << 20), CCNL_SERVE_FANOUT_BUCKETS - 1);
+}
+
+void test_ccnl_serve_pending_once_per_face()
+{
+    struct ccnl_face_s *f[FACES];
+    struct ccnl_relay_s *relay = create_relay(f);
+    struct ccnl_pkt_s *pkt;
+    struct ccnl_interest_s *i1, *i2;
+    struct ccnl_content_s *c;
+
+    pkt = create_pkt("/serve/once");
+    i1 = ccnl_interest_new(relay, f[0], &pkt);
+    assert_non_null(i1);
+    ccnl_interest_append_pending(i1, f[0]);
+    ccnl_interest_append_pending(i1, f[1]);
+    pkt = create_pkt("/serve/once");
+    i2 = ccnl_interest_new(relay, f[2], &pkt);
+    assert_non_null(i2);
+    ccnl_interest_append_pending(i2, f[0]);
+
+    /** face 0 is pending on both entries, it gets one copy */
+    pkt = create_pkt("/serve/once");
+    c = ccnl_content_new(&pkt);
+    assert_int_equal(ccnl_content_serve_pending(relay, c), 2);
+    assert_int_equal(sent[0], 1);
+    assert_int_equal(sent[1], 1);
+    assert_int_equal(sent[2], 0);
+    assert_null(relay->pit);
+
+    ccnl_content_free(c);
+    free_relay(relay);
+}
+
+void test_ccnl_serve_epoch_wrap()
+{
+    struct ccnl_face_s *f[FACES];
+    struct ccnl_relay_s *relay = create_relay(f);
+    struct ccnl_pkt_s *pkt;
+    struct ccnl_interest_s *i;
+    struct ccnl_content_s *c;
+
+    /** faces served long ago carry epochs the wrap comes back to */
+    relay->serve_epoch = UINT32_MAX;
+    f[0]->served_epoch = 1;
+    f[1]->served_epoch = 2;
+    f[2]->served_epoch = UINT32_MAX;
+
+    pkt = create_pkt("/serve/wrap");
+    i = ccnl_interest_new(relay, f[0], &pkt);
+    assert_non_null(i);
+    ccnl_interest_append_pending(i, f[0]);
+    pkt = create_pkt("/serve/wrap");
+    c = ccnl_content_new(&pkt);
+
+    assert_int_equal(ccnl_content_serve_pending(relay, c), 1);
+    assert_int_equal(sent[0], 1);
+    assert_int_equal(relay->serve_epoch, 1);
+    assert_int_equal(f[0]->served_epoch, 1);
+    assert_int_equal(f[1]->served_epoch, 0);
+    assert_int_equal(f[2]->served_epoch, 0);
+
+    ccnl_content_free(c);
+    free_relay(relay);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_nonce_find_or_append),
+        unit_test(test_ccnl_nonce_evict),
+        unit_test(test_ccnl_serve_fanout_bucket),
+        unit_test(test_ccnl_serve_pending_once_per_face),
+        unit_test(test_ccnl_serve_epoch_wrap),
+    };
+
+    return run_tests(tests);
+}
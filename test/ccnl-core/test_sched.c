@@ -0,0 +1,293 @@
+/**
+ * @file test_sched.c
+ * @brief Tests for the deficit round robin scheduler
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ccnl-sched.h"
+#include "ccnl-defs.h"
+
+#define FACES   3
+#define PKTS    512
+
+/** the interface: a ring of sends and a link sending one at a time */
+struct link_s {
+    struct ccnl_sched_s *sched;
+    int sync;               /**< sends complete before cts returns */
+    int ring[PKTS][2];      /**< face, length */
+    int qfront, qlen;
+    int wire;               /**< ring slot being sent, -1 if idle */
+    long sent[FACES];
+    int nsent;
+};
+
+struct face_s {
+    struct link_s *link;
+    struct ccnl_sched_s *sched;
+    int id;
+    int q[PKTS];
+    int qfront, qlen;
+};
+
+static void
+link_done(struct link_s *l)
+{
+    int *r = l->ring[l->wire];
+
+    l->wire = -1;
+    l->sent[r[0]] += r[1];
+    l->nsent++;
+    ccnl_sched_CTS_done(l->sched, 1, r[1]);
+}
+
+static void
+link_cts(void *aux1, void *aux2)
+{
+    struct link_s *l = aux1;
+
+    (void) aux2;
+    assert_int_equal(l->wire, -1);
+    assert_true(l->qlen > 0);
+    l->wire = l->qfront;
+    l->qfront = (l->qfront + 1) % PKTS;
+    l->qlen--;
+    if (l->sync) {
+        link_done(l);
+    }
+}
+
+static void
+face_cts(void *aux1, void *aux2)
+{
+    struct link_s *l = aux1;
+    struct face_s *f = aux2;
+    int *r;
+
+    if (!f->qlen) {
+        return;
+    }
+    r = l->ring[(l->qfront + l->qlen) % PKTS];
+    r[0] = f->id;
+    r[1] = f->q[f->qfront];
+    f->qfront = (f->qfront + 1) % PKTS;
+    f->qlen--;
+    l->qlen++;
+    ccnl_sched_RTS(l->sched, 1, r[1], l, NULL);
+}
+
+static void
+face_send(struct face_s *f, int len)
+{
+    f->q[(f->qfront + f->qlen) % PKTS] = len;
+    f->qlen++;
+    ccnl_sched_RTS(f->sched, 1, len, f->link, f);
+}
+
+static void
+setup(struct link_s *l, struct face_s *f, int sync, int quantum,
+      const int *weights)
+{
+    int i;
+
+    memset(l, 0, sizeof(*l));
+    memset(f, 0, FACES * sizeof(*f));
+    l->sync = sync;
+    l->wire = -1;
+    l->sched = ccnl_sched_drr_new(link_cts, NULL, quantum, 0);
+    assert_non_null(l->sched);
+    for (i = 0; i < FACES; i++) {
+        f[i].link = l;
+        f[i].id = i;
+        f[i].sched = ccnl_sched_drr_face_new(face_cts, l->sched, weights[i]);
+        assert_non_null(f[i].sched);
+    }
+}
+
+static void
+teardown(struct link_s *l, struct face_s *f)
+{
+    int i;
+
+    for (i = 0; i < FACES; i++) {
+        ccnl_sched_destroy(f[i].sched);
+    }
+    ccnl_sched_destroy(l->sched);
+}
+
+void test_ccnl_sched_drr_weights()
+{
+    static struct link_s l;
+    static struct face_s f[FACES];
+    static const int weights[FACES] = {1, 2, 4};
+    static const int lens[FACES] = {1400, 300, 700};
+    long total = 0;
+    int i, k;
+
+    setup(&l, f, 0, 500, weights);
+    for (k = 0; k < 400; k++) {
+        for (i = 0; i < FACES; i++) {
+            face_send(f + i, lens[i]);
+        }
+    }
+    /** the link sends while every face still has packets queued */
+    while (total < 300000) {
+        assert_true(l.wire >= 0);
+        total += l.ring[l.wire][1];
+        link_done(&l);
+    }
+    for (i = 0; i < FACES; i++) {
+        long share = l.sent[i] * 7 * 100 / total;
+
+        assert_true(f[i].qlen > 0);
+        /** bytes, not packets, are shared by weight */
+        assert_true(share >= weights[i] * 100 - 5 &&
+                    share <= weights[i] * 100 + 5);
+    }
+    assert_int_equal(l.sched->cnt, CCNL_SCHED_DRR_DEPTH);
+    teardown(&l, f);
+}
+
+void test_ccnl_sched_drr_latecomer()
+{
+    static struct link_s l;
+    static struct face_s f[FACES];
+    static const int weights[FACES] = {1, 1, 1};
+    int i, first;
+
+    setup(&l, f, 0, 1500, weights);
+    for (i = 0; i < 100; i++) {
+        face_send(f, 1000);
+    }
+    for (i = 0; i < 10; i++) {
+        link_done(&l);
+    }
+    /** a face sending once is not queued behind the backlog of another */
+    first = l.nsent;
+    face_send(f + 1, 200);
+    while (!l.sent[1]) {
+        link_done(&l);
+    }
+    assert_true(l.nsent - first <= CCNL_SCHED_DRR_DEPTH + 2);
+    /** nor does it bank credit for later while idle */
+    link_done(&l);
+    assert_int_equal(f[1].sched->inround, 0);
+    assert_true(f[1].sched->deficit <= 0);
+    assert_int_equal(f[0].qlen + l.nsent + l.qlen + (l.wire >= 0), 101);
+    teardown(&l, f);
+}
+
+void test_ccnl_sched_drr_sync()
+{
+    static struct link_s l;
+    static struct face_s f[FACES];
+    static const int weights[FACES] = {1, 1, 1};
+    int i;
+
+    /** a link which sends right away takes everything at once */
+    setup(&l, f, 1, 0, weights);
+    for (i = 0; i < 20; i++) {
+        face_send(f + i % FACES, 300);
+    }
+    assert_int_equal(l.nsent, 20);
+    assert_int_equal(l.sched->cnt, 0);
+    assert_null(l.sched->active);
+    for (i = 0; i < FACES; i++) {
+        assert_int_equal(f[i].qlen, 0);
+        assert_int_equal(f[i].sched->cnt, 0);
+    }
+    teardown(&l, f);
+}
+
+void test_ccnl_sched_drr_remove()
+{
+    static struct link_s l;
+    static struct face_s f[FACES];
+    static const int weights[FACES] = {1, 1, 1};
+    int i;
+
+    setup(&l, f, 0, 0, weights);
+    for (i = 0; i < 30; i++) {
+        face_send(f + i % FACES, 1000);
+    }
+    /** a face removed in the middle of the round leaves it */
+    ccnl_sched_destroy(f[1].sched);
+    f[1].sched = NULL;
+    while (l.wire >= 0) {
+        link_done(&l);
+    }
+    assert_int_equal(f[0].qlen, 0);
+    assert_int_equal(f[2].qlen, 0);
+    assert_true(f[1].qlen > 0);
+    assert_null(l.sched->active);
+
+    /** faces outliving their interface send right away */
+    ccnl_sched_destroy(l.sched);
+    assert_false(ccnl_sched_is_drr(f[0].sched));
+    assert_int_equal(ccnl_sched_drr_weight(f[0].sched, 2), -1);
+    l.sched = ccnl_sched_dummy_new(link_cts, NULL);
+    l.sync = 1;
+    face_send(f, 100);
+    assert_int_equal(l.sent[0], 10 * 1000 + 100);
+    teardown(&l, f);
+}
+
+void test_ccnl_sched_drr_config()
+{
+    struct ccnl_sched_s *drr = ccnl_sched_drr_new(link_cts, NULL, 0, 0);
+    struct ccnl_sched_s *dummy = ccnl_sched_dummy_new(link_cts, NULL);
+    struct ccnl_sched_s *face;
+
+    assert_true(ccnl_sched_is_drr(drr));
+    assert_false(ccnl_sched_is_drr(dummy));
+    assert_false(ccnl_sched_is_drr(NULL));
+    assert_int_equal(drr->quantum, CCNL_SCHED_DRR_QUANTUM);
+    assert_null(ccnl_sched_drr_face_new(face_cts, dummy, 1));
+    assert_null(ccnl_sched_drr_face_new(face_cts, drr, 0));
+    assert_null(ccnl_sched_drr_face_new(face_cts, drr,
+                                        CCNL_SCHED_DRR_MAX_WEIGHT + 1));
+
+    face = ccnl_sched_drr_face_new(face_cts, drr, 1);
+    assert_non_null(face);
+    assert_false(ccnl_sched_is_drr(face));
+    assert_int_equal(ccnl_sched_drr_weight(face, 3), 0);
+    assert_int_equal(face->weight, 3);
+    assert_int_equal(ccnl_sched_drr_weight(face, 0), -1);
+    assert_int_equal(ccnl_sched_drr_weight(dummy, 1), -1);
+    assert_int_equal(face->weight, 3);
+
+    ccnl_sched_destroy(face);
+    assert_null(drr->flows);
+    ccnl_sched_destroy(drr);
+    ccnl_sched_destroy(dummy);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_sched_drr_weights),
+        unit_test(test_ccnl_sched_drr_latecomer),
+        unit_test(test_ccnl_sched_drr_sync),
+        unit_test(test_ccnl_sched_drr_remove),
+        unit_test(test_ccnl_sched_drr_config),
+    };
+
+    return run_tests(tests);
+}
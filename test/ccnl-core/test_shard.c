@@ -0,0 +1,395 @@
+/**
+ * @file test_shard.c
+ * @brief Tests for splitting the relay into workers by name
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <cmocka.h>
+
+#include "ccnl-shard.h"
+#include "ccnl-relay.h"
+#include "ccnl-dispatch.h"
+#include "ccnl-pkt-builder.h"
+
+#define NDN_INTEREST    0x05
+#define NDN_DATA        0x06
+
+/* the relays of two workers, as they would live in two processes */
+static struct ccnl_relay_s worker[2];
+static int sent;
+
+static void
+count_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+         sockunion *dest, struct ccnl_buf_s *buf)
+{
+    (void) ccnl;
+    (void) ifc;
+    (void) dest;
+    (void) buf;
+    sent++;
+}
+
+static void
+setup_workers(void)
+{
+    int i;
+
+    ccnl_core_init();
+    memset(worker, 0, sizeof(worker));
+    for (i = 0; i < 2; i++) {
+        worker[i].ccnl_ll_TX_ptr = count_TX;
+        worker[i].ifcount = 1;
+        // no socket, which a worker would give up
+        worker[i].ifs[0].sock = -1;
+        worker[i].max_pit_entries = -1;
+    }
+    sent = 0;
+}
+
+static void
+peer(sockunion *su, uint32_t ip)
+{
+    memset(su, 0, sizeof(*su));
+    su->ip4.sin_family = AF_INET;
+    su->ip4.sin_addr.s_addr = htonl(ip);
+    su->ip4.sin_port = htons(9695);
+}
+
+/* an NDN packet of the given type whose name is /shard/<c2>/<c3>/<c4> */
+static size_t
+mkpkt(uint8_t *out, uint8_t type, char c2, char c3, char c4)
+{
+    uint8_t name[] = {
+        0x07, 17,
+        0x08, 5, 's', 'h', 'a', 'r', 'd',
+        0x08, 1, (uint8_t) c2,
+        0x08, 1, (uint8_t) c3,
+        0x08, 1, (uint8_t) c4,
+    };
+
+    out[0] = type;
+    out[1] = sizeof(name) + 3;
+    memcpy(out + 2, name, sizeof(name));
+    // a nonce or content after the name, which the owner does not read
+    out[2 + sizeof(name)] = 0x0a;
+    out[3 + sizeof(name)] = 1;
+    out[4 + sizeof(name)] = type;
+    return sizeof(name) + 5;
+}
+
+void test_ccnl_shard_single()
+{
+    uint8_t pkt[64];
+    size_t len = mkpkt(pkt, NDN_INTEREST, 'a', 'b', 'c');
+    sockunion su;
+
+    memset(&su, 0, sizeof(su));
+    su.ip4.sin_family = AF_INET;
+    assert_int_equal(ccnl_shard_init(1), 0);
+    assert_int_equal(ccnl_shard_workers(), 1);
+    assert_int_equal(ccnl_shard_self(), 0);
+    assert_int_equal(ccnl_shard_fd(), -1);
+    assert_int_equal(ccnl_shard_owner(pkt, len), 0);
+    /** one worker never hands anything over */
+    assert_int_equal(ccnl_shard_steer(NULL, 0, pkt, len, &su), 0);
+    assert_null(ccnl_shard_stats(0));
+}
+
+void test_ccnl_shard_owner_meet()
+{
+    uint8_t interest[64], data[64];
+    size_t ilen, dlen;
+    int owner;
+
+    assert_int_equal(ccnl_shard_init(4), 0);
+    ilen = mkpkt(interest, NDN_INTEREST, 'a', 'b', '1');
+    owner = ccnl_shard_owner(interest, ilen);
+    assert_true(owner >= 0 && owner < 4);
+
+    /** the Data answering an Interest belongs to the same worker */
+    dlen = mkpkt(data, NDN_DATA, 'a', 'b', '1');
+    assert_int_equal(ccnl_shard_owner(data, dlen), owner);
+
+    /** only the first components count, chunks of a name stay together */
+    dlen = mkpkt(data, NDN_DATA, 'a', 'b', '2');
+    assert_int_equal(ccnl_shard_owner(data, dlen), owner);
+}
+
+void test_ccnl_shard_owner_spread()
+{
+    uint8_t pkt[64];
+    int seen[4] = { 0 };
+    int i;
+
+    assert_int_equal(ccnl_shard_init(4), 0);
+    for (i = 0; i < 64; i++) {
+        size_t len = mkpkt(pkt, NDN_INTEREST, (char) ('a' + i % 8),
+                           (char) ('a' + i / 8), '0');
+        int owner = ccnl_shard_owner(pkt, len);
+
+        assert_true(owner >= 0 && owner < 4);
+        seen[owner]++;
+    }
+    for (i = 0; i < 4; i++) {
+        assert_true(seen[i] > 0);
+    }
+}
+
+void test_ccnl_shard_owner_unnamed()
+{
+    uint8_t pkt[64];
+    size_t len;
+
+    assert_int_equal(ccnl_shard_init(2), 0);
+    len = mkpkt(pkt, NDN_INTEREST, 'a', 'b', 'c');
+
+    /** cut short inside the name */
+    assert_int_equal(ccnl_shard_owner(pkt, 6), -1);
+    /** no name where it is expected */
+    pkt[2] = 0x0a;
+    assert_int_equal(ccnl_shard_owner(pkt, len), -1);
+    /** not a packet of a suite the relay knows */
+    memset(pkt, 0xee, sizeof(pkt));
+    assert_int_equal(ccnl_shard_owner(pkt, sizeof(pkt)), -1);
+}
+
+void test_ccnl_shard_steer()
+{
+    uint8_t pkt[64];
+    size_t len;
+    sockunion su;
+    char c;
+
+    assert_int_equal(ccnl_shard_init(2), 0);
+    memset(&su, 0, sizeof(su));
+    su.ip4.sin_family = AF_INET;
+    su.ip4.sin_addr.s_addr = htonl(0x7f000001);
+    su.ip4.sin_port = htons(9695);
+
+    /** find a name owned by each worker */
+    for (c = 'a'; c <= 'z'; c++) {
+        len = mkpkt(pkt, NDN_INTEREST, c, 'x', 'y');
+        if (ccnl_shard_owner(pkt, len) == 1) {
+            break;
+        }
+    }
+    assert_true(c <= 'z');
+
+    /** worker 0 keeps nothing of worker 1 */
+    assert_int_equal(ccnl_shard_steer(NULL, 0, pkt, len, &su), 1);
+    assert_int_equal(ccnl_shard_stats(1)->handed, 1);
+    assert_int_equal(ccnl_shard_stats(1)->wake_pending, 1);
+
+    /** unnamed packets are processed where they arrive */
+    assert_int_equal(ccnl_shard_steer(NULL, 0, pkt, 6, &su), 0);
+    assert_int_equal(ccnl_shard_stats(1)->handed, 1);
+}
+
+void test_ccnl_shard_fib()
+{
+    char uri[] = "/shard/fib";
+    struct ccnl_prefix_s *pfx = ccnl_URItoPrefix(uri, CCNL_SUITE_DEFAULT, NULL);
+    struct ccnl_face_s *face;
+    struct ccnl_forward_s *fwd;
+    sockunion nexthop;
+
+    assert_int_equal(ccnl_shard_init(2), 0);
+    setup_workers();
+    peer(&nexthop, 0x0a000003);
+
+    /** a route added at worker 0 is passed on to worker 1 */
+    ccnl_shard_join(worker, 0);
+    face = ccnl_get_face_or_create(worker, 0, &nexthop.sa, sizeof(nexthop.ip4));
+    assert_non_null(face);
+    assert_int_equal(ccnl_fib_add_entry(worker, ccnl_prefix_dup(pfx), face), 0);
+    assert_null(ccnl_fib_lookup(worker + 1, pfx));
+    ccnl_shard_join(worker + 1, 1);
+    assert_int_equal(ccnl_shard_drain(worker + 1), 1);
+    fwd = ccnl_fib_lookup(worker + 1, pfx);
+    assert_non_null(fwd);
+    assert_non_null(fwd->face);
+    assert_int_equal(fwd->face->ifndx, 0);
+    assert_int_equal(fwd->face->peer.ip4.sin_addr.s_addr, nexthop.ip4.sin_addr.s_addr);
+    assert_int_equal(fwd->face->peer.ip4.sin_port, nexthop.ip4.sin_port);
+    /** and not sent back */
+    ccnl_shard_join(worker, 0);
+    assert_int_equal(ccnl_shard_drain(worker), 0);
+
+    /** so is its removal */
+    assert_int_equal(ccnl_fib_rem_entry(worker, pfx, face), 0);
+    assert_null(ccnl_fib_lookup(worker, pfx));
+    ccnl_shard_join(worker + 1, 1);
+    assert_int_equal(ccnl_shard_drain(worker + 1), 1);
+    assert_null(ccnl_fib_lookup(worker + 1, pfx));
+
+    ccnl_core_cleanup(worker);
+    ccnl_core_cleanup(worker + 1);
+    ccnl_prefix_free(pfx);
+}
+
+/* the route to /shard/fib/<i>, as added and looked up */
+static struct ccnl_prefix_s*
+route(int i)
+{
+    char uri[32];
+
+    snprintf(uri, sizeof(uri), "/shard/fib/%d", i);
+    return ccnl_URItoPrefix(uri, CCNL_SUITE_DEFAULT, NULL);
+}
+
+void test_ccnl_shard_fib_backlog()
+{
+    const int routes = 3 * CCNL_SHARD_RING_SLOTS;
+    struct ccnl_prefix_s *pfx;
+    struct ccnl_face_s *face;
+    sockunion nexthop;
+    int i, rounds;
+
+    assert_int_equal(ccnl_shard_init(2), 0);
+    setup_workers();
+    peer(&nexthop, 0x0a000003);
+
+    /** more changes than the ring to worker 1 holds, removals included */
+    ccnl_shard_join(worker, 0);
+    face = ccnl_get_face_or_create(worker, 0, &nexthop.sa, sizeof(nexthop.ip4));
+    assert_non_null(face);
+    for (i = 0; i < routes; i++) {
+        assert_int_equal(ccnl_fib_add_entry(worker, route(i), face), 0);
+    }
+    for (i = 0; i < routes; i += 3) {
+        pfx = route(i);
+        assert_int_equal(ccnl_fib_rem_entry(worker, pfx, face), 0);
+        ccnl_prefix_free(pfx);
+    }
+    assert_true(ccnl_shard_flush() > 0);
+    assert_int_equal(ccnl_shard_stats(0)->backlog, ccnl_shard_flush());
+
+    /** they wait at worker 0, which is woken whenever worker 1 drained */
+    for (rounds = 0; rounds < 10; rounds++) {
+        ccnl_shard_join(worker + 1, 1);
+        if (!ccnl_shard_drain(worker + 1)) {
+            break;
+        }
+        ccnl_shard_join(worker, 0);
+        assert_int_equal(ccnl_shard_stats(0)->wake_pending,
+                         ccnl_shard_stats(0)->backlog > 0);
+        assert_int_equal(ccnl_shard_drain(worker), 0);
+        ccnl_shard_flush();
+    }
+    assert_true(rounds > 1 && rounds < 10);
+    assert_int_equal(ccnl_shard_stats(0)->backlog, 0);
+
+    /** until both FIBs hold the same routes */
+    assert_int_equal(worker[1].fibcnt, worker[0].fibcnt);
+    assert_int_equal(worker[0].fibcnt, routes - routes / 3);
+    for (i = 0; i < routes; i++) {
+        struct ccnl_forward_s *fwd;
+
+        pfx = route(i);
+        fwd = ccnl_fib_lookup(worker + 1, pfx);
+        if (i % 3) {
+            assert_non_null(fwd);
+            assert_int_equal(fwd->face->peer.ip4.sin_addr.s_addr,
+                             nexthop.ip4.sin_addr.s_addr);
+        } else {
+            assert_null(fwd);
+        }
+        assert_true(!fwd == !ccnl_fib_lookup(worker, pfx));
+        ccnl_prefix_free(pfx);
+    }
+
+    ccnl_core_cleanup(worker);
+    ccnl_core_cleanup(worker + 1);
+}
+
+void test_ccnl_shard_offer()
+{
+    char uri[] = "/shard/offer/data";
+    struct ccnl_prefix_s *pfx = ccnl_URItoPrefix(uri, CCNL_SUITE_DEFAULT, NULL);
+    ccnl_interest_opts_u opts;
+    struct ccnl_buf_s *ibuf, *dbuf;
+    uint8_t *interest, *data;
+    size_t ilen, dlen;
+    sockunion consumer, producer;
+
+    assert_int_equal(ccnl_shard_init(2), 0);
+    setup_workers();
+    peer(&consumer, 0x0a000001);
+    peer(&producer, 0x0a000002);
+    memset(&opts, 0, sizeof(opts));
+    opts.ndntlv.nonce = 42;
+    ibuf = ccnl_mkSimpleInterest(pfx, &opts);
+    dbuf = ccnl_mkSimpleContent(pfx, (uint8_t*) "offer", 5, NULL, NULL);
+    assert_non_null(ibuf);
+    assert_non_null(dbuf);
+    interest = ibuf->data;
+    ilen = ibuf->datalen;
+    data = dbuf->data;
+    dlen = dbuf->datalen;
+
+    /** worker 1 holds the Interest, the Data reaches worker 0 */
+    ccnl_shard_join(worker + 1, 1);
+    ccnl_core_RX(worker + 1, 0, interest, ilen, &consumer.sa, sizeof(consumer.ip4));
+    assert_non_null(worker[1].pit);
+    ccnl_shard_join(worker, 0);
+    ccnl_core_RX(worker, 0, data, dlen, &producer.sa, sizeof(producer.ip4));
+    assert_int_equal(sent, 0);
+    assert_int_equal(ccnl_shard_stats(1)->wake_pending, 1);
+
+    /** which offers it to worker 1, where it is sent on */
+    ccnl_shard_join(worker + 1, 1);
+    assert_int_equal(ccnl_shard_drain(worker + 1), 1);
+    assert_int_equal(sent, 1);
+    assert_null(worker[1].pit);
+
+    /** Data offered and not wanted is not offered again */
+    assert_int_equal(ccnl_shard_drain(worker + 1), 0);
+    ccnl_shard_join(worker + 1, 1);
+    ccnl_core_RX(worker + 1, 0, data, dlen, &producer.sa, sizeof(producer.ip4));
+    ccnl_shard_join(worker, 0);
+    assert_int_equal(ccnl_shard_drain(worker), 1);
+    assert_int_equal(ccnl_shard_drain(worker), 0);
+    ccnl_shard_join(worker + 1, 1);
+    assert_int_equal(ccnl_shard_drain(worker + 1), 0);
+    assert_int_equal(sent, 1);
+
+    ccnl_core_cleanup(worker);
+    ccnl_core_cleanup(worker + 1);
+    ccnl_buf_free(ibuf);
+    ccnl_buf_free(dbuf);
+    ccnl_prefix_free(pfx);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_shard_single),
+        unit_test(test_ccnl_shard_owner_meet),
+        unit_test(test_ccnl_shard_owner_spread),
+        unit_test(test_ccnl_shard_owner_unnamed),
+        unit_test(test_ccnl_shard_steer),
+        unit_test(test_ccnl_shard_fib),
+        unit_test(test_ccnl_shard_fib_backlog),
+        unit_test(test_ccnl_shard_offer),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,72 @@
+/**
+ * @file test_simd.c
+ * @brief Tests for the vectorized byte comparison
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ccnl-simd.h"
+
+void test_ccnl_simd_equal()
+{
+    unsigned char a[100], b[100];
+    int level, len, pos;
+
+    for (len = 0; len < (int) sizeof(a); len++) {
+        a[len] = (unsigned char) (len * 7 + 1);
+    }
+    /** every level agrees with memcmp, whatever the length and offset of a difference */
+    for (level = CCNL_SIMD_SCALAR; level <= CCNL_SIMD_AVX2; level++) {
+        if (ccnl_simd_select(level) != level) {
+            continue;
+        }
+        for (len = 0; len <= 80; len++) {
+            memcpy(b, a + 3, sizeof(b) - 3);
+            assert_true(ccnl_simd_equal(a + 3, b, (size_t) len));
+            for (pos = 0; pos < len; pos++) {
+                b[pos] ^= 0x40;
+                assert_false(ccnl_simd_equal(a + 3, b, (size_t) len));
+                b[pos] ^= 0x40;
+            }
+            /** bytes after the end do not matter */
+            b[len] ^= 0x40;
+            assert_true(ccnl_simd_equal(a + 3, b, (size_t) len));
+        }
+    }
+}
+
+void test_ccnl_simd_select()
+{
+    /** the scalar code is always there, higher levels are capped */
+    assert_int_equal(ccnl_simd_select(CCNL_SIMD_SCALAR), CCNL_SIMD_SCALAR);
+    assert_string_equal(ccnl_simd_name(), "scalar");
+    assert_true(ccnl_simd_select(CCNL_SIMD_AVX2 + 1) <= CCNL_SIMD_AVX2);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_simd_equal),
+        unit_test(test_ccnl_simd_select),
+    };
+
+    return run_tests(tests);
+}
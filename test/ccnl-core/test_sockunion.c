@@ -107,6 +107,25 @@ void test_ccnl_addr2ascii_invalid()
     assert_string_equal(result, "(local)");
 }
 
+void test_ccnl_addr_hash()
+{
+    sockunion s1, s2;
+
+    assert_int_equal(ccnl_addr_hash(NULL), 0);
+
+    memset(&s1, 0, sizeof(s1));
+    memset(&s2, 0xff, sizeof(s2));
+    s1.ip4.sin_family = s2.ip4.sin_family = AF_INET;
+    s1.ip4.sin_addr.s_addr = s2.ip4.sin_addr.s_addr = htonl(0x0a000001);
+    s1.ip4.sin_port = s2.ip4.sin_port = htons(9695);
+    /** bytes which ccnl_addr_cmp ignores must not change the hash */
+    assert_int_equal(ccnl_addr_cmp(&s1, &s2), 0);
+    assert_int_equal(ccnl_addr_hash(&s1), ccnl_addr_hash(&s2));
+
+    s2.ip4.sin_port = htons(9696);
+    assert_true(ccnl_addr_hash(&s1) != ccnl_addr_hash(&s2));
+}
+
 int main(void)
 {
     const UnitTest tests[] = {
@@ -116,6 +135,7 @@ int main(void)
         unit_test(test_ccnl_is_local_addr_invalid),
         unit_test(test_ccnl_is_local_addr_valid),
         unit_test(test_ccnl_addr2ascii_invalid),
+        unit_test(test_ccnl_addr_hash),
     };
     
     return run_tests(tests);
@@ -0,0 +1,135 @@
+/**
+ * @file test_wheel.c
+ * @brief Tests for the ageing timer wheel
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ccnl-wheel.h"
+
+struct entry_s {
+    int id;
+    struct ccnl_wheel_link_s ageing;
+};
+
+static int
+pop_id(struct ccnl_wheel_s *wheel)
+{
+    struct ccnl_wheel_link_s *link = ccnl_wheel_pop(wheel);
+
+    return link ? CCNL_WHEEL_ENTRY(link, struct entry_s, ageing)->id : -1;
+}
+
+void test_ccnl_wheel_due()
+{
+    static struct ccnl_wheel_s wheel;
+    struct entry_s e[3];
+    int i;
+
+    memset(&wheel, 0, sizeof(wheel));
+    memset(e, 0, sizeof(e));
+    for (i = 0; i < 3; i++) {
+        e[i].id = i;
+    }
+    ccnl_wheel_add(&wheel, &e[0].ageing, 1000);
+    ccnl_wheel_add(&wheel, &e[1].ageing, 1001);
+    /** same slot, one turn later */
+    ccnl_wheel_add(&wheel, &e[2].ageing, 1000 + CCNL_AGEING_WHEEL_SLOTS);
+    assert_int_equal(wheel.count, 3);
+
+    ccnl_wheel_advance(&wheel, 999);
+    assert_int_equal(pop_id(&wheel), -1);
+
+    ccnl_wheel_advance(&wheel, 1000);
+    assert_int_equal(pop_id(&wheel), 0);
+    assert_int_equal(pop_id(&wheel), -1);
+    assert_null(e[0].ageing.head);
+    assert_int_equal(wheel.count, 2);
+
+    /** rescheduling moves an entry, the past means the next advance */
+    ccnl_wheel_add(&wheel, &e[1].ageing, 1003);
+    ccnl_wheel_add(&wheel, &e[0].ageing, 5);
+    assert_int_equal(e[0].ageing.due, 1001);
+    assert_int_equal(wheel.count, 3);
+    ccnl_wheel_advance(&wheel, 1002);
+    assert_int_equal(pop_id(&wheel), 0);
+    assert_int_equal(pop_id(&wheel), -1);
+
+    ccnl_wheel_advance(&wheel, 1003 + CCNL_AGEING_WHEEL_SLOTS);
+    assert_int_equal(pop_id(&wheel) + pop_id(&wheel), 1 + 2);
+    assert_int_equal(pop_id(&wheel), -1);
+    assert_int_equal(wheel.count, 0);
+}
+
+void test_ccnl_wheel_remove()
+{
+    static struct ccnl_wheel_s wheel;
+    struct entry_s e[2];
+
+    memset(&wheel, 0, sizeof(wheel));
+    memset(e, 0, sizeof(e));
+    e[0].id = 0;
+    e[1].id = 1;
+    ccnl_wheel_add(&wheel, &e[0].ageing, 10);
+    ccnl_wheel_add(&wheel, &e[1].ageing, 10);
+
+    /** an entry removed after it was collected is not handed out */
+    ccnl_wheel_advance(&wheel, 10);
+    ccnl_wheel_remove(&wheel, &e[0].ageing);
+    ccnl_wheel_remove(&wheel, &e[0].ageing);
+    assert_int_equal(wheel.count, 1);
+    assert_int_equal(pop_id(&wheel), 1);
+    assert_int_equal(pop_id(&wheel), -1);
+    assert_int_equal(wheel.count, 0);
+}
+
+void test_ccnl_wheel_pause()
+{
+    static struct ccnl_wheel_s wheel;
+    struct entry_s e[4];
+    int i, sum = 0;
+
+    memset(&wheel, 0, sizeof(wheel));
+    memset(e, 0, sizeof(e));
+    for (i = 0; i < 4; i++) {
+        e[i].id = i;
+        ccnl_wheel_add(&wheel, &e[i].ageing, 100 + i * 1000);
+    }
+    /** after a pause of several turns everything due is collected once */
+    ccnl_wheel_advance(&wheel, 2500);
+    for (i = 0; i < 3; i++) {
+        sum += pop_id(&wheel);
+    }
+    assert_int_equal(sum, 0 + 1 + 2);
+    assert_int_equal(pop_id(&wheel), -1);
+    assert_int_equal(wheel.next, 2501);
+    assert_int_equal(wheel.count, 1);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_wheel_due),
+        unit_test(test_ccnl_wheel_remove),
+        unit_test(test_ccnl_wheel_pause),
+    };
+
+    return run_tests(tests);
+}